@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.cpp
+// ============
+// count the heap allocations of every frame and check the steady state
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationCounter.h"
+#include "FrameStats.h"
+#include "Logger.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// declaration of the global variables and defines
+namespace
+{
+	// allocations of the current thread - a plain thread local
+	// counter, since it must not allocate itself
+	thread_local long long t_Allocations = 0;
+	std::atomic<long long> g_TotalAllocations(0);
+
+	// allocations of the render thread when the frame started
+	long long g_FrameStartAllocations = 0;
+	bool g_bCheck = false;
+	long long g_FailedFrames = 0;
+
+	/***********************************************************
+	 *  CountedAllocate()
+	 *
+	 *  Allocate from the heap and count the allocation.  A
+	 *  request for 0 bytes still returns a unique pointer.
+	 ***********************************************************/
+	void* CountedAllocate(size_t bytes)
+	{
+		t_Allocations++;
+		g_TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+		return(malloc((bytes > 0) ? bytes : 1));
+	}
+
+	/***********************************************************
+	 *  ThrowingAllocate()
+	 *
+	 *  Allocate like CountedAllocate(), calling the new
+	 *  handler and throwing when the heap is out of memory.
+	 ***********************************************************/
+	void* ThrowingAllocate(size_t bytes)
+	{
+		void* pMemory = CountedAllocate(bytes);
+		while (NULL == pMemory)
+		{
+			std::new_handler handler = std::get_new_handler();
+			if (NULL == handler)
+			{
+				throw std::bad_alloc();
+			}
+			handler();
+			pMemory = malloc((bytes > 0) ? bytes : 1);
+		}
+		return(pMemory);
+	}
+}
+
+/***********************************************************
+ *  operator new()
+ *
+ *  The replaced global allocation functions - they only
+ *  count the allocations, the memory comes from malloc().
+ ***********************************************************/
+void* operator new(size_t bytes)
+{
+	return(ThrowingAllocate(bytes));
+}
+
+void* operator new[](size_t bytes)
+{
+	return(ThrowingAllocate(bytes));
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept
+{
+	return(CountedAllocate(bytes));
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept
+{
+	return(CountedAllocate(bytes));
+}
+
+/***********************************************************
+ *  operator delete()
+ *
+ *  The replaced global free functions, matching the
+ *  allocation functions above.
+ ***********************************************************/
+void operator delete(void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
+
+/***********************************************************
+ *  GetThreadAllocations()
+ *
+ *  This function is used for getting the number of
+ *  allocations made on the calling thread.
+ ***********************************************************/
+long long AllocationCounter::GetThreadAllocations()
+{
+	return(t_Allocations);
+}
+
+/***********************************************************
+ *  GetTotalAllocations()
+ *
+ *  This function is used for getting the number of
+ *  allocations made on all of the threads.
+ ***********************************************************/
+long long AllocationCounter::GetTotalAllocations()
+{
+	return(g_TotalAllocations.load(std::memory_order_relaxed));
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This function is used for remembering the allocations
+ *  of the render thread at the start of the frame.
+ ***********************************************************/
+void AllocationCounter::BeginFrame()
+{
+	g_FrameStartAllocations = t_Allocations;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This function is used for publishing the allocations
+ *  the render thread made during the frame.  When the check
+ *  is on and the frame is in the steady state, a frame that
+ *  allocated is written as an error.  The count is taken
+ *  before the error is written, since writing it allocates.
+ ***********************************************************/
+void AllocationCounter::EndFrame(bool bSteadyState)
+{
+	long long allocations = t_Allocations - g_FrameStartAllocations;
+	FrameStats::AddCounter("heap allocations", allocations);
+
+	if ((g_bCheck == true) && (bSteadyState == true) && (allocations > 0))
+	{
+		g_FailedFrames++;
+		LOG_ERROR("Steady state frame " << FrameStats::GetFrameCount()
+			<< " made " << allocations << " heap allocations");
+	}
+}
+
+/***********************************************************
+ *  SetCheck()
+ *
+ *  This function is used for turning the check of the
+ *  steady state frames on or off.
+ ***********************************************************/
+void AllocationCounter::SetCheck(bool bCheck)
+{
+	g_bCheck = bCheck;
+}
+
+/***********************************************************
+ *  GetFailedFrames()
+ *
+ *  This function is used for getting the number of steady
+ *  state frames that allocated.
+ ***********************************************************/
+long long AllocationCounter::GetFailedFrames()
+{
+	return(g_FailedFrames);
+}
@@ -0,0 +1,42 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.h
+// ============
+// count the heap allocations of every frame and check the steady state
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  AllocationCounter
+ *
+ *  These functions count the calls to the global operator
+ *  new, which is replaced in allocationcounter.cpp.  Every
+ *  thread counts its own allocations, so the frame count
+ *  only holds what the render thread allocated between the
+ *  start and the end of the frame, not the work of the
+ *  logger or the worker threads.
+ *
+ *  When the check is turned on, a steady state frame - one
+ *  drawn after startup and warm-up, while nothing is being
+ *  loaded - that allocates is written as an error and
+ *  counted as failed.
+ ***********************************************************/
+namespace AllocationCounter
+{
+	// number of allocations made on the calling thread
+	long long GetThreadAllocations();
+	// number of allocations made on all threads
+	long long GetTotalAllocations();
+
+	// start counting the allocations of a frame, on the
+	// render thread
+	void BeginFrame();
+	// finish the frame and publish its allocations to the
+	// frame stats, checking them when the frame is steady
+	void EndFrame(bool bSteadyState);
+
+	// turn the check of the steady state frames on or off
+	void SetCheck(bool bCheck);
+	// number of steady state frames that allocated
+	long long GetFailedFrames();
+}
@@ -0,0 +1,192 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.cpp
+// ============
+// memory map a cooked asset pack and read its tables in place
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetPack.h"
+#include "ResourceTracker.h"
+#include "Logger.h"
+#include "FileMapping.h"
+
+// the records are read straight from the file, so their
+// layout must not depend on the compiler
+static_assert(sizeof(AssetPack::PACK_HEADER) == 96, "unexpected pack header layout");
+static_assert(sizeof(AssetPack::PACK_TEXTURE) == 216, "unexpected pack texture layout");
+static_assert(sizeof(AssetPack::PACK_MESH) == 72, "unexpected pack mesh layout");
+static_assert(sizeof(AssetPack::PACK_MATERIAL) == 32, "unexpected pack material layout");
+static_assert(sizeof(AssetPack::PACK_OBJECT) == 88, "unexpected pack object layout");
+
+/***********************************************************
+ *  AssetPack()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetPack::AssetPack()
+{
+	m_pFile = NULL;
+	m_fileSize = 0;
+	m_pHeader = NULL;
+	m_pTextures = NULL;
+	m_pMeshes = NULL;
+	m_pMaterials = NULL;
+	m_pObjects = NULL;
+	m_pStrings = NULL;
+	m_pData = NULL;
+}
+
+/***********************************************************
+ *  ~AssetPack()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AssetPack::~AssetPack()
+{
+	Close();
+}
+
+/***********************************************************
+ *  IsTableValid()
+ *
+ *  This method is used for checking that a table of records
+ *  lies inside of the mapped file and is aligned for
+ *  reading the records in place.
+ ***********************************************************/
+bool AssetPack::IsTableValid(uint64_t offset, uint64_t count, size_t recordSize) const
+{
+	if ((offset % 8) != 0)
+	{
+		return(false);
+	}
+	if ((offset > m_fileSize) || (count > ((m_fileSize - offset) / recordSize)))
+	{
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a pack file and checking
+ *  its header.  Every table has to lie inside of the file,
+ *  so the records can be read without further checks.
+ ***********************************************************/
+bool AssetPack::Open(const char* filename)
+{
+	Close();
+
+	m_pFile = FileMapping::MapFile(filename, m_fileSize);
+	if (NULL == m_pFile)
+	{
+		LOG_ERROR("Could not map asset pack:" << filename);
+		return(false);
+	}
+
+	m_pHeader = reinterpret_cast<const PACK_HEADER*>(m_pFile);
+	bool bValid = (m_fileSize >= sizeof(PACK_HEADER));
+	if (bValid == true)
+	{
+		const PACK_HEADER& header = *m_pHeader;
+		bValid = (header.magic == PACK_MAGIC) &&
+			(header.version == PACK_VERSION) &&
+			(header.fileSize == m_fileSize) &&
+			IsTableValid(header.textureTable, header.textureCount, sizeof(PACK_TEXTURE)) &&
+			IsTableValid(header.meshTable, header.meshCount, sizeof(PACK_MESH)) &&
+			IsTableValid(header.materialTable, header.materialCount, sizeof(PACK_MATERIAL)) &&
+			IsTableValid(header.objectTable, header.objectCount, sizeof(PACK_OBJECT)) &&
+			IsTableValid(header.stringTable, header.stringBytes, 1) &&
+			IsTableValid(header.dataOffset, header.dataBytes, 1) &&
+			(header.stringBytes > 0);
+
+		// every string has to end inside of the table
+		if (bValid == true)
+		{
+			bValid = (m_pFile[header.stringTable + header.stringBytes - 1] == '\0');
+		}
+	}
+
+	if (bValid == false)
+	{
+		LOG_ERROR("Asset pack is damaged or from another version:" << filename);
+		Close();
+		return(false);
+	}
+
+	const PACK_HEADER& header = *m_pHeader;
+	m_pTextures = reinterpret_cast<const PACK_TEXTURE*>(m_pFile + header.textureTable);
+	m_pMeshes = reinterpret_cast<const PACK_MESH*>(m_pFile + header.meshTable);
+	m_pMaterials = reinterpret_cast<const PACK_MATERIAL*>(m_pFile + header.materialTable);
+	m_pObjects = reinterpret_cast<const PACK_OBJECT*>(m_pFile + header.objectTable);
+	m_pStrings = reinterpret_cast<const char*>(m_pFile + header.stringTable);
+	m_pData = m_pFile + header.dataOffset;
+
+	// the mapping is address space rather than allocated
+	// memory, but its pages are resident while it is read
+	ResourceTracker::Track(ResourceTracker::RESOURCE_CPU, reinterpret_cast<uintptr_t>(m_pFile),
+		m_fileSize, ResourceTracker::CATEGORY_ASSET_STAGING, "asset pack mapping");
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the pack file.  The
+ *  records and data read from the pack are gone after it
+ *  is closed.
+ ***********************************************************/
+void AssetPack::Close()
+{
+	if (NULL != m_pFile)
+	{
+		ResourceTracker::Release(ResourceTracker::RESOURCE_CPU, reinterpret_cast<uintptr_t>(m_pFile));
+		FileMapping::UnmapFile(m_pFile, m_fileSize);
+	}
+
+	m_pFile = NULL;
+	m_fileSize = 0;
+	m_pHeader = NULL;
+	m_pTextures = NULL;
+	m_pMeshes = NULL;
+	m_pMaterials = NULL;
+	m_pObjects = NULL;
+	m_pStrings = NULL;
+	m_pData = NULL;
+}
+
+/***********************************************************
+ *  GetString()
+ *
+ *  This method is used for getting a string from the string
+ *  table.  The table ends with a terminator, so any offset
+ *  inside of it gives a terminated string.
+ ***********************************************************/
+const char* AssetPack::GetString(uint32_t offset) const
+{
+	if ((NULL == m_pStrings) || (offset >= m_pHeader->stringBytes))
+	{
+		return("");
+	}
+
+	return(m_pStrings + offset);
+}
+
+/***********************************************************
+ *  GetData()
+ *
+ *  This method is used for getting a range of the data
+ *  section for passing it to OpenGL.
+ ***********************************************************/
+const void* AssetPack::GetData(uint64_t offset, uint64_t bytes) const
+{
+	if ((NULL == m_pData) ||
+		(offset > m_pHeader->dataBytes) ||
+		(bytes > (m_pHeader->dataBytes - offset)))
+	{
+		return(NULL);
+	}
+
+	return(m_pData + offset);
+}
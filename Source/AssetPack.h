@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.h
+// ============
+// memory map a cooked asset pack and read its tables in place
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  AssetPack
+ *
+ *  This class maps a pack file written by AssetPackWriter
+ *  into memory.  The pack holds the scene textures with all
+ *  of their mip levels, the library meshes in the format
+ *  they are uploaded in, and the material and object tables
+ *  of the scene.  The tables are fixed size records that
+ *  are read straight from the mapping, and the texture and
+ *  mesh data is passed to OpenGL from the mapping without
+ *  being copied first.
+ *
+ *  The pack is written in the byte order of the machine it
+ *  was cooked on - a pack from a machine with the other
+ *  byte order fails the magic number check.
+ ***********************************************************/
+class AssetPack
+{
+public:
+	// "SPAK" - identifies the file as an asset pack
+	static const uint32_t PACK_MAGIC = 0x4b415053;
+	// changed whenever the layout of the records changes
+	static const uint32_t PACK_VERSION = 1;
+	// largest number of mip levels stored for a texture
+	static const int MAX_TEXTURE_LEVELS = 16;
+
+	// start of the file, with the location of every table
+	struct PACK_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t fileSize;
+		uint32_t textureCount;
+		uint32_t meshCount;
+		uint32_t materialCount;
+		uint32_t objectCount;
+		uint64_t textureTable;
+		uint64_t meshTable;
+		uint64_t materialTable;
+		uint64_t objectTable;
+		uint64_t stringTable;
+		uint64_t stringBytes;
+		// texture and mesh data offsets are relative to the
+		// start of the data section
+		uint64_t dataOffset;
+		uint64_t dataBytes;
+	};
+
+	// a texture with its mip chain, either compressed or
+	// as 8 bit RGBA
+	struct PACK_TEXTURE
+	{
+		uint64_t levelOffsets[MAX_TEXTURE_LEVELS];
+		uint32_t levelBytes[MAX_TEXTURE_LEVELS];
+		uint32_t tagOffset;
+		uint32_t internalFormat;
+		uint32_t width;
+		uint32_t height;
+		uint32_t levelCount;
+		uint32_t reserved;
+	};
+
+	// a library mesh, ready to be uploaded
+	struct PACK_MESH
+	{
+		uint64_t vertexOffset;
+		uint64_t vertexBytes;
+		uint64_t indexOffset;
+		uint64_t indexBytes;
+		uint32_t tagOffset;
+		// MeshLibrary::VERTEX_FORMAT
+		uint32_t format;
+		uint32_t indexType;
+		uint32_t indexCount;
+		float positionOffset[3];
+		float positionScale[3];
+	};
+
+	// a scene material
+	struct PACK_MATERIAL
+	{
+		uint32_t tagOffset;
+		float diffuseColor[3];
+		float specularColor[3];
+		float shininess;
+	};
+
+	// an object placed in the scene
+	struct PACK_OBJECT
+	{
+		uint32_t tagOffset;
+		uint32_t textureTagOffset;
+		uint32_t materialTagOffset;
+		// library mesh the object is drawn with, the empty
+		// string when it uses its basic mesh
+		uint32_t meshTagOffset;
+		// SceneManager::MESH_TYPE
+		uint32_t mesh;
+		uint32_t bStatic;
+		float scaleXYZ[3];
+		float rotationDegrees[3];
+		float positionXYZ[3];
+		float color[4];
+		float UVscale[2];
+		uint32_t reserved;
+	};
+
+	// constructor
+	AssetPack();
+	// destructor
+	~AssetPack();
+
+	// map a pack file and check that its tables are valid
+	bool Open(const char* filename);
+	// unmap the pack file
+	void Close();
+
+	bool IsOpen() const { return(NULL != m_pFile); }
+	size_t GetFileSize() const { return(m_fileSize); }
+
+	// the tables of the pack, read in place
+	const PACK_HEADER& GetHeader() const { return(*m_pHeader); }
+	const PACK_TEXTURE* GetTextures() const { return(m_pTextures); }
+	const PACK_MESH* GetMeshes() const { return(m_pMeshes); }
+	const PACK_MATERIAL* GetMaterials() const { return(m_pMaterials); }
+	const PACK_OBJECT* GetObjects() const { return(m_pObjects); }
+
+	// get a string from the string table, the empty string
+	// for an offset outside of the table
+	const char* GetString(uint32_t offset) const;
+	// get a range of the data section, NULL when the range
+	// is not inside of it
+	const void* GetData(uint64_t offset, uint64_t bytes) const;
+
+private:
+	// check that a table lies inside of the file
+	bool IsTableValid(uint64_t offset, uint64_t count, size_t recordSize) const;
+
+	// the mapped file
+	const unsigned char* m_pFile;
+	size_t m_fileSize;
+
+	const PACK_HEADER* m_pHeader;
+	const PACK_TEXTURE* m_pTextures;
+	const PACK_MESH* m_pMeshes;
+	const PACK_MATERIAL* m_pMaterials;
+	const PACK_OBJECT* m_pObjects;
+	const char* m_pStrings;
+	const unsigned char* m_pData;
+};
@@ -0,0 +1,348 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpackwriter.cpp
+// ============
+// cook the loaded scene assets into an asset pack file
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetPackWriter.h"
+#include "GLState.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// declaration of the global variables and defines
+namespace
+{
+	// tables and data blocks start on this boundary, so the
+	// records can be read in place and the data is aligned
+	// for the driver
+	const size_t PACK_ALIGNMENT = 16;
+
+	/***********************************************************
+	 *  AlignOffset()
+	 *
+	 *  Round an offset up to the pack alignment.
+	 ***********************************************************/
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return((offset + PACK_ALIGNMENT - 1) & ~static_cast<uint64_t>(PACK_ALIGNMENT - 1));
+	}
+}
+
+/***********************************************************
+ *  AssetPackWriter()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetPackWriter::AssetPackWriter()
+{
+	m_textureBytes = 0;
+
+	// offset 0 is the empty string
+	m_strings.push_back('\0');
+}
+
+/***********************************************************
+ *  AddString()
+ *
+ *  This method is used for adding a string to the string
+ *  table.  The empty string is shared.
+ ***********************************************************/
+uint32_t AssetPackWriter::AddString(const std::string& text)
+{
+	if (text.empty() == true)
+	{
+		return(0);
+	}
+
+	uint32_t offset = static_cast<uint32_t>(m_strings.size());
+	m_strings.insert(m_strings.end(), text.begin(), text.end());
+	m_strings.push_back('\0');
+
+	return(offset);
+}
+
+/***********************************************************
+ *  AddData()
+ *
+ *  This method is used for adding a block of texture or
+ *  mesh data to the data section.
+ ***********************************************************/
+uint64_t AssetPackWriter::AddData(const void* pData, size_t bytes)
+{
+	uint64_t offset = AlignOffset(m_data.size());
+	m_data.resize(static_cast<size_t>(offset) + bytes);
+	memcpy(&m_data[static_cast<size_t>(offset)], pData, bytes);
+
+	return(offset);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for reading a loaded texture back
+ *  from a layer of its texture array.  Every mip level is
+ *  read as RGBA and, when
+ *  the driver supports S3TC, uploaded into a scratch texture
+ *  with a compressed format and read back compressed.  The
+ *  driver compression is slow, so it only runs while
+ *  cooking and never at startup.
+ ***********************************************************/
+bool AssetPackWriter::AddTexture(std::string tag, GLuint arrayTextureID, int layer)
+{
+	GLint width = 0;
+	GLint height = 0;
+	GLint layerCount = 0;
+	GLint sourceFormat = 0;
+
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, arrayTextureID);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_HEIGHT, &height);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_DEPTH, &layerCount);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_INTERNAL_FORMAT, &sourceFormat);
+	if ((width <= 0) || (height <= 0) || (layer < 0) || (layer >= layerCount))
+	{
+		GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		return(false);
+	}
+
+	// textures without alpha fit into half the space
+	GLenum internalFormat = GL_RGBA8;
+	if (GLEW_EXT_texture_compression_s3tc)
+	{
+		internalFormat = (sourceFormat == GL_RGBA8) ?
+			GL_COMPRESSED_RGBA_S3TC_DXT5_EXT :
+			GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	}
+
+	AssetPack::PACK_TEXTURE texture;
+	memset(&texture, 0, sizeof(texture));
+	texture.tagOffset = AddString(tag);
+	texture.internalFormat = internalFormat;
+	texture.width = static_cast<uint32_t>(width);
+	texture.height = static_cast<uint32_t>(height);
+
+	// a texture that fails to compress leaves no data behind
+	size_t dataBytes = m_data.size();
+	size_t textureBytes = m_textureBytes;
+
+	GLuint scratchID = 0;
+	if (internalFormat != GL_RGBA8)
+	{
+		glGenTextures(1, &scratchID);
+	}
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// a level is read back with all of the layers
+	std::vector<unsigned char> layerPixels;
+	std::vector<unsigned char> compressed;
+	bool bSuccess = true;
+	int levelWidth = width;
+	int levelHeight = height;
+	int level = 0;
+	while ((level < AssetPack::MAX_TEXTURE_LEVELS) && (bSuccess == true))
+	{
+		size_t levelBytes = static_cast<size_t>(levelWidth) * levelHeight * 4;
+		layerPixels.resize(levelBytes * layerCount);
+		GLState::BindTexture(GL_TEXTURE_2D_ARRAY, arrayTextureID);
+		glGetTexImage(GL_TEXTURE_2D_ARRAY, level, GL_RGBA, GL_UNSIGNED_BYTE, layerPixels.data());
+
+		const unsigned char* pPixels = layerPixels.data() + levelBytes * layer;
+		const unsigned char* pLevelData = pPixels;
+		if (scratchID != 0)
+		{
+			GLint bCompressed = GL_FALSE;
+			GLint compressedBytes = 0;
+			GLState::BindTexture(GL_TEXTURE_2D, scratchID);
+			glTexImage2D(GL_TEXTURE_2D, level, internalFormat, levelWidth, levelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pPixels);
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED, &bCompressed);
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressedBytes);
+
+			if ((bCompressed == GL_FALSE) || (compressedBytes <= 0))
+			{
+				bSuccess = false;
+				break;
+			}
+
+			compressed.resize(static_cast<size_t>(compressedBytes));
+			glGetCompressedTexImage(GL_TEXTURE_2D, level, compressed.data());
+			pLevelData = compressed.data();
+			levelBytes = compressed.size();
+		}
+
+		texture.levelOffsets[level] = AddData(pLevelData, levelBytes);
+		texture.levelBytes[level] = static_cast<uint32_t>(levelBytes);
+		m_textureBytes += levelBytes;
+		level++;
+
+		if ((levelWidth == 1) && (levelHeight == 1))
+		{
+			break;
+		}
+		levelWidth = std::max(1, levelWidth / 2);
+		levelHeight = std::max(1, levelHeight / 2);
+	}
+	texture.levelCount = static_cast<uint32_t>(level);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	if (scratchID != 0)
+	{
+		GLState::BindTexture(GL_TEXTURE_2D, 0);
+		glDeleteTextures(1, &scratchID);
+	}
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	if (bSuccess == false)
+	{
+		m_data.resize(dataBytes);
+		m_textureBytes = textureBytes;
+		LOG_ERROR("Could not compress texture:" << tag);
+		return(false);
+	}
+
+	m_textures.push_back(texture);
+
+	return(true);
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for adding the uploaded buffers of a
+ *  library mesh.
+ ***********************************************************/
+void AssetPackWriter::AddMesh(std::string tag, const MeshLibrary::MESH_BUFFERS& buffers)
+{
+	AssetPack::PACK_MESH mesh;
+	memset(&mesh, 0, sizeof(mesh));
+
+	mesh.tagOffset = AddString(tag);
+	mesh.format = static_cast<uint32_t>(buffers.format);
+	mesh.indexType = buffers.indexType;
+	mesh.indexCount = static_cast<uint32_t>(buffers.indexCount);
+	mesh.vertexBytes = buffers.vertexBytes;
+	mesh.vertexOffset = AddData(buffers.vertices, buffers.vertexBytes);
+	mesh.indexBytes = buffers.indexBytes;
+	mesh.indexOffset = AddData(buffers.indices, buffers.indexBytes);
+	for (int axis = 0; axis < 3; axis++)
+	{
+		mesh.positionOffset[axis] = buffers.positionOffset[axis];
+		mesh.positionScale[axis] = buffers.positionScale[axis];
+	}
+
+	m_meshes.push_back(mesh);
+}
+
+/***********************************************************
+ *  AddMaterial()
+ *
+ *  This method is used for adding a scene material.
+ ***********************************************************/
+void AssetPackWriter::AddMaterial(std::string tag, AssetPack::PACK_MATERIAL material)
+{
+	material.tagOffset = AddString(tag);
+	m_materials.push_back(material);
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for adding an object placed in the
+ *  scene.
+ ***********************************************************/
+void AssetPackWriter::AddObject(
+	std::string tag,
+	std::string textureTag,
+	std::string materialTag,
+	std::string meshTag,
+	AssetPack::PACK_OBJECT object)
+{
+	object.tagOffset = AddString(tag);
+	object.textureTagOffset = AddString(textureTag);
+	object.materialTagOffset = AddString(materialTag);
+	object.meshTagOffset = AddString(meshTag);
+	object.reserved = 0;
+	m_objects.push_back(object);
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for writing the collected assets
+ *  into a pack file - the header, the record tables, the
+ *  string table and the data section, each aligned so the
+ *  file can be read in place once it is mapped.
+ ***********************************************************/
+bool AssetPackWriter::Write(const char* filename)
+{
+	AssetPack::PACK_HEADER header;
+	memset(&header, 0, sizeof(header));
+
+	header.magic = AssetPack::PACK_MAGIC;
+	header.version = AssetPack::PACK_VERSION;
+	header.textureCount = static_cast<uint32_t>(m_textures.size());
+	header.meshCount = static_cast<uint32_t>(m_meshes.size());
+	header.materialCount = static_cast<uint32_t>(m_materials.size());
+	header.objectCount = static_cast<uint32_t>(m_objects.size());
+
+	header.textureTable = AlignOffset(sizeof(header));
+	header.meshTable = AlignOffset(header.textureTable + m_textures.size() * sizeof(AssetPack::PACK_TEXTURE));
+	header.materialTable = AlignOffset(header.meshTable + m_meshes.size() * sizeof(AssetPack::PACK_MESH));
+	header.objectTable = AlignOffset(header.materialTable + m_materials.size() * sizeof(AssetPack::PACK_MATERIAL));
+	header.stringTable = AlignOffset(header.objectTable + m_objects.size() * sizeof(AssetPack::PACK_OBJECT));
+	header.stringBytes = m_strings.size();
+	header.dataOffset = AlignOffset(header.stringTable + header.stringBytes);
+	header.dataBytes = m_data.size();
+	header.fileSize = header.dataOffset + header.dataBytes;
+
+	std::vector<unsigned char> file(static_cast<size_t>(header.fileSize), 0);
+	memcpy(&file[0], &header, sizeof(header));
+	if (m_textures.empty() == false)
+	{
+		memcpy(&file[header.textureTable], m_textures.data(), m_textures.size() * sizeof(AssetPack::PACK_TEXTURE));
+	}
+	if (m_meshes.empty() == false)
+	{
+		memcpy(&file[header.meshTable], m_meshes.data(), m_meshes.size() * sizeof(AssetPack::PACK_MESH));
+	}
+	if (m_materials.empty() == false)
+	{
+		memcpy(&file[header.materialTable], m_materials.data(), m_materials.size() * sizeof(AssetPack::PACK_MATERIAL));
+	}
+	if (m_objects.empty() == false)
+	{
+		memcpy(&file[header.objectTable], m_objects.data(), m_objects.size() * sizeof(AssetPack::PACK_OBJECT));
+	}
+	memcpy(&file[header.stringTable], m_strings.data(), m_strings.size());
+	if (m_data.empty() == false)
+	{
+		memcpy(&file[header.dataOffset], m_data.data(), m_data.size());
+	}
+
+	std::ofstream stream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (stream.is_open() == false)
+	{
+		LOG_ERROR("Could not create asset pack:" << filename);
+		return(false);
+	}
+
+	stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+	stream.close();
+	if (stream.fail() == true)
+	{
+		LOG_ERROR("Could not write asset pack:" << filename);
+		return(false);
+	}
+
+	LOG_INFO("Cooked asset pack:" << filename << ", bytes:" << file.size()
+		<< ", textures:" << m_textures.size() << ", meshes:" << m_meshes.size()
+		<< ", objects:" << m_objects.size());
+
+	return(true);
+}
@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpackwriter.h
+// ============
+// cook the loaded scene assets into an asset pack file
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AssetPack.h"
+#include "MeshLibrary.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  AssetPackWriter
+ *
+ *  This class collects the assets of a scene that was
+ *  loaded from the loose files and writes them into one
+ *  pack file that AssetPack can map.  The textures and
+ *  meshes are read back from OpenGL, so the pack holds
+ *  exactly what the loose path uploaded - the textures with
+ *  their whole mip chain, compressed by the driver when
+ *  S3TC compression is supported.
+ ***********************************************************/
+class AssetPackWriter
+{
+public:
+	// constructor
+	AssetPackWriter();
+
+	// read back a layer of a loaded texture array with all
+	// of its mip levels
+	bool AddTexture(std::string tag, GLuint arrayTextureID, int layer);
+	// add the buffers of a library mesh
+	void AddMesh(std::string tag, const MeshLibrary::MESH_BUFFERS& buffers);
+	// add a material - the tag is filled in by the writer
+	void AddMaterial(std::string tag, AssetPack::PACK_MATERIAL material);
+	// add a scene object - the tags are filled in by the writer
+	void AddObject(
+		std::string tag,
+		std::string textureTag,
+		std::string materialTag,
+		std::string meshTag,
+		AssetPack::PACK_OBJECT object);
+
+	// write the collected assets into a pack file
+	bool Write(const char* filename);
+
+	// number of bytes the texture data was cooked into
+	size_t GetTextureBytes() const { return(m_textureBytes); }
+
+private:
+	// add a string to the string table and return its offset
+	uint32_t AddString(const std::string& text);
+	// add a block to the data section and return its offset
+	uint64_t AddData(const void* pData, size_t bytes);
+
+	std::vector<AssetPack::PACK_TEXTURE> m_textures;
+	std::vector<AssetPack::PACK_MESH> m_meshes;
+	std::vector<AssetPack::PACK_MATERIAL> m_materials;
+	std::vector<AssetPack::PACK_OBJECT> m_objects;
+	std::vector<char> m_strings;
+	std::vector<unsigned char> m_data;
+	size_t m_textureBytes;
+};
@@ -0,0 +1,439 @@
+///////////////////////////////////////////////////////////////////////////////
+// batchrenderer.cpp
+// ============
+// render stills from a list of camera poses and write them to image files
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BatchRenderer.h"
+#include "GLState.h"
+#include "Logger.h"
+#include "ResourceTracker.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+// declaration of the global variables and defines
+namespace
+{
+	// wait in steps of one millisecond for a read back
+	const GLuint64 FENCE_WAIT_TIMEOUT = 1000000;
+	// bytes of a read back pixel
+	const int READBACK_PIXEL_BYTES = 4;
+}
+
+/***********************************************************
+ *  BatchRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BatchRenderer::BatchRenderer()
+{
+	m_nextPose = 0;
+	m_width = 0;
+	m_height = 0;
+	m_frameBytes = 0;
+	m_nextSlot = 0;
+	m_readbackWaits = 0;
+	m_activeJobs = 0;
+	m_failedStills = 0;
+	m_bStopEncoders = false;
+
+	for (int i = 0; i < READBACK_SLOTS; i++)
+	{
+		m_slots[i].buffer = 0;
+		m_slots[i].fence = 0;
+		m_slots[i].still = -1;
+	}
+}
+
+/***********************************************************
+ *  ~BatchRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+BatchRenderer::~BatchRenderer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopEncoders = true;
+	}
+	m_jobReady.notify_all();
+	for (size_t i = 0; i < m_encoders.size(); i++)
+	{
+		m_encoders[i].join();
+	}
+	m_encoders.clear();
+
+	for (int i = 0; i < READBACK_SLOTS; i++)
+	{
+		if (0 != m_slots[i].fence)
+		{
+			glDeleteSync(m_slots[i].fence);
+			m_slots[i].fence = 0;
+		}
+		if (0 != m_slots[i].buffer)
+		{
+			ResourceTracker::Release(ResourceTracker::RESOURCE_BUFFER, m_slots[i].buffer);
+			GLState::DeleteBuffer(m_slots[i].buffer);
+			m_slots[i].buffer = 0;
+		}
+	}
+}
+
+/***********************************************************
+ *  LoadCameraList()
+ *
+ *  This method is used for reading the poses of the camera
+ *  list.  A line that cannot be read stops the loading, so
+ *  a broken list is not rendered in part.
+ ***********************************************************/
+bool BatchRenderer::LoadCameraList(const char* filename)
+{
+	m_poses.clear();
+	m_nextPose = 0;
+
+	std::ifstream file(filename);
+	if (file.is_open() == false)
+	{
+		LOG_ERROR("Could not open the camera list " << filename);
+		return(false);
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		size_t start = line.find_first_not_of(" \t\r");
+		if ((start == std::string::npos) || (line[start] == '#'))
+		{
+			continue;
+		}
+
+		std::istringstream values(line);
+		CAMERA_POSE pose;
+		if (!(values >> pose.position.x >> pose.position.y >> pose.position.z
+			>> pose.target.x >> pose.target.y >> pose.target.z))
+		{
+			LOG_ERROR("Could not read line " << lineNumber << " of the camera list " << filename);
+			m_poses.clear();
+			return(false);
+		}
+		if (!(values >> pose.fieldOfView))
+		{
+			pose.fieldOfView = 0.0f;
+		}
+		m_poses.push_back(pose);
+	}
+
+	if (m_poses.empty() == true)
+	{
+		LOG_ERROR("The camera list " << filename << " has no poses");
+		return(false);
+	}
+
+	LOG_INFO("INFO: Loaded " << m_poses.size() << " camera poses from " << filename);
+	return(true);
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for creating the ring of pixel
+ *  buffers for frames of the passed in size and starting
+ *  the encoder threads.  One core is left for drawing the
+ *  frames.
+ ***********************************************************/
+void BatchRenderer::Start(int width, int height, const char* outputPrefix)
+{
+	m_width = width;
+	m_height = height;
+	m_frameBytes = static_cast<size_t>(width) * height * READBACK_PIXEL_BYTES;
+	m_outputPrefix = outputPrefix;
+	m_nextPose = 0;
+
+	for (int i = 0; i < READBACK_SLOTS; i++)
+	{
+		glGenBuffers(1, &m_slots[i].buffer);
+		GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, m_slots[i].buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER, m_frameBytes, NULL, GL_STREAM_READ);
+		ResourceTracker::Track(ResourceTracker::RESOURCE_BUFFER, m_slots[i].buffer, m_frameBytes,
+			ResourceTracker::CATEGORY_READBACK, "batch readback buffer");
+	}
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	int encoderCount = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+	if (encoderCount < 1)
+	{
+		encoderCount = 1;
+	}
+	if (encoderCount > MAX_ENCODERS)
+	{
+		encoderCount = MAX_ENCODERS;
+	}
+	for (int i = 0; i < encoderCount; i++)
+	{
+		m_encoders.push_back(std::thread(&BatchRenderer::EncoderMain, this));
+	}
+
+	m_startTime = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  GetPose()
+ *
+ *  This method is used for getting the pose of the next
+ *  still.
+ ***********************************************************/
+bool BatchRenderer::GetPose(CAMERA_POSE& pose) const
+{
+	if (IsFinished() == true)
+	{
+		return(false);
+	}
+
+	pose = m_poses[m_nextPose];
+	return(true);
+}
+
+/***********************************************************
+ *  CaptureFrame()
+ *
+ *  This method is used for reading the frame in the back
+ *  buffer into the next pixel buffer of the ring.  The read
+ *  only queues the copy on the GPU - the frame that last
+ *  used the slot is collected first, which only waits when
+ *  the GPU is a whole ring behind.
+ ***********************************************************/
+void BatchRenderer::CaptureFrame()
+{
+	if (IsFinished() == true)
+	{
+		return;
+	}
+
+	READBACK_SLOT& slot = m_slots[m_nextSlot];
+	if ((0 != slot.fence) && (ReadSlot(slot, false) == false))
+	{
+		m_readbackWaits++;
+		ReadSlot(slot, true);
+	}
+
+	GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.still = static_cast<int>(m_nextPose);
+	m_nextSlot = (m_nextSlot + 1) % READBACK_SLOTS;
+	m_nextPose++;
+
+	// hand the frames that are already done to the encoders
+	CollectReadbacks(false);
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for collecting the read backs that
+ *  are still in flight and waiting until the encoders have
+ *  written every still.
+ ***********************************************************/
+void BatchRenderer::Finish()
+{
+	CollectReadbacks(true);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_activeJobs > 0)
+	{
+		m_jobDone.wait(lock);
+	}
+
+	double totalTime = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - m_startTime).count();
+	size_t stillCount = std::max(m_nextPose, static_cast<size_t>(1));
+	LOG_INFO("INFO: Batch rendered " << m_nextPose << " stills in " << totalTime << " ms, "
+		<< (totalTime / stillCount) << " ms per still, " << m_readbackWaits << " read back waits");
+	if (m_failedStills > 0)
+	{
+		LOG_ERROR(m_failedStills << " stills could not be written");
+	}
+}
+
+/***********************************************************
+ *  CollectReadbacks()
+ *
+ *  This method is used for copying the finished read backs
+ *  out of their buffers, from the oldest one on, so the
+ *  stills reach the encoders in the order of the poses.
+ ***********************************************************/
+void BatchRenderer::CollectReadbacks(bool bWait)
+{
+	for (int i = 0; i < READBACK_SLOTS; i++)
+	{
+		READBACK_SLOT& slot = m_slots[(m_nextSlot + i) % READBACK_SLOTS];
+		if (0 == slot.fence)
+		{
+			continue;
+		}
+		if (ReadSlot(slot, bWait) == false)
+		{
+			return;
+		}
+	}
+}
+
+/***********************************************************
+ *  ReadSlot()
+ *
+ *  This method is used for copying a read back out of its
+ *  buffer once its fence has passed, and queueing it for
+ *  the encoders.  The copy goes into pixels an encoder
+ *  handed back, so the batch stops allocating once the
+ *  queue is full, and waits for the encoders when it is.
+ ***********************************************************/
+bool BatchRenderer::ReadSlot(READBACK_SLOT& slot, bool bWait)
+{
+	GLenum result = glClientWaitSync(slot.fence, 0, 0);
+	if ((result == GL_TIMEOUT_EXPIRED) || (result == GL_WAIT_FAILED))
+	{
+		if (bWait == false)
+		{
+			return(false);
+		}
+
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		while (result == GL_TIMEOUT_EXPIRED)
+		{
+			result = glClientWaitSync(slot.fence, flags, FENCE_WAIT_TIMEOUT);
+			flags = 0;
+		}
+	}
+	glDeleteSync(slot.fence);
+	slot.fence = 0;
+
+	ENCODE_JOB job;
+	job.still = slot.still;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (m_jobs.size() >= MAX_QUEUED_STILLS)
+		{
+			m_jobDone.wait(lock);
+		}
+		if (m_freePixels.empty() == false)
+		{
+			job.pixels.swap(m_freePixels.back());
+			m_freePixels.pop_back();
+		}
+	}
+	job.pixels.resize(m_frameBytes);
+
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	const void* pMapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_frameBytes, GL_MAP_READ_BIT);
+	if (NULL != pMapped)
+	{
+		memcpy(&job.pixels[0], pMapped, m_frameBytes);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	GLState::BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (NULL == pMapped)
+		{
+			m_failedStills++;
+			m_freePixels.push_back(std::move(job.pixels));
+			return(true);
+		}
+		m_jobs.push_back(std::move(job));
+		m_activeJobs++;
+	}
+	m_jobReady.notify_one();
+
+	return(true);
+}
+
+/***********************************************************
+ *  EncoderMain()
+ *
+ *  This method is the loop of the encoder threads.  They
+ *  write the queued stills until the batch renderer is
+ *  destroyed, and hand their pixels back for reuse.
+ ***********************************************************/
+void BatchRenderer::EncoderMain()
+{
+	while (true)
+	{
+		ENCODE_JOB job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while ((m_bStopEncoders == false) && (m_jobs.empty() == true))
+			{
+				m_jobReady.wait(lock);
+			}
+			if (m_jobs.empty() == true)
+			{
+				return;
+			}
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		bool bWritten = WriteImage(job);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (bWritten == false)
+			{
+				m_failedStills++;
+			}
+			m_freePixels.push_back(std::move(job.pixels));
+			m_activeJobs--;
+		}
+		m_jobDone.notify_all();
+	}
+}
+
+/***********************************************************
+ *  WriteImage()
+ *
+ *  This method is used for writing a still into a binary
+ *  PPM file, with the rows of the read back turned so the
+ *  top row comes first.
+ ***********************************************************/
+bool BatchRenderer::WriteImage(const ENCODE_JOB& job) const
+{
+	char number[16];
+	snprintf(number, sizeof(number), "%05d", job.still);
+	std::string filename = m_outputPrefix + number + ".ppm";
+
+	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		LOG_ERROR("Could not write the still " << filename);
+		return(false);
+	}
+
+	file << "P6\n" << m_width << " " << m_height << "\n255\n";
+	std::vector<unsigned char> row(static_cast<size_t>(m_width) * 3);
+	for (int y = m_height - 1; y >= 0; y--)
+	{
+		const unsigned char* pPixel = &job.pixels[static_cast<size_t>(y) * m_width * READBACK_PIXEL_BYTES];
+		for (int x = 0; x < m_width; x++)
+		{
+			row[x * 3] = pPixel[0];
+			row[x * 3 + 1] = pPixel[1];
+			row[x * 3 + 2] = pPixel[2];
+			pPixel += READBACK_PIXEL_BYTES;
+		}
+		file.write(reinterpret_cast<const char*>(&row[0]), row.size());
+	}
+
+	return(file.good());
+}
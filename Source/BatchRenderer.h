@@ -0,0 +1,147 @@
+///////////////////////////////////////////////////////////////////////////////
+// batchrenderer.h
+// ============
+// render stills from a list of camera poses and write them to image files
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  BatchRenderer
+ *
+ *  This class drives a batch of stills, like turntables or
+ *  catalog shots, through a single run of the project.  The
+ *  scene is loaded once and every pose of the camera list
+ *  is drawn as one frame.
+ *
+ *  The frames are read back without waiting - each one is
+ *  read into the next pixel buffer of a ring and fenced, and
+ *  the buffer is only mapped when its fence has passed, so
+ *  the GPU copies a frame while the next ones are drawn.
+ *  The pixels are copied out of the mapped buffer and
+ *  written into image files by a pool of encoder threads.
+ *
+ *  The camera list is a text file with one pose per line -
+ *  the position, the point looked at and optionally the
+ *  vertical field of view in degrees.  Lines starting with
+ *  '#' are skipped.  The stills are written as binary PPM
+ *  files named after the output prefix and the number of
+ *  their pose, counted from 0.
+ ***********************************************************/
+class BatchRenderer
+{
+public:
+	// frames read back at the same time, each with its own
+	// pixel buffer and fence
+	static const int READBACK_SLOTS = 3;
+	// largest number of encoder threads
+	static const int MAX_ENCODERS = 4;
+	// stills copied out and waiting for an encoder before the
+	// read backs wait for the encoders
+	static const size_t MAX_QUEUED_STILLS = 8;
+
+	// a pose of the camera list
+	struct CAMERA_POSE
+	{
+		glm::vec3 position;
+		glm::vec3 target;
+		// vertical field of view in degrees, 0 to keep the
+		// field of view of the camera
+		float fieldOfView;
+	};
+
+	// constructor
+	BatchRenderer();
+	// destructor
+	~BatchRenderer();
+
+	// read the poses of the camera list
+	bool LoadCameraList(const char* filename);
+	// create the pixel buffers for frames of the passed in
+	// size and start the encoders
+	void Start(int width, int height, const char* outputPrefix);
+
+	// get the pose of the next still, returns false once all
+	// of the poses were captured
+	bool GetPose(CAMERA_POSE& pose) const;
+	// read the frame drawn for the current pose back from the
+	// back buffer and move to the next pose
+	void CaptureFrame();
+	// wait until every still is written and print the time
+	// the batch took
+	void Finish();
+
+	bool IsFinished() const { return(m_nextPose >= m_poses.size()); }
+	size_t GetPoseCount() const { return(m_poses.size()); }
+
+private:
+	// a pixel buffer of the ring and the frame read into it
+	struct READBACK_SLOT
+	{
+		GLuint buffer;
+		// fence after the read, 0 when the slot is free
+		GLsync fence;
+		int still;
+	};
+
+	// a still copied out of its pixel buffer, rows at the
+	// bottom first
+	struct ENCODE_JOB
+	{
+		int still;
+		std::vector<unsigned char> pixels;
+	};
+
+	// copy the finished read backs out of their buffers, the
+	// oldest first, waiting for them or only taking the ones
+	// that are done
+	void CollectReadbacks(bool bWait);
+	// copy a read back out of its buffer and queue it for the
+	// encoders, returns false when it is not done and the
+	// caller does not wait
+	bool ReadSlot(READBACK_SLOT& slot, bool bWait);
+	// loop of the encoder threads
+	void EncoderMain();
+	// write a still into its image file
+	bool WriteImage(const ENCODE_JOB& job) const;
+
+	std::vector<CAMERA_POSE> m_poses;
+	size_t m_nextPose;
+	int m_width;
+	int m_height;
+	size_t m_frameBytes;
+	std::string m_outputPrefix;
+
+	READBACK_SLOT m_slots[READBACK_SLOTS];
+	// slot the next frame is read into, also the oldest one
+	// still in flight
+	int m_nextSlot;
+	// number of frames whose read back was not done when its
+	// slot was needed again
+	int m_readbackWaits;
+	std::chrono::steady_clock::time_point m_startTime;
+
+	// jobs shared with the encoder threads, and the pixel
+	// arrays they handed back for the next stills
+	std::vector<std::thread> m_encoders;
+	std::mutex m_mutex;
+	std::condition_variable m_jobReady;
+	std::condition_variable m_jobDone;
+	std::deque<ENCODE_JOB> m_jobs;
+	std::vector<std::vector<unsigned char> > m_freePixels;
+	// jobs queued or being encoded
+	int m_activeJobs;
+	int m_failedStills;
+	bool m_bStopEncoders;
+};
@@ -0,0 +1,398 @@
+///////////////////////////////////////////////////////////////////////////////
+// boundsbvh.cpp
+// ============
+// bounding volume hierarchy over the world space bounds of scene objects
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BoundsBVH.h"
+#include "RayCast.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of the global variables and defines
+namespace
+{
+	// number of bins the centroids are sorted into when
+	// looking for the cheapest split
+	const int SPLIT_BINS = 12;
+	// leaves up to this size are kept when no split is
+	// cheaper than testing all of their items
+	const int MAX_CHEAP_LEAF_ITEMS = 16;
+
+	/***********************************************************
+	 *  SurfaceArea()
+	 *
+	 *  Calculate the surface area of a box, used as the chance
+	 *  of a ray hitting it.
+	 ***********************************************************/
+	float SurfaceArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+	{
+		glm::vec3 size = glm::max(boundsMax - boundsMin, glm::vec3(0.0f));
+		return(2.0f * (size.x * size.y + size.y * size.z + size.z * size.x));
+	}
+
+	// a node waiting to be visited by a ray, with the distance
+	// the ray enters its bounds
+	struct RAY_STACK_ENTRY
+	{
+		int node;
+		float distance;
+	};
+}
+
+/***********************************************************
+ *  BoundsBVH()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BoundsBVH::BoundsBVH()
+{
+	m_lastTestCount = 0;
+}
+
+/***********************************************************
+ *  FitNode()
+ *
+ *  This method is used for setting the bounds of a node to
+ *  enclose all of its items.
+ ***********************************************************/
+void BoundsBVH::FitNode(NODE& node, const std::vector<BOUNDS>& bounds)
+{
+	node.boundsMin = glm::vec3(INFINITY);
+	node.boundsMax = glm::vec3(-INFINITY);
+	for (int i = node.first; i < node.first + node.count; i++)
+	{
+		node.boundsMin = glm::min(node.boundsMin, bounds[m_items[i]].boundsMin);
+		node.boundsMax = glm::max(node.boundsMax, bounds[m_items[i]].boundsMax);
+	}
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the tree over the
+ *  passed in bounds.  The nodes are split from the root
+ *  down, and the children of a node are always stored
+ *  after it.
+ ***********************************************************/
+void BoundsBVH::Build(const std::vector<BOUNDS>& bounds)
+{
+	int itemCount = static_cast<int>(bounds.size());
+
+	m_nodes.clear();
+	m_items.resize(itemCount);
+	for (int i = 0; i < itemCount; i++)
+	{
+		m_items[i] = i;
+	}
+
+	if (itemCount == 0)
+	{
+		return;
+	}
+
+	m_nodes.reserve(2 * itemCount);
+
+	NODE root;
+	root.first = 0;
+	root.count = itemCount;
+	FitNode(root, bounds);
+	m_nodes.push_back(root);
+
+	std::vector<int> pending;
+	pending.push_back(0);
+	while (pending.empty() == false)
+	{
+		int nodeIndex = pending.back();
+		pending.pop_back();
+
+		SplitNode(nodeIndex, bounds);
+		if (m_nodes[nodeIndex].count == 0)
+		{
+			pending.push_back(m_nodes[nodeIndex].first);
+			pending.push_back(m_nodes[nodeIndex].first + 1);
+		}
+	}
+}
+
+/***********************************************************
+ *  SplitNode()
+ *
+ *  This method is used for splitting the items of a leaf
+ *  into two new children.  The item centroids are sorted
+ *  into bins along the longest axis, and the split between
+ *  bins with the lowest surface area cost is used.  Nodes
+ *  whose items can't be told apart are split in the middle.
+ ***********************************************************/
+void BoundsBVH::SplitNode(int nodeIndex, const std::vector<BOUNDS>& bounds)
+{
+	NODE node = m_nodes[nodeIndex];
+	if (node.count <= MAX_LEAF_ITEMS)
+	{
+		return;
+	}
+
+	int* items = &m_items[node.first];
+
+	glm::vec3 centroidMin(INFINITY);
+	glm::vec3 centroidMax(-INFINITY);
+	for (int i = 0; i < node.count; i++)
+	{
+		glm::vec3 centroid = (bounds[items[i]].boundsMin + bounds[items[i]].boundsMax) * 0.5f;
+		centroidMin = glm::min(centroidMin, centroid);
+		centroidMax = glm::max(centroidMax, centroid);
+	}
+
+	glm::vec3 extent = centroidMax - centroidMin;
+	int axis = 0;
+	if (extent.y > extent[axis])
+	{
+		axis = 1;
+	}
+	if (extent.z > extent[axis])
+	{
+		axis = 2;
+	}
+
+	int leftCount = 0;
+	if (extent[axis] > 0.0f)
+	{
+		int binCounts[SPLIT_BINS] = { 0 };
+		glm::vec3 binMin[SPLIT_BINS];
+		glm::vec3 binMax[SPLIT_BINS];
+		for (int b = 0; b < SPLIT_BINS; b++)
+		{
+			binMin[b] = glm::vec3(INFINITY);
+			binMax[b] = glm::vec3(-INFINITY);
+		}
+
+		float binScale = SPLIT_BINS / extent[axis];
+		for (int i = 0; i < node.count; i++)
+		{
+			const BOUNDS& itemBounds = bounds[items[i]];
+			float centroid = (itemBounds.boundsMin[axis] + itemBounds.boundsMax[axis]) * 0.5f;
+			int bin = std::min(static_cast<int>((centroid - centroidMin[axis]) * binScale), SPLIT_BINS - 1);
+			binCounts[bin]++;
+			binMin[bin] = glm::min(binMin[bin], itemBounds.boundsMin);
+			binMax[bin] = glm::max(binMax[bin], itemBounds.boundsMax);
+		}
+
+		// sweep from the right to get the cost of the right
+		// side of every split, then from the left
+		float rightCost[SPLIT_BINS];
+		glm::vec3 sweepMin(INFINITY);
+		glm::vec3 sweepMax(-INFINITY);
+		int sweepCount = 0;
+		for (int b = SPLIT_BINS - 1; b > 0; b--)
+		{
+			sweepMin = glm::min(sweepMin, binMin[b]);
+			sweepMax = glm::max(sweepMax, binMax[b]);
+			sweepCount += binCounts[b];
+			rightCost[b] = (sweepCount > 0) ? SurfaceArea(sweepMin, sweepMax) * sweepCount : 0.0f;
+		}
+
+		float bestCost = INFINITY;
+		int bestSplit = -1;
+		sweepMin = glm::vec3(INFINITY);
+		sweepMax = glm::vec3(-INFINITY);
+		sweepCount = 0;
+		for (int b = 0; b < SPLIT_BINS - 1; b++)
+		{
+			sweepMin = glm::min(sweepMin, binMin[b]);
+			sweepMax = glm::max(sweepMax, binMax[b]);
+			sweepCount += binCounts[b];
+			if ((sweepCount == 0) || (sweepCount == node.count))
+			{
+				continue;
+			}
+
+			float cost = SurfaceArea(sweepMin, sweepMax) * sweepCount + rightCost[b + 1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestSplit = b;
+			}
+		}
+
+		// small nodes stay leaves when testing their items is
+		// cheaper than any split
+		float leafCost = SurfaceArea(node.boundsMin, node.boundsMax) * node.count;
+		if ((bestSplit < 0) ||
+			((bestCost >= leafCost) && (node.count <= MAX_CHEAP_LEAF_ITEMS)))
+		{
+			if (node.count <= MAX_CHEAP_LEAF_ITEMS)
+			{
+				return;
+			}
+		}
+		else
+		{
+			int* middle = std::partition(items, items + node.count,
+				[&](int item)
+				{
+					float centroid = (bounds[item].boundsMin[axis] + bounds[item].boundsMax[axis]) * 0.5f;
+					int bin = std::min(static_cast<int>((centroid - centroidMin[axis]) * binScale), SPLIT_BINS - 1);
+					return(bin <= bestSplit);
+				});
+			leftCount = static_cast<int>(middle - items);
+		}
+	}
+
+	if ((leftCount == 0) || (leftCount == node.count))
+	{
+		// split in the middle along the axis
+		leftCount = node.count / 2;
+		std::nth_element(items, items + leftCount, items + node.count,
+			[&](int a, int b)
+			{
+				return((bounds[a].boundsMin[axis] + bounds[a].boundsMax[axis]) <
+					(bounds[b].boundsMin[axis] + bounds[b].boundsMax[axis]));
+			});
+	}
+
+	NODE left;
+	left.first = node.first;
+	left.count = leftCount;
+	FitNode(left, bounds);
+
+	NODE right;
+	right.first = node.first + leftCount;
+	right.count = node.count - leftCount;
+	FitNode(right, bounds);
+
+	m_nodes[nodeIndex].first = static_cast<int>(m_nodes.size());
+	m_nodes[nodeIndex].count = 0;
+	m_nodes.push_back(left);
+	m_nodes.push_back(right);
+}
+
+/***********************************************************
+ *  Refit()
+ *
+ *  This method is used for updating the bounds of every
+ *  node after items moved.  The children are stored after
+ *  their parent, so walking the nodes backwards updates
+ *  the children first.
+ ***********************************************************/
+void BoundsBVH::Refit(const std::vector<BOUNDS>& bounds)
+{
+	if (bounds.size() != m_items.size())
+	{
+		Build(bounds);
+		return;
+	}
+
+	for (int i = static_cast<int>(m_nodes.size()) - 1; i >= 0; i--)
+	{
+		NODE& node = m_nodes[i];
+		if (node.count > 0)
+		{
+			FitNode(node, bounds);
+		}
+		else
+		{
+			const NODE& left = m_nodes[node.first];
+			const NODE& right = m_nodes[node.first + 1];
+			node.boundsMin = glm::min(left.boundsMin, right.boundsMin);
+			node.boundsMax = glm::max(left.boundsMax, right.boundsMax);
+		}
+	}
+}
+
+/***********************************************************
+ *  CastRay()
+ *
+ *  This method is used for finding the nearest item hit by
+ *  the ray.  The nearer child of each node is visited
+ *  first, and nodes the ray enters behind the nearest hit
+ *  found so far are skipped.
+ ***********************************************************/
+int BoundsBVH::CastRay(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	RAY_TEST rayTest,
+	void* pContext,
+	float& distance)
+{
+	m_lastTestCount = 0;
+	if (m_nodes.empty() == true)
+	{
+		return(-1);
+	}
+
+	glm::vec3 inverseDirection = 1.0f / direction;
+	float nearest = maxDistance;
+	int nearestItem = -1;
+
+	float entry = 0.0f;
+	if (RayCast::IntersectBounds(origin, inverseDirection,
+		m_nodes[0].boundsMin, m_nodes[0].boundsMax, nearest, entry) == false)
+	{
+		return(-1);
+	}
+
+	std::vector<RAY_STACK_ENTRY> stack;
+	stack.reserve(64);
+	RAY_STACK_ENTRY rootEntry = { 0, entry };
+	stack.push_back(rootEntry);
+
+	while (stack.empty() == false)
+	{
+		RAY_STACK_ENTRY current = stack.back();
+		stack.pop_back();
+		if (current.distance > nearest)
+		{
+			continue;
+		}
+
+		const NODE& node = m_nodes[current.node];
+		if (node.count > 0)
+		{
+			for (int i = node.first; i < node.first + node.count; i++)
+			{
+				float itemDistance = 0.0f;
+				m_lastTestCount++;
+				if ((rayTest(pContext, m_items[i], origin, direction, itemDistance) == true) &&
+					(itemDistance <= nearest))
+				{
+					nearest = itemDistance;
+					nearestItem = m_items[i];
+				}
+			}
+			continue;
+		}
+
+		RAY_STACK_ENTRY children[2];
+		int childCount = 0;
+		for (int c = 0; c < 2; c++)
+		{
+			const NODE& child = m_nodes[node.first + c];
+			float childEntry = 0.0f;
+			if (RayCast::IntersectBounds(origin, inverseDirection,
+				child.boundsMin, child.boundsMax, nearest, childEntry) == true)
+			{
+				children[childCount].node = node.first + c;
+				children[childCount].distance = childEntry;
+				childCount++;
+			}
+		}
+
+		// push the far child first so the near one is visited next
+		if ((childCount == 2) && (children[0].distance < children[1].distance))
+		{
+			std::swap(children[0], children[1]);
+		}
+		for (int c = 0; c < childCount; c++)
+		{
+			stack.push_back(children[c]);
+		}
+	}
+
+	if (nearestItem >= 0)
+	{
+		distance = nearest;
+	}
+	return(nearestItem);
+}
@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// boundsbvh.h
+// ============
+// bounding volume hierarchy over the world space bounds of scene objects
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  BoundsBVH
+ *
+ *  This class sorts a list of bounding boxes into a binary
+ *  tree, split with the surface area heuristic, so a ray
+ *  only visits the boxes along its path.  The tree can be
+ *  refitted when boxes move without being rebuilt.  The
+ *  boxes hit by a ray are passed to a test function for
+ *  the exact intersection, nearest boxes first.
+ ***********************************************************/
+class BoundsBVH
+{
+public:
+	// world space bounds of one item
+	struct BOUNDS
+	{
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+	};
+
+	// exact intersection of the ray with an item, returns true
+	// and the hit distance when the item is hit
+	typedef bool (*RAY_TEST)(
+		void* pContext,
+		int item,
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float& distance);
+
+	// constructor
+	BoundsBVH();
+
+	// build the tree over the passed in bounds, the item index
+	// is the position in the list
+	void Build(const std::vector<BOUNDS>& bounds);
+	// update the node bounds after items moved
+	void Refit(const std::vector<BOUNDS>& bounds);
+
+	// find the nearest item hit by the ray, -1 when nothing is
+	// hit closer than the maximum distance
+	int CastRay(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		RAY_TEST rayTest,
+		void* pContext,
+		float& distance);
+
+	// number of items in the tree
+	int GetItemCount() const { return(static_cast<int>(m_items.size())); }
+	// number of exact tests run by the last ray
+	int GetLastTestCount() const { return(m_lastTestCount); }
+
+private:
+	// largest number of items kept in a leaf
+	static const int MAX_LEAF_ITEMS = 4;
+
+	struct NODE
+	{
+		glm::vec3 boundsMin;
+		// first item of a leaf, or the left child of an inner
+		// node - the right child follows it
+		int first;
+		glm::vec3 boundsMax;
+		// number of items of a leaf, 0 for an inner node
+		int count;
+	};
+
+	// split the items of a node into two children
+	void SplitNode(int nodeIndex, const std::vector<BOUNDS>& bounds);
+	// set the bounds of a node from its items
+	void FitNode(NODE& node, const std::vector<BOUNDS>& bounds);
+
+	std::vector<NODE> m_nodes;
+	// item indices, sorted so each leaf holds a range
+	std::vector<int> m_items;
+	int m_lastTestCount;
+};
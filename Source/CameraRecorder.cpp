@@ -0,0 +1,270 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerarecorder.cpp
+// ============
+// record the camera path into a file and replay it at a fixed time step
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CameraRecorder.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <fstream>
+
+// the samples are read straight from the file, so their
+// layout must not depend on the compiler
+static_assert(sizeof(CameraRecorder::CAMERA_SAMPLE) == 44, "unexpected camera sample layout");
+
+// declaration of the global variables and defines
+namespace
+{
+	/***********************************************************
+	 *  GetPercentile()
+	 *
+	 *  Get the value below which the passed in fraction of the
+	 *  sorted values lie.
+	 ***********************************************************/
+	double GetPercentile(const std::vector<double>& sorted, double fraction)
+	{
+		if (sorted.empty() == true)
+		{
+			return(0.0);
+		}
+
+		size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+		return(sorted[std::min(index, sorted.size() - 1)]);
+	}
+}
+
+/***********************************************************
+ *  CameraRecorder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CameraRecorder::CameraRecorder()
+{
+	m_tickRate = DEFAULT_TICK_RATE;
+	m_bRecording = false;
+	m_bReplaying = false;
+	m_tickRemainder = 0.0;
+	m_lastSample = CAMERA_SAMPLE();
+	m_nextSample = 0;
+}
+
+/***********************************************************
+ *  ~CameraRecorder()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CameraRecorder::~CameraRecorder()
+{
+	m_samples.clear();
+	m_frameTimes.clear();
+}
+
+/***********************************************************
+ *  StartRecording()
+ *
+ *  This method is used for starting to capture the camera
+ *  at the passed in number of ticks per second.
+ ***********************************************************/
+void CameraRecorder::StartRecording(const char* filename, int tickRate)
+{
+	m_filename = filename;
+	m_tickRate = (tickRate > 0) ? tickRate : DEFAULT_TICK_RATE;
+	m_bRecording = true;
+	m_bReplaying = false;
+	m_tickRemainder = 0.0;
+	m_samples.clear();
+
+	// room for a minute of samples, so the first part of the
+	// recording does not grow the list
+	m_samples.reserve(static_cast<size_t>(m_tickRate) * 60);
+}
+
+/***********************************************************
+ *  Record()
+ *
+ *  This method is used for adding the samples of the ticks
+ *  that passed during the last frame.  The first sample is
+ *  taken right away.  When several ticks passed, like after
+ *  the loop waited for input, the earlier ones still show
+ *  the camera of the previous frame.
+ ***********************************************************/
+void CameraRecorder::Record(double elapsedSeconds, const CAMERA_SAMPLE& sample)
+{
+	if (m_bRecording == false)
+	{
+		return;
+	}
+
+	if (m_samples.empty() == true)
+	{
+		m_samples.push_back(sample);
+		m_lastSample = sample;
+		return;
+	}
+
+	double tickTime = 1.0 / m_tickRate;
+	m_tickRemainder += std::max(elapsedSeconds, 0.0);
+	while (m_tickRemainder >= tickTime)
+	{
+		m_tickRemainder -= tickTime;
+		m_samples.push_back((m_tickRemainder >= tickTime) ? m_lastSample : sample);
+	}
+	m_lastSample = sample;
+}
+
+/***********************************************************
+ *  StopRecording()
+ *
+ *  This method is used for writing the captured samples to
+ *  the recording file.
+ ***********************************************************/
+bool CameraRecorder::StopRecording()
+{
+	if (m_bRecording == false)
+	{
+		return(false);
+	}
+	m_bRecording = false;
+
+	std::ofstream file(m_filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		LOG_ERROR("could not write the camera recording " << m_filename);
+		return(false);
+	}
+
+	RECORDING_HEADER header;
+	header.magic = RECORDING_MAGIC;
+	header.version = RECORDING_VERSION;
+	header.tickRate = static_cast<uint32_t>(m_tickRate);
+	header.sampleCount = static_cast<uint32_t>(m_samples.size());
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (m_samples.empty() == false)
+	{
+		file.write(reinterpret_cast<const char*>(&m_samples[0]), m_samples.size() * sizeof(CAMERA_SAMPLE));
+	}
+
+	if (file.good() == false)
+	{
+		LOG_ERROR("could not write the camera recording " << m_filename);
+		return(false);
+	}
+
+	LOG_INFO("INFO: Recorded " << m_samples.size() << " camera ticks at "
+		<< m_tickRate << " per second into " << m_filename);
+	return(true);
+}
+
+/***********************************************************
+ *  StartReplay()
+ *
+ *  This method is used for reading a recording file, so its
+ *  samples can be played back one tick per frame.
+ ***********************************************************/
+bool CameraRecorder::StartReplay(const char* filename)
+{
+	m_bRecording = false;
+	m_bReplaying = false;
+	m_samples.clear();
+	m_frameTimes.clear();
+	m_nextSample = 0;
+
+	std::ifstream file(filename, std::ios::binary);
+	if (file.is_open() == false)
+	{
+		LOG_ERROR("could not open the camera recording " << filename);
+		return(false);
+	}
+
+	RECORDING_HEADER header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if ((file.good() == false) ||
+		(header.magic != RECORDING_MAGIC) ||
+		(header.version != RECORDING_VERSION) ||
+		(header.tickRate == 0) ||
+		(header.sampleCount == 0))
+	{
+		LOG_ERROR(filename << " is not a camera recording");
+		return(false);
+	}
+
+	m_samples.resize(header.sampleCount);
+	file.read(reinterpret_cast<char*>(&m_samples[0]), m_samples.size() * sizeof(CAMERA_SAMPLE));
+	if (file.gcount() != static_cast<std::streamsize>(m_samples.size() * sizeof(CAMERA_SAMPLE)))
+	{
+		LOG_ERROR("the camera recording " << filename << " is truncated");
+		m_samples.clear();
+		return(false);
+	}
+
+	m_tickRate = static_cast<int>(header.tickRate);
+	m_bReplaying = true;
+
+	// the frame times are kept for the summary without
+	// growing the list during the replay
+	m_frameTimes.reserve(m_samples.size());
+
+	LOG_INFO("INFO: Replaying " << m_samples.size() << " camera ticks at "
+		<< m_tickRate << " per second from " << filename);
+	return(true);
+}
+
+/***********************************************************
+ *  NextSample()
+ *
+ *  This method is used for getting the camera of the next
+ *  tick, timing the frame since the previous tick.
+ ***********************************************************/
+bool CameraRecorder::NextSample(CAMERA_SAMPLE& sample)
+{
+	if ((m_bReplaying == false) || (m_nextSample >= m_samples.size()))
+	{
+		return(false);
+	}
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (m_nextSample > 0)
+	{
+		m_frameTimes.push_back(std::chrono::duration<double, std::milli>(now - m_lastTick).count());
+	}
+	m_lastTick = now;
+
+	sample = m_samples[m_nextSample];
+	m_nextSample++;
+
+	return(true);
+}
+
+/***********************************************************
+ *  PrintReplaySummary()
+ *
+ *  This method is used for printing the frame times of the
+ *  replay, so runs of different builds can be compared.
+ *  The replay is over, so the times are sorted where they
+ *  are instead of in a copy, which would be allocated in
+ *  the last frame.
+ ***********************************************************/
+void CameraRecorder::PrintReplaySummary()
+{
+	if (m_frameTimes.empty() == true)
+	{
+		return;
+	}
+
+	std::vector<double>& sorted = m_frameTimes;
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+	for (size_t i = 0; i < sorted.size(); i++)
+	{
+		total += sorted[i];
+	}
+
+	LOG_INFO("REPLAY: " << sorted.size() << " frames in " << (total / 1000.0)
+		<< " s, average " << (total / sorted.size()) << " ms, min " << sorted.front()
+		<< " ms, median " << GetPercentile(sorted, 0.5) << " ms, 95% " << GetPercentile(sorted, 0.95)
+		<< " ms, 99% " << GetPercentile(sorted, 0.99) << " ms, max " << sorted.back()
+		<< " ms");
+}
@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// camerarecorder.h
+// ============
+// record the camera path into a file and replay it at a fixed time step
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  CameraRecorder
+ *
+ *  This class captures the state of the camera at a fixed
+ *  tick rate while the scene is explored, and plays it back
+ *  one tick per rendered frame.  A replay shows the same
+ *  views in the same order on every run, whatever the frame
+ *  rate, so frame times can be compared between builds.
+ *
+ *  While recording, every tick that passes between two
+ *  frames gets a sample, so the time the camera stands
+ *  still is replayed as well.  The file is a small header
+ *  followed by the fixed size samples, in the byte order of
+ *  the machine it was recorded on.
+ ***********************************************************/
+class CameraRecorder
+{
+public:
+	// "CAMR" - identifies the file as a camera recording
+	static const uint32_t RECORDING_MAGIC = 0x524d4143;
+	// changed whenever the layout of the samples changes
+	static const uint32_t RECORDING_VERSION = 1;
+	// ticks per second used when none is passed in
+	static const int DEFAULT_TICK_RATE = 60;
+
+	// state of the camera in one tick
+	struct CAMERA_SAMPLE
+	{
+		float position[3];
+		float front[3];
+		float up[3];
+		float zoom;
+		uint8_t bOrthographic;
+		// arrangement of the views, a ViewManager::VIEW_LAYOUT
+		uint8_t viewLayout;
+		uint16_t padding;
+	};
+
+	// constructor
+	CameraRecorder();
+	// destructor
+	~CameraRecorder();
+
+	// start capturing samples, which are written to the file
+	// when the recording is stopped
+	void StartRecording(const char* filename, int tickRate);
+	// add a sample for every tick that passed since the last
+	// frame, the last of them with the current camera
+	void Record(double elapsedSeconds, const CAMERA_SAMPLE& sample);
+	// write the captured samples to the file
+	bool StopRecording();
+
+	// read a recording for playing it back
+	bool StartReplay(const char* filename);
+	// get the sample of the next tick, returns false when
+	// the recording has ended
+	bool NextSample(CAMERA_SAMPLE& sample);
+	// print the frame times measured during the replay,
+	// sorting them in place
+	void PrintReplaySummary();
+
+	bool IsRecording() const { return(m_bRecording); }
+	bool IsReplaying() const { return(m_bReplaying); }
+	// simulated time of one tick, in seconds
+	float GetTickTime() const { return(1.0f / m_tickRate); }
+
+private:
+	// start of the file
+	struct RECORDING_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t tickRate;
+		uint32_t sampleCount;
+	};
+
+	std::vector<CAMERA_SAMPLE> m_samples;
+	int m_tickRate;
+	bool m_bRecording;
+	bool m_bReplaying;
+
+	// recording state - the file the samples are written to
+	// and the time not yet covered by a tick
+	std::string m_filename;
+	double m_tickRemainder;
+	CAMERA_SAMPLE m_lastSample;
+
+	// replay state - the next sample and the time of every
+	// replayed frame, in milliseconds
+	size_t m_nextSample;
+	std::chrono::steady_clock::time_point m_lastTick;
+	std::vector<double> m_frameTimes;
+};
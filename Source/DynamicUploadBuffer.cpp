@@ -0,0 +1,230 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicuploadbuffer.cpp
+// ============
+// ring buffer for uploading per-frame data with several frames in flight
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DynamicUploadBuffer.h"
+#include "FrameStats.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
+
+#include <cstring>
+
+// declaration of the global variables and defines
+namespace
+{
+	// wait in steps of one millisecond for a busy region
+	const GLuint64 FENCE_WAIT_TIMEOUT = 1000000;
+}
+
+/***********************************************************
+ *  DynamicUploadBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DynamicUploadBuffer::DynamicUploadBuffer(GLenum target, GLsizeiptr frameSize, int frameCount)
+{
+	m_target = target;
+	m_buffer = 0;
+	m_pMapped = NULL;
+	m_alignment = 16;
+	m_frameCount = frameCount;
+	m_frame = 0;
+	m_frameOffset = 0;
+	m_waitCount = 0;
+	m_overflowCount = 0;
+
+	if (m_frameCount < 1)
+	{
+		m_frameCount = 1;
+	}
+	if (m_frameCount > MAX_FRAMES)
+	{
+		m_frameCount = MAX_FRAMES;
+	}
+	for (int i = 0; i < MAX_FRAMES; i++)
+	{
+		m_fences[i] = 0;
+	}
+
+	if (m_target == GL_UNIFORM_BUFFER)
+	{
+		GLint alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		if (alignment > m_alignment)
+		{
+			m_alignment = alignment;
+		}
+	}
+
+	// every region starts on an aligned offset
+	m_frameSize = ((frameSize + m_alignment - 1) / m_alignment) * m_alignment;
+	GLsizeiptr totalSize = m_frameSize * m_frameCount;
+
+	glGenBuffers(1, &m_buffer);
+	GLState::BindBuffer(m_target, m_buffer);
+
+#ifndef __APPLE__
+	if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(m_target, totalSize, NULL, flags);
+		m_pMapped = static_cast<unsigned char*>(glMapBufferRange(m_target, 0, totalSize, flags));
+
+		// the storage is immutable, so a failed mapping needs
+		// a new buffer for the fallback - it usually gets the
+		// deleted name, which has to be bound again
+		if (NULL == m_pMapped)
+		{
+			GLState::DeleteBuffer(m_buffer);
+			glGenBuffers(1, &m_buffer);
+			GLState::BindBuffer(m_target, m_buffer);
+		}
+	}
+#endif
+
+	// fall back to uploading into the fenced regions
+	if (NULL == m_pMapped)
+	{
+		glBufferData(m_target, totalSize, NULL, GL_STREAM_DRAW);
+	}
+
+	GLState::BindBuffer(m_target, 0);
+	ResourceTracker::Track(ResourceTracker::RESOURCE_BUFFER, m_buffer, static_cast<size_t>(totalSize),
+		ResourceTracker::CATEGORY_UPLOAD_BUFFER, "dynamic upload buffer");
+}
+
+/***********************************************************
+ *  ~DynamicUploadBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DynamicUploadBuffer::~DynamicUploadBuffer()
+{
+	for (int i = 0; i < MAX_FRAMES; i++)
+	{
+		if (0 != m_fences[i])
+		{
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = 0;
+		}
+	}
+
+	if (NULL != m_pMapped)
+	{
+		GLState::BindBuffer(m_target, m_buffer);
+		glUnmapBuffer(m_target);
+		GLState::BindBuffer(m_target, 0);
+		m_pMapped = NULL;
+	}
+
+	ResourceTracker::Release(ResourceTracker::RESOURCE_BUFFER, m_buffer);
+	GLState::DeleteBuffer(m_buffer);
+	m_buffer = 0;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for moving to the next region and
+ *  waiting until the GPU has finished reading the data that
+ *  was written into it the last time it was used.
+ ***********************************************************/
+void DynamicUploadBuffer::BeginFrame()
+{
+	m_frame = (m_frame + 1) % m_frameCount;
+	m_frameOffset = 0;
+
+	GLsync fence = m_fences[m_frame];
+	if (0 == fence)
+	{
+		return;
+	}
+
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if ((result == GL_TIMEOUT_EXPIRED) || (result == GL_WAIT_FAILED))
+	{
+		// the CPU got too far ahead of the GPU
+		m_waitCount++;
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		while (result == GL_TIMEOUT_EXPIRED)
+		{
+			result = glClientWaitSync(fence, flags, FENCE_WAIT_TIMEOUT);
+			flags = 0;
+		}
+	}
+
+	glDeleteSync(fence);
+	m_fences[m_frame] = 0;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for fencing the current region so it
+ *  is not written again until the GPU has read it.
+ ***********************************************************/
+void DynamicUploadBuffer::EndFrame()
+{
+	if (0 != m_fences[m_frame])
+	{
+		glDeleteSync(m_fences[m_frame]);
+	}
+	m_fences[m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for copying data into the current
+ *  frame's region.  The returned offset is aligned so it can
+ *  be bound directly.
+ ***********************************************************/
+GLintptr DynamicUploadBuffer::Write(const void* data, GLsizeiptr size)
+{
+	GLintptr offset = ((m_frameOffset + m_alignment - 1) / m_alignment) * m_alignment;
+	if ((offset + size) > m_frameSize)
+	{
+		m_overflowCount++;
+		return(-1);
+	}
+	m_frameOffset = offset + size;
+
+	GLintptr bufferOffset = (m_frame * m_frameSize) + offset;
+	if (NULL != m_pMapped)
+	{
+		memcpy(m_pMapped + bufferOffset, data, size);
+	}
+	else
+	{
+		GLState::BindBuffer(m_target, m_buffer);
+		glBufferSubData(m_target, bufferOffset, size, data);
+	}
+
+	return(bufferOffset);
+}
+
+/***********************************************************
+ *  BindRange()
+ *
+ *  This method is used for binding a written range to an
+ *  indexed binding point of the buffer target.
+ ***********************************************************/
+void DynamicUploadBuffer::BindRange(GLuint binding, GLintptr offset, GLsizeiptr size)
+{
+	GLState::BindBufferRange(m_target, binding, m_buffer, offset, size);
+}
+
+/***********************************************************
+ *  UpdateFrameStats()
+ *
+ *  This method is used for publishing the bytes written in
+ *  the current frame and the waits for busy regions.
+ ***********************************************************/
+void DynamicUploadBuffer::UpdateFrameStats()
+{
+	FrameStats::SetBytes("upload buffer frame usage", m_frameOffset);
+	FrameStats::SetValue("upload buffer waits", static_cast<double>(m_waitCount));
+	FrameStats::SetValue("upload buffer overflows", static_cast<double>(m_overflowCount));
+}
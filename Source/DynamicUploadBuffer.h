@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicuploadbuffer.h
+// ============
+// ring buffer for uploading per-frame data with several frames in flight
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  DynamicUploadBuffer
+ *
+ *  This class owns one buffer split into a region for each
+ *  frame in flight.  The data for a frame is written into
+ *  the region of that frame, and a fence guards the region
+ *  until the GPU has read it, so the CPU only waits when it
+ *  gets more frames ahead than there are regions.
+ *
+ *  When persistent mapping is supported the buffer stays
+ *  mapped and data is written directly into it.  Otherwise
+ *  the data is uploaded into the fenced region with
+ *  glBufferSubData.
+ ***********************************************************/
+class DynamicUploadBuffer
+{
+public:
+	// constructor
+	DynamicUploadBuffer(GLenum target, GLsizeiptr frameSize, int frameCount);
+	// destructor
+	~DynamicUploadBuffer();
+
+	// wait until the region for the new frame is free
+	void BeginFrame();
+	// fence the region after the frame's commands are issued
+	void EndFrame();
+
+	// copy data into the current frame's region and return its
+	// buffer offset, or -1 when the region is full
+	GLintptr Write(const void* data, GLsizeiptr size);
+	// bind a written range to an indexed binding point
+	void BindRange(GLuint binding, GLintptr offset, GLsizeiptr size);
+
+	// check whether the buffer is persistently mapped
+	bool IsPersistent() const { return(NULL != m_pMapped); }
+	// get the size of a frame region, and the alignment of
+	// the offsets written into it
+	GLsizeiptr GetFrameSize() const { return(m_frameSize); }
+	GLintptr GetAlignment() const { return(m_alignment); }
+
+	// publish the upload values to the frame stats
+	void UpdateFrameStats();
+
+private:
+	// maximum number of frame regions
+	static const int MAX_FRAMES = 4;
+
+	GLenum m_target;
+	GLuint m_buffer;
+	// pointer to the mapped buffer, NULL when not mapped
+	unsigned char* m_pMapped;
+	// required alignment of bound offsets
+	GLintptr m_alignment;
+	GLsizeiptr m_frameSize;
+	int m_frameCount;
+	// region of the current frame
+	int m_frame;
+	// next free offset inside the current region
+	GLintptr m_frameOffset;
+	// fence for each region, 0 when the region is free
+	GLsync m_fences[MAX_FRAMES];
+	// number of times a region was still in use at the
+	// start of a frame
+	long long m_waitCount;
+	// number of writes that did not fit in a region
+	long long m_overflowCount;
+};
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// filemapping.cpp
+// ============
+// map whole files into memory for reading them in place
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FileMapping.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************
+ *  MapFile()
+ *
+ *  This function is used for mapping a whole file into
+ *  memory for reading.
+ ***********************************************************/
+const unsigned char* FileMapping::MapFile(const char* filename, size_t& fileSize)
+{
+	fileSize = 0;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(
+		filename,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return(NULL);
+	}
+
+	LARGE_INTEGER size;
+	if ((GetFileSizeEx(file, &size) == FALSE) || (size.QuadPart == 0))
+	{
+		CloseHandle(file);
+		return(NULL);
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (NULL == mapping)
+	{
+		return(NULL);
+	}
+
+	// the view keeps the mapping alive after its handle
+	// is closed
+	void* pView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (NULL == pView)
+	{
+		return(NULL);
+	}
+
+	fileSize = static_cast<size_t>(size.QuadPart);
+	return(static_cast<const unsigned char*>(pView));
+#else
+	int file = open(filename, O_RDONLY);
+	if (file < 0)
+	{
+		return(NULL);
+	}
+
+	struct stat status;
+	if ((fstat(file, &status) != 0) || (status.st_size <= 0))
+	{
+		close(file);
+		return(NULL);
+	}
+
+	// the mapping keeps the file open after the descriptor
+	// is closed
+	void* pView = mmap(NULL, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (pView == MAP_FAILED)
+	{
+		return(NULL);
+	}
+
+	// the whole file is read once from front to back
+	madvise(pView, static_cast<size_t>(status.st_size), MADV_WILLNEED);
+
+	fileSize = static_cast<size_t>(status.st_size);
+	return(static_cast<const unsigned char*>(pView));
+#endif
+}
+
+/***********************************************************
+ *  UnmapFile()
+ *
+ *  This function is used for unmapping a file mapped by
+ *  MapFile().
+ ***********************************************************/
+void FileMapping::UnmapFile(const unsigned char* pFile, size_t fileSize)
+{
+#ifdef _WIN32
+	UnmapViewOfFile(pFile);
+#else
+	munmap(const_cast<unsigned char*>(pFile), fileSize);
+#endif
+}
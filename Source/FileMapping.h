@@ -0,0 +1,27 @@
+///////////////////////////////////////////////////////////////////////////////
+// filemapping.h
+// ============
+// map whole files into memory for reading them in place
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  FileMapping
+ *
+ *  These functions map a file read-only into the address
+ *  space, so large files like asset packs and imported
+ *  meshes are read in place through the page cache instead
+ *  of being copied into buffers first.  The pages are read
+ *  in ahead, since the callers go through the whole file.
+ ***********************************************************/
+namespace FileMapping
+{
+	// map a whole file into memory for reading, NULL when the
+	// file cannot be opened or is empty
+	const unsigned char* MapFile(const char* filename, size_t& fileSize);
+	// unmap a file mapped by MapFile()
+	void UnmapFile(const unsigned char* pFile, size_t fileSize);
+}
@@ -0,0 +1,153 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.cpp
+// ============
+// hand out memory for the transient data of one frame from a single block
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.h"
+#include "FrameStats.h"
+#include "ResourceTracker.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+/***********************************************************
+ *  FrameArena()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameArena::FrameArena(const char* owner)
+{
+	m_pBlock = NULL;
+	m_capacity = 0;
+	m_used = 0;
+	m_frameBytes = 0;
+	m_owner = owner;
+
+	GrowBlock(INITIAL_BYTES);
+	// room for a few overflows, so recording one does not
+	// allocate as well
+	m_overflowBlocks.reserve(16);
+}
+
+/***********************************************************
+ *  ~FrameArena()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameArena::~FrameArena()
+{
+	for (size_t i = 0; i < m_overflowBlocks.size(); i++)
+	{
+		delete[] m_overflowBlocks[i];
+	}
+	m_overflowBlocks.clear();
+
+	if (NULL != m_pBlock)
+	{
+		ResourceTracker::Release(ResourceTracker::RESOURCE_CPU, reinterpret_cast<uintptr_t>(this));
+		delete[] m_pBlock;
+		m_pBlock = NULL;
+	}
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for taking back all of the memory
+ *  handed out in the last frame.  When the frame did not
+ *  fit into the block, its overflow allocations are freed
+ *  and the block grows to twice the size the frame needed,
+ *  so the following frames fit again.
+ ***********************************************************/
+void FrameArena::Reset()
+{
+	if (m_overflowBlocks.empty() == false)
+	{
+		for (size_t i = 0; i < m_overflowBlocks.size(); i++)
+		{
+			delete[] m_overflowBlocks[i];
+		}
+		m_overflowBlocks.clear();
+
+		GrowBlock(std::max(m_capacity * 2, m_frameBytes * 2));
+	}
+
+	m_used = 0;
+	m_frameBytes = 0;
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for taking an aligned range of the
+ *  block.  A range that does not fit is allocated from the
+ *  heap until the end of the frame.  The alignment has to
+ *  be a power of two.
+ ***********************************************************/
+void* FrameArena::Allocate(size_t bytes, size_t alignment)
+{
+	if (bytes == 0)
+	{
+		bytes = 1;
+	}
+	alignment = std::max(alignment, static_cast<size_t>(1));
+
+	uintptr_t base = reinterpret_cast<uintptr_t>(m_pBlock);
+	uintptr_t aligned = (base + m_used + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+	size_t offset = static_cast<size_t>(aligned - base);
+
+	m_frameBytes += bytes + (offset - m_used);
+	if ((NULL != m_pBlock) && ((offset + bytes) <= m_capacity))
+	{
+		m_used = offset + bytes;
+		return(m_pBlock + offset);
+	}
+
+	unsigned char* pOverflow = new (std::nothrow) unsigned char[bytes + alignment];
+	if (NULL == pOverflow)
+	{
+		return(NULL);
+	}
+	m_overflowBlocks.push_back(pOverflow);
+
+	uintptr_t overflowBase = reinterpret_cast<uintptr_t>(pOverflow);
+	uintptr_t overflowAligned = (overflowBase + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+	return(pOverflow + (overflowAligned - overflowBase));
+}
+
+/***********************************************************
+ *  UpdateFrameStats()
+ *
+ *  This method is used for publishing the size of the
+ *  block and the bytes handed out in this frame.
+ ***********************************************************/
+void FrameArena::UpdateFrameStats()
+{
+	FrameStats::SetBytes("frame arena used", m_frameBytes);
+	FrameStats::SetBytes("frame arena capacity", m_capacity);
+}
+
+/***********************************************************
+ *  GrowBlock()
+ *
+ *  This method is used for replacing the block by a larger
+ *  one.  It is only called between frames, when nothing in
+ *  the old block is used any more.
+ ***********************************************************/
+void FrameArena::GrowBlock(size_t bytes)
+{
+	unsigned char* pBlock = new (std::nothrow) unsigned char[bytes];
+	if (NULL == pBlock)
+	{
+		return;
+	}
+
+	delete[] m_pBlock;
+	m_pBlock = pBlock;
+	m_capacity = bytes;
+
+	ResourceTracker::Track(ResourceTracker::RESOURCE_CPU, reinterpret_cast<uintptr_t>(this),
+		m_capacity, ResourceTracker::CATEGORY_SCENE_DATA, m_owner);
+}
@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.h
+// ============
+// hand out memory for the transient data of one frame from a single block
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/***********************************************************
+ *  FrameArena
+ *
+ *  This class hands out memory that only lives until the
+ *  end of the frame, like the list of objects collected for
+ *  drawing, by moving a pointer through one block.  Nothing
+ *  is freed on its own - the whole block is taken back when
+ *  the next frame starts, so the frames do not allocate
+ *  from the heap once the block is large enough.
+ *
+ *  When a frame needs more than the block holds, the rest
+ *  is allocated from the heap for that frame, and the block
+ *  is replaced by a larger one when the next frame starts.
+ *  No destructors are run, so only types that do not need
+ *  them can be stored.
+ ***********************************************************/
+class FrameArena
+{
+public:
+	// size the block starts with
+	static const size_t INITIAL_BYTES = 64 * 1024;
+	// alignment of the allocations unless another is asked for
+	static const size_t DEFAULT_ALIGNMENT = 16;
+
+	// constructor - the owner name is passed to the resource
+	// tracker
+	explicit FrameArena(const char* owner);
+	// destructor
+	~FrameArena();
+
+	// take back everything handed out in the last frame
+	void Reset();
+	// take a range of the block, NULL when the heap is out of
+	// memory
+	void* Allocate(size_t bytes, size_t alignment = DEFAULT_ALIGNMENT);
+
+	// take an array of a type that needs no destructor
+	template <typename T>
+	T* AllocateArray(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value,
+			"frame arena memory is never destructed");
+		return(static_cast<T*>(Allocate(count * sizeof(T), alignof(T))));
+	}
+
+	size_t GetBytesUsed() const { return(m_frameBytes); }
+	size_t GetCapacity() const { return(m_capacity); }
+
+	// publish the size of the block and the bytes handed out
+	// in this frame to the frame stats
+	void UpdateFrameStats();
+
+private:
+	// replace the block by one that holds the passed in bytes
+	void GrowBlock(size_t bytes);
+
+	unsigned char* m_pBlock;
+	size_t m_capacity;
+	// offset of the next allocation in the block
+	size_t m_used;
+	// bytes asked for in this frame, also the ones that did
+	// not fit into the block
+	size_t m_frameBytes;
+	// heap allocations of this frame that did not fit
+	std::vector<unsigned char*> m_overflowBlocks;
+	const char* m_owner;
+};
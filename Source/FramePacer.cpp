@@ -0,0 +1,215 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.cpp
+// ============
+// decide when the main loop renders a frame and pace the rendered frames
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FramePacer.h"
+#include "FrameStats.h"
+
+// GLFW library
+#include "GLFW/glfw3.h"
+
+#include <chrono>
+#include <thread>
+
+// declaration of the global variables and defines
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+	typedef std::chrono::duration<double> Seconds;
+
+	// a redraw renders one extra frame after the change, so
+	// results that lag a frame behind (occlusion queries,
+	// GPU timers) settle before the loop goes idle
+	const int REDRAW_FRAMES = 2;
+
+	bool g_bRenderOnDemand = true;
+	int g_PendingFrames = REDRAW_FRAMES;
+
+	// time between rendered frames, 0 when not capped
+	double g_FrameInterval = 0.0;
+	Clock::time_point g_NextFrame = Clock::now();
+	// how long a short sleep can take - the final stretch
+	// before a frame is due is spun instead of slept
+	double g_SleepOvershoot = 0.002;
+
+	long long g_ActiveFrames = 0;
+	long long g_IdleFrames = 0;
+
+	/***********************************************************
+	 *  WaitUntil()
+	 *
+	 *  Sleep in short steps until the passed in time is near,
+	 *  then spin for the rest of the time.
+	 ***********************************************************/
+	void WaitUntil(Clock::time_point target)
+	{
+		for (;;)
+		{
+			Clock::time_point now = Clock::now();
+			double remaining = Seconds(target - now).count();
+			if (remaining <= 0.0)
+			{
+				return;
+			}
+
+			if (remaining > g_SleepOvershoot)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+				// track the longest sleep, slowly forgetting old ones
+				double slept = Seconds(Clock::now() - now).count();
+				g_SleepOvershoot *= 0.99;
+				if (slept > g_SleepOvershoot)
+				{
+					g_SleepOvershoot = slept;
+				}
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  SetRenderOnDemand()
+ *
+ *  This function is used for turning render-on-demand mode
+ *  on or off.  When it is off, a frame is rendered on every
+ *  pass of the main loop.
+ ***********************************************************/
+void FramePacer::SetRenderOnDemand(bool bOnDemand)
+{
+	g_bRenderOnDemand = bOnDemand;
+	RequestRedraw();
+}
+
+/***********************************************************
+ *  IsRenderOnDemand()
+ *
+ *  This function is used for checking whether frames are
+ *  only rendered on demand.
+ ***********************************************************/
+bool FramePacer::IsRenderOnDemand()
+{
+	return(g_bRenderOnDemand);
+}
+
+/***********************************************************
+ *  SetFrameRateCap()
+ *
+ *  This function is used for setting the maximum number of
+ *  rendered frames per second.
+ ***********************************************************/
+void FramePacer::SetFrameRateCap(double framesPerSecond)
+{
+	if (framesPerSecond > 0.0)
+	{
+		g_FrameInterval = 1.0 / framesPerSecond;
+	}
+	else
+	{
+		g_FrameInterval = 0.0;
+	}
+	g_NextFrame = Clock::now();
+}
+
+/***********************************************************
+ *  RequestRedraw()
+ *
+ *  This function is used for asking for the scene to be
+ *  rendered again.  It is called from the GLFW callbacks as
+ *  well, so it only marks the frames as pending.
+ ***********************************************************/
+void FramePacer::RequestRedraw()
+{
+	g_PendingFrames = REDRAW_FRAMES;
+}
+
+/***********************************************************
+ *  WaitForFrame()
+ *
+ *  This function is used for blocking on window events in
+ *  render-on-demand mode until a redraw is requested.  The
+ *  main loop renders a frame when true is returned, and
+ *  checks again otherwise.
+ ***********************************************************/
+bool FramePacer::WaitForFrame()
+{
+	if ((g_bRenderOnDemand == false) || (g_PendingFrames > 0))
+	{
+		return(true);
+	}
+
+	// the callbacks of the received events may request a redraw
+	glfwWaitEvents();
+	if (g_PendingFrames > 0)
+	{
+		// pace from the wake up, not from the last frame
+		g_NextFrame = Clock::now();
+		return(true);
+	}
+
+	g_IdleFrames++;
+	FrameStats::SetValue("idle frames", static_cast<double>(g_IdleFrames));
+	return(false);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This function is used for counting a rendered frame and
+ *  waiting until the next frame is allowed by the frame
+ *  rate cap.
+ ***********************************************************/
+void FramePacer::EndFrame()
+{
+	g_ActiveFrames++;
+	if (g_PendingFrames > 0)
+	{
+		g_PendingFrames--;
+	}
+	FrameStats::SetValue("active frames", static_cast<double>(g_ActiveFrames));
+
+	if (g_FrameInterval <= 0.0)
+	{
+		return;
+	}
+
+	g_NextFrame += std::chrono::duration_cast<Clock::duration>(Seconds(g_FrameInterval));
+
+	// don't try to catch up after a long frame
+	Clock::time_point now = Clock::now();
+	if (g_NextFrame < now)
+	{
+		g_NextFrame = now;
+		return;
+	}
+
+	WaitUntil(g_NextFrame);
+}
+
+/***********************************************************
+ *  GetActiveFrameCount()
+ *
+ *  This function is used for getting the number of frames
+ *  that were rendered.
+ ***********************************************************/
+long long FramePacer::GetActiveFrameCount()
+{
+	return(g_ActiveFrames);
+}
+
+/***********************************************************
+ *  GetIdleFrameCount()
+ *
+ *  This function is used for getting the number of times
+ *  the main loop woke up without rendering a frame.
+ ***********************************************************/
+long long FramePacer::GetIdleFrameCount()
+{
+	return(g_IdleFrames);
+}
@@ -0,0 +1,44 @@
+///////////////////////////////////////////////////////////////////////////////
+// framepacer.h
+// ============
+// decide when the main loop renders a frame and pace the rendered frames
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+/***********************************************************
+ *  FramePacer
+ *
+ *  These functions let the main loop sleep while nothing in
+ *  the scene changes.  In render-on-demand mode the loop
+ *  blocks on window events, and only renders a frame after
+ *  RequestRedraw() has been called by the camera, input,
+ *  lighting or scene code.  Rendered frames can be capped
+ *  to a frame rate, sleeping for most of the remaining time
+ *  and spinning for the last part so the pacing is accurate.
+ ***********************************************************/
+namespace FramePacer
+{
+	// turn render-on-demand mode on or off
+	void SetRenderOnDemand(bool bOnDemand);
+	bool IsRenderOnDemand();
+
+	// set the maximum number of frames per second, 0 for
+	// no limit
+	void SetFrameRateCap(double framesPerSecond);
+
+	// ask for the scene to be rendered again - called by
+	// anything that changes what is shown
+	void RequestRedraw();
+
+	// wait for a frame to be due, returns false when the wait
+	// ended without anything to render
+	bool WaitForFrame();
+	// finish a rendered frame and wait for the frame rate cap
+	void EndFrame();
+
+	// number of frames rendered
+	long long GetActiveFrameCount();
+	// number of wake ups that did not render a frame
+	long long GetIdleFrameCount();
+}
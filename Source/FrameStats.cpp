@@ -0,0 +1,248 @@
+///////////////////////////////////////////////////////////////////////////////
+// framestats.cpp
+// ============
+// collect per-frame counters, timings and memory sizes and report them
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameStats.h"
+#include "Logger.h"
+
+#include <cstring>
+#include <chrono>
+
+// declaration of the global variables and defines
+namespace
+{
+	// maximum number of distinct statistics that can be tracked
+	const int MAX_STATS = 128;
+
+	struct STAT_ENTRY
+	{
+		const char* name;
+		FrameStats::STAT_TYPE type;
+		double value;
+	};
+
+	// the tracked statistics - a fixed table so that collecting
+	// the statistics never allocates memory during a frame
+	STAT_ENTRY g_Stats[MAX_STATS];
+	int g_StatCount = 0;
+
+	long long g_FrameCount = 0;
+	double g_ReportInterval = 1.0;
+
+	// frame timing used for the report
+	std::chrono::steady_clock::time_point g_FrameStart;
+	std::chrono::steady_clock::time_point g_LastReport;
+	double g_FrameTimeTotal = 0.0;
+	int g_ReportFrames = 0;
+
+	/***********************************************************
+	 *  FindStat()
+	 *
+	 *  Find the statistic with the passed in name, adding it
+	 *  to the table when it is not there yet.
+	 ***********************************************************/
+	STAT_ENTRY* FindStat(const char* name, FrameStats::STAT_TYPE type)
+	{
+		for (int i = 0; i < g_StatCount; i++)
+		{
+			if ((g_Stats[i].name == name) || (strcmp(g_Stats[i].name, name) == 0))
+			{
+				return(&g_Stats[i]);
+			}
+		}
+
+		if (g_StatCount >= MAX_STATS)
+		{
+			return(nullptr);
+		}
+
+		g_Stats[g_StatCount].name = name;
+		g_Stats[g_StatCount].type = type;
+		g_Stats[g_StatCount].value = 0.0;
+		g_StatCount++;
+
+		return(&g_Stats[g_StatCount - 1]);
+	}
+
+	/***********************************************************
+	 *  PrintReport()
+	 *
+	 *  Print all of the tracked statistics to the console.
+	 ***********************************************************/
+	void PrintReport()
+	{
+		double averageFrame = 0.0;
+		if (g_ReportFrames > 0)
+		{
+			averageFrame = g_FrameTimeTotal / g_ReportFrames;
+		}
+
+		if (Logger::IsEnabled(Logger::LEVEL_INFO) == false)
+		{
+			return;
+		}
+
+		LOG_INFO("FRAME STATS: frame " << g_FrameCount
+			<< ", average frame time " << averageFrame << " ms");
+
+		for (int i = 0; i < g_StatCount; i++)
+		{
+			Logger::LogMessage line(Logger::LEVEL_INFO);
+			line << "    " << g_Stats[i].name << ": ";
+			switch (g_Stats[i].type)
+			{
+			case FrameStats::STAT_MILLISECONDS:
+				line << g_Stats[i].value << " ms";
+				break;
+			case FrameStats::STAT_BYTES:
+				line << (g_Stats[i].value / (1024.0 * 1024.0)) << " MB";
+				break;
+			default:
+				line << g_Stats[i].value;
+				break;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  Reset the per-frame counters for a new frame.
+ ***********************************************************/
+void FrameStats::BeginFrame()
+{
+	g_FrameStart = std::chrono::steady_clock::now();
+	if (g_FrameCount == 0)
+	{
+		g_LastReport = g_FrameStart;
+	}
+
+	for (int i = 0; i < g_StatCount; i++)
+	{
+		if (g_Stats[i].type == STAT_COUNTER)
+		{
+			g_Stats[i].value = 0.0;
+		}
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  Finish the frame statistics and print the report once
+ *  the report interval has passed.
+ ***********************************************************/
+void FrameStats::EndFrame()
+{
+	std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+
+	g_FrameTimeTotal += std::chrono::duration<double, std::milli>(frameEnd - g_FrameStart).count();
+	g_ReportFrames++;
+	g_FrameCount++;
+
+	if ((g_ReportInterval > 0.0) &&
+		(std::chrono::duration<double>(frameEnd - g_LastReport).count() >= g_ReportInterval))
+	{
+		PrintReport();
+		g_LastReport = frameEnd;
+		g_FrameTimeTotal = 0.0;
+		g_ReportFrames = 0;
+	}
+}
+
+/***********************************************************
+ *  AddCounter()
+ *
+ *  Add the passed in amount to a per-frame counter.
+ ***********************************************************/
+void FrameStats::AddCounter(const char* name, long long amount)
+{
+	STAT_ENTRY* stat = FindStat(name, STAT_COUNTER);
+	if (stat != nullptr)
+	{
+		stat->value += static_cast<double>(amount);
+	}
+}
+
+/***********************************************************
+ *  SetValue()
+ *
+ *  Set a statistic value that persists between frames.
+ ***********************************************************/
+void FrameStats::SetValue(const char* name, double value)
+{
+	STAT_ENTRY* stat = FindStat(name, STAT_VALUE);
+	if (stat != nullptr)
+	{
+		stat->value = value;
+	}
+}
+
+/***********************************************************
+ *  SetMilliseconds()
+ *
+ *  Set a timing statistic, in milliseconds.
+ ***********************************************************/
+void FrameStats::SetMilliseconds(const char* name, double milliseconds)
+{
+	STAT_ENTRY* stat = FindStat(name, STAT_MILLISECONDS);
+	if (stat != nullptr)
+	{
+		stat->value = milliseconds;
+	}
+}
+
+/***********************************************************
+ *  SetBytes()
+ *
+ *  Set a memory size statistic, in bytes.
+ ***********************************************************/
+void FrameStats::SetBytes(const char* name, size_t bytes)
+{
+	STAT_ENTRY* stat = FindStat(name, STAT_BYTES);
+	if (stat != nullptr)
+	{
+		stat->value = static_cast<double>(bytes);
+	}
+}
+
+/***********************************************************
+ *  GetValue()
+ *
+ *  Get the current value of the named statistic.
+ ***********************************************************/
+double FrameStats::GetValue(const char* name)
+{
+	for (int i = 0; i < g_StatCount; i++)
+	{
+		if (strcmp(g_Stats[i].name, name) == 0)
+		{
+			return(g_Stats[i].value);
+		}
+	}
+
+	return(0.0);
+}
+
+/***********************************************************
+ *  GetFrameCount()
+ *
+ *  Get the number of frames that have been completed.
+ ***********************************************************/
+long long FrameStats::GetFrameCount()
+{
+	return(g_FrameCount);
+}
+
+/***********************************************************
+ *  SetReportInterval()
+ *
+ *  Set how often, in seconds, the report is printed.
+ ***********************************************************/
+void FrameStats::SetReportInterval(double seconds)
+{
+	g_ReportInterval = seconds;
+}
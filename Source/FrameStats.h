@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// framestats.h
+// ============
+// collect per-frame counters, timings and memory sizes and report them
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  FrameStats
+ *
+ *  These functions collect named statistics for each
+ *  rendered frame.  The names must be string literals or
+ *  other strings that stay alive for the whole run, since
+ *  only the pointers are stored.
+ ***********************************************************/
+namespace FrameStats
+{
+	// type of a tracked statistic - counters are reset at the
+	// start of every frame, the other types keep their value
+	enum STAT_TYPE
+	{
+		STAT_COUNTER,
+		STAT_VALUE,
+		STAT_MILLISECONDS,
+		STAT_BYTES
+	};
+
+	// start collecting the statistics for a new frame
+	void BeginFrame();
+	// finish the frame and print the report when it is due
+	void EndFrame();
+
+	// add to a counter that is reset every frame
+	void AddCounter(const char* name, long long amount);
+	// set a value that persists until it is set again
+	void SetValue(const char* name, double value);
+	// set a timing value, in milliseconds
+	void SetMilliseconds(const char* name, double milliseconds);
+	// set a memory size, in bytes
+	void SetBytes(const char* name, size_t bytes);
+
+	// get the current value of a statistic, 0 if unknown
+	double GetValue(const char* name);
+	// get the number of frames rendered so far
+	long long GetFrameCount();
+
+	// set the number of seconds between printed reports,
+	// 0 turns the report off
+	void SetReportInterval(double seconds);
+}
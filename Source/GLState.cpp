@@ -0,0 +1,972 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstate.cpp
+// ============
+// track the OpenGL state and drop calls that would not change it
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLState.h"
+#include "FrameStats.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+
+// declaration of the global variables and defines
+namespace
+{
+	// value of a binding that is not known
+	const GLuint UNKNOWN_BINDING = 0xffffffff;
+	const int MAX_TEXTURE_UNITS = 32;
+	const int MAX_UNIFORM_BUFFER_BINDINGS = 16;
+	const int MAX_SHADERS = 8;
+	const int MAX_SAMPLERS = 32;
+	const int MAX_UNIFORMS = 256;
+	const int MAX_VIEWPORTS = 16;
+
+	// tracked capabilities, -1 while the state is not known
+	struct CAPABILITY_STATE
+	{
+		GLenum capability;
+		int state;
+	};
+	CAPABILITY_STATE g_Capabilities[] =
+	{
+		{ GL_DEPTH_TEST, -1 },
+		{ GL_BLEND, -1 },
+		{ GL_CULL_FACE, -1 },
+		{ GL_POLYGON_OFFSET_FILL, -1 },
+		{ GL_SCISSOR_TEST, -1 },
+		{ GL_STENCIL_TEST, -1 }
+	};
+	const int NUM_CAPABILITIES = sizeof(g_Capabilities) / sizeof(g_Capabilities[0]);
+
+	// fixed function state
+	bool g_bClearColorKnown = false;
+	float g_ClearColor[4];
+	bool g_bColorMaskKnown = false;
+	GLboolean g_ColorMask[4];
+	bool g_bDepthMaskKnown = false;
+	GLboolean g_DepthMask;
+	GLenum g_DepthFunc = UNKNOWN_BINDING;
+	bool g_bBlendFuncKnown = false;
+	GLenum g_BlendFunc[2];
+	bool g_bPolygonOffsetKnown = false;
+	float g_PolygonOffset[2];
+	bool g_bViewportKnown = false;
+	int g_Viewport[4];
+	// the indexed viewports after the first one, which is
+	// the viewport above
+	bool g_bIndexedViewportKnown[MAX_VIEWPORTS] = { false };
+	int g_IndexedViewports[MAX_VIEWPORTS][4];
+
+	// bindings
+	GLuint g_Program = UNKNOWN_BINDING;
+	GLuint g_VertexArray = UNKNOWN_BINDING;
+	GLuint g_ArrayBuffer = UNKNOWN_BINDING;
+	GLuint g_UniformBuffer = UNKNOWN_BINDING;
+	struct BUFFER_RANGE
+	{
+		GLuint buffer;
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+	BUFFER_RANGE g_UniformBufferRanges[MAX_UNIFORM_BUFFER_BINDINGS];
+	GLuint g_ActiveUnit = UNKNOWN_BINDING;
+	// 2D and 2D array texture bound to each unit - texture 0
+	// is bound to every unit when the context is created
+	GLuint g_Textures[MAX_TEXTURE_UNITS][2];
+	GLuint g_DrawFramebuffer = UNKNOWN_BINDING;
+	GLuint g_ReadFramebuffer = UNKNOWN_BINDING;
+
+	// program of each ShaderManager that was used
+	struct SHADER_PROGRAM
+	{
+		ShaderManager* pShader;
+		GLuint program;
+	};
+	SHADER_PROGRAM g_Shaders[MAX_SHADERS];
+	int g_ShaderCount = 0;
+
+	// sampler uniform values - these are stored in the program
+	// objects, so they stay valid when the state is invalidated
+	struct SAMPLER_VALUE
+	{
+		ShaderManager* pShader;
+		const char* name;
+		int unit;
+	};
+	SAMPLER_VALUE g_Samplers[MAX_SAMPLERS];
+	int g_SamplerCount = 0;
+
+	// uniform locations that were looked up by name - like
+	// the sampler values they belong to the program objects
+	struct UNIFORM_LOCATION
+	{
+		ShaderManager* pShader;
+		const char* name;
+		GLint location;
+		// the value slot of the location, shared by the names
+		// of a shader that resolve to the same location
+		int valueIndex;
+	};
+	UNIFORM_LOCATION g_Uniforms[MAX_UNIFORMS];
+	int g_UniformCount = 0;
+
+	// last value set at each uniform location, up to a 4x4
+	// matrix - unlike the samplers the values are forgotten
+	// when the state is invalidated, since the ShaderManager
+	// setters change them directly
+	struct UNIFORM_VALUE
+	{
+		bool bKnown;
+		unsigned char bytes[16 * sizeof(GLfloat)];
+	};
+	UNIFORM_VALUE g_UniformValues[MAX_UNIFORMS];
+
+	// calls passed on and dropped since the last frame stats
+	long long g_IssuedCalls = 0;
+	long long g_DroppedCalls = 0;
+
+	/***********************************************************
+	 *  ShouldIssue()
+	 *
+	 *  Count a call as passed on or dropped, and return true
+	 *  when it has to be passed on.
+	 ***********************************************************/
+	bool ShouldIssue(bool bUnchanged)
+	{
+		if (bUnchanged == true)
+		{
+			g_DroppedCalls++;
+			return(false);
+		}
+
+		g_IssuedCalls++;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  FindUniform()
+	 *
+	 *  Find the entry of a uniform of a shader, -1 when the
+	 *  table is full.  The names are compared by their
+	 *  pointers first, and the location is only looked up in
+	 *  the current program the first time a name is used.
+	 ***********************************************************/
+	int FindUniform(ShaderManager* pShader, const char* name, GLint& location)
+	{
+		for (int i = 0; i < g_UniformCount; i++)
+		{
+			if ((g_Uniforms[i].pShader == pShader) && (g_Uniforms[i].name == name))
+			{
+				location = g_Uniforms[i].location;
+				return(i);
+			}
+		}
+		for (int i = 0; i < g_UniformCount; i++)
+		{
+			if ((g_Uniforms[i].pShader == pShader) && (strcmp(g_Uniforms[i].name, name) == 0))
+			{
+				location = g_Uniforms[i].location;
+				return(i);
+			}
+		}
+
+		GLint program = 0;
+		glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+		location = glGetUniformLocation(static_cast<GLuint>(program), name);
+		if (g_UniformCount >= MAX_UNIFORMS)
+		{
+			return(-1);
+		}
+
+		UNIFORM_LOCATION& uniform = g_Uniforms[g_UniformCount];
+		uniform.pShader = pShader;
+		uniform.name = name;
+		uniform.location = location;
+		uniform.valueIndex = g_UniformCount;
+		for (int i = 0; i < g_UniformCount; i++)
+		{
+			if ((g_Uniforms[i].pShader == pShader) && (g_Uniforms[i].location == location))
+			{
+				uniform.valueIndex = g_Uniforms[i].valueIndex;
+				break;
+			}
+		}
+		g_UniformValues[g_UniformCount].bKnown = false;
+
+		return(g_UniformCount++);
+	}
+
+	/***********************************************************
+	 *  GetUniformLocation()
+	 *
+	 *  Get the location of a uniform in the program of a
+	 *  shader.
+	 ***********************************************************/
+	GLint GetUniformLocation(ShaderManager* pShader, const char* name)
+	{
+		GLint location = -1;
+		FindUniform(pShader, name, location);
+		return(location);
+	}
+
+	/***********************************************************
+	 *  ShouldSetUniform()
+	 *
+	 *  Count the setting of a uniform as passed on or dropped,
+	 *  and return true when the value differs from the last
+	 *  one set at its location and has to be passed on.  The
+	 *  value is remembered, and the location returned.
+	 ***********************************************************/
+	bool ShouldSetUniform(ShaderManager* pShader, const char* name, const void* pValue, size_t bytes, GLint& location)
+	{
+		int index = FindUniform(pShader, name, location);
+		if (index < 0)
+		{
+			return(ShouldIssue(false));
+		}
+
+		UNIFORM_VALUE& value = g_UniformValues[g_Uniforms[index].valueIndex];
+		bool bUnchanged = (value.bKnown == true) && (memcmp(value.bytes, pValue, bytes) == 0);
+		if (ShouldIssue(bUnchanged) == false)
+		{
+			return(false);
+		}
+
+		memcpy(value.bytes, pValue, bytes);
+		value.bKnown = true;
+		return(true);
+	}
+
+	/***********************************************************
+	 *  SetCapability()
+	 *
+	 *  Enable or disable a capability when its tracked state
+	 *  differs.  Capabilities that are not tracked are always
+	 *  passed on.
+	 ***********************************************************/
+	void SetCapability(GLenum capability, bool bEnable)
+	{
+		int state = bEnable ? 1 : 0;
+		for (int i = 0; i < NUM_CAPABILITIES; i++)
+		{
+			if (g_Capabilities[i].capability == capability)
+			{
+				if (ShouldIssue(g_Capabilities[i].state == state) == false)
+				{
+					return;
+				}
+				g_Capabilities[i].state = state;
+				break;
+			}
+		}
+
+		if (bEnable == true)
+		{
+			glEnable(capability);
+		}
+		else
+		{
+			glDisable(capability);
+		}
+	}
+
+	/***********************************************************
+	 *  GetTextureTargetIndex()
+	 *
+	 *  Get the index of a tracked texture target, -1 when the
+	 *  target is not tracked.
+	 ***********************************************************/
+	int GetTextureTargetIndex(GLenum target)
+	{
+		if (target == GL_TEXTURE_2D)
+		{
+			return(0);
+		}
+		if (target == GL_TEXTURE_2D_ARRAY)
+		{
+			return(1);
+		}
+		return(-1);
+	}
+}
+
+/***********************************************************
+ *  Enable()
+ *
+ *  This function is used for enabling a capability.
+ ***********************************************************/
+void GLState::Enable(GLenum capability)
+{
+	SetCapability(capability, true);
+}
+
+/***********************************************************
+ *  Disable()
+ *
+ *  This function is used for disabling a capability.
+ ***********************************************************/
+void GLState::Disable(GLenum capability)
+{
+	SetCapability(capability, false);
+}
+
+/***********************************************************
+ *  ClearColor()
+ *
+ *  This function is used for setting the clear color.
+ ***********************************************************/
+void GLState::ClearColor(float red, float green, float blue, float alpha)
+{
+	bool bUnchanged = g_bClearColorKnown &&
+		(g_ClearColor[0] == red) && (g_ClearColor[1] == green) &&
+		(g_ClearColor[2] == blue) && (g_ClearColor[3] == alpha);
+	if (ShouldIssue(bUnchanged) == false)
+	{
+		return;
+	}
+
+	g_ClearColor[0] = red;
+	g_ClearColor[1] = green;
+	g_ClearColor[2] = blue;
+	g_ClearColor[3] = alpha;
+	g_bClearColorKnown = true;
+	glClearColor(red, green, blue, alpha);
+}
+
+/***********************************************************
+ *  ColorMask()
+ *
+ *  This function is used for setting which color channels
+ *  are written.
+ ***********************************************************/
+void GLState::ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+	bool bUnchanged = g_bColorMaskKnown &&
+		(g_ColorMask[0] == red) && (g_ColorMask[1] == green) &&
+		(g_ColorMask[2] == blue) && (g_ColorMask[3] == alpha);
+	if (ShouldIssue(bUnchanged) == false)
+	{
+		return;
+	}
+
+	g_ColorMask[0] = red;
+	g_ColorMask[1] = green;
+	g_ColorMask[2] = blue;
+	g_ColorMask[3] = alpha;
+	g_bColorMaskKnown = true;
+	glColorMask(red, green, blue, alpha);
+}
+
+/***********************************************************
+ *  DepthMask()
+ *
+ *  This function is used for setting whether depth is
+ *  written.
+ ***********************************************************/
+void GLState::DepthMask(GLboolean flag)
+{
+	if (ShouldIssue(g_bDepthMaskKnown && (g_DepthMask == flag)) == false)
+	{
+		return;
+	}
+
+	g_DepthMask = flag;
+	g_bDepthMaskKnown = true;
+	glDepthMask(flag);
+}
+
+/***********************************************************
+ *  DepthFunc()
+ *
+ *  This function is used for setting the depth comparison.
+ ***********************************************************/
+void GLState::DepthFunc(GLenum func)
+{
+	if (ShouldIssue(g_DepthFunc == func) == false)
+	{
+		return;
+	}
+
+	g_DepthFunc = func;
+	glDepthFunc(func);
+}
+
+/***********************************************************
+ *  BlendFunc()
+ *
+ *  This function is used for setting the blend factors.
+ ***********************************************************/
+void GLState::BlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+	bool bUnchanged = g_bBlendFuncKnown &&
+		(g_BlendFunc[0] == sourceFactor) && (g_BlendFunc[1] == destinationFactor);
+	if (ShouldIssue(bUnchanged) == false)
+	{
+		return;
+	}
+
+	g_BlendFunc[0] = sourceFactor;
+	g_BlendFunc[1] = destinationFactor;
+	g_bBlendFuncKnown = true;
+	glBlendFunc(sourceFactor, destinationFactor);
+}
+
+/***********************************************************
+ *  PolygonOffset()
+ *
+ *  This function is used for setting the depth offset of
+ *  filled polygons.
+ ***********************************************************/
+void GLState::PolygonOffset(float factor, float units)
+{
+	bool bUnchanged = g_bPolygonOffsetKnown &&
+		(g_PolygonOffset[0] == factor) && (g_PolygonOffset[1] == units);
+	if (ShouldIssue(bUnchanged) == false)
+	{
+		return;
+	}
+
+	g_PolygonOffset[0] = factor;
+	g_PolygonOffset[1] = units;
+	g_bPolygonOffsetKnown = true;
+	glPolygonOffset(factor, units);
+}
+
+/***********************************************************
+ *  Viewport()
+ *
+ *  This function is used for setting the viewport.
+ ***********************************************************/
+void GLState::Viewport(int x, int y, int width, int height)
+{
+	bool bUnchanged = g_bViewportKnown &&
+		(g_Viewport[0] == x) && (g_Viewport[1] == y) &&
+		(g_Viewport[2] == width) && (g_Viewport[3] == height);
+	if (ShouldIssue(bUnchanged) == false)
+	{
+		return;
+	}
+
+	g_Viewport[0] = x;
+	g_Viewport[1] = y;
+	g_Viewport[2] = width;
+	g_Viewport[3] = height;
+	g_bViewportKnown = true;
+	glViewport(x, y, width, height);
+
+	// glViewport sets every indexed viewport
+	for (int i = 1; i < MAX_VIEWPORTS; i++)
+	{
+		g_IndexedViewports[i][0] = x;
+		g_IndexedViewports[i][1] = y;
+		g_IndexedViewports[i][2] = width;
+		g_IndexedViewports[i][3] = height;
+		g_bIndexedViewportKnown[i] = true;
+	}
+}
+
+/***********************************************************
+ *  ViewportIndexed()
+ *
+ *  This function is used for setting one viewport of the
+ *  viewport array.  Viewport 0 is the one set by Viewport().
+ ***********************************************************/
+void GLState::ViewportIndexed(GLuint index, int x, int y, int width, int height)
+{
+	int* pViewport = (index == 0) ? g_Viewport : NULL;
+	bool* pKnown = (index == 0) ? &g_bViewportKnown : NULL;
+	if ((index > 0) && (index < MAX_VIEWPORTS))
+	{
+		pViewport = g_IndexedViewports[index];
+		pKnown = &g_bIndexedViewportKnown[index];
+	}
+
+	if (NULL != pViewport)
+	{
+		bool bUnchanged = (*pKnown == true) &&
+			(pViewport[0] == x) && (pViewport[1] == y) &&
+			(pViewport[2] == width) && (pViewport[3] == height);
+		if (ShouldIssue(bUnchanged) == false)
+		{
+			return;
+		}
+		pViewport[0] = x;
+		pViewport[1] = y;
+		pViewport[2] = width;
+		pViewport[3] = height;
+		*pKnown = true;
+	}
+	else
+	{
+		g_IssuedCalls++;
+	}
+
+	glViewportIndexedf(index,
+		static_cast<float>(x), static_cast<float>(y),
+		static_cast<float>(width), static_cast<float>(height));
+}
+
+/***********************************************************
+ *  GetViewport()
+ *
+ *  This function is used for getting the viewport.  OpenGL
+ *  is only queried when the viewport is not known.
+ ***********************************************************/
+void GLState::GetViewport(int viewport[4])
+{
+	if (g_bViewportKnown == false)
+	{
+		glGetIntegerv(GL_VIEWPORT, g_Viewport);
+		g_bViewportKnown = true;
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		viewport[i] = g_Viewport[i];
+	}
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This function is used for making a program current.
+ ***********************************************************/
+void GLState::UseProgram(GLuint program)
+{
+	if (ShouldIssue(g_Program == program) == false)
+	{
+		return;
+	}
+
+	g_Program = program;
+	glUseProgram(program);
+}
+
+/***********************************************************
+ *  UseShader()
+ *
+ *  This function is used for making the program of a
+ *  ShaderManager current.  The first time a shader is used
+ *  its program is read back from OpenGL.
+ ***********************************************************/
+void GLState::UseShader(ShaderManager* pShader)
+{
+	if (NULL == pShader)
+	{
+		return;
+	}
+
+	for (int i = 0; i < g_ShaderCount; i++)
+	{
+		if (g_Shaders[i].pShader == pShader)
+		{
+			UseProgram(g_Shaders[i].program);
+			return;
+		}
+	}
+
+	pShader->use();
+	GLint program = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	g_Program = static_cast<GLuint>(program);
+	g_IssuedCalls++;
+
+	if (g_ShaderCount < MAX_SHADERS)
+	{
+		g_Shaders[g_ShaderCount].pShader = pShader;
+		g_Shaders[g_ShaderCount].program = g_Program;
+		g_ShaderCount++;
+	}
+}
+
+/***********************************************************
+ *  SetSampler()
+ *
+ *  This function is used for setting the texture unit of a
+ *  sampler uniform.  The shader must be current.
+ ***********************************************************/
+void GLState::SetSampler(ShaderManager* pShader, const char* name, int unit)
+{
+	if (NULL == pShader)
+	{
+		return;
+	}
+
+	for (int i = 0; i < g_SamplerCount; i++)
+	{
+		if ((g_Samplers[i].pShader == pShader) && (g_Samplers[i].name == name))
+		{
+			if (ShouldIssue(g_Samplers[i].unit == unit) == true)
+			{
+				g_Samplers[i].unit = unit;
+				glUniform1i(GetUniformLocation(pShader, name), unit);
+			}
+			return;
+		}
+	}
+
+	g_IssuedCalls++;
+	glUniform1i(GetUniformLocation(pShader, name), unit);
+	if (g_SamplerCount < MAX_SAMPLERS)
+	{
+		g_Samplers[g_SamplerCount].pShader = pShader;
+		g_Samplers[g_SamplerCount].name = name;
+		g_Samplers[g_SamplerCount].unit = unit;
+		g_SamplerCount++;
+	}
+}
+
+/***********************************************************
+ *  SetUniform()
+ *
+ *  These functions are used for setting a uniform of the
+ *  current shader by its cached location.  The value is
+ *  only passed on when it differs from the last one set at
+ *  the location.
+ ***********************************************************/
+void GLState::SetUniform(ShaderManager* pShader, const char* name, bool bValue)
+{
+	GLint value = (bValue == true) ? 1 : 0;
+	GLint location = -1;
+	if (ShouldSetUniform(pShader, name, &value, sizeof(value), location) == true)
+	{
+		glUniform1i(location, value);
+	}
+}
+
+void GLState::SetUniform(ShaderManager* pShader, const char* name, int value)
+{
+	GLint location = -1;
+	if (ShouldSetUniform(pShader, name, &value, sizeof(value), location) == true)
+	{
+		glUniform1i(location, value);
+	}
+}
+
+void GLState::SetUniform(ShaderManager* pShader, const char* name, float value)
+{
+	GLint location = -1;
+	if (ShouldSetUniform(pShader, name, &value, sizeof(value), location) == true)
+	{
+		glUniform1f(location, value);
+	}
+}
+
+void GLState::SetUniform(ShaderManager* pShader, const char* name, const glm::vec2& value)
+{
+	GLint location = -1;
+	if (ShouldSetUniform(pShader, name, glm::value_ptr(value), 2 * sizeof(GLfloat), location) == true)
+	{
+		glUniform2fv(location, 1, glm::value_ptr(value));
+	}
+}
+
+void GLState::SetUniform(ShaderManager* pShader, const char* name, const glm::vec3& value)
+{
+	GLint location = -1;
+	if (ShouldSetUniform(pShader, name, glm::value_ptr(value), 3 * sizeof(GLfloat), location) == true)
+	{
+		glUniform3fv(location, 1, glm::value_ptr(value));
+	}
+}
+
+void GLState::SetUniform(ShaderManager* pShader, const char* name, const glm::mat4& value)
+{
+	GLint location = -1;
+	if (ShouldSetUniform(pShader, name, glm::value_ptr(value), 16 * sizeof(GLfloat), location) == true)
+	{
+		glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+	}
+}
+
+/***********************************************************
+ *  BindVertexArray()
+ *
+ *  This function is used for binding a vertex array.
+ ***********************************************************/
+void GLState::BindVertexArray(GLuint vertexArray)
+{
+	if (ShouldIssue(g_VertexArray == vertexArray) == false)
+	{
+		return;
+	}
+
+	g_VertexArray = vertexArray;
+	glBindVertexArray(vertexArray);
+}
+
+/***********************************************************
+ *  BindBuffer()
+ *
+ *  This function is used for binding a buffer.  The element
+ *  array binding belongs to the bound vertex array, so it
+ *  is always passed on.
+ ***********************************************************/
+void GLState::BindBuffer(GLenum target, GLuint buffer)
+{
+	GLuint* pBinding = NULL;
+	if (target == GL_ARRAY_BUFFER)
+	{
+		pBinding = &g_ArrayBuffer;
+	}
+	else if (target == GL_UNIFORM_BUFFER)
+	{
+		pBinding = &g_UniformBuffer;
+	}
+
+	if (NULL != pBinding)
+	{
+		if (ShouldIssue(*pBinding == buffer) == false)
+		{
+			return;
+		}
+		*pBinding = buffer;
+	}
+	else
+	{
+		g_IssuedCalls++;
+	}
+
+	glBindBuffer(target, buffer);
+}
+
+/***********************************************************
+ *  BindBufferRange()
+ *
+ *  This function is used for binding a range of a buffer to
+ *  an indexed binding point.
+ ***********************************************************/
+void GLState::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	if ((target == GL_UNIFORM_BUFFER) && (index < MAX_UNIFORM_BUFFER_BINDINGS))
+	{
+		BUFFER_RANGE& range = g_UniformBufferRanges[index];
+		bool bUnchanged = (range.buffer == buffer) && (range.offset == offset) && (range.size == size);
+		if (ShouldIssue(bUnchanged) == false)
+		{
+			return;
+		}
+		range.buffer = buffer;
+		range.offset = offset;
+		range.size = size;
+		// the generic binding point is changed as well
+		g_UniformBuffer = buffer;
+	}
+	else
+	{
+		g_IssuedCalls++;
+	}
+
+	glBindBufferRange(target, index, buffer, offset, size);
+}
+
+/***********************************************************
+ *  DeleteBuffer()
+ *
+ *  This function is used for deleting a buffer.  OpenGL
+ *  unbinds a deleted buffer from every binding point, and
+ *  its name is usually handed out again by the next
+ *  glGenBuffers, so the tracked bindings of the name are
+ *  reset to no buffer as well.
+ ***********************************************************/
+void GLState::DeleteBuffer(GLuint buffer)
+{
+	if (0 == buffer)
+	{
+		return;
+	}
+
+	if (g_ArrayBuffer == buffer)
+	{
+		g_ArrayBuffer = 0;
+	}
+	if (g_UniformBuffer == buffer)
+	{
+		g_UniformBuffer = 0;
+	}
+	for (int i = 0; i < MAX_UNIFORM_BUFFER_BINDINGS; i++)
+	{
+		if (g_UniformBufferRanges[i].buffer == buffer)
+		{
+			g_UniformBufferRanges[i].buffer = 0;
+			g_UniformBufferRanges[i].offset = 0;
+			g_UniformBufferRanges[i].size = 0;
+		}
+	}
+
+	g_IssuedCalls++;
+	glDeleteBuffers(1, &buffer);
+}
+
+/***********************************************************
+ *  ActiveTexture()
+ *
+ *  This function is used for selecting the texture unit
+ *  that textures are bound to.
+ ***********************************************************/
+void GLState::ActiveTexture(GLenum unit)
+{
+	GLuint unitIndex = unit - GL_TEXTURE0;
+	if (ShouldIssue(g_ActiveUnit == unitIndex) == false)
+	{
+		return;
+	}
+
+	g_ActiveUnit = unitIndex;
+	glActiveTexture(unit);
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This function is used for binding a texture to the
+ *  active texture unit.
+ ***********************************************************/
+void GLState::BindTexture(GLenum target, GLuint texture)
+{
+	int targetIndex = GetTextureTargetIndex(target);
+	if ((targetIndex >= 0) && (g_ActiveUnit < MAX_TEXTURE_UNITS))
+	{
+		GLuint& binding = g_Textures[g_ActiveUnit][targetIndex];
+		if (ShouldIssue(binding == texture) == false)
+		{
+			return;
+		}
+		binding = texture;
+	}
+	else
+	{
+		g_IssuedCalls++;
+	}
+
+	glBindTexture(target, texture);
+}
+
+/***********************************************************
+ *  BindFramebuffer()
+ *
+ *  This function is used for binding a framebuffer for
+ *  drawing, reading or both.
+ ***********************************************************/
+void GLState::BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	bool bDraw = (target == GL_FRAMEBUFFER) || (target == GL_DRAW_FRAMEBUFFER);
+	bool bRead = (target == GL_FRAMEBUFFER) || (target == GL_READ_FRAMEBUFFER);
+
+	bool bUnchanged =
+		((bDraw == false) || (g_DrawFramebuffer == framebuffer)) &&
+		((bRead == false) || (g_ReadFramebuffer == framebuffer));
+	if (ShouldIssue(bUnchanged) == false)
+	{
+		return;
+	}
+
+	if (bDraw == true)
+	{
+		g_DrawFramebuffer = framebuffer;
+	}
+	if (bRead == true)
+	{
+		g_ReadFramebuffer = framebuffer;
+	}
+	glBindFramebuffer(target, framebuffer);
+}
+
+/***********************************************************
+ *  GetDrawFramebuffer()
+ *
+ *  This function is used for getting the framebuffer bound
+ *  for drawing.  OpenGL is only queried when the binding is
+ *  not known.
+ ***********************************************************/
+GLuint GLState::GetDrawFramebuffer()
+{
+	if (g_DrawFramebuffer == UNKNOWN_BINDING)
+	{
+		GLint framebuffer = 0;
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer);
+		g_DrawFramebuffer = static_cast<GLuint>(framebuffer);
+	}
+
+	return(g_DrawFramebuffer);
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This function is used for forgetting all of the tracked
+ *  state, so the next call of each kind is passed on.
+ ***********************************************************/
+void GLState::Invalidate()
+{
+	for (int i = 0; i < NUM_CAPABILITIES; i++)
+	{
+		g_Capabilities[i].state = -1;
+	}
+
+	g_bClearColorKnown = false;
+	g_bColorMaskKnown = false;
+	g_bDepthMaskKnown = false;
+	g_DepthFunc = UNKNOWN_BINDING;
+	g_bBlendFuncKnown = false;
+	g_bPolygonOffsetKnown = false;
+	g_bViewportKnown = false;
+	for (int i = 0; i < MAX_VIEWPORTS; i++)
+	{
+		g_bIndexedViewportKnown[i] = false;
+	}
+
+	g_Program = UNKNOWN_BINDING;
+	g_VertexArray = UNKNOWN_BINDING;
+	g_ArrayBuffer = UNKNOWN_BINDING;
+	g_UniformBuffer = UNKNOWN_BINDING;
+	for (int i = 0; i < MAX_UNIFORM_BUFFER_BINDINGS; i++)
+	{
+		g_UniformBufferRanges[i].buffer = UNKNOWN_BINDING;
+		g_UniformBufferRanges[i].offset = 0;
+		g_UniformBufferRanges[i].size = 0;
+	}
+	g_ActiveUnit = UNKNOWN_BINDING;
+	for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+	{
+		g_Textures[i][0] = UNKNOWN_BINDING;
+		g_Textures[i][1] = UNKNOWN_BINDING;
+	}
+	g_DrawFramebuffer = UNKNOWN_BINDING;
+	g_ReadFramebuffer = UNKNOWN_BINDING;
+
+	for (int i = 0; i < g_UniformCount; i++)
+	{
+		g_UniformValues[i].bKnown = false;
+	}
+}
+
+/***********************************************************
+ *  InvalidateVertexArray()
+ *
+ *  This function is used for forgetting the vertex array
+ *  and array buffer bindings, after drawing a mesh that
+ *  binds them directly.
+ ***********************************************************/
+void GLState::InvalidateVertexArray()
+{
+	g_VertexArray = UNKNOWN_BINDING;
+	g_ArrayBuffer = UNKNOWN_BINDING;
+}
+
+/***********************************************************
+ *  UpdateFrameStats()
+ *
+ *  This function is used for publishing the number of
+ *  calls passed on to OpenGL and dropped since the last
+ *  time.
+ ***********************************************************/
+void GLState::UpdateFrameStats()
+{
+	FrameStats::AddCounter("GL state calls issued", g_IssuedCalls);
+	FrameStats::AddCounter("GL state calls dropped", g_DroppedCalls);
+	g_IssuedCalls = 0;
+	g_DroppedCalls = 0;
+}
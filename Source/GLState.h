@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstate.h
+// ============
+// track the OpenGL state and drop calls that would not change it
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  GLState
+ *
+ *  These functions mirror the OpenGL state, binding and
+ *  program calls made while rendering.  A call is only
+ *  passed on to OpenGL when it changes the tracked state,
+ *  and the passed on and dropped calls are counted.
+ *
+ *  Code outside of the project, like ShapeMeshes, changes
+ *  the state directly, so the tracked state has to be
+ *  invalidated after calling into it.
+ *
+ *  The uniforms set while rendering go through here too,
+ *  by their location, since the ShaderManager setters build
+ *  a string from the name on every call.  The last value
+ *  set at each location is kept, so a uniform that is sent
+ *  again with the same value is dropped as well.
+ ***********************************************************/
+namespace GLState
+{
+	// capabilities
+	void Enable(GLenum capability);
+	void Disable(GLenum capability);
+
+	// fixed function state
+	void ClearColor(float red, float green, float blue, float alpha);
+	void ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+	void DepthMask(GLboolean flag);
+	void DepthFunc(GLenum func);
+	void BlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+	void PolygonOffset(float factor, float units);
+	void Viewport(int x, int y, int width, int height);
+	// set one viewport of the viewport array, which Viewport()
+	// sets all of
+	void ViewportIndexed(GLuint index, int x, int y, int width, int height);
+	// get the tracked viewport without querying OpenGL
+	void GetViewport(int viewport[4]);
+
+	// programs - the program of a ShaderManager is looked up
+	// the first time it is used
+	void UseProgram(GLuint program);
+	void UseShader(ShaderManager* pShader);
+	// set a sampler uniform of a shader, the name must stay
+	// alive for the whole run
+	void SetSampler(ShaderManager* pShader, const char* name, int unit);
+	// set a uniform of the current shader without building a
+	// string for its name - the location is looked up the
+	// first time, and the name must stay alive for the whole
+	// run
+	void SetUniform(ShaderManager* pShader, const char* name, bool bValue);
+	void SetUniform(ShaderManager* pShader, const char* name, int value);
+	void SetUniform(ShaderManager* pShader, const char* name, float value);
+	void SetUniform(ShaderManager* pShader, const char* name, const glm::vec2& value);
+	void SetUniform(ShaderManager* pShader, const char* name, const glm::vec3& value);
+	void SetUniform(ShaderManager* pShader, const char* name, const glm::mat4& value);
+
+	// bindings
+	void BindVertexArray(GLuint vertexArray);
+	void BindBuffer(GLenum target, GLuint buffer);
+	void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+	// delete a buffer and forget its bindings, so a new buffer
+	// that gets the same name is bound again
+	void DeleteBuffer(GLuint buffer);
+	void ActiveTexture(GLenum unit);
+	void BindTexture(GLenum target, GLuint texture);
+	void BindFramebuffer(GLenum target, GLuint framebuffer);
+	// get the framebuffer bound for drawing
+	GLuint GetDrawFramebuffer();
+
+	// forget the tracked state after it was changed directly
+	void Invalidate();
+	void InvalidateVertexArray();
+
+	// publish the passed on and dropped calls of the frame
+	void UpdateFrameStats();
+}
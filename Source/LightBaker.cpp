@@ -0,0 +1,378 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightbaker.cpp
+// ============
+// bake the lighting of static objects into their vertices on all cores
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightBaker.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+const float LightBaker::MAX_EDGE_LENGTH = 0.5f;
+
+// declaration of the global variables and defines
+namespace
+{
+	// number of vertices baked by a thread at a time
+	const size_t CHUNK_VERTICES = 2048;
+	// distance the shadow rays start off the surface, so they
+	// do not hit the surface they start on
+	const float SHADOW_RAY_OFFSET = 0.01f;
+
+	/***********************************************************
+	 *  GetGridIndex()
+	 *
+	 *  Get the index of a vertex in the triangular grid of a
+	 *  refined triangle, stored row after row.
+	 ***********************************************************/
+	unsigned int GetGridIndex(int subdivisions, int row, int column)
+	{
+		return(static_cast<unsigned int>((row * (subdivisions + 1)) - ((row * (row - 1)) / 2) + column));
+	}
+}
+
+/***********************************************************
+ *  LightBaker()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightBaker::LightBaker()
+{
+	m_rayTest = NULL;
+	m_pRayContext = NULL;
+	m_nextChunk = 0;
+}
+
+/***********************************************************
+ *  ~LightBaker()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightBaker::~LightBaker()
+{
+	m_lights.clear();
+	m_objects.clear();
+	m_chunks.clear();
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a light to the bake.
+ ***********************************************************/
+void LightBaker::AddLight(const BAKE_LIGHT& light)
+{
+	m_lights.push_back(light);
+}
+
+/***********************************************************
+ *  SetOccluders()
+ *
+ *  This method is used for setting the objects the shadow
+ *  rays are cast against.  The ray test reads the objects
+ *  through the passed in context, which must not change
+ *  while the bake runs.
+ ***********************************************************/
+void LightBaker::SetOccluders(
+	const std::vector<BoundsBVH::BOUNDS>& bounds,
+	BoundsBVH::RAY_TEST rayTest,
+	void* pContext)
+{
+	m_occluderBVH.Build(bounds);
+	m_rayTest = rayTest;
+	m_pRayContext = pContext;
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for adding an object to the bake.
+ *  Its mesh is copied and refined in its world space size.
+ ***********************************************************/
+int LightBaker::AddObject(const MESH_DATA& mesh, const glm::mat4& model, const glm::vec3& diffuseColor)
+{
+	BAKE_OBJECT object;
+	object.model = model;
+	object.normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
+	object.diffuseColor = diffuseColor;
+	RefineMesh(mesh, model, object);
+
+	m_objects.push_back(object);
+	return(static_cast<int>(m_objects.size()) - 1);
+}
+
+/***********************************************************
+ *  RefineMesh()
+ *
+ *  This method is used for copying a mesh into the baked
+ *  vertices, splitting every triangle into a grid of
+ *  smaller ones until its longest world space edge is no
+ *  longer than MAX_EDGE_LENGTH.  The new vertices are
+ *  interpolated from the corners, so the shape and texture
+ *  mapping stay the same.
+ ***********************************************************/
+void LightBaker::RefineMesh(const MESH_DATA& mesh, const glm::mat4& model, BAKE_OBJECT& object)
+{
+	for (size_t t = 0; (t + 2) < mesh.indices.size(); t += 3)
+	{
+		const float* corners[3];
+		glm::vec3 worldCorners[3];
+		for (int c = 0; c < 3; c++)
+		{
+			corners[c] = &mesh.vertices[mesh.indices[t + c] * MESH_DATA::FLOATS_PER_VERTEX];
+			const float* position = corners[c] + MESH_DATA::POSITION_OFFSET;
+			worldCorners[c] = glm::vec3(model * glm::vec4(position[0], position[1], position[2], 1.0f));
+		}
+
+		float longestEdge = std::max(
+			glm::length(worldCorners[1] - worldCorners[0]),
+			std::max(
+				glm::length(worldCorners[2] - worldCorners[1]),
+				glm::length(worldCorners[0] - worldCorners[2])));
+		int subdivisions = static_cast<int>(std::ceil(longestEdge / MAX_EDGE_LENGTH));
+		subdivisions = std::min(std::max(subdivisions, 1), static_cast<int>(MAX_EDGE_SUBDIVISIONS));
+
+		// the grid vertices, row by row from the first corner
+		// towards the third
+		unsigned int firstVertex = static_cast<unsigned int>(object.vertices.size());
+		for (int row = 0; row <= subdivisions; row++)
+		{
+			for (int column = 0; column <= (subdivisions - row); column++)
+			{
+				float weights[3];
+				weights[1] = static_cast<float>(row) / subdivisions;
+				weights[2] = static_cast<float>(column) / subdivisions;
+				weights[0] = 1.0f - weights[1] - weights[2];
+
+				BAKED_VERTEX vertex = BAKED_VERTEX();
+				for (int c = 0; c < 3; c++)
+				{
+					for (int i = 0; i < 3; i++)
+					{
+						vertex.position[i] += corners[c][MESH_DATA::POSITION_OFFSET + i] * weights[c];
+						vertex.normal[i] += corners[c][MESH_DATA::NORMAL_OFFSET + i] * weights[c];
+					}
+					vertex.uv[0] += corners[c][MESH_DATA::UV_OFFSET] * weights[c];
+					vertex.uv[1] += corners[c][MESH_DATA::UV_OFFSET + 1] * weights[c];
+				}
+
+				glm::vec3 normal(vertex.normal[0], vertex.normal[1], vertex.normal[2]);
+				if (glm::length(normal) > 0.0f)
+				{
+					normal = glm::normalize(normal);
+				}
+				vertex.normal[0] = normal.x;
+				vertex.normal[1] = normal.y;
+				vertex.normal[2] = normal.z;
+
+				object.vertices.push_back(vertex);
+			}
+		}
+
+		// two triangles for every grid cell, keeping the
+		// winding of the original triangle
+		for (int row = 0; row < subdivisions; row++)
+		{
+			for (int column = 0; column < (subdivisions - row); column++)
+			{
+				unsigned int corner = firstVertex + GetGridIndex(subdivisions, row, column);
+				unsigned int nextRow = firstVertex + GetGridIndex(subdivisions, row + 1, column);
+				unsigned int nextColumn = corner + 1;
+				object.indices.push_back(corner);
+				object.indices.push_back(nextRow);
+				object.indices.push_back(nextColumn);
+
+				if (column < (subdivisions - row - 1))
+				{
+					object.indices.push_back(nextRow);
+					object.indices.push_back(nextRow + 1);
+					object.indices.push_back(nextColumn);
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used for baking the vertices of every
+ *  object.  The vertices are split into chunks that the
+ *  threads take from a shared counter until all are done,
+ *  so a large object is spread over all of the threads.
+ *  The calling thread bakes chunks as well.
+ ***********************************************************/
+void LightBaker::Bake(int threadCount)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	m_chunks.clear();
+	size_t vertexCount = 0;
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		size_t objectVertices = m_objects[i].vertices.size();
+		for (size_t first = 0; first < objectVertices; first += CHUNK_VERTICES)
+		{
+			BAKE_CHUNK chunk;
+			chunk.object = static_cast<int>(i);
+			chunk.firstVertex = first;
+			chunk.endVertex = std::min(first + CHUNK_VERTICES, objectVertices);
+			m_chunks.push_back(chunk);
+		}
+		vertexCount += objectVertices;
+	}
+
+	if (threadCount <= 0)
+	{
+		threadCount = static_cast<int>(std::thread::hardware_concurrency());
+	}
+	threadCount = std::max(1, std::min(threadCount, static_cast<int>(m_chunks.size())));
+
+	// every thread casts its rays through its own copy of
+	// the tree, which counts the tests of its last ray
+	m_nextChunk = 0;
+	std::vector<std::thread> workers;
+	for (int i = 1; i < threadCount; i++)
+	{
+		workers.push_back(std::thread(&LightBaker::BakeChunks, this, m_occluderBVH));
+	}
+	BakeChunks(m_occluderBVH);
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	double bakeTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	LOG_INFO("INFO: Baked the lighting of " << m_objects.size() << " objects, "
+		<< vertexCount << " vertices, on " << threadCount << " threads in "
+		<< bakeTime << " ms");
+}
+
+/***********************************************************
+ *  BakeChunks()
+ *
+ *  This method is used for baking chunks until none are
+ *  left.  Each vertex is only written by the thread that
+ *  took its chunk.
+ ***********************************************************/
+void LightBaker::BakeChunks(BoundsBVH bvh)
+{
+	for (;;)
+	{
+		size_t chunkIndex = m_nextChunk.fetch_add(1);
+		if (chunkIndex >= m_chunks.size())
+		{
+			return;
+		}
+
+		const BAKE_CHUNK& chunk = m_chunks[chunkIndex];
+		BAKE_OBJECT& object = m_objects[chunk.object];
+		for (size_t i = chunk.firstVertex; i < chunk.endVertex; i++)
+		{
+			BakeVertex(bvh, object, object.vertices[i]);
+		}
+	}
+}
+
+/***********************************************************
+ *  BakeVertex()
+ *
+ *  This method is used for adding up the ambient and
+ *  diffuse light of every light at a vertex, the same way
+ *  the fragment shader does.  The shadows of the lights
+ *  with a visibility channel are found with a ray, and
+ *  their visibility is kept for the specular highlights.
+ ***********************************************************/
+void LightBaker::BakeVertex(BoundsBVH& bvh, const BAKE_OBJECT& object, BAKED_VERTEX& vertex)
+{
+	glm::vec3 position = glm::vec3(object.model *
+		glm::vec4(vertex.position[0], vertex.position[1], vertex.position[2], 1.0f));
+	glm::vec3 normal(vertex.normal[0], vertex.normal[1], vertex.normal[2]);
+
+	// the rays start off the surface along the world space
+	// normal
+	glm::vec3 worldNormal = object.normalMatrix * normal;
+	if (glm::length(worldNormal) > 0.0f)
+	{
+		worldNormal = glm::normalize(worldNormal);
+	}
+	glm::vec3 rayOrigin = position + (worldNormal * SHADOW_RAY_OFFSET);
+
+	glm::vec3 ambient(0.0f);
+	glm::vec3 diffuse(0.0f);
+	for (int c = 0; c < MAX_SHADOWED_LIGHTS; c++)
+	{
+		vertex.visibility[c] = 255;
+	}
+
+	for (size_t i = 0; i < m_lights.size(); i++)
+	{
+		const BAKE_LIGHT& light = m_lights[i];
+
+		glm::vec3 lightDirection;
+		float lightDistance = INFINITY;
+		float attenuation = 1.0f;
+		float intensity = 1.0f;
+		if (light.type == LIGHT_DIRECTIONAL)
+		{
+			lightDirection = glm::normalize(-light.direction);
+		}
+		else
+		{
+			glm::vec3 toLight = light.position - position;
+			lightDistance = glm::length(toLight);
+			lightDirection = (lightDistance > 0.0f) ? (toLight / lightDistance) : glm::vec3(0.0f, 1.0f, 0.0f);
+		}
+
+		if (light.type == LIGHT_SPOT)
+		{
+			attenuation = 1.0f / (light.constant + (light.linear * lightDistance) +
+				(light.quadratic * lightDistance * lightDistance));
+			float theta = glm::dot(lightDirection, glm::normalize(-light.direction));
+			float epsilon = light.cutOff - light.outerCutOff;
+			intensity = glm::clamp((theta - light.outerCutOff) / epsilon, 0.0f, 1.0f);
+		}
+
+		// lights outside their cone do not need a shadow ray
+		float visibility = 1.0f;
+		if ((light.shadowChannel >= 0) && (light.shadowChannel < MAX_SHADOWED_LIGHTS) && (intensity > 0.0f))
+		{
+			if (IsLit(bvh, rayOrigin, lightDirection, lightDistance) == false)
+			{
+				visibility = 0.0f;
+				vertex.visibility[light.shadowChannel] = 0;
+			}
+		}
+
+		float diffuseFactor = std::max(glm::dot(normal, lightDirection), 0.0f);
+		ambient += light.ambient * attenuation;
+		diffuse += light.diffuse * diffuseFactor * object.diffuseColor * intensity * visibility * attenuation;
+	}
+
+	for (int c = 0; c < 3; c++)
+	{
+		vertex.ambient[c] = ambient[c];
+		vertex.diffuse[c] = diffuse[c];
+	}
+}
+
+/***********************************************************
+ *  IsLit()
+ *
+ *  This method is used for checking whether a ray towards a
+ *  light reaches it without hitting an occluder.
+ ***********************************************************/
+bool LightBaker::IsLit(BoundsBVH& bvh, const glm::vec3& origin, const glm::vec3& direction, float maxDistance)
+{
+	if ((NULL == m_rayTest) || (bvh.GetItemCount() == 0))
+	{
+		return(true);
+	}
+
+	float distance = 0.0f;
+	return(bvh.CastRay(origin, direction, maxDistance, m_rayTest, m_pRayContext, distance) < 0);
+}
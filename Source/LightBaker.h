@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightbaker.h
+// ============
+// bake the lighting of static objects into their vertices on all cores
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+#include "BoundsBVH.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <vector>
+
+/***********************************************************
+ *  LightBaker
+ *
+ *  This class calculates the part of the scene lighting
+ *  that does not depend on the view - the ambient and
+ *  diffuse light of every light, with shadows found by
+ *  casting a ray from each vertex to the light against the
+ *  exact shapes of the occluders.  The result is stored in
+ *  the vertices of a copy of each object's mesh, which is
+ *  refined first so the vertices are close enough together
+ *  to show the spot light cone and the shadow edges.
+ *
+ *  The formulas are the ones of the scene fragment shader,
+ *  lit with the vertex normal as the shader receives it, so
+ *  a baked object only differs from a live lit one by the
+ *  lighting being interpolated between the vertices.  The
+ *  vertices are baked in chunks on one thread per core.
+ ***********************************************************/
+class LightBaker
+{
+public:
+	// number of lights whose shadows are kept in the vertex
+	// visibility
+	static const int MAX_SHADOWED_LIGHTS = 4;
+	// longest world space edge left by refining the meshes
+	static const float MAX_EDGE_LENGTH;
+	// largest number of pieces an edge is split into
+	static const int MAX_EDGE_SUBDIVISIONS = 64;
+
+	enum LIGHT_TYPE
+	{
+		LIGHT_DIRECTIONAL,
+		LIGHT_POINT,
+		LIGHT_SPOT
+	};
+
+	// a light with the values of the shader's light structs,
+	// the spot values are only used by spot lights
+	struct BAKE_LIGHT
+	{
+		LIGHT_TYPE type;
+		glm::vec3 position;
+		glm::vec3 direction;
+		glm::vec3 ambient;
+		glm::vec3 diffuse;
+		float cutOff;
+		float outerCutOff;
+		float constant;
+		float linear;
+		float quadratic;
+		// visibility channel of the light's shadow, -1 when
+		// the light casts no shadow
+		int shadowChannel;
+	};
+
+	// constructor
+	LightBaker();
+	// destructor
+	~LightBaker();
+
+	// add a light to bake
+	void AddLight(const BAKE_LIGHT& light);
+	// set the objects that cast shadows - the ray test is
+	// called with the index of an occluder in the bounds list,
+	// from several threads at once
+	void SetOccluders(
+		const std::vector<BoundsBVH::BOUNDS>& bounds,
+		BoundsBVH::RAY_TEST rayTest,
+		void* pContext);
+	// add an object with its local mesh, placement and the
+	// diffuse color of its material, returns its number
+	int AddObject(const MESH_DATA& mesh, const glm::mat4& model, const glm::vec3& diffuseColor);
+
+	// bake every added object, using one thread per core when
+	// the thread count is 0
+	void Bake(int threadCount = 0);
+
+	// the baked mesh of an object
+	const std::vector<BAKED_VERTEX>& GetVertices(int object) const { return(m_objects[object].vertices); }
+	const std::vector<unsigned int>& GetIndices(int object) const { return(m_objects[object].indices); }
+	int GetObjectCount() const { return(static_cast<int>(m_objects.size())); }
+
+private:
+	struct BAKE_OBJECT
+	{
+		glm::mat4 model;
+		// transforms the normals into world space for moving
+		// the shadow rays off the surface
+		glm::mat3 normalMatrix;
+		glm::vec3 diffuseColor;
+		std::vector<BAKED_VERTEX> vertices;
+		std::vector<unsigned int> indices;
+	};
+
+	// a range of vertices of one object baked by one thread
+	struct BAKE_CHUNK
+	{
+		int object;
+		size_t firstVertex;
+		size_t endVertex;
+	};
+
+	// split the triangles of a mesh until their world space
+	// edges are short enough
+	static void RefineMesh(const MESH_DATA& mesh, const glm::mat4& model, BAKE_OBJECT& object);
+	// bake the chunks taken from the shared counter
+	void BakeChunks(BoundsBVH bvh);
+	// bake one vertex of an object
+	void BakeVertex(BoundsBVH& bvh, const BAKE_OBJECT& object, BAKED_VERTEX& vertex);
+	// whether the light reaches a point, casting a ray of
+	// the passed in length towards the light
+	bool IsLit(BoundsBVH& bvh, const glm::vec3& origin, const glm::vec3& direction, float maxDistance);
+
+	std::vector<BAKE_LIGHT> m_lights;
+	std::vector<BAKE_OBJECT> m_objects;
+
+	// the occluders, the tree is copied for every thread
+	BoundsBVH m_occluderBVH;
+	BoundsBVH::RAY_TEST m_rayTest;
+	void* m_pRayContext;
+
+	std::vector<BAKE_CHUNK> m_chunks;
+	// next chunk to bake, shared by the threads
+	std::atomic<size_t> m_nextChunk;
+};
@@ -0,0 +1,490 @@
+///////////////////////////////////////////////////////////////////////////////
+// logger.cpp
+// ============
+// queue console messages for a background thread to write
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// declaration of the global variables and defines
+namespace
+{
+	// number of threads that can hold a ring at the same time,
+	// threads beyond that write their messages right away
+	const int MAX_RINGS = 32;
+	// records in each ring, a power of two
+	const size_t RING_CAPACITY = 128;
+	// time the writer sleeps when no message is queued
+	const int WRITER_SLEEP_MILLISECONDS = 5;
+
+	struct LOG_RECORD
+	{
+		// order of the message over all of the threads
+		uint64_t sequence;
+		Logger::LOG_LEVEL level;
+		int length;
+		char text[Logger::MAX_MESSAGE_LENGTH];
+	};
+
+	// a single producer, single consumer ring - only the
+	// owning thread moves the tail and only the writer moves
+	// the head, so neither needs a lock
+	struct LOG_RING
+	{
+		std::atomic<bool> bClaimed;
+		std::atomic<size_t> head;
+		std::atomic<size_t> tail;
+		LOG_RECORD records[RING_CAPACITY];
+	};
+
+	// a queued record found by the writer, sorted by sequence
+	struct PENDING_RECORD
+	{
+		uint64_t sequence;
+		const LOG_RECORD* pRecord;
+	};
+
+	// the rings live for the whole run - a ring given up by an
+	// ending thread is claimed again by the next new thread
+	LOG_RING g_Rings[MAX_RINGS];
+	std::atomic<int> g_RingCount(0);
+
+	std::atomic<uint64_t> g_NextSequence(0);
+	std::atomic<long long> g_DroppedCount(0);
+	// debug messages are compiled into debug builds, but only
+	// written when asked for
+	std::atomic<int> g_Level(Logger::LEVEL_INFO);
+
+	// the writer thread, and the lock that keeps its output
+	// apart from the messages written right away
+	std::atomic<bool> g_bRunning(false);
+	std::thread g_WriterThread;
+	std::mutex g_OutputMutex;
+	long long g_ReportedDropCount = 0;
+
+	/***********************************************************
+	 *  RING_OWNER
+	 *
+	 *  Holds the ring of the current thread and gives it up
+	 *  when the thread ends.  The queued records stay in the
+	 *  ring until the writer has written them.
+	 ***********************************************************/
+	struct RING_OWNER
+	{
+		LOG_RING* pRing;
+
+		RING_OWNER()
+		{
+			pRing = nullptr;
+		}
+
+		~RING_OWNER()
+		{
+			if (nullptr != pRing)
+			{
+				pRing->bClaimed.store(false, std::memory_order_release);
+			}
+		}
+	};
+
+	thread_local RING_OWNER g_ThreadRing;
+
+	/***********************************************************
+	 *  GetThreadRing()
+	 *
+	 *  Get the ring of the calling thread, claiming a free one
+	 *  on its first message.  Returns null when every ring is
+	 *  held by another thread.
+	 ***********************************************************/
+	LOG_RING* GetThreadRing()
+	{
+		if (nullptr != g_ThreadRing.pRing)
+		{
+			return(g_ThreadRing.pRing);
+		}
+
+		for (int i = 0; i < MAX_RINGS; i++)
+		{
+			bool bClaimed = false;
+			if (g_Rings[i].bClaimed.compare_exchange_strong(bClaimed, true, std::memory_order_acq_rel) == true)
+			{
+				// let the writer look at the rings up to this one
+				int count = g_RingCount.load(std::memory_order_relaxed);
+				while ((count < (i + 1)) &&
+					(g_RingCount.compare_exchange_weak(count, i + 1, std::memory_order_release) == false))
+				{
+				}
+
+				g_ThreadRing.pRing = &g_Rings[i];
+				return(g_ThreadRing.pRing);
+			}
+		}
+
+		return(nullptr);
+	}
+
+	/***********************************************************
+	 *  WriteRecord()
+	 *
+	 *  Write one message to the console, with its level in
+	 *  front when it is a warning or an error.  The caller
+	 *  holds the output lock.
+	 ***********************************************************/
+	void WriteRecord(Logger::LOG_LEVEL level, const char* text, int length)
+	{
+		switch (level)
+		{
+		case Logger::LEVEL_ERROR:
+			std::cerr << "ERROR: ";
+			std::cerr.write(text, length);
+			std::cerr << '\n';
+			break;
+		case Logger::LEVEL_WARNING:
+			std::cerr << "WARNING: ";
+			std::cerr.write(text, length);
+			std::cerr << '\n';
+			break;
+		case Logger::LEVEL_DEBUG:
+			std::cout << "DEBUG: ";
+			std::cout.write(text, length);
+			std::cout << '\n';
+			break;
+		default:
+			std::cout.write(text, length);
+			std::cout << '\n';
+			break;
+		}
+	}
+
+	/***********************************************************
+	 *  WriteQueuedRecords()
+	 *
+	 *  Write every record queued in the rings, merged into the
+	 *  order they were made, and free their slots.  Returns the
+	 *  number of records written.
+	 ***********************************************************/
+	size_t WriteQueuedRecords(std::vector<PENDING_RECORD>& pending)
+	{
+		size_t ends[MAX_RINGS];
+		int ringCount = g_RingCount.load(std::memory_order_acquire);
+
+		pending.clear();
+		for (int i = 0; i < ringCount; i++)
+		{
+			size_t head = g_Rings[i].head.load(std::memory_order_relaxed);
+			ends[i] = g_Rings[i].tail.load(std::memory_order_acquire);
+			for (size_t j = head; j != ends[i]; j++)
+			{
+				PENDING_RECORD record;
+				record.pRecord = &g_Rings[i].records[j & (RING_CAPACITY - 1)];
+				record.sequence = record.pRecord->sequence;
+				pending.push_back(record);
+			}
+		}
+
+		long long droppedCount = g_DroppedCount.load(std::memory_order_relaxed);
+		if ((pending.empty() == true) && (droppedCount == g_ReportedDropCount))
+		{
+			return(0);
+		}
+
+		std::sort(pending.begin(), pending.end(),
+			[](const PENDING_RECORD& a, const PENDING_RECORD& b) { return(a.sequence < b.sequence); });
+
+		{
+			std::lock_guard<std::mutex> lock(g_OutputMutex);
+			for (size_t i = 0; i < pending.size(); i++)
+			{
+				WriteRecord(pending[i].pRecord->level, pending[i].pRecord->text, pending[i].pRecord->length);
+			}
+			if (droppedCount != g_ReportedDropCount)
+			{
+				std::cerr << "WARNING: " << (droppedCount - g_ReportedDropCount)
+					<< " log messages were dropped" << '\n';
+				g_ReportedDropCount = droppedCount;
+			}
+			std::cout.flush();
+			std::cerr.flush();
+		}
+
+		// the slots can be reused once the records are written
+		for (int i = 0; i < ringCount; i++)
+		{
+			g_Rings[i].head.store(ends[i], std::memory_order_release);
+		}
+
+		return(pending.size());
+	}
+
+	/***********************************************************
+	 *  WriterThread()
+	 *
+	 *  Write the queued records until the logger is shut down,
+	 *  sleeping while there are none.
+	 ***********************************************************/
+	void WriterThread()
+	{
+		// room for every ring to be full, so writing never
+		// grows the list
+		std::vector<PENDING_RECORD> pending;
+		pending.reserve(MAX_RINGS * RING_CAPACITY);
+
+		while (g_bRunning.load(std::memory_order_acquire) == true)
+		{
+			if (WriteQueuedRecords(pending) == 0)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_SLEEP_MILLISECONDS));
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This function is used for starting the writer thread.
+ *  Shutdown() is registered to run at exit, so the queued
+ *  messages are written however the application ends.
+ ***********************************************************/
+void Logger::Initialize()
+{
+	if (g_bRunning.load(std::memory_order_acquire) == true)
+	{
+		return;
+	}
+
+	static bool bAtExitRegistered = false;
+	if (bAtExitRegistered == false)
+	{
+		std::atexit(Logger::Shutdown);
+		bAtExitRegistered = true;
+	}
+
+	g_bRunning.store(true, std::memory_order_release);
+	g_WriterThread = std::thread(WriterThread);
+}
+
+/***********************************************************
+ *  Shutdown()
+ *
+ *  This function is used for stopping the writer thread
+ *  and writing the messages it had not reached yet.
+ ***********************************************************/
+void Logger::Shutdown()
+{
+	if (g_bRunning.exchange(false, std::memory_order_acq_rel) == false)
+	{
+		return;
+	}
+
+	if (g_WriterThread.joinable() == true)
+	{
+		g_WriterThread.join();
+	}
+
+	std::vector<PENDING_RECORD> pending;
+	WriteQueuedRecords(pending);
+}
+
+/***********************************************************
+ *  SetLevel()
+ *
+ *  This function is used for setting the lowest level of
+ *  the messages that are written.
+ ***********************************************************/
+void Logger::SetLevel(LOG_LEVEL level)
+{
+	g_Level.store(level, std::memory_order_relaxed);
+}
+
+/***********************************************************
+ *  IsEnabled()
+ *
+ *  This function is used for checking whether messages of
+ *  the passed in level are written.
+ ***********************************************************/
+bool Logger::IsEnabled(LOG_LEVEL level)
+{
+	return(level >= g_Level.load(std::memory_order_relaxed));
+}
+
+/***********************************************************
+ *  GetDroppedCount()
+ *
+ *  This function is used for getting the number of the
+ *  messages that found their ring full.
+ ***********************************************************/
+long long Logger::GetDroppedCount()
+{
+	return(g_DroppedCount.load(std::memory_order_relaxed));
+}
+
+/***********************************************************
+ *  LogMessage()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Logger::LogMessage::LogMessage(LOG_LEVEL level)
+{
+	m_level = level;
+	m_length = 0;
+	m_text[0] = '\0';
+}
+
+/***********************************************************
+ *  ~LogMessage()
+ *
+ *  The destructor for the class - queues the message in
+ *  the ring of the calling thread, or writes it right away
+ *  when the writer is not running or no ring is free.
+ ***********************************************************/
+Logger::LogMessage::~LogMessage()
+{
+	LOG_RING* pRing = nullptr;
+	if (g_bRunning.load(std::memory_order_acquire) == true)
+	{
+		pRing = GetThreadRing();
+	}
+
+	if (nullptr == pRing)
+	{
+		std::lock_guard<std::mutex> lock(g_OutputMutex);
+		WriteRecord(m_level, m_text, m_length);
+		std::cout.flush();
+		return;
+	}
+
+	size_t tail = pRing->tail.load(std::memory_order_relaxed);
+	if ((tail - pRing->head.load(std::memory_order_acquire)) >= RING_CAPACITY)
+	{
+		g_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	LOG_RECORD& record = pRing->records[tail & (RING_CAPACITY - 1)];
+	record.sequence = g_NextSequence.fetch_add(1, std::memory_order_relaxed);
+	record.level = m_level;
+	record.length = m_length;
+	memcpy(record.text, m_text, m_length);
+	pRing->tail.store(tail + 1, std::memory_order_release);
+}
+
+/***********************************************************
+ *  Append()
+ *
+ *  This method is used for adding formatted text to the
+ *  message, cutting it off when the buffer is full.
+ ***********************************************************/
+void Logger::LogMessage::Append(const char* format, ...)
+{
+	int room = MAX_MESSAGE_LENGTH - m_length;
+	if (room <= 1)
+	{
+		return;
+	}
+
+	va_list arguments;
+	va_start(arguments, format);
+	int written = vsnprintf(m_text + m_length, room, format, arguments);
+	va_end(arguments);
+
+	if (written > 0)
+	{
+		m_length += std::min(written, room - 1);
+	}
+}
+
+/***********************************************************
+ *  operator<<()
+ *
+ *  These methods are used for adding a value to the message,
+ *  formatted the way a stream would format it.
+ ***********************************************************/
+Logger::LogMessage& Logger::LogMessage::operator<<(const char* text)
+{
+	Append("%s", (nullptr != text) ? text : "(null)");
+	return(*this);
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(const unsigned char* text)
+{
+	return(*this << reinterpret_cast<const char*>(text));
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(const std::string& text)
+{
+	return(*this << text.c_str());
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(char character)
+{
+	Append("%c", character);
+	return(*this);
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(bool bValue)
+{
+	Append("%d", (bValue == true) ? 1 : 0);
+	return(*this);
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(int value)
+{
+	Append("%d", value);
+	return(*this);
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(unsigned int value)
+{
+	Append("%u", value);
+	return(*this);
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(long value)
+{
+	Append("%ld", value);
+	return(*this);
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(unsigned long value)
+{
+	Append("%lu", value);
+	return(*this);
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(long long value)
+{
+	Append("%lld", value);
+	return(*this);
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(unsigned long long value)
+{
+	Append("%llu", value);
+	return(*this);
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(double value)
+{
+	Append("%g", value);
+	return(*this);
+}
+
+Logger::LogMessage& Logger::LogMessage::operator<<(const void* pointer)
+{
+	Append("%p", pointer);
+	return(*this);
+}
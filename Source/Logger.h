@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+// logger.h
+// ============
+// queue console messages for a background thread to write
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+
+/***********************************************************
+ *  Logger
+ *
+ *  These functions take the console output off the threads
+ *  that produce it.  A message is formatted into a fixed
+ *  size record and pushed into a ring buffer owned by the
+ *  calling thread, without locking or allocating, and a
+ *  background thread writes the records in the order they
+ *  were made.  When a ring is full the message is dropped
+ *  and counted rather than waiting for the console.
+ *
+ *  Messages are written through the LOG_ macros, which take
+ *  a chain of values joined with <<.  Levels below the
+ *  compile level are removed from the build, and levels
+ *  below the run time level are skipped before formatting.
+ *  Before Initialize() and after Shutdown() the messages
+ *  are written right away.
+ ***********************************************************/
+namespace Logger
+{
+	// severity of a message - warnings and errors go to the
+	// error output with their level in front, info messages
+	// are written as they are
+	enum LOG_LEVEL
+	{
+		LEVEL_DEBUG,
+		LEVEL_INFO,
+		LEVEL_WARNING,
+		LEVEL_ERROR
+	};
+
+	// longest message kept, longer ones are cut off
+	const int MAX_MESSAGE_LENGTH = 240;
+
+	// start the thread that writes the queued messages
+	void Initialize();
+	// write the messages still queued and stop the thread
+	void Shutdown();
+
+	// set the lowest level that is written
+	void SetLevel(LOG_LEVEL level);
+	// whether messages of a level are written
+	bool IsEnabled(LOG_LEVEL level);
+
+	// number of messages dropped because a ring was full
+	long long GetDroppedCount();
+
+	/***********************************************************
+	 *  LogMessage
+	 *
+	 *  This class formats one message into its own buffer and
+	 *  queues it when it goes out of scope.  It is normally
+	 *  created by the LOG_ macros, and directly only when a
+	 *  message is put together over several statements.
+	 ***********************************************************/
+	class LogMessage
+	{
+	public:
+		explicit LogMessage(LOG_LEVEL level);
+		~LogMessage();
+
+		LogMessage& operator<<(const char* text);
+		LogMessage& operator<<(const unsigned char* text);
+		LogMessage& operator<<(const std::string& text);
+		LogMessage& operator<<(char character);
+		LogMessage& operator<<(bool bValue);
+		LogMessage& operator<<(int value);
+		LogMessage& operator<<(unsigned int value);
+		LogMessage& operator<<(long value);
+		LogMessage& operator<<(unsigned long value);
+		LogMessage& operator<<(long long value);
+		LogMessage& operator<<(unsigned long long value);
+		LogMessage& operator<<(double value);
+		LogMessage& operator<<(const void* pointer);
+
+	private:
+		// add formatted text, cutting it off at the end of
+		// the buffer
+		void Append(const char* format, ...);
+
+		LOG_LEVEL m_level;
+		int m_length;
+		char m_text[MAX_MESSAGE_LENGTH];
+	};
+}
+
+// lowest level compiled into the build - debug messages
+// are only kept in debug builds unless this is defined
+#ifndef LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILE_LEVEL 1
+#else
+#define LOG_COMPILE_LEVEL 0
+#endif
+#endif
+
+// queue a message of the passed in level, the values are
+// only formatted when the level is written
+#define LOG_MESSAGE(level, message) \
+	do \
+	{ \
+		if (Logger::IsEnabled(level) == true) \
+		{ \
+			Logger::LogMessage logMessage(level); \
+			logMessage << message; \
+		} \
+	} while (false)
+
+#if LOG_COMPILE_LEVEL <= 0
+#define LOG_DEBUG(message) LOG_MESSAGE(Logger::LEVEL_DEBUG, message)
+#else
+#define LOG_DEBUG(message) do {} while (false)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 1
+#define LOG_INFO(message) LOG_MESSAGE(Logger::LEVEL_INFO, message)
+#else
+#define LOG_INFO(message) do {} while (false)
+#endif
+
+#if LOG_COMPILE_LEVEL <= 2
+#define LOG_WARNING(message) LOG_MESSAGE(Logger::LEVEL_WARNING, message)
+#else
+#define LOG_WARNING(message) do {} while (false)
+#endif
+
+#define LOG_ERROR(message) LOG_MESSAGE(Logger::LEVEL_ERROR, message)
@@ -7,8 +7,8 @@
 //	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
 ///////////////////////////////////////////////////////////////////////////////
 
-#include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -20,8 +20,25 @@
 
 #include "SceneManager.h"
 #include "ViewManager.h"
+#include "AllocationCounter.h"
+#include "BatchRenderer.h"
+#include "CameraRecorder.h"
+#include "FrameStats.h"
+#include "FramePacer.h"
+#include "GLState.h"
+#include "Logger.h"
+#include "MeshImporter.h"
+#include "ResolutionScaler.h"
+#include "ResourceTracker.h"
 #include "ShapeMeshes.h"
+#include "ShaderBenchmark.h"
 #include "ShaderManager.h"
+#include "SoftwareRasterizer.h"
+#include "TaskGraph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
 
 // Namespace for declaring global variables
 namespace
@@ -32,18 +49,86 @@ namespace
 	// Main GLFW window
 	GLFWwindow* g_Window = nullptr;
 
+	// default frame rate cap, rendered frames per second
+	const double DEFAULT_FRAME_RATE_CAP = 60.0;
+
+	// dynamic resolution options read from the command line
+	bool g_bDynamicResolution = true;
+	double g_GPUFrameBudget = 1000.0 / DEFAULT_FRAME_RATE_CAP;
+	float g_MinResolutionScale = 0.5f;
+
+	// asset pack options read from the command line - the
+	// scene is loaded from the pack, or cooked into it
+	const char* g_AssetPackFilename = NULL;
+	const char* g_CookPackFilename = NULL;
+	// budget of the streamed texture levels, 0 for no budget
+	size_t g_TextureBudget = 0;
+	// bake the lighting of the static objects at startup
+	bool g_bBakeLighting = true;
+
+	// camera path options read from the command line - the
+	// camera is recorded into the file, or driven from it
+	const char* g_RecordCameraFilename = NULL;
+	const char* g_ReplayCameraFilename = NULL;
+	int g_CameraTickRate = CameraRecorder::DEFAULT_TICK_RATE;
+
+	// frames drawn after the startup before the frames count
+	// as steady for the allocation check, so the caches and
+	// lists have grown to their final size
+	const int ALLOCATION_WARMUP_FRAMES = 60;
+
+	// software render options read from the command line - the
+	// scene is drawn on the CPU without a window or GPU and
+	// written into the file, or compared to the OpenGL frame
+	// as well
+	const char* g_SoftwareRenderFilename = NULL;
+	bool g_bCompareSoftwareRender = false;
+	// steady frames drawn with OpenGL before the comparison,
+	// and the frames drawn on the CPU for timing it
+	const int SOFTWARE_RENDER_WARMUP_FRAMES = 3;
+	const int SOFTWARE_RENDER_FRAMES = 10;
+	// difference of a color channel counted as a different
+	// pixel, out of 255
+	const int SOFTWARE_RENDER_TOLERANCE = 16;
+
+	// batch render options read from the command line - a
+	// still is drawn for every pose of the camera list and
+	// written into a file starting with the prefix
+	const char* g_BatchCameraFilename = NULL;
+	const char* g_BatchOutputPrefix = "still_";
+
+	// shader benchmark option read from the command line - the
+	// cost of the fragment shader is measured and written into
+	// the file
+	const char* g_ShaderBenchmarkFilename = NULL;
+
+	// mesh import options read from the command line - the
+	// mesh file is placed on the desk, or its import is timed
+	const char* g_ImportMeshFilename = NULL;
+	const char* g_ImportBenchmarkFilename = NULL;
+
 	// scene manager object for managing the 3D scene prepare and render
 	SceneManager* g_SceneManager = nullptr;
 	// shader manager object for dynamic interaction with the shader code
 	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// resolution scaler object for holding the GPU frame time
+	ResolutionScaler* g_ResolutionScaler = nullptr;
+	// batch renderer object for reading back the stills of a
+	// batch render
+	BatchRenderer* g_BatchRenderer = nullptr;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+void ParseCommandLine(int argc, char* argv[]);
+void ReportStartup(TaskGraph& startup);
+bool RenderSoftwareOnly();
+const SoftwareRasterizer* DrawSoftwareFrames(int width, int height);
+void RenderSoftwareFrames();
 
 
 /***********************************************************
@@ -54,12 +139,41 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// write the console output from a background thread, so
+	// the frames never wait for the terminal
+	Logger::Initialize();
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
 		return(EXIT_FAILURE);
 	}
 
+	// only render when the scene changes, at most 60 times a
+	// second, unless the command line says otherwise
+	FramePacer::SetRenderOnDemand(true);
+	FramePacer::SetFrameRateCap(DEFAULT_FRAME_RATE_CAP);
+	ParseCommandLine(argc, argv);
+
+	// the import benchmark needs no window
+	if (NULL != g_ImportBenchmarkFilename)
+	{
+		bool bImported = MeshImporter::Benchmark(g_ImportBenchmarkFilename);
+		Logger::Shutdown();
+		glfwTerminate();
+		exit((bImported == true) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// the software render needs no window or GPU, unless it
+	// is compared to OpenGL
+	if ((NULL != g_SoftwareRenderFilename) && (g_bCompareSoftwareRender == false))
+	{
+		bool bRendered = RenderSoftwareOnly();
+		Logger::Shutdown();
+		glfwTerminate();
+		exit((bRendered == true) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
 	// try to create a new shader manager object
 	g_ShaderManager = new ShaderManager();
 	// try to create a new view manager object
@@ -75,42 +189,257 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
+	// the startup runs as a graph of tasks - the images are
+	// decoded and the meshes generated on worker threads while
+	// the shaders compile, and the OpenGL steps run on this
+	// thread, which owns the context
+	double startupStart = glfwGetTime();
+	TaskGraph startup;
+	startup.SetWakeFunction(glfwPostEmptyEvent);
+
 	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"shaders/vertexShader.glsl",
-		"shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
+	int shaderTask = startup.AddTask("compile scene shaders", TaskGraph::THREAD_CONTEXT,
+		[]()
+		{
+			g_ShaderManager->LoadShaders(
+				"shaders/vertexShader.glsl",
+				"shaders/fragmentShader.glsl");
+			g_ShaderManager->use();
+		});
 
-	// try to create a new scene manager object and prepare the 3D scene
+	// try to create a new resolution scaler object for drawing
+	// the scene offscreen at a scale that holds the GPU budget
+	g_ResolutionScaler = new ResolutionScaler();
+	g_ResolutionScaler->SetTargetFrameTime(g_GPUFrameBudget);
+	g_ResolutionScaler->SetScaleBounds(g_MinResolutionScale, 1.0f);
+	g_ResolutionScaler->SetEnabled(g_bDynamicResolution);
+
+	// try to create a new scene manager object and add the tasks
+	// that prepare the 3D scene
 	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
+	g_SceneManager->SetTextureBudget(g_TextureBudget);
+	// a cooked pack is baked when it is loaded, not when it
+	// is cooked
+	g_SceneManager->SetLightBaking((g_bBakeLighting == true) && (NULL == g_CookPackFilename));
+	// the imported mesh is not part of a cooked pack
+	if ((NULL != g_ImportMeshFilename) && (NULL == g_CookPackFilename))
+	{
+		g_SceneManager->SetImportMesh(g_ImportMeshFilename);
+	}
+	int sceneTask = g_SceneManager->PrepareScene(
+		startup, shaderTask, (NULL == g_CookPackFilename) ? g_AssetPackFilename : NULL);
+	startup.Start();
+
+	// the first frame is drawn as soon as the objects can be
+	// drawn, the textures and the baked lighting follow
+	// between the frames
+	startup.WaitForTask(sceneTask);
+	glFinish();
+	LOG_INFO("INFO: First frame ready after " << ((glfwGetTime() - startupStart) * 1000.0) << " ms");
+
+	// cooking, replays for comparing frame times, software
+	// renders, batch renders and the shader benchmark need the
+	// whole scene
+	if ((NULL != g_CookPackFilename) || (NULL != g_ReplayCameraFilename) ||
+		(NULL != g_SoftwareRenderFilename) || (NULL != g_BatchCameraFilename) ||
+		(NULL != g_ShaderBenchmarkFilename))
+	{
+		startup.WaitForAll();
+	}
+
+	// time the fragment shader at the window size and quit,
+	// the benchmark leaves the shader set up for its quads
+	if (NULL != g_ShaderBenchmarkFilename)
+	{
+		int width = 0;
+		int height = 0;
+		glfwGetFramebufferSize(g_Window, &width, &height);
+		ShaderBenchmark* pBenchmark = new ShaderBenchmark(g_ShaderManager);
+		pBenchmark->Run(width, height, g_ShaderBenchmarkFilename);
+		delete pBenchmark;
+		glfwSetWindowShouldClose(g_Window, GL_TRUE);
+	}
+
+	// cook the scene into an asset pack and quit
+	if (NULL != g_CookPackFilename)
+	{
+		g_SceneManager->CookAssetPack(g_CookPackFilename);
+		glfwSetWindowShouldClose(g_Window, GL_TRUE);
+	}
+
+	// render a still for every pose of the camera list, with
+	// all of the resources loaded once
+	if (NULL != g_BatchCameraFilename)
+	{
+		g_BatchRenderer = new BatchRenderer();
+		if (g_BatchRenderer->LoadCameraList(g_BatchCameraFilename) == true)
+		{
+			int width = 0;
+			int height = 0;
+			glfwGetFramebufferSize(g_Window, &width, &height);
+			g_BatchRenderer->Start(width, height, g_BatchOutputPrefix);
+		}
+		else
+		{
+			glfwSetWindowShouldClose(g_Window, GL_TRUE);
+		}
+	}
+
+	// record the camera path, or replay a recorded one for
+	// comparing frame times
+	if (NULL != g_ReplayCameraFilename)
+	{
+		if (g_ViewManager->StartCameraReplay(g_ReplayCameraFilename) == false)
+		{
+			glfwSetWindowShouldClose(g_Window, GL_TRUE);
+		}
+	}
+	else if (NULL != g_RecordCameraFilename)
+	{
+		g_ViewManager->StartCameraRecording(g_RecordCameraFilename, g_CameraTickRate);
+	}
+
+	// the loaders change the OpenGL state directly, so start
+	// the frames with all of the tracked state unknown
+	GLState::Invalidate();
 
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
+	bool bStartupRunning = true;
+	int steadyFrames = 0;
 	while (!glfwWindowShouldClose(g_Window))
 	{
+		// run the startup steps that are ready - a worker wakes
+		// the loop up when it makes one ready
+		if (bStartupRunning == true)
+		{
+			if (startup.RunContextTasks() == true)
+			{
+				GLState::Invalidate();
+			}
+			if (startup.IsFinished() == true)
+			{
+				ReportStartup(startup);
+				bStartupRunning = false;
+			}
+		}
+
+		// sleep until something changed that needs to be drawn
+		if (FramePacer::WaitForFrame() == false)
+		{
+			continue;
+		}
+
+		FrameStats::BeginFrame();
+		AllocationCounter::BeginFrame();
+		// a frame is steady once the startup is done and
+		// nothing is streamed in, picked or shut down in it
+		bool bSteadyFrame = (bStartupRunning == false) &&
+			(g_SceneManager->IsStreamingTextures() == false);
+
 		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		GLState::Enable(GL_DEPTH_TEST);
+
+		// draw into the scaled offscreen target
+		g_ResolutionScaler->BeginFrame(g_Window);
 
 		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		GLState::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+		// place the camera for the next still of a batch
+		BatchRenderer::CAMERA_POSE pose;
+		bool bBatchFrame = (NULL != g_BatchRenderer) && (g_BatchRenderer->GetPose(pose) == true);
+		if (bBatchFrame == true)
+		{
+			g_ViewManager->SetCameraPose(pose.position, pose.target, pose.fieldOfView);
+		}
+
 		// convert from 3D object space to 2D view
 		g_ViewManager->PrepareSceneView();
 
 		// refresh the 3D scene
+		g_SceneManager->SetViews(
+			g_ViewManager->GetViews(),
+			g_ViewManager->GetViewCount());
+
+		// report the object under the cursor after a click
+		glm::vec3 pickOrigin;
+		glm::vec3 pickDirection;
+		SceneManager::PICK_RESULT pick;
+		if ((g_ViewManager->GetPickRay(pickOrigin, pickDirection) == true) &&
+			(g_SceneManager->PickObject(pickOrigin, pickDirection, pick) == true))
+		{
+			bSteadyFrame = false;
+			LOG_INFO("PICKED: " << pick.tag << " (object " << pick.objectIndex
+				<< ") at " << pick.position.x << ", " << pick.position.y << ", " << pick.position.z
+				);
+		}
 		g_SceneManager->RenderScene();
 
+		// upscale the scene into the window
+		g_ResolutionScaler->EndFrame();
 
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
+		// draw the same frame on the CPU once the textures are
+		// in, and compare it to this one before it is shown
+		if ((NULL != g_SoftwareRenderFilename) && (steadyFrames >= SOFTWARE_RENDER_WARMUP_FRAMES))
+		{
+			RenderSoftwareFrames();
+			glfwSetWindowShouldClose(g_Window, GL_TRUE);
+		}
+
+		// the stills of a batch are read from the back buffer
+		// and never shown, so their frames do not wait for the
+		// display - a pose whose texture levels are still loading
+		// is drawn again
+		if (bBatchFrame == true)
+		{
+			if (g_SceneManager->IsStreamingTextures() == false)
+			{
+				g_BatchRenderer->CaptureFrame();
+			}
+			if (g_BatchRenderer->IsFinished() == true)
+			{
+				g_BatchRenderer->Finish();
+				glfwSetWindowShouldClose(g_Window, GL_TRUE);
+			}
+		}
+		else
+		{
+			// Flips the the back buffer with the front buffer every frame.
+			glfwSwapBuffers(g_Window);
+		}
 
 		// query the latest GLFW events
 		glfwPollEvents();
+
+		// wait for the frame rate cap before the next frame
+		FramePacer::EndFrame();
+		GLState::UpdateFrameStats();
+		ResourceTracker::UpdateFrameStats();
+
+		bSteadyFrame = (bSteadyFrame == true) &&
+			(g_SceneManager->IsStreamingTextures() == false) &&
+			(glfwWindowShouldClose(g_Window) == false);
+		steadyFrames = (bSteadyFrame == true) ? (steadyFrames + 1) : 0;
+		AllocationCounter::EndFrame(steadyFrames > ALLOCATION_WARMUP_FRAMES);
+		FrameStats::EndFrame();
+	}
+
+	// the startup tasks that are left use the managers, so
+	// they finish before the managers are freed
+	if (bStartupRunning == true)
+	{
+		startup.WaitForAll();
+		ReportStartup(startup);
 	}
 
 	// clear the allocated manager objects from memory
+	if (NULL != g_BatchRenderer)
+	{
+		delete g_BatchRenderer;
+		g_BatchRenderer = NULL;
+	}
 	if (NULL != g_SceneManager)
 	{
 		delete g_SceneManager;
@@ -121,16 +450,364 @@ int main(int argc, char* argv[])
 		delete g_ViewManager;
 		g_ViewManager = NULL;
 	}
+	if (NULL != g_ResolutionScaler)
+	{
+		delete g_ResolutionScaler;
+		g_ResolutionScaler = NULL;
+	}
 	if (NULL != g_ShaderManager)
 	{
 		delete g_ShaderManager;
 		g_ShaderManager = NULL;
 	}
 
+	// everything the managers allocated is freed by now
+	ResourceTracker::ReportLeaks();
+
+	// a steady frame that allocated fails the check
+	bool bAllocationsFailed = (AllocationCounter::GetFailedFrames() > 0);
+	if (bAllocationsFailed == true)
+	{
+		LOG_ERROR(AllocationCounter::GetFailedFrames() << " steady state frames made heap allocations");
+	}
+
+	// write the messages that are still queued
+	Logger::Shutdown();
+
+	if (bAllocationsFailed == true)
+	{
+		exit(EXIT_FAILURE);
+	}
+
 	// Terminates the program successfully
 	exit(EXIT_SUCCESS); 
 }
 
+/***********************************************************
+ *	ParseCommandLine()
+ *
+ *  This function is used to read the frame pacing and
+ *  resolution options from the command line:
+ *    --continuous          render every frame instead of on demand
+ *    --fps <value>         frame rate cap, 0 for no cap
+ *    --fixed-resolution    always render at the window resolution
+ *    --gpu-budget <ms>     GPU time per frame the resolution holds
+ *    --min-scale <value>   lowest resolution scale, 0 to 1
+ *    --pack <file>         load the scene from a cooked asset pack
+ *    --cook <file>         cook the loose scene files into an asset
+ *                          pack and quit
+ *    --gpu-memory <MB>     budget for textures, buffers and targets
+ *    --cpu-memory <MB>     budget for the tracked CPU memory
+ *    --texture-memory <MB> budget for the streamed texture levels
+ *    --record-camera <file> record the camera path into a file
+ *    --replay-camera <file> drive the camera from a recording, one
+ *                          tick per frame, print the frame times
+ *                          and quit
+ *    --tick-rate <value>   camera ticks recorded per second
+ *    --hidden              do not show the window, for replays
+ *                          without a desktop
+ *    --no-bake             light the static objects live instead of
+ *                          baking their lighting
+ *    --log-level <level>   lowest message level written - debug,
+ *                          info, warning or error
+ *    --check-allocations   fail when a steady state frame allocates
+ *                          from the heap, for replays
+ *    --software-render <file> draw the scene on the CPU into a PPM
+ *                          image without a window or GPU, print the
+ *                          time per frame, and quit
+ *    --compare-opengl      draw the software render in a window
+ *                          with OpenGL as well, and print the
+ *                          difference
+ *    --batch-render <file> render a still for every camera pose in
+ *                          the file, "x y z  tx ty tz  [fov]" per
+ *                          line, and quit
+ *    --batch-output <prefix> start of the still file names
+ *    --shader-benchmark <file> time the fragment shader for a set
+ *                          of light configurations, write the
+ *                          times into a CSV file, and quit
+ *    --import-mesh <file>  import an .obj, .gltf or .glb file and
+ *                          place it on the desk
+ *    --import-benchmark <file> time the import of a mesh file with
+ *                          1 to all of the cores, print the MB/s,
+ *                          and quit
+ ***********************************************************/
+void ParseCommandLine(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--continuous") == 0)
+		{
+			FramePacer::SetRenderOnDemand(false);
+		}
+		else if ((strcmp(argv[i], "--fps") == 0) && ((i + 1) < argc))
+		{
+			FramePacer::SetFrameRateCap(atof(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--fixed-resolution") == 0)
+		{
+			g_bDynamicResolution = false;
+		}
+		else if ((strcmp(argv[i], "--gpu-budget") == 0) && ((i + 1) < argc))
+		{
+			g_GPUFrameBudget = atof(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--min-scale") == 0) && ((i + 1) < argc))
+		{
+			g_MinResolutionScale = static_cast<float>(atof(argv[++i]));
+		}
+		else if ((strcmp(argv[i], "--pack") == 0) && ((i + 1) < argc))
+		{
+			g_AssetPackFilename = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--cook") == 0) && ((i + 1) < argc))
+		{
+			g_CookPackFilename = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--gpu-memory") == 0) && ((i + 1) < argc))
+		{
+			ResourceTracker::SetGPUBudget(static_cast<size_t>(atof(argv[++i]) * 1024.0 * 1024.0));
+		}
+		else if ((strcmp(argv[i], "--cpu-memory") == 0) && ((i + 1) < argc))
+		{
+			ResourceTracker::SetCPUBudget(static_cast<size_t>(atof(argv[++i]) * 1024.0 * 1024.0));
+		}
+		else if ((strcmp(argv[i], "--texture-memory") == 0) && ((i + 1) < argc))
+		{
+			g_TextureBudget = static_cast<size_t>(atof(argv[++i]) * 1024.0 * 1024.0);
+		}
+		else if ((strcmp(argv[i], "--record-camera") == 0) && ((i + 1) < argc))
+		{
+			g_RecordCameraFilename = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--replay-camera") == 0) && ((i + 1) < argc))
+		{
+			// a replay renders every frame so each one takes a
+			// tick of the recording
+			g_ReplayCameraFilename = argv[++i];
+			FramePacer::SetRenderOnDemand(false);
+		}
+		else if ((strcmp(argv[i], "--tick-rate") == 0) && ((i + 1) < argc))
+		{
+			g_CameraTickRate = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--hidden") == 0)
+		{
+			glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+		}
+		else if (strcmp(argv[i], "--no-bake") == 0)
+		{
+			g_bBakeLighting = false;
+		}
+		else if (strcmp(argv[i], "--check-allocations") == 0)
+		{
+			AllocationCounter::SetCheck(true);
+		}
+		else if ((strcmp(argv[i], "--batch-render") == 0) && ((i + 1) < argc))
+		{
+			// the stills are drawn one after the other as fast as
+			// they can be, at the window size
+			g_BatchCameraFilename = argv[++i];
+			FramePacer::SetRenderOnDemand(false);
+			FramePacer::SetFrameRateCap(0.0);
+			g_bDynamicResolution = false;
+		}
+		else if ((strcmp(argv[i], "--batch-output") == 0) && ((i + 1) < argc))
+		{
+			g_BatchOutputPrefix = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--shader-benchmark") == 0) && ((i + 1) < argc))
+		{
+			g_ShaderBenchmarkFilename = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--import-mesh") == 0) && ((i + 1) < argc))
+		{
+			g_ImportMeshFilename = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--import-benchmark") == 0) && ((i + 1) < argc))
+		{
+			g_ImportBenchmarkFilename = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--software-render") == 0) && ((i + 1) < argc))
+		{
+			// the OpenGL frame is compared at the window size and
+			// lit live, the way the CPU draws it
+			g_SoftwareRenderFilename = argv[++i];
+			FramePacer::SetRenderOnDemand(false);
+			g_bDynamicResolution = false;
+			g_bBakeLighting = false;
+		}
+		else if (strcmp(argv[i], "--compare-opengl") == 0)
+		{
+			g_bCompareSoftwareRender = true;
+		}
+		else if ((strcmp(argv[i], "--log-level") == 0) && ((i + 1) < argc))
+		{
+			i++;
+			if (strcmp(argv[i], "debug") == 0)
+			{
+				Logger::SetLevel(Logger::LEVEL_DEBUG);
+			}
+			else if (strcmp(argv[i], "info") == 0)
+			{
+				Logger::SetLevel(Logger::LEVEL_INFO);
+			}
+			else if (strcmp(argv[i], "warning") == 0)
+			{
+				Logger::SetLevel(Logger::LEVEL_WARNING);
+			}
+			else if (strcmp(argv[i], "error") == 0)
+			{
+				Logger::SetLevel(Logger::LEVEL_ERROR);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *	ReportStartup()
+ *
+ *  This function is used to write where the scene was
+ *  prepared from, once every startup task has finished,
+ *  and the timeline of the tasks with the critical path.
+ ***********************************************************/
+void ReportStartup(TaskGraph& startup)
+{
+	LOG_INFO("INFO: Scene prepared from "
+		<< ((g_SceneManager->IsLoadedFromPack() == true) ? "asset pack" : "loose files"));
+	startup.ReportTimeline();
+}
+
+/***********************************************************
+ *	RenderSoftwareOnly()
+ *
+ *  This function is used to draw the scene on the CPU on a
+ *  machine without a GPU.  No window, OpenGL context or
+ *  shader is created - the scene is only loaded into
+ *  memory, drawn from the starting camera at the size of
+ *  the window and written into the software render file.
+ *  Returns false when the image could not be written.
+ ***********************************************************/
+bool RenderSoftwareOnly()
+{
+	// without a shader manager the managers make no OpenGL
+	// calls
+	g_ViewManager = new ViewManager(NULL);
+	g_SceneManager = new SceneManager(NULL);
+	if (NULL != g_ImportMeshFilename)
+	{
+		g_SceneManager->SetImportMesh(g_ImportMeshFilename);
+	}
+	g_SceneManager->PrepareSceneSoftware(g_AssetPackFilename);
+	LOG_INFO("INFO: Scene prepared from "
+		<< ((g_SceneManager->IsLoadedFromPack() == true) ? "asset pack" : "loose files"));
+
+	g_ViewManager->CalculateViews();
+	g_SceneManager->SetViews(
+		g_ViewManager->GetViews(),
+		g_ViewManager->GetViewCount());
+
+	int width = 0;
+	int height = 0;
+	ViewManager::GetWindowSize(width, height);
+	bool bRendered = (NULL != DrawSoftwareFrames(width, height));
+
+	delete g_SceneManager;
+	g_SceneManager = NULL;
+	delete g_ViewManager;
+	g_ViewManager = NULL;
+	ResourceTracker::ReportLeaks();
+
+	return(bRendered);
+}
+
+/***********************************************************
+ *	DrawSoftwareFrames()
+ *
+ *  This function is used to draw the first view of the
+ *  scene on the CPU and write it into the software render
+ *  file.  The frame is drawn several times for the time
+ *  per frame.  The image is returned, or NULL when it could
+ *  not be written.
+ ***********************************************************/
+const SoftwareRasterizer* DrawSoftwareFrames(int width, int height)
+{
+	const SoftwareRasterizer* pImage = NULL;
+	std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+	for (int i = 0; i < SOFTWARE_RENDER_FRAMES; i++)
+	{
+		pImage = g_SceneManager->RenderSceneSoftware(width, height);
+	}
+	double frameTime = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - renderStart).count() / SOFTWARE_RENDER_FRAMES;
+	LOG_INFO("INFO: Software render " << width << "x" << height << " in " << frameTime << " ms per frame");
+
+	if (pImage->SaveImage(g_SoftwareRenderFilename) == false)
+	{
+		LOG_ERROR("Failed to write the software render " << g_SoftwareRenderFilename);
+		return(NULL);
+	}
+
+	return(pImage);
+}
+
+/***********************************************************
+ *	RenderSoftwareFrames()
+ *
+ *  This function is used to draw the current frame on the
+ *  CPU at the size of the window, write it into the
+ *  software render file and compare it to the frame drawn
+ *  by OpenGL, which is read back from the back buffer.  The
+ *  shadows are only drawn by OpenGL, so the frames differ
+ *  where they fall.
+ ***********************************************************/
+void RenderSoftwareFrames()
+{
+	int width = 0;
+	int height = 0;
+	glfwGetFramebufferSize(g_Window, &width, &height);
+	if ((width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	// the rows of the back buffer start at the bottom
+	std::vector<unsigned char> glPixels(static_cast<size_t>(width) * height * 4);
+	GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &glPixels[0]);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	const SoftwareRasterizer* pImage = DrawSoftwareFrames(width, height);
+	if (NULL == pImage)
+	{
+		return;
+	}
+
+	double totalDifference = 0.0;
+	size_t differentPixels = 0;
+	for (int y = 0; y < height; y++)
+	{
+		const unsigned char* pRow = &glPixels[static_cast<size_t>(height - 1 - y) * width * 4];
+		for (int x = 0; x < width; x++)
+		{
+			const unsigned char* pCPU = pImage->GetPixel(x, y);
+			int largest = 0;
+			for (int c = 0; c < 3; c++)
+			{
+				int difference = std::abs(static_cast<int>(pCPU[c]) - static_cast<int>(pRow[x * 4 + c]));
+				totalDifference += difference;
+				largest = std::max(largest, difference);
+			}
+			differentPixels += (largest > SOFTWARE_RENDER_TOLERANCE) ? 1 : 0;
+		}
+	}
+
+	double pixelCount = static_cast<double>(width) * height;
+	LOG_INFO("INFO: Software render differs from OpenGL by " << (totalDifference / (pixelCount * 3.0))
+		<< " per channel, " << (100.0 * differentPixels / pixelCount) << "% of the pixels by more than "
+		<< SOFTWARE_RENDER_TOLERANCE);
+}
+
 /***********************************************************
  *	InitializeGLFW()
  * 
@@ -173,14 +850,14 @@ bool InitializeGLEW()
 	GLEWInitResult = glewInit();
 	if (GLEW_OK != GLEWInitResult)
 	{
-		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		LOG_ERROR(glewGetErrorString(GLEWInitResult));
 		return false;
 	}
 	// GLEW: end -------------------------------
 
 	// Displays a successful OpenGL initialization message
-	std::cout << "INFO: OpenGL Successfully Initialized\n";
-	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
+	LOG_INFO("INFO: OpenGL Successfully Initialized");
+	LOG_INFO("INFO: OpenGL Version: " << glGetString(GL_VERSION));
 
 	return(true);
 }
\ No newline at end of file
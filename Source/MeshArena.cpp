@@ -0,0 +1,268 @@
+///////////////////////////////////////////////////////////////////////////////
+// mesharena.cpp
+// ============
+// sub-allocate the vertices and indices of all meshes from shared buffers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshArena.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  MeshArena()
+ *
+ *  The constructor for the class - the buffers are created
+ *  with the first mesh.
+ ***********************************************************/
+MeshArena::MeshArena()
+{
+	m_vertexBuffer.buffer = 0;
+	m_vertexBuffer.capacity = 0;
+	m_vertexBuffer.used = 0;
+	m_vertexBuffer.owner = "mesh arena vertices";
+
+	m_indexBuffer.buffer = 0;
+	m_indexBuffer.capacity = 0;
+	m_indexBuffer.used = 0;
+	m_indexBuffer.owner = "mesh arena indices";
+
+	m_bufferVersion = 0;
+}
+
+/***********************************************************
+ *  ~MeshArena()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshArena::~MeshArena()
+{
+	ARENA_BUFFER* buffers[2] = { &m_vertexBuffer, &m_indexBuffer };
+	for (int i = 0; i < 2; i++)
+	{
+		if (buffers[i]->buffer != 0)
+		{
+			ResourceTracker::Release(ResourceTracker::RESOURCE_BUFFER, buffers[i]->buffer);
+			GLState::DeleteBuffer(buffers[i]->buffer);
+			buffers[i]->buffer = 0;
+		}
+		buffers[i]->freeBlocks.clear();
+	}
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for taking the ranges of a mesh in
+ *  the shared buffers and uploading its vertices and
+ *  indices into them.  The vertex range starts on a whole
+ *  vertex, so the shared vertex array reaches it with a
+ *  base vertex.
+ ***********************************************************/
+bool MeshArena::AddMesh(
+	const void* vertices,
+	size_t vertexBytes,
+	size_t vertexSize,
+	const void* indices,
+	size_t indexBytes,
+	ARENA_RANGE& range)
+{
+	range.vertexOffset = 0;
+	range.vertexBytes = vertexBytes;
+	range.indexOffset = 0;
+	range.indexBytes = indexBytes;
+
+	if (Allocate(m_vertexBuffer, vertexBytes, vertexSize, INITIAL_VERTEX_BYTES, range.vertexOffset) == false)
+	{
+		return(false);
+	}
+	if (Allocate(m_indexBuffer, indexBytes, INDEX_ALIGNMENT, INITIAL_INDEX_BYTES, range.indexOffset) == false)
+	{
+		FreeRange(m_vertexBuffer, range.vertexOffset, vertexBytes);
+		return(false);
+	}
+
+	// the copy write target leaves the bindings of the vertex
+	// arrays alone
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_vertexBuffer.buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, range.vertexOffset, vertexBytes, vertices);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_indexBuffer.buffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, range.indexOffset, indexBytes, indices);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	m_vertexBuffer.used += vertexBytes;
+	m_indexBuffer.used += indexBytes;
+
+	return(true);
+}
+
+/***********************************************************
+ *  RemoveMesh()
+ *
+ *  This method is used for giving the ranges of a mesh back
+ *  to the free lists.  The buffers keep their size.
+ ***********************************************************/
+void MeshArena::RemoveMesh(const ARENA_RANGE& range)
+{
+	FreeRange(m_vertexBuffer, range.vertexOffset, range.vertexBytes);
+	FreeRange(m_indexBuffer, range.indexOffset, range.indexBytes);
+
+	m_vertexBuffer.used -= range.vertexBytes;
+	m_indexBuffer.used -= range.indexBytes;
+}
+
+/***********************************************************
+ *  ReadMesh()
+ *
+ *  This method is used for reading the vertices and indices
+ *  of a mesh back from the shared buffers.
+ ***********************************************************/
+void MeshArena::ReadMesh(const ARENA_RANGE& range, void* vertices, void* indices)
+{
+	GLState::BindBuffer(GL_COPY_READ_BUFFER, m_vertexBuffer.buffer);
+	glGetBufferSubData(GL_COPY_READ_BUFFER, range.vertexOffset, range.vertexBytes, vertices);
+	GLState::BindBuffer(GL_COPY_READ_BUFFER, m_indexBuffer.buffer);
+	glGetBufferSubData(GL_COPY_READ_BUFFER, range.indexOffset, range.indexBytes, indices);
+	GLState::BindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+/***********************************************************
+ *  AllocateRange()
+ *
+ *  This method is used for taking an aligned range from the
+ *  first free block it fits into.  What is left of the block
+ *  in front of and behind the range stays free.
+ ***********************************************************/
+bool MeshArena::AllocateRange(ARENA_BUFFER& arenaBuffer, size_t bytes, size_t alignment, size_t& offset)
+{
+	for (size_t i = 0; i < arenaBuffer.freeBlocks.size(); i++)
+	{
+		FREE_BLOCK block = arenaBuffer.freeBlocks[i];
+		size_t aligned = ((block.offset + alignment - 1) / alignment) * alignment;
+		size_t blockEnd = block.offset + block.size;
+		if ((aligned > blockEnd) || ((blockEnd - aligned) < bytes))
+		{
+			continue;
+		}
+
+		arenaBuffer.freeBlocks.erase(arenaBuffer.freeBlocks.begin() + i);
+		if ((aligned + bytes) < blockEnd)
+		{
+			FREE_BLOCK back = { aligned + bytes, blockEnd - (aligned + bytes) };
+			arenaBuffer.freeBlocks.insert(arenaBuffer.freeBlocks.begin() + i, back);
+		}
+		if (aligned > block.offset)
+		{
+			FREE_BLOCK front = { block.offset, aligned - block.offset };
+			arenaBuffer.freeBlocks.insert(arenaBuffer.freeBlocks.begin() + i, front);
+		}
+
+		offset = aligned;
+		return(true);
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  FreeRange()
+ *
+ *  This method is used for putting a range back onto the
+ *  free list, merging it with the free blocks it touches.
+ ***********************************************************/
+void MeshArena::FreeRange(ARENA_BUFFER& arenaBuffer, size_t offset, size_t bytes)
+{
+	if (bytes == 0)
+	{
+		return;
+	}
+
+	std::vector<FREE_BLOCK>& blocks = arenaBuffer.freeBlocks;
+	size_t index = 0;
+	while ((index < blocks.size()) && (blocks[index].offset < offset))
+	{
+		index++;
+	}
+
+	FREE_BLOCK block = { offset, bytes };
+	blocks.insert(blocks.begin() + index, block);
+
+	// merge with the following block, then with the one before
+	if (((index + 1) < blocks.size()) && ((blocks[index].offset + blocks[index].size) == blocks[index + 1].offset))
+	{
+		blocks[index].size += blocks[index + 1].size;
+		blocks.erase(blocks.begin() + index + 1);
+	}
+	if ((index > 0) && ((blocks[index - 1].offset + blocks[index - 1].size) == blocks[index].offset))
+	{
+		blocks[index - 1].size += blocks[index].size;
+		blocks.erase(blocks.begin() + index);
+	}
+}
+
+/***********************************************************
+ *  GrowBuffer()
+ *
+ *  This method is used for replacing a buffer by one at
+ *  least twice as large, copying the ranges that are in use
+ *  on the GPU.  The new space at the end is added to the
+ *  free list.
+ ***********************************************************/
+bool MeshArena::GrowBuffer(ARENA_BUFFER& arenaBuffer, size_t extraBytes, size_t initialBytes)
+{
+	size_t capacity = std::max(std::max(arenaBuffer.capacity * 2, initialBytes), arenaBuffer.capacity + extraBytes);
+	if (ResourceTracker::FitsBudget(ResourceTracker::RESOURCE_BUFFER, capacity) == false)
+	{
+		return(false);
+	}
+
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, capacity, NULL, GL_STATIC_DRAW);
+
+	if (arenaBuffer.buffer != 0)
+	{
+		GLState::BindBuffer(GL_COPY_READ_BUFFER, arenaBuffer.buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, arenaBuffer.capacity);
+		GLState::BindBuffer(GL_COPY_READ_BUFFER, 0);
+
+		ResourceTracker::Release(ResourceTracker::RESOURCE_BUFFER, arenaBuffer.buffer);
+		GLState::DeleteBuffer(arenaBuffer.buffer);
+	}
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	FreeRange(arenaBuffer, arenaBuffer.capacity, capacity - arenaBuffer.capacity);
+
+	arenaBuffer.buffer = buffer;
+	arenaBuffer.capacity = capacity;
+	m_bufferVersion++;
+
+	ResourceTracker::Track(ResourceTracker::RESOURCE_BUFFER, buffer, capacity,
+		ResourceTracker::CATEGORY_MESH, arenaBuffer.owner);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for taking a range of a buffer,
+ *  growing the buffer once when no free block is large
+ *  enough.
+ ***********************************************************/
+bool MeshArena::Allocate(ARENA_BUFFER& arenaBuffer, size_t bytes, size_t alignment, size_t initialBytes, size_t& offset)
+{
+	if (AllocateRange(arenaBuffer, bytes, alignment, offset) == true)
+	{
+		return(true);
+	}
+
+	if (GrowBuffer(arenaBuffer, bytes + alignment, initialBytes) == false)
+	{
+		return(false);
+	}
+
+	return(AllocateRange(arenaBuffer, bytes, alignment, offset));
+}
@@ -0,0 +1,113 @@
+///////////////////////////////////////////////////////////////////////////////
+// mesharena.h
+// ============
+// sub-allocate the vertices and indices of all meshes from shared buffers
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+/***********************************************************
+ *  MeshArena
+ *
+ *  This class owns one large vertex buffer and one large
+ *  index buffer, and hands out ranges of them to meshes.
+ *  Meshes in the same vertex format share one vertex array
+ *  that points at the start of the vertex buffer, and are
+ *  drawn with a base vertex and an index offset, so moving
+ *  from one mesh to the next does not bind anything.
+ *
+ *  The ranges of a removed mesh go back onto a free list,
+ *  merged with the free ranges next to them, and are handed
+ *  out again first.  When no free range is large enough the
+ *  buffer is replaced by one of twice the size, and the old
+ *  contents are copied over on the GPU.
+ ***********************************************************/
+class MeshArena
+{
+public:
+	// size the buffers start with
+	static const size_t INITIAL_VERTEX_BYTES = 4 * 1024 * 1024;
+	static const size_t INITIAL_INDEX_BYTES = 1024 * 1024;
+	// index ranges start on 4 bytes, so 32 bit indices are
+	// aligned in the shared buffer
+	static const size_t INDEX_ALIGNMENT = 4;
+
+	// the ranges of one mesh in the shared buffers - the
+	// vertex offset is a multiple of the vertex size
+	struct ARENA_RANGE
+	{
+		size_t vertexOffset;
+		size_t vertexBytes;
+		size_t indexOffset;
+		size_t indexBytes;
+	};
+
+	// constructor
+	MeshArena();
+	// destructor
+	~MeshArena();
+
+	// take ranges for a mesh and upload its data, returns false
+	// when the buffers cannot grow within the memory budget
+	bool AddMesh(
+		const void* vertices,
+		size_t vertexBytes,
+		size_t vertexSize,
+		const void* indices,
+		size_t indexBytes,
+		ARENA_RANGE& range);
+	// give the ranges of a mesh back
+	void RemoveMesh(const ARENA_RANGE& range);
+	// read the data of a mesh back from the buffers
+	void ReadMesh(const ARENA_RANGE& range, void* vertices, void* indices);
+
+	GLuint GetVertexBuffer() const { return(m_vertexBuffer.buffer); }
+	GLuint GetIndexBuffer() const { return(m_indexBuffer.buffer); }
+	// changes every time the buffers are replaced, so the
+	// vertex arrays know to point at the new ones
+	unsigned int GetBufferVersion() const { return(m_bufferVersion); }
+
+	// memory handed out to meshes and the size of the buffers
+	size_t GetVertexBytesUsed() const { return(m_vertexBuffer.used); }
+	size_t GetVertexCapacity() const { return(m_vertexBuffer.capacity); }
+	size_t GetIndexBytesUsed() const { return(m_indexBuffer.used); }
+	size_t GetIndexCapacity() const { return(m_indexBuffer.capacity); }
+
+private:
+	// a range of a buffer that is not used by any mesh
+	struct FREE_BLOCK
+	{
+		size_t offset;
+		size_t size;
+	};
+
+	struct ARENA_BUFFER
+	{
+		GLuint buffer;
+		size_t capacity;
+		size_t used;
+		// sorted by offset, no two blocks touch
+		std::vector<FREE_BLOCK> freeBlocks;
+		// owner name for the resource tracker
+		const char* owner;
+	};
+
+	// take the first free range that fits, returns false when
+	// none does
+	static bool AllocateRange(ARENA_BUFFER& arenaBuffer, size_t bytes, size_t alignment, size_t& offset);
+	// put a range back onto the free list
+	static void FreeRange(ARENA_BUFFER& arenaBuffer, size_t offset, size_t bytes);
+	// replace a buffer by a larger one that holds at least
+	// the passed in number of bytes more
+	bool GrowBuffer(ARENA_BUFFER& arenaBuffer, size_t extraBytes, size_t initialBytes);
+	// take a range, growing the buffer when it is full
+	bool Allocate(ARENA_BUFFER& arenaBuffer, size_t bytes, size_t alignment, size_t initialBytes, size_t& offset);
+
+	ARENA_BUFFER m_vertexBuffer;
+	ARENA_BUFFER m_indexBuffer;
+	unsigned int m_bufferVersion;
+};
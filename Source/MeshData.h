@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshdata.h
+// ============
+// CPU side vertex and index data for meshes built or loaded by the project
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MESH_DATA
+ *
+ *  Indexed triangle list in the same layout the shaders
+ *  consume - position (3 floats), normal (3 floats) and
+ *  texture coordinate (2 floats) for every vertex.
+ ***********************************************************/
+struct MESH_DATA
+{
+	// number of floats stored for every vertex
+	static const int FLOATS_PER_VERTEX = 8;
+	// offsets of the attributes inside a vertex
+	static const int POSITION_OFFSET = 0;
+	static const int NORMAL_OFFSET = 3;
+	static const int UV_OFFSET = 6;
+
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+
+	// number of vertices stored in the mesh
+	unsigned int GetVertexCount() const
+	{
+		return(static_cast<unsigned int>(vertices.size() / FLOATS_PER_VERTEX));
+	}
+
+	// add a vertex and return its index
+	unsigned int AddVertex(
+		float x, float y, float z,
+		float nx, float ny, float nz,
+		float u, float v)
+	{
+		unsigned int index = GetVertexCount();
+		vertices.push_back(x);
+		vertices.push_back(y);
+		vertices.push_back(z);
+		vertices.push_back(nx);
+		vertices.push_back(ny);
+		vertices.push_back(nz);
+		vertices.push_back(u);
+		vertices.push_back(v);
+		return(index);
+	}
+
+	// add a triangle from three vertex indices
+	void AddTriangle(unsigned int a, unsigned int b, unsigned int c)
+	{
+		indices.push_back(a);
+		indices.push_back(b);
+		indices.push_back(c);
+	}
+};
+
+/***********************************************************
+ *  BAKED_VERTEX
+ *
+ *  Vertex of a static object with the lighting that does
+ *  not depend on the view baked into it.  The ambient light
+ *  is kept apart because the shader still multiplies it by
+ *  the object's color or texture.
+ ***********************************************************/
+struct BAKED_VERTEX
+{
+	float position[3];
+	float normal[3];
+	float uv[2];
+	float ambient[3];
+	float diffuse[3];
+	// how much of each shadowed light reaches the vertex,
+	// for the specular highlights drawn live
+	uint8_t visibility[4];
+};
@@ -0,0 +1,277 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.cpp
+// ============
+// generate the basic shapes as CPU side mesh data at any tessellation
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshGenerator.h"
+
+#include <cmath>
+
+// declaration of the global variables and defines
+namespace
+{
+	const float PI = 3.14159265358979f;
+}
+
+/***********************************************************
+ *  GeneratePlane()
+ *
+ *  This function is used for generating a flat plane on the
+ *  XZ axes, split into a grid of the passed in subdivisions.
+ ***********************************************************/
+void MeshGenerator::GeneratePlane(MESH_DATA& mesh, int subdivisions)
+{
+	if (subdivisions < 1)
+	{
+		subdivisions = 1;
+	}
+
+	unsigned int firstVertex = mesh.GetVertexCount();
+	int rowLength = subdivisions + 1;
+
+	for (int j = 0; j <= subdivisions; j++)
+	{
+		for (int i = 0; i <= subdivisions; i++)
+		{
+			float u = static_cast<float>(i) / subdivisions;
+			float v = static_cast<float>(j) / subdivisions;
+			mesh.AddVertex(
+				-1.0f + (2.0f * u), 0.0f, -1.0f + (2.0f * v),
+				0.0f, 1.0f, 0.0f,
+				u, v);
+		}
+	}
+
+	for (int j = 0; j < subdivisions; j++)
+	{
+		for (int i = 0; i < subdivisions; i++)
+		{
+			unsigned int a = firstVertex + (j * rowLength) + i;
+			unsigned int b = a + 1;
+			unsigned int c = a + rowLength;
+			unsigned int d = c + 1;
+
+			// counter clockwise when seen from above
+			mesh.AddTriangle(a, c, b);
+			mesh.AddTriangle(b, c, d);
+		}
+	}
+}
+
+/***********************************************************
+ *  GenerateBox()
+ *
+ *  This function is used for generating a unit cube around
+ *  the origin, with separate vertices for each face so the
+ *  normals stay flat.
+ ***********************************************************/
+void MeshGenerator::GenerateBox(MESH_DATA& mesh)
+{
+	// normal, then the two face axes where U x V = normal
+	const float faces[6][9] =
+	{
+		{  1.0f,  0.0f,  0.0f,   0.0f, 0.0f, -1.0f,   0.0f, 1.0f,  0.0f },
+		{ -1.0f,  0.0f,  0.0f,   0.0f, 0.0f,  1.0f,   0.0f, 1.0f,  0.0f },
+		{  0.0f,  1.0f,  0.0f,   1.0f, 0.0f,  0.0f,   0.0f, 0.0f, -1.0f },
+		{  0.0f, -1.0f,  0.0f,   1.0f, 0.0f,  0.0f,   0.0f, 0.0f,  1.0f },
+		{  0.0f,  0.0f,  1.0f,   1.0f, 0.0f,  0.0f,   0.0f, 1.0f,  0.0f },
+		{  0.0f,  0.0f, -1.0f,  -1.0f, 0.0f,  0.0f,   0.0f, 1.0f,  0.0f }
+	};
+	const float corners[4][2] =
+	{
+		{ -1.0f, -1.0f }, { 1.0f, -1.0f }, { 1.0f, 1.0f }, { -1.0f, 1.0f }
+	};
+
+	for (int f = 0; f < 6; f++)
+	{
+		const float* n = &faces[f][0];
+		const float* u = &faces[f][3];
+		const float* v = &faces[f][6];
+		unsigned int firstVertex = mesh.GetVertexCount();
+
+		for (int c = 0; c < 4; c++)
+		{
+			float su = corners[c][0] * 0.5f;
+			float sv = corners[c][1] * 0.5f;
+			mesh.AddVertex(
+				(n[0] * 0.5f) + (u[0] * su) + (v[0] * sv),
+				(n[1] * 0.5f) + (u[1] * su) + (v[1] * sv),
+				(n[2] * 0.5f) + (u[2] * su) + (v[2] * sv),
+				n[0], n[1], n[2],
+				su + 0.5f, sv + 0.5f);
+		}
+
+		mesh.AddTriangle(firstVertex, firstVertex + 1, firstVertex + 2);
+		mesh.AddTriangle(firstVertex, firstVertex + 2, firstVertex + 3);
+	}
+}
+
+/***********************************************************
+ *  GenerateSphere()
+ *
+ *  This function is used for generating a sphere of radius
+ *  1 from rings of latitude and longitude.
+ ***********************************************************/
+void MeshGenerator::GenerateSphere(MESH_DATA& mesh, int stacks, int slices)
+{
+	if (stacks < 2)
+	{
+		stacks = 2;
+	}
+	if (slices < 3)
+	{
+		slices = 3;
+	}
+
+	unsigned int firstVertex = mesh.GetVertexCount();
+	int rowLength = slices + 1;
+
+	for (int i = 0; i <= stacks; i++)
+	{
+		float phi = PI * i / stacks;
+		float y = std::cos(phi);
+		float ringRadius = std::sin(phi);
+
+		for (int j = 0; j <= slices; j++)
+		{
+			float theta = 2.0f * PI * j / slices;
+			float x = ringRadius * std::cos(theta);
+			float z = ringRadius * std::sin(theta);
+
+			// the position is also the normal of a unit sphere
+			mesh.AddVertex(
+				x, y, z,
+				x, y, z,
+				static_cast<float>(j) / slices,
+				1.0f - (static_cast<float>(i) / stacks));
+		}
+	}
+
+	for (int i = 0; i < stacks; i++)
+	{
+		for (int j = 0; j < slices; j++)
+		{
+			unsigned int a = firstVertex + (i * rowLength) + j;
+			unsigned int b = a + 1;
+			unsigned int c = a + rowLength;
+			unsigned int d = c + 1;
+
+			// the triangles touching the poles would be degenerate
+			if (i != 0)
+			{
+				mesh.AddTriangle(a, b, c);
+			}
+			if (i != (stacks - 1))
+			{
+				mesh.AddTriangle(b, d, c);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GenerateCylinder()
+ *
+ *  This function is used for generating a cylinder standing
+ *  on the origin with a bottom radius of 1.  A top radius
+ *  below 1 gives a tapered cylinder and 0 gives a cone.
+ ***********************************************************/
+void MeshGenerator::GenerateCylinder(
+	MESH_DATA& mesh,
+	int slices,
+	int stacks,
+	float topRadius,
+	bool bCaps)
+{
+	if (slices < 3)
+	{
+		slices = 3;
+	}
+	if (stacks < 1)
+	{
+		stacks = 1;
+	}
+
+	unsigned int firstVertex = mesh.GetVertexCount();
+	int rowLength = slices + 1;
+
+	// the side normal leans up by the slope of the side
+	float slope = 1.0f - topRadius;
+	float normalScale = 1.0f / std::sqrt(1.0f + (slope * slope));
+
+	for (int i = 0; i <= stacks; i++)
+	{
+		float y = static_cast<float>(i) / stacks;
+		float ringRadius = 1.0f + ((topRadius - 1.0f) * y);
+
+		for (int j = 0; j <= slices; j++)
+		{
+			float theta = 2.0f * PI * j / slices;
+			float c = std::cos(theta);
+			float s = std::sin(theta);
+
+			mesh.AddVertex(
+				ringRadius * c, y, ringRadius * s,
+				c * normalScale, slope * normalScale, s * normalScale,
+				static_cast<float>(j) / slices, y);
+		}
+	}
+
+	for (int i = 0; i < stacks; i++)
+	{
+		for (int j = 0; j < slices; j++)
+		{
+			unsigned int a = firstVertex + (i * rowLength) + j;
+			unsigned int b = a + 1;
+			unsigned int c = a + rowLength;
+			unsigned int d = c + 1;
+
+			mesh.AddTriangle(a, c, b);
+			// the top ring of a cone is a single point
+			if ((topRadius > 0.0f) || (i != (stacks - 1)))
+			{
+				mesh.AddTriangle(b, c, d);
+			}
+		}
+	}
+
+	if (bCaps == false)
+	{
+		return;
+	}
+
+	// bottom cap facing down
+	unsigned int center = mesh.AddVertex(0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.5f, 0.5f);
+	for (int j = 0; j <= slices; j++)
+	{
+		float theta = 2.0f * PI * j / slices;
+		float c = std::cos(theta);
+		float s = std::sin(theta);
+		mesh.AddVertex(c, 0.0f, s, 0.0f, -1.0f, 0.0f, 0.5f + (0.5f * c), 0.5f + (0.5f * s));
+	}
+	for (int j = 0; j < slices; j++)
+	{
+		mesh.AddTriangle(center, center + 1 + j, center + 2 + j);
+	}
+
+	// top cap facing up, a cone has none
+	if (topRadius > 0.0f)
+	{
+		center = mesh.AddVertex(0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.5f, 0.5f);
+		for (int j = 0; j <= slices; j++)
+		{
+			float theta = 2.0f * PI * j / slices;
+			float c = std::cos(theta);
+			float s = std::sin(theta);
+			mesh.AddVertex(
+				topRadius * c, 1.0f, topRadius * s,
+				0.0f, 1.0f, 0.0f,
+				0.5f + (0.5f * c), 0.5f + (0.5f * s));
+		}
+		for (int j = 0; j < slices; j++)
+		{
+			mesh.AddTriangle(center, center + 2 + j, center + 1 + j);
+		}
+	}
+}
@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.h
+// ============
+// generate the basic shapes as CPU side mesh data at any tessellation
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+/***********************************************************
+ *  MeshGenerator
+ *
+ *  These functions generate the basic shapes with the same
+ *  local placement as the ShapeMeshes versions - the plane
+ *  spans -1 to 1 on X and Z, the box is a unit cube around
+ *  the origin, the sphere has radius 1, and the cylinders
+ *  and cone have radius 1 and stand from Y 0 to Y 1.
+ ***********************************************************/
+namespace MeshGenerator
+{
+	// generate a flat plane facing up
+	void GeneratePlane(MESH_DATA& mesh, int subdivisions);
+	// generate a box with one set of vertices per face
+	void GenerateBox(MESH_DATA& mesh);
+	// generate a UV sphere
+	void GenerateSphere(MESH_DATA& mesh, int stacks, int slices);
+	// generate a cylinder, tapered cylinder or cone depending on
+	// the radius at the top
+	void GenerateCylinder(
+		MESH_DATA& mesh,
+		int slices,
+		int stacks,
+		float topRadius,
+		bool bCaps);
+}
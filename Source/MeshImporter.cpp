@@ -0,0 +1,2095 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshimporter.cpp
+// ============
+// import OBJ and glTF meshes on all cores into indexed mesh data
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshImporter.h"
+#include "FileMapping.h"
+#include "Logger.h"
+#include "ResourceTracker.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+// declaration of the global variables and defines
+namespace
+{
+	// an OBJ corner value that is counted back from the last
+	// value read, stored as a 31 bit signed number relative to
+	// the start of its chunk
+	const uint32_t RELATIVE_INDEX = 0x80000000u;
+	// an OBJ corner without a texture coordinate or normal
+	const uint32_t MISSING_INDEX = 0x7fffffffu;
+
+	// "glTF", and the types of the chunks of a binary glTF file
+	const uint32_t GLB_MAGIC = 0x46546c67;
+	const uint32_t GLB_CHUNK_JSON = 0x4e4f534a;
+	const uint32_t GLB_CHUNK_BIN = 0x004e4942;
+	const size_t GLB_HEADER_BYTES = 12;
+	const size_t GLB_CHUNK_HEADER_BYTES = 8;
+
+	// component types of glTF accessors
+	const int GLTF_BYTE = 5120;
+	const int GLTF_UNSIGNED_BYTE = 5121;
+	const int GLTF_SHORT = 5122;
+	const int GLTF_UNSIGNED_SHORT = 5123;
+	const int GLTF_UNSIGNED_INT = 5125;
+	const int GLTF_FLOAT = 5126;
+	// primitive mode of triangle lists, the only one imported
+	const int GLTF_TRIANGLES = 4;
+
+	// deepest nesting of JSON values and of glTF nodes
+	const int MAX_NESTING = 64;
+	// smallest hash table a weld starts with
+	const size_t MIN_WELD_SLOTS = 1024;
+
+	const int FLOATS_PER_VERTEX = MESH_DATA::FLOATS_PER_VERTEX;
+
+	/***********************************************************
+	 *  JSON_VALUE
+	 *
+	 *  A value of a JSON document.  The members of an object
+	 *  are kept in the elements, with their names in the same
+	 *  order.
+	 ***********************************************************/
+	struct JSON_VALUE
+	{
+		enum TYPE
+		{
+			JSON_NULL,
+			JSON_BOOL,
+			JSON_NUMBER,
+			JSON_STRING,
+			JSON_ARRAY,
+			JSON_OBJECT
+		};
+
+		TYPE type;
+		bool bValue;
+		double number;
+		std::string text;
+		std::vector<JSON_VALUE> elements;
+		std::vector<std::string> names;
+
+		JSON_VALUE()
+		{
+			type = JSON_NULL;
+			bValue = false;
+			number = 0.0;
+		}
+
+		// get a member of an object, NULL when it is missing
+		const JSON_VALUE* Find(const char* name) const
+		{
+			if (type != JSON_OBJECT)
+			{
+				return(NULL);
+			}
+			for (size_t i = 0; i < names.size(); i++)
+			{
+				if (names[i] == name)
+				{
+					return(&elements[i]);
+				}
+			}
+			return(NULL);
+		}
+
+		// get an element of an array, NULL when it is missing
+		const JSON_VALUE* At(int index) const
+		{
+			if ((type != JSON_ARRAY) || (index < 0) || (index >= static_cast<int>(elements.size())))
+			{
+				return(NULL);
+			}
+			return(&elements[index]);
+		}
+
+		// get a number member, or the default when it is missing
+		double GetNumber(const char* name, double defaultValue) const
+		{
+			const JSON_VALUE* pValue = Find(name);
+			return(((NULL != pValue) && (pValue->type == JSON_NUMBER)) ? pValue->number : defaultValue);
+		}
+
+		// get a number member as an index, -1 when it is missing
+		int GetIndex(const char* name) const
+		{
+			double value = GetNumber(name, -1.0);
+			return(((value >= 0.0) && (value < 2147483647.0)) ? static_cast<int>(value) : -1);
+		}
+
+		// get the value as an index, -1 when it is not one
+		int AsIndex() const
+		{
+			bool bIndex = (type == JSON_NUMBER) && (number >= 0.0) && (number < 2147483647.0);
+			return((bIndex == true) ? static_cast<int>(number) : -1);
+		}
+
+		// get a number member as a count or a byte size, 0 when
+		// it is missing - false when it is negative, not whole,
+		// or too large to be held exactly
+		bool GetSize(const char* name, size_t& size) const
+		{
+			size = 0;
+			double value = GetNumber(name, 0.0);
+			double largest = std::min(9007199254740992.0, static_cast<double>(SIZE_MAX));
+			if ((value >= 0.0) && (value <= largest) && (value == std::floor(value)))
+			{
+				size = static_cast<size_t>(value);
+				return(true);
+			}
+			return(false);
+		}
+	};
+
+	/***********************************************************
+	 *  IsSpace()
+	 *
+	 *  Check for a space inside of a line.
+	 ***********************************************************/
+	inline bool IsSpace(char character)
+	{
+		return((character == ' ') || (character == '\t') || (character == '\r'));
+	}
+
+	/***********************************************************
+	 *  SkipSpaces()
+	 *
+	 *  Move past the spaces inside of a line.
+	 ***********************************************************/
+	inline void SkipSpaces(const char*& p, const char* end)
+	{
+		while ((p < end) && (IsSpace(*p) == true))
+		{
+			p++;
+		}
+	}
+
+	/***********************************************************
+	 *  ParseNumber()
+	 *
+	 *  Read a decimal number with an optional fraction and
+	 *  exponent, without the locale the C library would use.
+	 *  The first 19 digits are kept exactly, which is more
+	 *  than a double holds.
+	 ***********************************************************/
+	bool ParseNumber(const char*& p, const char* end, double& value)
+	{
+		// powers of ten that a double holds exactly
+		static const double POWERS_OF_TEN[] =
+		{
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+		const char* start = p;
+		bool bNegative = false;
+		if ((p < end) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+
+		uint64_t mantissa = 0;
+		int digits = 0;
+		int exponent = 0;
+		bool bDigits = false;
+		while ((p < end) && (*p >= '0') && (*p <= '9'))
+		{
+			if (digits < 19)
+			{
+				mantissa = (mantissa * 10) + static_cast<uint64_t>(*p - '0');
+				digits += (mantissa > 0) ? 1 : 0;
+			}
+			else
+			{
+				exponent++;
+			}
+			bDigits = true;
+			p++;
+		}
+		if ((p < end) && (*p == '.'))
+		{
+			p++;
+			while ((p < end) && (*p >= '0') && (*p <= '9'))
+			{
+				if (digits < 19)
+				{
+					mantissa = (mantissa * 10) + static_cast<uint64_t>(*p - '0');
+					digits += (mantissa > 0) ? 1 : 0;
+					exponent--;
+				}
+				bDigits = true;
+				p++;
+			}
+		}
+		if (bDigits == false)
+		{
+			p = start;
+			return(false);
+		}
+
+		if ((p < end) && ((*p == 'e') || (*p == 'E')))
+		{
+			const char* exponentStart = p;
+			p++;
+			bool bNegativeExponent = false;
+			if ((p < end) && ((*p == '-') || (*p == '+')))
+			{
+				bNegativeExponent = (*p == '-');
+				p++;
+			}
+			if ((p >= end) || (*p < '0') || (*p > '9'))
+			{
+				// an 'e' without digits is not part of the number
+				p = exponentStart;
+			}
+			else
+			{
+				int written = 0;
+				while ((p < end) && (*p >= '0') && (*p <= '9'))
+				{
+					written = std::min((written * 10) + (*p - '0'), 100000);
+					p++;
+				}
+				exponent += (bNegativeExponent == true) ? -written : written;
+			}
+		}
+
+		value = static_cast<double>(mantissa);
+		if ((exponent >= 0) && (exponent <= 22))
+		{
+			value *= POWERS_OF_TEN[exponent];
+		}
+		else if ((exponent < 0) && (exponent >= -22))
+		{
+			value /= POWERS_OF_TEN[-exponent];
+		}
+		else if (mantissa != 0)
+		{
+			value *= std::pow(10.0, static_cast<double>(exponent));
+		}
+		if (bNegative == true)
+		{
+			value = -value;
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ParseInteger()
+	 *
+	 *  Read a whole number with an optional sign.
+	 ***********************************************************/
+	bool ParseInteger(const char*& p, const char* end, long long& value)
+	{
+		bool bNegative = false;
+		if ((p < end) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+		if ((p >= end) || (*p < '0') || (*p > '9'))
+		{
+			return(false);
+		}
+
+		value = 0;
+		while ((p < end) && (*p >= '0') && (*p <= '9'))
+		{
+			value = std::min((value * 10) + (*p - '0'), 0x7fffffffffffLL);
+			p++;
+		}
+		if (bNegative == true)
+		{
+			value = -value;
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  StoreOBJIndex()
+	 *
+	 *  Store the number of an OBJ value a corner refers to.
+	 *  Numbers from 1 count from the start of the file and are
+	 *  stored from 0, negative numbers count back from the
+	 *  last value read and are stored relative to the start
+	 *  of the chunk, for when the chunk's place is known.
+	 ***********************************************************/
+	bool StoreOBJIndex(long long value, size_t chunkCount, uint32_t& index)
+	{
+		if ((value > 0) && (value <= static_cast<long long>(MISSING_INDEX)))
+		{
+			index = static_cast<uint32_t>(value - 1);
+			return(true);
+		}
+		long long relative = static_cast<long long>(chunkCount) + value;
+		if ((value < 0) && (relative > -0x40000000LL) && (relative < 0x40000000LL))
+		{
+			index = RELATIVE_INDEX | (static_cast<uint32_t>(relative) & ~RELATIVE_INDEX);
+			return(true);
+		}
+
+		return(false);
+	}
+
+	/***********************************************************
+	 *  ResolveOBJIndex()
+	 *
+	 *  Turn a stored corner value into the number of the value
+	 *  in the whole file, returns false when it is outside of
+	 *  the values read.
+	 ***********************************************************/
+	inline bool ResolveOBJIndex(uint32_t index, size_t chunkFirst, size_t count, size_t& resolved)
+	{
+		if ((index & RELATIVE_INDEX) != 0)
+		{
+			// sign extend the 31 bit value
+			long long relative = static_cast<int32_t>(index << 1) >> 1;
+			long long absolute = static_cast<long long>(chunkFirst) + relative;
+			if (absolute < 0)
+			{
+				return(false);
+			}
+			resolved = static_cast<size_t>(absolute);
+		}
+		else
+		{
+			resolved = index;
+		}
+
+		return(resolved < count);
+	}
+
+	/***********************************************************
+	 *  HashVertex()
+	 *
+	 *  Hash the bits of the floats of a vertex.
+	 ***********************************************************/
+	inline size_t HashVertex(const float* pVertex)
+	{
+		uint64_t hash = 0;
+		for (int i = 0; i < FLOATS_PER_VERTEX; i++)
+		{
+			uint32_t bits;
+			memcpy(&bits, &pVertex[i], sizeof(bits));
+			hash = (hash ^ bits) * 0x9e3779b97f4a7c15ULL;
+			hash ^= hash >> 32;
+		}
+		return(static_cast<size_t>(hash));
+	}
+
+	/***********************************************************
+	 *  ResizeWeldTable()
+	 *
+	 *  Make the hash table of a weld hold at least the passed
+	 *  in number of vertices at half of its slots, and put the
+	 *  vertices welded so far into it again.
+	 ***********************************************************/
+	void ResizeWeldTable(std::vector<unsigned int>& table, const std::vector<float>& vertices, size_t vertexCount)
+	{
+		size_t slotCount = MIN_WELD_SLOTS;
+		while (slotCount < (vertexCount * 2))
+		{
+			slotCount *= 2;
+		}
+		if (slotCount <= table.size())
+		{
+			return;
+		}
+
+		table.assign(slotCount, 0);
+		size_t mask = slotCount - 1;
+		size_t welded = vertices.size() / FLOATS_PER_VERTEX;
+		for (size_t i = 0; i < welded; i++)
+		{
+			size_t slot = HashVertex(&vertices[i * FLOATS_PER_VERTEX]) & mask;
+			while (table[slot] != 0)
+			{
+				slot = (slot + 1) & mask;
+			}
+			table[slot] = static_cast<unsigned int>(i + 1);
+		}
+	}
+
+	/***********************************************************
+	 *  WeldVertex()
+	 *
+	 *  Find a vertex with the same values in the hash table of
+	 *  a weld, or add the vertex when there is none, and
+	 *  return its number.  The table holds the vertex numbers
+	 *  plus one in open addressed slots, 0 for an empty slot.
+	 ***********************************************************/
+	unsigned int WeldVertex(std::vector<unsigned int>& table, std::vector<float>& vertices, const float* pVertex)
+	{
+		// adding 0 turns -0 into 0, so the bits of equal
+		// values are equal
+		float key[FLOATS_PER_VERTEX];
+		for (int i = 0; i < FLOATS_PER_VERTEX; i++)
+		{
+			key[i] = pVertex[i] + 0.0f;
+		}
+
+		size_t welded = vertices.size() / FLOATS_PER_VERTEX;
+		if (((welded + 1) * 2) > table.size())
+		{
+			ResizeWeldTable(table, vertices, welded + 1);
+		}
+
+		size_t mask = table.size() - 1;
+		size_t slot = HashVertex(key) & mask;
+		while (table[slot] != 0)
+		{
+			unsigned int index = table[slot] - 1;
+			if (memcmp(&vertices[index * FLOATS_PER_VERTEX], key, sizeof(key)) == 0)
+			{
+				return(index);
+			}
+			slot = (slot + 1) & mask;
+		}
+
+		vertices.insert(vertices.end(), key, key + FLOATS_PER_VERTEX);
+		table[slot] = static_cast<unsigned int>(welded + 1);
+		return(static_cast<unsigned int>(welded));
+	}
+
+	/***********************************************************
+	 *  ParseJSONString()
+	 *
+	 *  Read a JSON string after its opening quote, turning the
+	 *  escapes into UTF-8.
+	 ***********************************************************/
+	bool ParseJSONString(const char*& p, const char* end, std::string& text)
+	{
+		text.clear();
+		while (p < end)
+		{
+			char character = *p++;
+			if (character == '"')
+			{
+				return(true);
+			}
+			if (character != '\\')
+			{
+				text.push_back(character);
+				continue;
+			}
+			if (p >= end)
+			{
+				return(false);
+			}
+
+			character = *p++;
+			switch (character)
+			{
+			case 'b': text.push_back('\b'); break;
+			case 'f': text.push_back('\f'); break;
+			case 'n': text.push_back('\n'); break;
+			case 'r': text.push_back('\r'); break;
+			case 't': text.push_back('\t'); break;
+			case 'u':
+			{
+				if ((end - p) < 4)
+				{
+					return(false);
+				}
+				unsigned int code = 0;
+				for (int i = 0; i < 4; i++)
+				{
+					char digit = *p++;
+					code <<= 4;
+					if ((digit >= '0') && (digit <= '9'))
+					{
+						code |= static_cast<unsigned int>(digit - '0');
+					}
+					else if ((digit >= 'a') && (digit <= 'f'))
+					{
+						code |= static_cast<unsigned int>(digit - 'a' + 10);
+					}
+					else if ((digit >= 'A') && (digit <= 'F'))
+					{
+						code |= static_cast<unsigned int>(digit - 'A' + 10);
+					}
+					else
+					{
+						return(false);
+					}
+				}
+				if (code < 0x80)
+				{
+					text.push_back(static_cast<char>(code));
+				}
+				else if (code < 0x800)
+				{
+					text.push_back(static_cast<char>(0xc0 | (code >> 6)));
+					text.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+				}
+				else
+				{
+					text.push_back(static_cast<char>(0xe0 | (code >> 12)));
+					text.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+					text.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+				}
+				break;
+			}
+			default:
+				text.push_back(character);
+				break;
+			}
+		}
+
+		return(false);
+	}
+
+	/***********************************************************
+	 *  SkipJSONSpaces()
+	 *
+	 *  Move past the white space between JSON values.
+	 ***********************************************************/
+	inline void SkipJSONSpaces(const char*& p, const char* end)
+	{
+		while ((p < end) && ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')))
+		{
+			p++;
+		}
+	}
+
+	/***********************************************************
+	 *  ParseJSONValue()
+	 *
+	 *  Read a JSON value and everything nested in it.
+	 ***********************************************************/
+	bool ParseJSONValue(const char*& p, const char* end, JSON_VALUE& value, int depth)
+	{
+		SkipJSONSpaces(p, end);
+		if ((p >= end) || (depth > MAX_NESTING))
+		{
+			return(false);
+		}
+
+		if (*p == '{')
+		{
+			value.type = JSON_VALUE::JSON_OBJECT;
+			p++;
+			SkipJSONSpaces(p, end);
+			if ((p < end) && (*p == '}'))
+			{
+				p++;
+				return(true);
+			}
+			for (;;)
+			{
+				SkipJSONSpaces(p, end);
+				if ((p >= end) || (*p != '"'))
+				{
+					return(false);
+				}
+				p++;
+				value.names.push_back(std::string());
+				if (ParseJSONString(p, end, value.names.back()) == false)
+				{
+					return(false);
+				}
+				SkipJSONSpaces(p, end);
+				if ((p >= end) || (*p != ':'))
+				{
+					return(false);
+				}
+				p++;
+				value.elements.push_back(JSON_VALUE());
+				if (ParseJSONValue(p, end, value.elements.back(), depth + 1) == false)
+				{
+					return(false);
+				}
+				SkipJSONSpaces(p, end);
+				if ((p < end) && (*p == ','))
+				{
+					p++;
+					continue;
+				}
+				if ((p < end) && (*p == '}'))
+				{
+					p++;
+					return(true);
+				}
+				return(false);
+			}
+		}
+		if (*p == '[')
+		{
+			value.type = JSON_VALUE::JSON_ARRAY;
+			p++;
+			SkipJSONSpaces(p, end);
+			if ((p < end) && (*p == ']'))
+			{
+				p++;
+				return(true);
+			}
+			for (;;)
+			{
+				value.elements.push_back(JSON_VALUE());
+				if (ParseJSONValue(p, end, value.elements.back(), depth + 1) == false)
+				{
+					return(false);
+				}
+				SkipJSONSpaces(p, end);
+				if ((p < end) && (*p == ','))
+				{
+					p++;
+					continue;
+				}
+				if ((p < end) && (*p == ']'))
+				{
+					p++;
+					return(true);
+				}
+				return(false);
+			}
+		}
+		if (*p == '"')
+		{
+			value.type = JSON_VALUE::JSON_STRING;
+			p++;
+			return(ParseJSONString(p, end, value.text));
+		}
+		if (((end - p) >= 4) && (strncmp(p, "true", 4) == 0))
+		{
+			value.type = JSON_VALUE::JSON_BOOL;
+			value.bValue = true;
+			p += 4;
+			return(true);
+		}
+		if (((end - p) >= 5) && (strncmp(p, "false", 5) == 0))
+		{
+			value.type = JSON_VALUE::JSON_BOOL;
+			p += 5;
+			return(true);
+		}
+		if (((end - p) >= 4) && (strncmp(p, "null", 4) == 0))
+		{
+			p += 4;
+			return(true);
+		}
+
+		value.type = JSON_VALUE::JSON_NUMBER;
+		return(ParseNumber(p, end, value.number));
+	}
+
+	/***********************************************************
+	 *  DecodeURI()
+	 *
+	 *  Turn the %XX escapes of a relative URI into characters.
+	 ***********************************************************/
+	std::string DecodeURI(const std::string& uri)
+	{
+		std::string decoded;
+		for (size_t i = 0; i < uri.size(); i++)
+		{
+			if ((uri[i] == '%') && ((i + 2) < uri.size()))
+			{
+				char digits[3] = { uri[i + 1], uri[i + 2], '\0' };
+				char* pEnd = NULL;
+				long code = strtol(digits, &pEnd, 16);
+				if (pEnd == (digits + 2))
+				{
+					decoded.push_back(static_cast<char>(code));
+					i += 2;
+					continue;
+				}
+			}
+			decoded.push_back(uri[i]);
+		}
+		return(decoded);
+	}
+
+	/***********************************************************
+	 *  GetComponentSize()
+	 *
+	 *  Get the size of a glTF component type in bytes, 0 for
+	 *  an unknown type.
+	 ***********************************************************/
+	size_t GetComponentSize(int componentType)
+	{
+		switch (componentType)
+		{
+		case GLTF_BYTE:
+		case GLTF_UNSIGNED_BYTE:
+			return(1);
+		case GLTF_SHORT:
+		case GLTF_UNSIGNED_SHORT:
+			return(2);
+		case GLTF_UNSIGNED_INT:
+		case GLTF_FLOAT:
+			return(4);
+		default:
+			return(0);
+		}
+	}
+
+	/***********************************************************
+	 *  GetComponentCount()
+	 *
+	 *  Get the number of components of a glTF accessor type,
+	 *  0 for the matrix types, which meshes do not use.
+	 ***********************************************************/
+	int GetComponentCount(const std::string& type)
+	{
+		if (type == "SCALAR")
+		{
+			return(1);
+		}
+		if (type == "VEC2")
+		{
+			return(2);
+		}
+		if (type == "VEC3")
+		{
+			return(3);
+		}
+		if (type == "VEC4")
+		{
+			return(4);
+		}
+		return(0);
+	}
+
+	/***********************************************************
+	 *  GetNodeMatrix()
+	 *
+	 *  Get the transform of a glTF node relative to its
+	 *  parent, from its matrix or from its translation,
+	 *  rotation and scale.
+	 ***********************************************************/
+	glm::mat4 GetNodeMatrix(const JSON_VALUE& node)
+	{
+		glm::mat4 matrix(1.0f);
+
+		const JSON_VALUE* pMatrix = node.Find("matrix");
+		if ((NULL != pMatrix) && (pMatrix->type == JSON_VALUE::JSON_ARRAY) && (pMatrix->elements.size() == 16))
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				matrix[i / 4][i % 4] = static_cast<float>(pMatrix->elements[i].number);
+			}
+			return(matrix);
+		}
+
+		glm::vec3 translation(0.0f);
+		glm::vec4 rotation(0.0f, 0.0f, 0.0f, 1.0f);
+		glm::vec3 scale(1.0f);
+		const JSON_VALUE* pTranslation = node.Find("translation");
+		const JSON_VALUE* pRotation = node.Find("rotation");
+		const JSON_VALUE* pScale = node.Find("scale");
+		if ((NULL != pTranslation) && (pTranslation->elements.size() == 3))
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				translation[i] = static_cast<float>(pTranslation->elements[i].number);
+			}
+		}
+		if ((NULL != pRotation) && (pRotation->elements.size() == 4))
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				rotation[i] = static_cast<float>(pRotation->elements[i].number);
+			}
+		}
+		if ((NULL != pScale) && (pScale->elements.size() == 3))
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				scale[i] = static_cast<float>(pScale->elements[i].number);
+			}
+		}
+
+		// rotation matrix of the unit quaternion x, y, z, w
+		float x = rotation.x;
+		float y = rotation.y;
+		float z = rotation.z;
+		float w = rotation.w;
+		glm::mat4 rotationMatrix(1.0f);
+		rotationMatrix[0][0] = 1.0f - (2.0f * ((y * y) + (z * z)));
+		rotationMatrix[0][1] = 2.0f * ((x * y) + (z * w));
+		rotationMatrix[0][2] = 2.0f * ((x * z) - (y * w));
+		rotationMatrix[1][0] = 2.0f * ((x * y) - (z * w));
+		rotationMatrix[1][1] = 1.0f - (2.0f * ((x * x) + (z * z)));
+		rotationMatrix[1][2] = 2.0f * ((y * z) + (x * w));
+		rotationMatrix[2][0] = 2.0f * ((x * z) + (y * w));
+		rotationMatrix[2][1] = 2.0f * ((y * z) - (x * w));
+		rotationMatrix[2][2] = 1.0f - (2.0f * ((x * x) + (y * y)));
+
+		for (int column = 0; column < 3; column++)
+		{
+			matrix[column] = rotationMatrix[column] * scale[column];
+		}
+		matrix[3] = glm::vec4(translation, 1.0f);
+
+		return(matrix);
+	}
+}
+
+/***********************************************************
+ *  MeshImporter()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshImporter::MeshImporter()
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_threadCount = 1;
+	m_nextChunk = 0;
+	m_pMesh = NULL;
+}
+
+/***********************************************************
+ *  ~MeshImporter()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshImporter::~MeshImporter()
+{
+	UnmapBuffers();
+}
+
+/***********************************************************
+ *  Import()
+ *
+ *  This method is used for importing a mesh file into the
+ *  passed in mesh.  The file is mapped, its chunks are read
+ *  and welded on all of the threads, and the chunks are
+ *  welded into the mesh.  The mesh is left empty when the
+ *  file cannot be read.
+ ***********************************************************/
+bool MeshImporter::Import(const char* filename, MESH_DATA& mesh, int threadCount)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	memset(&m_stats, 0, sizeof(m_stats));
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	if (threadCount <= 0)
+	{
+		threadCount = static_cast<int>(std::thread::hardware_concurrency());
+	}
+	m_threadCount = std::max(threadCount, 1);
+	m_stats.threadCount = m_threadCount;
+
+	FILE_FORMAT format;
+	if (GetFileFormat(filename, format) == false)
+	{
+		LOG_ERROR("Mesh file is not an .obj, .gltf or .glb file:" << filename);
+		return(false);
+	}
+
+	size_t fileSize = 0;
+	const unsigned char* pFile = FileMapping::MapFile(filename, fileSize);
+	if (NULL == pFile)
+	{
+		LOG_ERROR("Could not map mesh file:" << filename);
+		return(false);
+	}
+	ResourceTracker::Track(ResourceTracker::RESOURCE_CPU, reinterpret_cast<uintptr_t>(pFile),
+		fileSize, ResourceTracker::CATEGORY_ASSET_STAGING, "mesh import mapping");
+	m_stats.fileBytes = fileSize;
+
+	bool bImported = false;
+	if (format == FORMAT_OBJ)
+	{
+		bImported = ImportOBJ(pFile, fileSize);
+	}
+	else
+	{
+		bImported = ImportGLTF(filename, pFile, fileSize, format);
+	}
+	std::chrono::steady_clock::time_point chunksDone = std::chrono::steady_clock::now();
+
+	if (bImported == true)
+	{
+		MergeChunks(mesh);
+	}
+
+	ResourceTracker::Release(ResourceTracker::RESOURCE_CPU, reinterpret_cast<uintptr_t>(pFile));
+	FileMapping::UnmapFile(pFile, fileSize);
+	UnmapBuffers();
+
+	// the chunk data is only needed during the import
+	std::vector<IMPORT_CHUNK>().swap(m_chunks);
+	std::vector<float>().swap(m_positions);
+	std::vector<float>().swap(m_uvs);
+	std::vector<float>().swap(m_normals);
+	std::vector<float>().swap(m_positionNormals);
+	std::vector<GLTF_PRIMITIVE>().swap(m_primitives);
+	m_pMesh = NULL;
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	m_stats.chunkTime = std::chrono::duration<double, std::milli>(chunksDone - start).count();
+	m_stats.mergeTime = std::chrono::duration<double, std::milli>(end - chunksDone).count();
+	m_stats.totalTime = std::chrono::duration<double, std::milli>(end - start).count();
+
+	if ((bImported == true) && (mesh.indices.empty() == true))
+	{
+		LOG_ERROR("Mesh file has no triangles:" << filename);
+		bImported = false;
+	}
+
+	return(bImported);
+}
+
+/***********************************************************
+ *  GetFileFormat()
+ *
+ *  This method is used for picking the format of a mesh
+ *  file from the extension of its name, in any case.
+ ***********************************************************/
+bool MeshImporter::GetFileFormat(const char* filename, FILE_FORMAT& format)
+{
+	std::string name = filename;
+	size_t dot = name.find_last_of('.');
+	if (dot == std::string::npos)
+	{
+		return(false);
+	}
+
+	std::string extension = name.substr(dot + 1);
+	for (size_t i = 0; i < extension.size(); i++)
+	{
+		if ((extension[i] >= 'A') && (extension[i] <= 'Z'))
+		{
+			extension[i] = static_cast<char>(extension[i] - 'A' + 'a');
+		}
+	}
+
+	if (extension == "obj")
+	{
+		format = FORMAT_OBJ;
+		return(true);
+	}
+	if (extension == "gltf")
+	{
+		format = FORMAT_GLTF;
+		return(true);
+	}
+	if (extension == "glb")
+	{
+		format = FORMAT_GLB;
+		return(true);
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  RunStep()
+ *
+ *  This method is used for running a step of the import on
+ *  several threads.  The threads take their chunks from the
+ *  shared counter, and the calling thread works as well.
+ ***********************************************************/
+void MeshImporter::RunStep(void (MeshImporter::*pStep)())
+{
+	int threadCount = std::max(1, std::min(m_threadCount, static_cast<int>(m_chunks.size())));
+
+	m_nextChunk = 0;
+	std::vector<std::thread> workers;
+	for (int i = 1; i < threadCount; i++)
+	{
+		workers.push_back(std::thread(pStep, this));
+	}
+	(this->*pStep)();
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+}
+
+/***********************************************************
+ *  ImportOBJ()
+ *
+ *  This method is used for reading an OBJ file.  The file
+ *  is split into chunks of whole lines that are read on all
+ *  of the threads.  The values of the chunks are then put
+ *  together in file order, so the corners can be resolved,
+ *  and the corners of each chunk are welded into vertices.
+ ***********************************************************/
+bool MeshImporter::ImportOBJ(const unsigned char* pFile, size_t fileSize)
+{
+	const char* pText = reinterpret_cast<const char*>(pFile);
+	const char* pTextEnd = pText + fileSize;
+
+	// a chunk ends after the line break that follows its size
+	const char* pBegin = pText;
+	while (pBegin < pTextEnd)
+	{
+		const char* pEnd = pTextEnd;
+		if (static_cast<size_t>(pTextEnd - pBegin) > OBJ_CHUNK_BYTES)
+		{
+			const char* pSearch = pBegin + OBJ_CHUNK_BYTES;
+			const void* pBreak = memchr(pSearch, '\n', static_cast<size_t>(pTextEnd - pSearch));
+			pEnd = (NULL != pBreak) ? (static_cast<const char*>(pBreak) + 1) : pTextEnd;
+		}
+
+		IMPORT_CHUNK chunk = IMPORT_CHUNK();
+		chunk.pBegin = pBegin;
+		chunk.pEnd = pEnd;
+		chunk.primitive = -1;
+		m_chunks.push_back(chunk);
+		pBegin = pEnd;
+	}
+
+	RunStep(&MeshImporter::ParseOBJChunks);
+
+	// number the values of the chunks in file order
+	size_t positionCount = 0;
+	size_t uvCount = 0;
+	size_t normalCount = 0;
+	bool bMissingNormals = false;
+	for (size_t i = 0; i < m_chunks.size(); i++)
+	{
+		IMPORT_CHUNK& chunk = m_chunks[i];
+		if (chunk.bFailed == true)
+		{
+			LOG_ERROR("OBJ file has a line with bad values, near byte " << (chunk.pBegin - pText));
+			return(false);
+		}
+		chunk.firstPosition = positionCount;
+		chunk.firstUV = uvCount;
+		chunk.firstNormal = normalCount;
+		positionCount += chunk.positions.size() / 3;
+		uvCount += chunk.uvs.size() / 2;
+		normalCount += chunk.normals.size() / 3;
+		bMissingNormals = (bMissingNormals == true) || (chunk.bMissingNormals == true);
+		m_stats.triangleCount += chunk.corners.size() / 9;
+	}
+	if (positionCount > MISSING_INDEX)
+	{
+		LOG_ERROR("OBJ file has too many positions:" << positionCount);
+		return(false);
+	}
+
+	m_positions.reserve(positionCount * 3);
+	m_uvs.reserve(uvCount * 2);
+	m_normals.reserve(normalCount * 3);
+	for (size_t i = 0; i < m_chunks.size(); i++)
+	{
+		IMPORT_CHUNK& chunk = m_chunks[i];
+		m_positions.insert(m_positions.end(), chunk.positions.begin(), chunk.positions.end());
+		m_uvs.insert(m_uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+		m_normals.insert(m_normals.end(), chunk.normals.begin(), chunk.normals.end());
+		std::vector<float>().swap(chunk.positions);
+		std::vector<float>().swap(chunk.uvs);
+		std::vector<float>().swap(chunk.normals);
+	}
+
+	if ((bMissingNormals == true) && (CalculatePositionNormals() == false))
+	{
+		LOG_ERROR("OBJ file has a face with a position that is not defined");
+		return(false);
+	}
+
+	RunStep(&MeshImporter::WeldOBJChunks);
+
+	for (size_t i = 0; i < m_chunks.size(); i++)
+	{
+		if (m_chunks[i].bFailed == true)
+		{
+			LOG_ERROR("OBJ file has a face with a value that is not defined");
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ParseOBJChunks()
+ *
+ *  This method is used for reading the lines of chunks
+ *  until none are left.  Each chunk keeps its own values,
+ *  since its place in the file order is only known once
+ *  the chunks before it are read.
+ ***********************************************************/
+void MeshImporter::ParseOBJChunks()
+{
+	for (;;)
+	{
+		size_t chunkIndex = m_nextChunk.fetch_add(1);
+		if (chunkIndex >= m_chunks.size())
+		{
+			return;
+		}
+
+		IMPORT_CHUNK& chunk = m_chunks[chunkIndex];
+
+		// the corners are about half of the bytes of a file
+		// with normals and texture coordinates
+		size_t chunkBytes = static_cast<size_t>(chunk.pEnd - chunk.pBegin);
+		chunk.corners.reserve(chunkBytes / 16);
+
+		const char* p = chunk.pBegin;
+		while ((p < chunk.pEnd) && (chunk.bFailed == false))
+		{
+			const void* pBreak = memchr(p, '\n', static_cast<size_t>(chunk.pEnd - p));
+			const char* pLineEnd = (NULL != pBreak) ? static_cast<const char*>(pBreak) : chunk.pEnd;
+			chunk.bFailed = (ParseOBJLine(chunk, p, pLineEnd) == false);
+			p = pLineEnd + 1;
+		}
+	}
+}
+
+/***********************************************************
+ *  ParseOBJLine()
+ *
+ *  This method is used for reading the positions, texture
+ *  coordinates, normals and faces of an OBJ file.  Faces
+ *  with more than three corners are split into a fan of
+ *  triangles, and all other lines are skipped.
+ ***********************************************************/
+bool MeshImporter::ParseOBJLine(IMPORT_CHUNK& chunk, const char* p, const char* end)
+{
+	SkipSpaces(p, end);
+	if ((end - p) < 2)
+	{
+		return(true);
+	}
+
+	// "v x y z", "vt u v" and "vn x y z" - values after the
+	// ones used, like vertex colors, are skipped
+	if (p[0] == 'v')
+	{
+		std::vector<float>* pValues = NULL;
+		int valueCount = 0;
+		int requiredCount = 0;
+		if (IsSpace(p[1]) == true)
+		{
+			pValues = &chunk.positions;
+			valueCount = 3;
+			requiredCount = 3;
+			p += 1;
+		}
+		else if ((p[1] == 't') && ((end - p) > 2) && (IsSpace(p[2]) == true))
+		{
+			pValues = &chunk.uvs;
+			valueCount = 2;
+			requiredCount = 1;
+			p += 2;
+		}
+		else if ((p[1] == 'n') && ((end - p) > 2) && (IsSpace(p[2]) == true))
+		{
+			pValues = &chunk.normals;
+			valueCount = 3;
+			requiredCount = 3;
+			p += 2;
+		}
+		else
+		{
+			return(true);
+		}
+
+		for (int i = 0; i < valueCount; i++)
+		{
+			SkipSpaces(p, end);
+			double value = 0.0;
+			if (ParseNumber(p, end, value) == false)
+			{
+				if (i < requiredCount)
+				{
+					return(false);
+				}
+				value = 0.0;
+			}
+			pValues->push_back(static_cast<float>(value));
+		}
+		return(true);
+	}
+
+	// "f p/t/n p/t/n p/t/n ...", where the texture coordinate
+	// and the normal can be left out
+	if ((p[0] == 'f') && (IsSpace(p[1]) == true))
+	{
+		p += 1;
+		uint32_t first[3];
+		uint32_t previous[3];
+		int cornerCount = 0;
+		for (;;)
+		{
+			SkipSpaces(p, end);
+			if (p >= end)
+			{
+				break;
+			}
+
+			uint32_t corner[3] = { MISSING_INDEX, MISSING_INDEX, MISSING_INDEX };
+			size_t counts[3] =
+			{
+				chunk.positions.size() / 3,
+				chunk.uvs.size() / 2,
+				chunk.normals.size() / 3
+			};
+			for (int part = 0; part < 3; part++)
+			{
+				if (part > 0)
+				{
+					if ((p >= end) || (*p != '/'))
+					{
+						break;
+					}
+					p++;
+					// "p//n" leaves out the texture coordinate
+					if ((p < end) && (*p == '/'))
+					{
+						continue;
+					}
+				}
+				long long value = 0;
+				if ((ParseInteger(p, end, value) == false) ||
+					(StoreOBJIndex(value, counts[part], corner[part]) == false))
+				{
+					return(false);
+				}
+			}
+			if ((p < end) && (IsSpace(*p) == false))
+			{
+				return(false);
+			}
+			chunk.bMissingNormals = (chunk.bMissingNormals == true) || (corner[2] == MISSING_INDEX);
+
+			if (cornerCount == 0)
+			{
+				memcpy(first, corner, sizeof(first));
+			}
+			else if (cornerCount >= 2)
+			{
+				chunk.corners.insert(chunk.corners.end(), first, first + 3);
+				chunk.corners.insert(chunk.corners.end(), previous, previous + 3);
+				chunk.corners.insert(chunk.corners.end(), corner, corner + 3);
+			}
+			memcpy(previous, corner, sizeof(previous));
+			cornerCount++;
+		}
+		return(true);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CalculatePositionNormals()
+ *
+ *  This method is used for the smooth normals of the OBJ
+ *  positions, for the corners that have no normal.  The
+ *  normals of the faces around a position are added up,
+ *  weighted by the area of the faces.
+ ***********************************************************/
+bool MeshImporter::CalculatePositionNormals()
+{
+	size_t positionCount = m_positions.size() / 3;
+	std::vector<glm::vec3> normals(positionCount, glm::vec3(0.0f));
+
+	for (size_t i = 0; i < m_chunks.size(); i++)
+	{
+		const IMPORT_CHUNK& chunk = m_chunks[i];
+		for (size_t corner = 0; corner < chunk.corners.size(); corner += 9)
+		{
+			size_t indices[3];
+			for (int k = 0; k < 3; k++)
+			{
+				if (ResolveOBJIndex(chunk.corners[corner + (k * 3)], chunk.firstPosition, positionCount, indices[k]) == false)
+				{
+					return(false);
+				}
+			}
+
+			glm::vec3 a(m_positions[indices[0] * 3], m_positions[indices[0] * 3 + 1], m_positions[indices[0] * 3 + 2]);
+			glm::vec3 b(m_positions[indices[1] * 3], m_positions[indices[1] * 3 + 1], m_positions[indices[1] * 3 + 2]);
+			glm::vec3 c(m_positions[indices[2] * 3], m_positions[indices[2] * 3 + 1], m_positions[indices[2] * 3 + 2]);
+			glm::vec3 faceNormal = glm::cross(b - a, c - a);
+			for (int k = 0; k < 3; k++)
+			{
+				normals[indices[k]] += faceNormal;
+			}
+		}
+	}
+
+	m_positionNormals.resize(positionCount * 3);
+	for (size_t i = 0; i < positionCount; i++)
+	{
+		float length = glm::length(normals[i]);
+		glm::vec3 normal = (length > 0.0f) ? (normals[i] / length) : glm::vec3(0.0f, 1.0f, 0.0f);
+		m_positionNormals[i * 3] = normal.x;
+		m_positionNormals[i * 3 + 1] = normal.y;
+		m_positionNormals[i * 3 + 2] = normal.z;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WeldOBJChunks()
+ *
+ *  This method is used for turning the corners of chunks
+ *  into vertices until no chunks are left.  The corners
+ *  with the same values share a vertex of the chunk.
+ ***********************************************************/
+void MeshImporter::WeldOBJChunks()
+{
+	size_t positionCount = m_positions.size() / 3;
+	size_t uvCount = m_uvs.size() / 2;
+	size_t normalCount = m_normals.size() / 3;
+
+	for (;;)
+	{
+		size_t chunkIndex = m_nextChunk.fetch_add(1);
+		if (chunkIndex >= m_chunks.size())
+		{
+			return;
+		}
+
+		IMPORT_CHUNK& chunk = m_chunks[chunkIndex];
+		size_t cornerCount = chunk.corners.size() / 3;
+		chunk.indices.reserve(cornerCount);
+		std::vector<unsigned int> table;
+		// a closed mesh has about one vertex for every six
+		// triangle corners
+		ResizeWeldTable(table, chunk.vertices, cornerCount / 4);
+
+		for (size_t i = 0; i < cornerCount; i++)
+		{
+			const uint32_t* pCorner = &chunk.corners[i * 3];
+			float vertex[FLOATS_PER_VERTEX];
+			size_t index = 0;
+
+			if (ResolveOBJIndex(pCorner[0], chunk.firstPosition, positionCount, index) == false)
+			{
+				chunk.bFailed = true;
+				break;
+			}
+			const float* pPosition = &m_positions[index * 3];
+			const float* pNormal = NULL;
+			if (pCorner[2] == MISSING_INDEX)
+			{
+				pNormal = &m_positionNormals[index * 3];
+			}
+			else if (ResolveOBJIndex(pCorner[2], chunk.firstNormal, normalCount, index) == true)
+			{
+				pNormal = &m_normals[index * 3];
+			}
+			else
+			{
+				chunk.bFailed = true;
+				break;
+			}
+
+			vertex[MESH_DATA::POSITION_OFFSET] = pPosition[0];
+			vertex[MESH_DATA::POSITION_OFFSET + 1] = pPosition[1];
+			vertex[MESH_DATA::POSITION_OFFSET + 2] = pPosition[2];
+			vertex[MESH_DATA::NORMAL_OFFSET] = pNormal[0];
+			vertex[MESH_DATA::NORMAL_OFFSET + 1] = pNormal[1];
+			vertex[MESH_DATA::NORMAL_OFFSET + 2] = pNormal[2];
+			vertex[MESH_DATA::UV_OFFSET] = 0.0f;
+			vertex[MESH_DATA::UV_OFFSET + 1] = 0.0f;
+			if (pCorner[1] != MISSING_INDEX)
+			{
+				if (ResolveOBJIndex(pCorner[1], chunk.firstUV, uvCount, index) == false)
+				{
+					chunk.bFailed = true;
+					break;
+				}
+				vertex[MESH_DATA::UV_OFFSET] = m_uvs[index * 2];
+				vertex[MESH_DATA::UV_OFFSET + 1] = m_uvs[index * 2 + 1];
+			}
+
+			chunk.indices.push_back(WeldVertex(table, chunk.vertices, vertex));
+		}
+
+		std::vector<uint32_t>().swap(chunk.corners);
+	}
+}
+
+/***********************************************************
+ *  ImportGLTF()
+ *
+ *  This method is used for reading a glTF file, either the
+ *  JSON with separate buffer files or a binary file with
+ *  the JSON and the first buffer in it.  The buffer files
+ *  are mapped, the nodes of the default scene are walked
+ *  to place the primitives, and the triangles of the
+ *  primitives are split into chunks that are read and
+ *  welded on all of the threads.
+ ***********************************************************/
+bool MeshImporter::ImportGLTF(const std::string& filename, const unsigned char* pFile, size_t fileSize, FILE_FORMAT format)
+{
+	const char* pJSON = reinterpret_cast<const char*>(pFile);
+	size_t jsonBytes = fileSize;
+	const unsigned char* pBinary = NULL;
+	size_t binaryBytes = 0;
+
+	// a binary file is a header and a JSON chunk, followed
+	// by the chunk of the first buffer
+	if (format == FORMAT_GLB)
+	{
+		uint32_t header[3] = { 0, 0, 0 };
+		uint32_t chunkHeader[2] = { 0, 0 };
+		if (fileSize >= (GLB_HEADER_BYTES + GLB_CHUNK_HEADER_BYTES))
+		{
+			memcpy(header, pFile, sizeof(header));
+			memcpy(chunkHeader, pFile + GLB_HEADER_BYTES, sizeof(chunkHeader));
+		}
+		size_t jsonStart = GLB_HEADER_BYTES + GLB_CHUNK_HEADER_BYTES;
+		if ((header[0] != GLB_MAGIC) || (header[1] != 2) || (header[2] > fileSize) ||
+			(chunkHeader[1] != GLB_CHUNK_JSON) || (chunkHeader[0] > (fileSize - jsonStart)))
+		{
+			LOG_ERROR("Not a binary glTF 2.0 file:" << filename);
+			return(false);
+		}
+		pJSON = reinterpret_cast<const char*>(pFile + jsonStart);
+		jsonBytes = chunkHeader[0];
+
+		size_t binaryStart = jsonStart + jsonBytes;
+		if ((fileSize - binaryStart) >= GLB_CHUNK_HEADER_BYTES)
+		{
+			memcpy(chunkHeader, pFile + binaryStart, sizeof(chunkHeader));
+			if ((chunkHeader[1] == GLB_CHUNK_BIN) &&
+				(chunkHeader[0] <= (fileSize - binaryStart - GLB_CHUNK_HEADER_BYTES)))
+			{
+				pBinary = pFile + binaryStart + GLB_CHUNK_HEADER_BYTES;
+				binaryBytes = chunkHeader[0];
+			}
+		}
+	}
+
+	JSON_VALUE root;
+	const char* p = pJSON;
+	if ((ParseJSONValue(p, pJSON + jsonBytes, root, 0) == false) || (root.type != JSON_VALUE::JSON_OBJECT))
+	{
+		LOG_ERROR("glTF file has bad JSON:" << filename);
+		return(false);
+	}
+	const JSON_VALUE* pAsset = root.Find("asset");
+	const JSON_VALUE* pVersion = (NULL != pAsset) ? pAsset->Find("version") : NULL;
+	if ((NULL == pVersion) || (pVersion->type != JSON_VALUE::JSON_STRING) || (pVersion->text.compare(0, 2, "2.") != 0))
+	{
+		LOG_ERROR("Not a glTF 2.0 file:" << filename);
+		return(false);
+	}
+
+	// the buffers - the binary chunk, or files next to the
+	// glTF file
+	std::string directory;
+	size_t slash = filename.find_last_of("/\\");
+	if (slash != std::string::npos)
+	{
+		directory = filename.substr(0, slash + 1);
+	}
+	std::vector<const unsigned char*> bufferData;
+	std::vector<size_t> bufferBytes;
+	const JSON_VALUE* pBuffers = root.Find("buffers");
+	for (int i = 0; (NULL != pBuffers) && (i < static_cast<int>(pBuffers->elements.size())); i++)
+	{
+		const JSON_VALUE& buffer = pBuffers->elements[i];
+		const JSON_VALUE* pURI = buffer.Find("uri");
+		size_t byteLength = 0;
+		if (buffer.GetSize("byteLength", byteLength) == false)
+		{
+			LOG_ERROR("glTF buffer " << i << " has an invalid byteLength:" << filename);
+			return(false);
+		}
+		const unsigned char* pData = NULL;
+		size_t dataBytes = 0;
+
+		if ((NULL == pURI) || (pURI->type != JSON_VALUE::JSON_STRING))
+		{
+			if ((i == 0) && (NULL != pBinary))
+			{
+				pData = pBinary;
+				dataBytes = binaryBytes;
+			}
+		}
+		else if (pURI->text.compare(0, 5, "data:") == 0)
+		{
+			LOG_ERROR("glTF buffers embedded as data URIs are not supported, export the buffers to files:" << filename);
+			return(false);
+		}
+		else
+		{
+			std::string bufferFilename = directory + DecodeURI(pURI->text);
+			pData = FileMapping::MapFile(bufferFilename.c_str(), dataBytes);
+			if (NULL == pData)
+			{
+				LOG_ERROR("Could not map glTF buffer file:" << bufferFilename);
+				return(false);
+			}
+			ResourceTracker::Track(ResourceTracker::RESOURCE_CPU, reinterpret_cast<uintptr_t>(pData),
+				dataBytes, ResourceTracker::CATEGORY_ASSET_STAGING, "mesh import mapping");
+			m_bufferMappings.push_back(pData);
+			m_bufferMappingSizes.push_back(dataBytes);
+			m_stats.fileBytes += dataBytes;
+		}
+
+		if ((NULL == pData) || (byteLength > dataBytes))
+		{
+			LOG_ERROR("glTF buffer " << i << " is missing or too short:" << filename);
+			return(false);
+		}
+		bufferData.push_back(pData);
+		bufferBytes.push_back(byteLength);
+	}
+
+	// the accessors, resolved to the memory of their buffer
+	// views - an accessor that does not fit into its buffer
+	// is left without data
+	const JSON_VALUE* pViews = root.Find("bufferViews");
+	const JSON_VALUE* pAccessors = root.Find("accessors");
+	std::vector<GLTF_ACCESSOR> accessors;
+	for (int i = 0; (NULL != pAccessors) && (i < static_cast<int>(pAccessors->elements.size())); i++)
+	{
+		const JSON_VALUE& source = pAccessors->elements[i];
+		GLTF_ACCESSOR accessor = GLTF_ACCESSOR();
+		bool bSizes = source.GetSize("count", accessor.count);
+		accessor.componentType = source.GetIndex("componentType");
+		const JSON_VALUE* pType = source.Find("type");
+		accessor.components = (NULL != pType) ? GetComponentCount(pType->text) : 0;
+		const JSON_VALUE* pNormalized = source.Find("normalized");
+		accessor.bNormalized = (NULL != pNormalized) && (pNormalized->bValue == true);
+
+		const JSON_VALUE* pView = (NULL != pViews) ? pViews->At(source.GetIndex("bufferView")) : NULL;
+		int buffer = (NULL != pView) ? pView->GetIndex("buffer") : -1;
+		size_t elementBytes = GetComponentSize(accessor.componentType) * accessor.components;
+		if ((NULL != pView) && (buffer >= 0) && (buffer < static_cast<int>(bufferData.size())) &&
+			(elementBytes > 0) && (bSizes == true) && (accessor.count > 0) && (NULL == source.Find("sparse")))
+		{
+			size_t viewOffset = 0;
+			size_t viewBytes = 0;
+			size_t offset = 0;
+			bSizes = (pView->GetSize("byteOffset", viewOffset) == true) &&
+				(pView->GetSize("byteLength", viewBytes) == true) &&
+				(source.GetSize("byteOffset", offset) == true) &&
+				(pView->GetSize("byteStride", accessor.stride) == true);
+			if (accessor.stride == 0)
+			{
+				accessor.stride = elementBytes;
+			}
+
+			// the last element has to end inside of the view -
+			// checked by dividing, so a crafted count or stride
+			// cannot wrap the end around
+			if ((bSizes == true) && (viewOffset <= bufferBytes[buffer]) &&
+				(viewBytes <= (bufferBytes[buffer] - viewOffset)) && (accessor.stride >= elementBytes) &&
+				(offset <= viewBytes) && (elementBytes <= (viewBytes - offset)) &&
+				(accessor.count <= (((viewBytes - offset - elementBytes) / accessor.stride) + 1)))
+			{
+				accessor.pData = bufferData[buffer] + viewOffset + offset;
+			}
+		}
+		accessors.push_back(accessor);
+	}
+
+	// the nodes of the default scene, or every mesh once when
+	// the file has no scenes
+	std::vector<std::pair<int, glm::mat4> > placements;
+	const JSON_VALUE* pNodes = root.Find("nodes");
+	const JSON_VALUE* pMeshes = root.Find("meshes");
+	const JSON_VALUE* pScenes = root.Find("scenes");
+	const JSON_VALUE* pScene = (NULL != pScenes) ? pScenes->At(std::max(root.GetIndex("scene"), 0)) : NULL;
+	if ((NULL != pScene) && (NULL != pNodes))
+	{
+		// walk the node tree without recursion, with the
+		// transform of the parent of each node
+		std::vector<std::pair<int, glm::mat4> > stack;
+		std::vector<int> depths;
+		const JSON_VALUE* pRootNodes = pScene->Find("nodes");
+		for (size_t i = 0; (NULL != pRootNodes) && (i < pRootNodes->elements.size()); i++)
+		{
+			stack.push_back(std::make_pair(pRootNodes->elements[i].AsIndex(), glm::mat4(1.0f)));
+			depths.push_back(0);
+		}
+		while (stack.empty() == false)
+		{
+			std::pair<int, glm::mat4> entry = stack.back();
+			int depth = depths.back();
+			stack.pop_back();
+			depths.pop_back();
+
+			const JSON_VALUE* pNode = pNodes->At(entry.first);
+			if ((NULL == pNode) || (depth > MAX_NESTING))
+			{
+				continue;
+			}
+			glm::mat4 model = entry.second * GetNodeMatrix(*pNode);
+			if (pNode->GetIndex("mesh") >= 0)
+			{
+				placements.push_back(std::make_pair(pNode->GetIndex("mesh"), model));
+			}
+			const JSON_VALUE* pChildren = pNode->Find("children");
+			for (size_t i = 0; (NULL != pChildren) && (i < pChildren->elements.size()); i++)
+			{
+				stack.push_back(std::make_pair(pChildren->elements[i].AsIndex(), model));
+				depths.push_back(depth + 1);
+			}
+		}
+	}
+	else if (NULL != pMeshes)
+	{
+		for (size_t i = 0; i < pMeshes->elements.size(); i++)
+		{
+			placements.push_back(std::make_pair(static_cast<int>(i), glm::mat4(1.0f)));
+		}
+	}
+
+	// the triangle list primitives of the placed meshes
+	int skippedPrimitives = 0;
+	for (size_t i = 0; i < placements.size(); i++)
+	{
+		const JSON_VALUE* pMesh = (NULL != pMeshes) ? pMeshes->At(placements[i].first) : NULL;
+		const JSON_VALUE* pPrimitives = (NULL != pMesh) ? pMesh->Find("primitives") : NULL;
+		for (size_t j = 0; (NULL != pPrimitives) && (j < pPrimitives->elements.size()); j++)
+		{
+			const JSON_VALUE& source = pPrimitives->elements[j];
+			const JSON_VALUE* pAttributes = source.Find("attributes");
+			if ((NULL == pAttributes) || (source.GetNumber("mode", GLTF_TRIANGLES) != GLTF_TRIANGLES))
+			{
+				skippedPrimitives++;
+				continue;
+			}
+
+			GLTF_ACCESSOR missing = GLTF_ACCESSOR();
+			int positionIndex = pAttributes->GetIndex("POSITION");
+			int normalIndex = pAttributes->GetIndex("NORMAL");
+			int uvIndex = pAttributes->GetIndex("TEXCOORD_0");
+			int indexIndex = source.GetIndex("indices");
+			GLTF_PRIMITIVE primitive;
+			primitive.positions = (positionIndex < static_cast<int>(accessors.size()) && (positionIndex >= 0)) ? accessors[positionIndex] : missing;
+			primitive.normals = (normalIndex < static_cast<int>(accessors.size()) && (normalIndex >= 0)) ? accessors[normalIndex] : missing;
+			primitive.uvs = (uvIndex < static_cast<int>(accessors.size()) && (uvIndex >= 0)) ? accessors[uvIndex] : missing;
+			primitive.indices = (indexIndex < static_cast<int>(accessors.size()) && (indexIndex >= 0)) ? accessors[indexIndex] : missing;
+
+			// the attributes the importer reads - float
+			// positions and normals, and float or normalized
+			// integer texture coordinates
+			bool bValid = (NULL != primitive.positions.pData) && (primitive.positions.components == 3) &&
+				(primitive.positions.componentType == GLTF_FLOAT);
+			bValid = (bValid == true) && ((normalIndex < 0) ||
+				((NULL != primitive.normals.pData) && (primitive.normals.components == 3) &&
+				(primitive.normals.componentType == GLTF_FLOAT) &&
+				(primitive.normals.count >= primitive.positions.count)));
+			bValid = (bValid == true) && ((uvIndex < 0) ||
+				((NULL != primitive.uvs.pData) && (primitive.uvs.components == 2) &&
+				(primitive.uvs.count >= primitive.positions.count)));
+			bValid = (bValid == true) && ((indexIndex < 0) ||
+				((NULL != primitive.indices.pData) && (primitive.indices.components == 1) &&
+				((primitive.indices.componentType == GLTF_UNSIGNED_BYTE) ||
+				(primitive.indices.componentType == GLTF_UNSIGNED_SHORT) ||
+				(primitive.indices.componentType == GLTF_UNSIGNED_INT))));
+			if (bValid == false)
+			{
+				skippedPrimitives++;
+				continue;
+			}
+
+			primitive.model = placements[i].second;
+			glm::mat3 linear = glm::mat3(primitive.model);
+			primitive.normalMatrix = glm::transpose(glm::inverse(linear));
+			primitive.bMirrored = (glm::determinant(linear) < 0.0f);
+			primitive.triangleCount = ((indexIndex >= 0) ? primitive.indices.count : primitive.positions.count) / 3;
+			m_primitives.push_back(primitive);
+			m_stats.triangleCount += primitive.triangleCount;
+
+			for (size_t first = 0; first < primitive.triangleCount; first += GLTF_CHUNK_TRIANGLES)
+			{
+				IMPORT_CHUNK chunk = IMPORT_CHUNK();
+				chunk.primitive = static_cast<int>(m_primitives.size()) - 1;
+				chunk.firstTriangle = first;
+				chunk.endTriangle = std::min(first + GLTF_CHUNK_TRIANGLES, primitive.triangleCount);
+				m_chunks.push_back(chunk);
+			}
+		}
+	}
+	if (skippedPrimitives > 0)
+	{
+		LOG_WARNING("Skipped " << skippedPrimitives << " glTF primitives that are not triangle lists or have unsupported attributes:" << filename);
+	}
+
+	RunStep(&MeshImporter::WeldGLTFChunks);
+
+	for (size_t i = 0; i < m_chunks.size(); i++)
+	{
+		if (m_chunks[i].bFailed == true)
+		{
+			LOG_ERROR("glTF file has an index outside of its vertices:" << filename);
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReadAccessor()
+ *
+ *  This method is used for reading an element of a glTF
+ *  accessor as floats.  Normalized integers are scaled to
+ *  0 to 1, or -1 to 1 for the signed types.
+ ***********************************************************/
+void MeshImporter::ReadAccessor(const GLTF_ACCESSOR& accessor, size_t element, float* pValues)
+{
+	const unsigned char* pElement = accessor.pData + (element * accessor.stride);
+	for (int i = 0; i < accessor.components; i++)
+	{
+		float value = 0.0f;
+		switch (accessor.componentType)
+		{
+		case GLTF_FLOAT:
+			memcpy(&value, pElement + (i * 4), sizeof(value));
+			break;
+		case GLTF_BYTE:
+		{
+			int8_t component = static_cast<int8_t>(pElement[i]);
+			value = (accessor.bNormalized == true) ? std::max(component / 127.0f, -1.0f) : component;
+			break;
+		}
+		case GLTF_UNSIGNED_BYTE:
+			value = (accessor.bNormalized == true) ? (pElement[i] / 255.0f) : pElement[i];
+			break;
+		case GLTF_SHORT:
+		{
+			int16_t component;
+			memcpy(&component, pElement + (i * 2), sizeof(component));
+			value = (accessor.bNormalized == true) ? std::max(component / 32767.0f, -1.0f) : component;
+			break;
+		}
+		case GLTF_UNSIGNED_SHORT:
+		{
+			uint16_t component;
+			memcpy(&component, pElement + (i * 2), sizeof(component));
+			value = (accessor.bNormalized == true) ? (component / 65535.0f) : component;
+			break;
+		}
+		case GLTF_UNSIGNED_INT:
+		{
+			uint32_t component;
+			memcpy(&component, pElement + (i * 4), sizeof(component));
+			value = static_cast<float>(component);
+			break;
+		}
+		default:
+			break;
+		}
+		pValues[i] = value;
+	}
+}
+
+/***********************************************************
+ *  ReadIndex()
+ *
+ *  This method is used for reading an element of a glTF
+ *  index accessor.
+ ***********************************************************/
+size_t MeshImporter::ReadIndex(const GLTF_ACCESSOR& accessor, size_t element)
+{
+	const unsigned char* pElement = accessor.pData + (element * accessor.stride);
+	if (accessor.componentType == GLTF_UNSIGNED_BYTE)
+	{
+		return(pElement[0]);
+	}
+	if (accessor.componentType == GLTF_UNSIGNED_SHORT)
+	{
+		uint16_t index;
+		memcpy(&index, pElement, sizeof(index));
+		return(index);
+	}
+
+	uint32_t index;
+	memcpy(&index, pElement, sizeof(index));
+	return(index);
+}
+
+/***********************************************************
+ *  WeldGLTFChunks()
+ *
+ *  This method is used for reading the triangles of chunks
+ *  into vertices until no chunks are left.  The vertices
+ *  are moved into place by the transform of their node,
+ *  and the texture coordinates are turned to start at the
+ *  bottom, the way the textures are loaded.
+ ***********************************************************/
+void MeshImporter::WeldGLTFChunks()
+{
+	for (;;)
+	{
+		size_t chunkIndex = m_nextChunk.fetch_add(1);
+		if (chunkIndex >= m_chunks.size())
+		{
+			return;
+		}
+
+		IMPORT_CHUNK& chunk = m_chunks[chunkIndex];
+		const GLTF_PRIMITIVE& primitive = m_primitives[chunk.primitive];
+		size_t triangleCount = chunk.endTriangle - chunk.firstTriangle;
+		chunk.indices.reserve(triangleCount * 3);
+		std::vector<unsigned int> table;
+		// indexed primitives share most of their vertices
+		// between about six corners
+		ResizeWeldTable(table, chunk.vertices, (triangleCount * 3) / 4);
+
+		for (size_t triangle = chunk.firstTriangle; triangle < chunk.endTriangle; triangle++)
+		{
+			size_t corners[3];
+			for (int k = 0; k < 3; k++)
+			{
+				size_t element = (triangle * 3) + k;
+				corners[k] = (NULL != primitive.indices.pData) ? ReadIndex(primitive.indices, element) : element;
+			}
+			if ((corners[0] >= primitive.positions.count) || (corners[1] >= primitive.positions.count) ||
+				(corners[2] >= primitive.positions.count))
+			{
+				chunk.bFailed = true;
+				break;
+			}
+			if (primitive.bMirrored == true)
+			{
+				std::swap(corners[1], corners[2]);
+			}
+
+			float vertices[3][FLOATS_PER_VERTEX];
+			glm::vec3 positions[3];
+			for (int k = 0; k < 3; k++)
+			{
+				float values[3];
+				ReadAccessor(primitive.positions, corners[k], values);
+				positions[k] = glm::vec3(primitive.model * glm::vec4(values[0], values[1], values[2], 1.0f));
+			}
+
+			// a primitive without normals is flat shaded
+			glm::vec3 faceNormal = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+			float faceLength = glm::length(faceNormal);
+			faceNormal = (faceLength > 0.0f) ? (faceNormal / faceLength) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+			for (int k = 0; k < 3; k++)
+			{
+				float* pVertex = vertices[k];
+				glm::vec3 normal = faceNormal;
+				if (NULL != primitive.normals.pData)
+				{
+					float values[3];
+					ReadAccessor(primitive.normals, corners[k], values);
+					normal = primitive.normalMatrix * glm::vec3(values[0], values[1], values[2]);
+					float length = glm::length(normal);
+					normal = (length > 0.0f) ? (normal / length) : faceNormal;
+				}
+				float uv[2] = { 0.0f, 1.0f };
+				if (NULL != primitive.uvs.pData)
+				{
+					ReadAccessor(primitive.uvs, corners[k], uv);
+				}
+
+				pVertex[MESH_DATA::POSITION_OFFSET] = positions[k].x;
+				pVertex[MESH_DATA::POSITION_OFFSET + 1] = positions[k].y;
+				pVertex[MESH_DATA::POSITION_OFFSET + 2] = positions[k].z;
+				pVertex[MESH_DATA::NORMAL_OFFSET] = normal.x;
+				pVertex[MESH_DATA::NORMAL_OFFSET + 1] = normal.y;
+				pVertex[MESH_DATA::NORMAL_OFFSET + 2] = normal.z;
+				pVertex[MESH_DATA::UV_OFFSET] = uv[0];
+				pVertex[MESH_DATA::UV_OFFSET + 1] = 1.0f - uv[1];
+			}
+
+			for (int k = 0; k < 3; k++)
+			{
+				chunk.indices.push_back(WeldVertex(table, chunk.vertices, vertices[k]));
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  MergeChunks()
+ *
+ *  This method is used for welding the vertices of the
+ *  chunks into the mesh, in the order of the chunks, and
+ *  writing the indices of the chunks numbered after the
+ *  mesh on all of the threads.  Only the vertices a chunk
+ *  shares with the chunks before it are welded here, the
+ *  rest were welded in the chunks.
+ ***********************************************************/
+void MeshImporter::MergeChunks(MESH_DATA& mesh)
+{
+	size_t chunkVertices = 0;
+	size_t indexCount = 0;
+	for (size_t i = 0; i < m_chunks.size(); i++)
+	{
+		chunkVertices += m_chunks[i].vertices.size() / FLOATS_PER_VERTEX;
+		m_chunks[i].firstIndex = indexCount;
+		indexCount += m_chunks[i].indices.size();
+	}
+	m_stats.cornerCount = indexCount;
+
+	mesh.vertices.reserve(chunkVertices * FLOATS_PER_VERTEX);
+	std::vector<unsigned int> table;
+	ResizeWeldTable(table, mesh.vertices, chunkVertices);
+	for (size_t i = 0; i < m_chunks.size(); i++)
+	{
+		IMPORT_CHUNK& chunk = m_chunks[i];
+		size_t vertexCount = chunk.vertices.size() / FLOATS_PER_VERTEX;
+		chunk.remap.resize(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			chunk.remap[v] = WeldVertex(table, mesh.vertices, &chunk.vertices[v * FLOATS_PER_VERTEX]);
+		}
+		std::vector<float>().swap(chunk.vertices);
+	}
+	std::vector<float>(mesh.vertices).swap(mesh.vertices);
+	m_stats.vertexCount = mesh.GetVertexCount();
+
+	mesh.indices.resize(indexCount);
+	m_pMesh = &mesh;
+	RunStep(&MeshImporter::RemapChunks);
+}
+
+/***********************************************************
+ *  RemapChunks()
+ *
+ *  This method is used for writing the indices of chunks
+ *  into their range of the mesh until no chunks are left.
+ ***********************************************************/
+void MeshImporter::RemapChunks()
+{
+	for (;;)
+	{
+		size_t chunkIndex = m_nextChunk.fetch_add(1);
+		if (chunkIndex >= m_chunks.size())
+		{
+			return;
+		}
+
+		IMPORT_CHUNK& chunk = m_chunks[chunkIndex];
+		if (chunk.indices.empty() == true)
+		{
+			continue;
+		}
+		unsigned int* pIndices = &m_pMesh->indices[0] + chunk.firstIndex;
+		for (size_t i = 0; i < chunk.indices.size(); i++)
+		{
+			pIndices[i] = chunk.remap[chunk.indices[i]];
+		}
+	}
+}
+
+/***********************************************************
+ *  UnmapBuffers()
+ *
+ *  This method is used for unmapping the buffer files of a
+ *  glTF file.
+ ***********************************************************/
+void MeshImporter::UnmapBuffers()
+{
+	for (size_t i = 0; i < m_bufferMappings.size(); i++)
+	{
+		ResourceTracker::Release(ResourceTracker::RESOURCE_CPU, reinterpret_cast<uintptr_t>(m_bufferMappings[i]));
+		FileMapping::UnmapFile(m_bufferMappings[i], m_bufferMappingSizes[i]);
+	}
+	m_bufferMappings.clear();
+	m_bufferMappingSizes.clear();
+}
+
+/***********************************************************
+ *  FitToUnitBox()
+ *
+ *  This method is used for scaling an imported mesh to the
+ *  size of the basic box, so a scene object places it like
+ *  a box.  The scale is the same on every axis, so the
+ *  normals keep their direction.
+ ***********************************************************/
+void MeshImporter::FitToUnitBox(MESH_DATA& mesh)
+{
+	unsigned int vertexCount = mesh.GetVertexCount();
+	if (vertexCount == 0)
+	{
+		return;
+	}
+
+	glm::vec3 minimum(FLT_MAX);
+	glm::vec3 maximum(-FLT_MAX);
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		const float* pPosition = &mesh.vertices[(i * FLOATS_PER_VERTEX) + MESH_DATA::POSITION_OFFSET];
+		glm::vec3 position(pPosition[0], pPosition[1], pPosition[2]);
+		minimum = glm::min(minimum, position);
+		maximum = glm::max(maximum, position);
+	}
+
+	glm::vec3 extent = maximum - minimum;
+	float longest = std::max(extent.x, std::max(extent.y, extent.z));
+	float scale = (longest > 0.0f) ? (1.0f / longest) : 1.0f;
+	glm::vec3 base((minimum.x + maximum.x) * 0.5f, minimum.y, (minimum.z + maximum.z) * 0.5f);
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		float* pPosition = &mesh.vertices[(i * FLOATS_PER_VERTEX) + MESH_DATA::POSITION_OFFSET];
+		pPosition[0] = (pPosition[0] - base.x) * scale;
+		pPosition[1] = ((pPosition[1] - base.y) * scale) - 0.5f;
+		pPosition[2] = (pPosition[2] - base.z) * scale;
+	}
+}
+
+/***********************************************************
+ *  Benchmark()
+ *
+ *  This method is used for timing the import of a file
+ *  with a growing number of threads.  Each number of
+ *  threads is timed a few times and the fastest import
+ *  counts, so the file is in the page cache for all but
+ *  the first one.
+ ***********************************************************/
+bool MeshImporter::Benchmark(const char* filename)
+{
+	int coreCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	LOG_INFO("INFO: Mesh import benchmark of " << filename << ", " << coreCount << " cores");
+
+	double singleThreadTime = 0.0;
+	for (int threadCount = 1; ; threadCount = std::min(threadCount * 2, coreCount))
+	{
+		double fastest = 0.0;
+		IMPORT_STATS stats;
+		for (int run = 0; run < BENCHMARK_RUNS; run++)
+		{
+			MESH_DATA mesh;
+			MeshImporter importer;
+			if (importer.Import(filename, mesh, threadCount) == false)
+			{
+				return(false);
+			}
+			if ((run == 0) || (importer.GetStats().totalTime < fastest))
+			{
+				stats = importer.GetStats();
+				fastest = stats.totalTime;
+			}
+		}
+
+		if (threadCount == 1)
+		{
+			singleThreadTime = fastest;
+			LOG_INFO("INFO:   " << (stats.fileBytes / (1024.0 * 1024.0)) << " MB, "
+				<< stats.triangleCount << " triangles, " << stats.cornerCount << " corners welded into "
+				<< stats.vertexCount << " vertices");
+		}
+
+		double throughput = (stats.fileBytes / (1024.0 * 1024.0)) / (std::max(fastest, 0.001) / 1000.0);
+		LOG_INFO("INFO:   " << threadCount << " threads: " << fastest << " ms ("
+			<< stats.chunkTime << " ms chunks, " << stats.mergeTime << " ms merge), "
+			<< throughput << " MB/s, " << (singleThreadTime / std::max(fastest, 0.001)) << "x");
+
+		if (threadCount >= coreCount)
+		{
+			break;
+		}
+	}
+
+	return(true);
+}
@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshimporter.h
+// ============
+// import OBJ and glTF meshes on all cores into indexed mesh data
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  MeshImporter
+ *
+ *  This class reads a Wavefront OBJ file or a glTF 2.0 file
+ *  into an indexed triangle list in the layout of the mesh
+ *  library, so a model made in a modeling tool is drawn
+ *  like the generated meshes.  The file and the binary
+ *  buffers of a glTF file are memory mapped and read in
+ *  place.
+ *
+ *  The work is split into chunks that the threads take
+ *  from a shared counter - an OBJ file into ranges of whole
+ *  lines, a glTF file into ranges of the triangles of its
+ *  primitives.  Each chunk turns its triangle corners into
+ *  vertices and welds the equal ones through its own hash
+ *  table, and the chunks are then welded into one mesh in
+ *  their order, so the result does not depend on the
+ *  number of threads.
+ *
+ *  All of the groups of an OBJ file and all of the meshes
+ *  placed by the default scene of a glTF file are merged
+ *  into one mesh, without their materials.  Corners
+ *  without a normal get the smooth normal of their OBJ
+ *  position or the flat normal of their glTF triangle, and
+ *  corners without a texture coordinate get 0, 0.
+ ***********************************************************/
+class MeshImporter
+{
+public:
+	// bytes of an OBJ file parsed by a thread at a time
+	static const size_t OBJ_CHUNK_BYTES = 1024 * 1024;
+	// triangles of a glTF primitive read by a thread at a time
+	static const size_t GLTF_CHUNK_TRIANGLES = 32768;
+	// imports timed for each number of threads in the
+	// benchmark, the fastest one counts
+	static const int BENCHMARK_RUNS = 3;
+
+	// what the last import read and how long it took
+	struct IMPORT_STATS
+	{
+		// bytes of the file and of the buffers it refers to
+		size_t fileBytes;
+		size_t triangleCount;
+		// vertices before and after welding the equal ones
+		size_t cornerCount;
+		size_t vertexCount;
+		int threadCount;
+		// milliseconds for reading the corners and welding
+		// them in the chunks, for welding the chunks into one
+		// mesh, and for the whole import
+		double chunkTime;
+		double mergeTime;
+		double totalTime;
+	};
+
+	// constructor
+	MeshImporter();
+	// destructor
+	~MeshImporter();
+
+	// import an .obj, .gltf or .glb file into the passed in
+	// mesh, with one thread per core when 0 threads are
+	// passed in
+	bool Import(const char* filename, MESH_DATA& mesh, int threadCount = 0);
+	// what the last import read and how long it took
+	const IMPORT_STATS& GetStats() const { return(m_stats); }
+
+	// scale a mesh so its longest side is 1 and move it to
+	// stand on the bottom of the box of the basic box mesh,
+	// centered on X and Z
+	static void FitToUnitBox(MESH_DATA& mesh);
+	// time imports of a file with one thread, and with twice
+	// the threads of the last time up to one per core, and
+	// write the throughput in MB/s
+	static bool Benchmark(const char* filename);
+
+private:
+	// file formats the importer reads
+	enum FILE_FORMAT
+	{
+		FORMAT_OBJ,
+		FORMAT_GLTF,
+		FORMAT_GLB
+	};
+
+	// an accessor of a glTF file, resolved to the memory of
+	// its buffer
+	struct GLTF_ACCESSOR
+	{
+		const unsigned char* pData;
+		size_t count;
+		size_t stride;
+		int componentType;
+		int components;
+		bool bNormalized;
+	};
+
+	// a glTF primitive placed by a node of the scene, with
+	// the accessors of its attributes - the data pointers are
+	// NULL for missing attributes
+	struct GLTF_PRIMITIVE
+	{
+		GLTF_ACCESSOR positions;
+		GLTF_ACCESSOR normals;
+		GLTF_ACCESSOR uvs;
+		GLTF_ACCESSOR indices;
+		size_t triangleCount;
+		glm::mat4 model;
+		glm::mat3 normalMatrix;
+		// the transform mirrors the primitive, so its
+		// triangles are turned around to face outward again
+		bool bMirrored;
+	};
+
+	// a piece of the work done by one thread
+	struct IMPORT_CHUNK
+	{
+		// OBJ - the lines of the chunk
+		const char* pBegin;
+		const char* pEnd;
+		// glTF - the triangles of the chunk
+		int primitive;
+		size_t firstTriangle;
+		size_t endTriangle;
+
+		// OBJ - the values read from the lines, and the
+		// position, texture coordinate and normal number of
+		// every triangle corner
+		std::vector<float> positions;
+		std::vector<float> uvs;
+		std::vector<float> normals;
+		std::vector<uint32_t> corners;
+		// numbers of the first values of the chunk in the
+		// whole file
+		size_t firstPosition;
+		size_t firstUV;
+		size_t firstNormal;
+		// some triangle corner has no normal
+		bool bMissingNormals;
+
+		// the welded vertices and the triangles, numbered
+		// within the chunk until the chunks are merged
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		// number of each vertex in the mesh, and the first
+		// index of the chunk in the mesh
+		std::vector<unsigned int> remap;
+		size_t firstIndex;
+		// the chunk could not be read
+		bool bFailed;
+	};
+
+	// pick the format from the extension of the file name
+	static bool GetFileFormat(const char* filename, FILE_FORMAT& format);
+	// split an OBJ file into chunks and read them
+	bool ImportOBJ(const unsigned char* pFile, size_t fileSize);
+	// read the JSON of a glTF file and split its primitives
+	// into chunks
+	bool ImportGLTF(const std::string& filename, const unsigned char* pFile, size_t fileSize, FILE_FORMAT format);
+	// read a line of an OBJ file into its chunk, returns
+	// false when the line has bad values
+	static bool ParseOBJLine(IMPORT_CHUNK& chunk, const char* p, const char* end);
+	// add up the face normals around every OBJ position
+	bool CalculatePositionNormals();
+	// read an element of a glTF accessor as floats
+	static void ReadAccessor(const GLTF_ACCESSOR& accessor, size_t element, float* pValues);
+	// read an element of a glTF index accessor
+	static size_t ReadIndex(const GLTF_ACCESSOR& accessor, size_t element);
+	// weld the vertices of the chunks into one mesh
+	void MergeChunks(MESH_DATA& mesh);
+	// unmap the buffers of a glTF file
+	void UnmapBuffers();
+
+	// run a step of the import on all of the threads, which
+	// take their chunks from the shared counter
+	void RunStep(void (MeshImporter::*pStep)());
+	// read the lines of OBJ chunks
+	void ParseOBJChunks();
+	// turn the corners of OBJ chunks into welded vertices
+	void WeldOBJChunks();
+	// read the triangles of glTF chunks into welded vertices
+	void WeldGLTFChunks();
+	// write the indices of chunks into the mesh, numbered
+	// after merging
+	void RemapChunks();
+
+	IMPORT_STATS m_stats;
+	int m_threadCount;
+
+	// the chunks of the current import, and the next chunk
+	// a thread takes
+	std::vector<IMPORT_CHUNK> m_chunks;
+	std::atomic<size_t> m_nextChunk;
+
+	// OBJ - the values of all chunks, and the smooth normals
+	// of the positions, when any corner has no normal
+	std::vector<float> m_positions;
+	std::vector<float> m_uvs;
+	std::vector<float> m_normals;
+	std::vector<float> m_positionNormals;
+
+	// glTF - the placed primitives and the mapped buffers
+	std::vector<GLTF_PRIMITIVE> m_primitives;
+	std::vector<const unsigned char*> m_bufferMappings;
+	std::vector<size_t> m_bufferMappingSizes;
+
+	// the mesh the chunks are merged into
+	MESH_DATA* m_pMesh;
+};
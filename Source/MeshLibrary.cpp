@@ -0,0 +1,768 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlibrary.cpp
+// ============
+// upload mesh data to OpenGL buffers in a selectable vertex format
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshLibrary.h"
+#include "FrameStats.h"
+#include "GLState.h"
+#include "Logger.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// declaration of the global variables and defines
+namespace
+{
+	const char* g_PackedVerticesName = "bPackedVertices";
+	const char* g_PositionOffsetName = "positionOffset";
+	const char* g_PositionScaleName = "positionScale";
+
+	// one packed vertex - 16 bytes
+	struct PACKED_VERTEX
+	{
+		uint16_t position[4];
+		int16_t normal[2];
+		uint16_t uv[2];
+	};
+
+	/***********************************************************
+	 *  FloatToHalf()
+	 *
+	 *  Convert a float into a 16 bit half float, rounding to
+	 *  the nearest value.
+	 ***********************************************************/
+	uint16_t FloatToHalf(float value)
+	{
+		uint32_t bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+
+		uint32_t sign = (bits >> 16) & 0x8000;
+		int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+		uint32_t mantissa = bits & 0x007fffff;
+
+		// infinity and not a number
+		if (((bits >> 23) & 0xff) == 0xff)
+		{
+			return(static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0)));
+		}
+		// too large for a half float
+		if (exponent >= 31)
+		{
+			return(static_cast<uint16_t>(sign | 0x7c00));
+		}
+		// too small even for a denormal half float
+		if (exponent < -10)
+		{
+			return(static_cast<uint16_t>(sign));
+		}
+		// denormal half float
+		if (exponent <= 0)
+		{
+			mantissa = (mantissa | 0x00800000) >> (1 - exponent);
+			return(static_cast<uint16_t>(sign | ((mantissa + 0x00001000) >> 13)));
+		}
+
+		// the rounding may carry into the exponent, which is
+		// still the correct result
+		uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+		if (mantissa & 0x00001000)
+		{
+			half++;
+		}
+		return(static_cast<uint16_t>(half));
+	}
+
+	/***********************************************************
+	 *  PackSnorm16()
+	 *
+	 *  Convert a value from -1 to 1 into a signed 16 bit value.
+	 ***********************************************************/
+	int16_t PackSnorm16(float value)
+	{
+		value = std::fmax(-1.0f, std::fmin(1.0f, value));
+		return(static_cast<int16_t>(std::floor((value * 32767.0f) + 0.5f)));
+	}
+
+	/***********************************************************
+	 *  EncodeOctahedral()
+	 *
+	 *  Map a unit normal onto the octahedron and unfold it into
+	 *  two values from -1 to 1.
+	 ***********************************************************/
+	void EncodeOctahedral(float x, float y, float z, int16_t encoded[2])
+	{
+		float sum = std::fabs(x) + std::fabs(y) + std::fabs(z);
+		if (sum <= 0.0f)
+		{
+			encoded[0] = 0;
+			encoded[1] = 0;
+			return;
+		}
+
+		float u = x / sum;
+		float v = y / sum;
+
+		// fold the lower half of the octahedron over the upper half
+		if (z < 0.0f)
+		{
+			float foldedU = (1.0f - std::fabs(v)) * ((u >= 0.0f) ? 1.0f : -1.0f);
+			float foldedV = (1.0f - std::fabs(u)) * ((v >= 0.0f) ? 1.0f : -1.0f);
+			u = foldedU;
+			v = foldedV;
+		}
+
+		encoded[0] = PackSnorm16(u);
+		encoded[1] = PackSnorm16(v);
+	}
+
+	/***********************************************************
+	 *  HalfToFloat()
+	 *
+	 *  Convert a 16 bit half float into a float.
+	 ***********************************************************/
+	float HalfToFloat(uint16_t half)
+	{
+		uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+		uint32_t exponent = (half >> 10) & 0x1f;
+		uint32_t mantissa = half & 0x03ff;
+
+		// zero and denormal half floats
+		if (exponent == 0)
+		{
+			float value = std::ldexp(static_cast<float>(mantissa), -24);
+			return((sign != 0) ? -value : value);
+		}
+
+		uint32_t bits = sign | (mantissa << 13);
+		if (exponent == 31)
+		{
+			bits |= 0x7f800000;
+		}
+		else
+		{
+			bits |= (exponent - 15 + 127) << 23;
+		}
+		float value = 0.0f;
+		memcpy(&value, &bits, sizeof(value));
+		return(value);
+	}
+
+	/***********************************************************
+	 *  DecodeOctahedral()
+	 *
+	 *  Fold two values from -1 to 1 back onto the octahedron
+	 *  and turn them into a unit normal, the way the vertex
+	 *  shader does.
+	 ***********************************************************/
+	void DecodeOctahedral(const int16_t encoded[2], float normal[3])
+	{
+		float x = std::fmax(encoded[0] / 32767.0f, -1.0f);
+		float y = std::fmax(encoded[1] / 32767.0f, -1.0f);
+		float z = 1.0f - std::fabs(x) - std::fabs(y);
+		if (z < 0.0f)
+		{
+			float foldedX = (1.0f - std::fabs(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+			float foldedY = (1.0f - std::fabs(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+
+		float length = std::sqrt((x * x) + (y * y) + (z * z));
+		normal[0] = x / length;
+		normal[1] = y / length;
+		normal[2] = z / length;
+	}
+}
+
+/***********************************************************
+ *  MeshLibrary()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshLibrary::MeshLibrary(bool bUpload)
+{
+	m_bUpload = bUpload;
+	for (int i = 0; i < VERTEX_FORMAT_COUNT; i++)
+	{
+		m_vertexArrays[i] = 0;
+		m_vertexArrayVersions[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~MeshLibrary()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshLibrary::~MeshLibrary()
+{
+	// the arena buffers are freed by the arena
+	if (m_bUpload == true)
+	{
+		GLState::BindVertexArray(0);
+		for (int i = 0; i < VERTEX_FORMAT_COUNT; i++)
+		{
+			if (m_vertexArrays[i] != 0)
+			{
+				glDeleteVertexArrays(1, &m_vertexArrays[i]);
+				m_vertexArrays[i] = 0;
+			}
+		}
+	}
+	m_meshes.clear();
+}
+
+/***********************************************************
+ *  GetVertexSize()
+ *
+ *  This method is used for getting the size in bytes of one
+ *  vertex in the passed in format.
+ ***********************************************************/
+size_t MeshLibrary::GetVertexSize(VERTEX_FORMAT format)
+{
+	if (format == VERTEX_FORMAT_PACKED)
+	{
+		return(sizeof(PACKED_VERTEX));
+	}
+	if (format == VERTEX_FORMAT_BAKED)
+	{
+		return(sizeof(BAKED_VERTEX));
+	}
+
+	return(MESH_DATA::FLOATS_PER_VERTEX * sizeof(float));
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for encoding mesh data in the passed
+ *  in vertex format and uploading it.  Meshes with less
+ *  than 65536 vertices use 16 bit indices.
+ ***********************************************************/
+int MeshLibrary::AddMesh(std::string tag, const MESH_DATA& mesh, VERTEX_FORMAT format)
+{
+	MESH_BUFFERS buffers;
+	unsigned int vertexCount = mesh.GetVertexCount();
+
+	buffers.format = format;
+	buffers.indexCount = static_cast<GLsizei>(mesh.indices.size());
+	buffers.positionOffset = glm::vec3(0.0f);
+	buffers.positionScale = glm::vec3(1.0f);
+
+	std::vector<PACKED_VERTEX> packed;
+	if (format == VERTEX_FORMAT_PACKED)
+	{
+		// find the bounds the positions are quantized to
+		glm::vec3 boundsMin(0.0f);
+		glm::vec3 boundsMax(0.0f);
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			const float* position = &mesh.vertices[(i * MESH_DATA::FLOATS_PER_VERTEX) + MESH_DATA::POSITION_OFFSET];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				if ((i == 0) || (position[axis] < boundsMin[axis]))
+				{
+					boundsMin[axis] = position[axis];
+				}
+				if ((i == 0) || (position[axis] > boundsMax[axis]))
+				{
+					boundsMax[axis] = position[axis];
+				}
+			}
+		}
+		buffers.positionOffset = boundsMin;
+		buffers.positionScale = boundsMax - boundsMin;
+
+		packed.resize(vertexCount);
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			const float* vertex = &mesh.vertices[i * MESH_DATA::FLOATS_PER_VERTEX];
+			const float* normal = vertex + MESH_DATA::NORMAL_OFFSET;
+			const float* uv = vertex + MESH_DATA::UV_OFFSET;
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float range = buffers.positionScale[axis];
+				float unit = (range > 0.0f) ? ((vertex[axis] - boundsMin[axis]) / range) : 0.0f;
+				packed[i].position[axis] = static_cast<uint16_t>(std::floor((unit * 65535.0f) + 0.5f));
+			}
+			packed[i].position[3] = 0;
+
+			EncodeOctahedral(normal[0], normal[1], normal[2], packed[i].normal);
+			packed[i].uv[0] = FloatToHalf(uv[0]);
+			packed[i].uv[1] = FloatToHalf(uv[1]);
+		}
+
+		buffers.vertices = packed.data();
+		buffers.vertexBytes = packed.size() * sizeof(PACKED_VERTEX);
+	}
+	else
+	{
+		buffers.vertices = mesh.vertices.data();
+		buffers.vertexBytes = mesh.vertices.size() * sizeof(float);
+	}
+
+	std::vector<uint16_t> shortIndices;
+	if (vertexCount <= 65536)
+	{
+		shortIndices.assign(mesh.indices.begin(), mesh.indices.end());
+		buffers.indexType = GL_UNSIGNED_SHORT;
+		buffers.indices = shortIndices.data();
+		buffers.indexBytes = shortIndices.size() * sizeof(uint16_t);
+	}
+	else
+	{
+		buffers.indexType = GL_UNSIGNED_INT;
+		buffers.indices = mesh.indices.data();
+		buffers.indexBytes = mesh.indices.size() * sizeof(unsigned int);
+	}
+
+	return(AddMesh(tag, buffers));
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for uploading a mesh whose vertices
+ *  carry baked lighting.  Meshes with less than 65536
+ *  vertices use 16 bit indices.
+ ***********************************************************/
+int MeshLibrary::AddMesh(std::string tag, const std::vector<BAKED_VERTEX>& vertices, const std::vector<unsigned int>& indices)
+{
+	MESH_BUFFERS buffers;
+
+	buffers.format = VERTEX_FORMAT_BAKED;
+	buffers.vertices = vertices.data();
+	buffers.vertexBytes = vertices.size() * sizeof(BAKED_VERTEX);
+	buffers.indexCount = static_cast<GLsizei>(indices.size());
+	buffers.positionOffset = glm::vec3(0.0f);
+	buffers.positionScale = glm::vec3(1.0f);
+
+	std::vector<uint16_t> shortIndices;
+	if (vertices.size() <= 65536)
+	{
+		shortIndices.assign(indices.begin(), indices.end());
+		buffers.indexType = GL_UNSIGNED_SHORT;
+		buffers.indices = shortIndices.data();
+		buffers.indexBytes = shortIndices.size() * sizeof(uint16_t);
+	}
+	else
+	{
+		buffers.indexType = GL_UNSIGNED_INT;
+		buffers.indices = indices.data();
+		buffers.indexBytes = indices.size() * sizeof(unsigned int);
+	}
+
+	return(AddMesh(tag, buffers));
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for uploading the buffers of a mesh
+ *  that is already encoded into ranges of the mesh arena.
+ *  A mesh that does not fit into the memory budget is not
+ *  loaded, and -1 is returned, so its objects keep their
+ *  basic mesh.  Without uploads the mesh only gets its
+ *  index and tag.
+ ***********************************************************/
+int MeshLibrary::AddMesh(std::string tag, const MESH_BUFFERS& buffers)
+{
+	GL_MESH glMesh;
+	size_t vertexSize = GetVertexSize(buffers.format);
+
+	if (m_bUpload == false)
+	{
+		glMesh.range.vertexOffset = 0;
+		glMesh.range.vertexBytes = 0;
+		glMesh.range.indexOffset = 0;
+		glMesh.range.indexBytes = 0;
+	}
+	else if (m_arena.AddMesh(
+		buffers.vertices,
+		buffers.vertexBytes,
+		vertexSize,
+		buffers.indices,
+		buffers.indexBytes,
+		glMesh.range) == false)
+	{
+		LOG_ERROR("Mesh does not fit into the GPU memory budget:" << tag);
+		return(-1);
+	}
+
+	glMesh.tag = tag;
+	glMesh.bLoaded = true;
+	glMesh.format = buffers.format;
+	glMesh.baseVertex = static_cast<GLint>(glMesh.range.vertexOffset / vertexSize);
+	glMesh.indexCount = buffers.indexCount;
+	glMesh.indexType = buffers.indexType;
+	glMesh.positionOffset = buffers.positionOffset;
+	glMesh.positionScale = buffers.positionScale;
+
+	// reuse the index of an unloaded mesh
+	for (size_t i = 0; i < m_meshes.size(); i++)
+	{
+		if (m_meshes[i].bLoaded == false)
+		{
+			m_meshes[i] = glMesh;
+			return(static_cast<int>(i));
+		}
+	}
+
+	m_meshes.push_back(glMesh);
+
+	return(static_cast<int>(m_meshes.size()) - 1);
+}
+
+/***********************************************************
+ *  RemoveMesh()
+ *
+ *  This method is used for unloading a mesh.  Its ranges
+ *  go back to the arena for the next meshes.
+ ***********************************************************/
+void MeshLibrary::RemoveMesh(int index)
+{
+	if (IsLoaded(index) == false)
+	{
+		return;
+	}
+
+	GL_MESH& glMesh = m_meshes[index];
+	if (m_bUpload == true)
+	{
+		m_arena.RemoveMesh(glMesh.range);
+	}
+	glMesh.tag.clear();
+	glMesh.bLoaded = false;
+	glMesh.indexCount = 0;
+}
+
+/***********************************************************
+ *  ReadMesh()
+ *
+ *  This method is used for reading the uploaded buffers of
+ *  a mesh back from OpenGL, so they can be written into an
+ *  asset pack exactly as they are drawn.
+ ***********************************************************/
+bool MeshLibrary::ReadMesh(
+	int index,
+	std::vector<unsigned char>& vertices,
+	std::vector<unsigned char>& indices,
+	MESH_BUFFERS& buffers)
+{
+	if (IsLoaded(index) == false)
+	{
+		return(false);
+	}
+
+	const GL_MESH& glMesh = m_meshes[index];
+
+	vertices.resize(glMesh.range.vertexBytes);
+	indices.resize(glMesh.range.indexBytes);
+	m_arena.ReadMesh(glMesh.range, vertices.data(), indices.data());
+
+	buffers.format = glMesh.format;
+	buffers.vertices = vertices.data();
+	buffers.vertexBytes = glMesh.range.vertexBytes;
+	buffers.indices = indices.data();
+	buffers.indexBytes = glMesh.range.indexBytes;
+	buffers.indexType = glMesh.indexType;
+	buffers.indexCount = glMesh.indexCount;
+	buffers.positionOffset = glMesh.positionOffset;
+	buffers.positionScale = glMesh.positionScale;
+
+	return(true);
+}
+
+/***********************************************************
+ *  DecodeMesh()
+ *
+ *  This method is used for turning the buffers of a mesh
+ *  in the float or packed format back into mesh data, for
+ *  the work done on the CPU with meshes that were loaded
+ *  already encoded.  Meshes with baked lighting are not
+ *  decoded.
+ ***********************************************************/
+bool MeshLibrary::DecodeMesh(const MESH_BUFFERS& buffers, MESH_DATA& mesh)
+{
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	size_t vertexSize = GetVertexSize(buffers.format);
+	size_t indexSize = (buffers.indexType == GL_UNSIGNED_SHORT) ? sizeof(uint16_t) : sizeof(uint32_t);
+	if ((buffers.format == VERTEX_FORMAT_BAKED) ||
+		((buffers.indexType != GL_UNSIGNED_SHORT) && (buffers.indexType != GL_UNSIGNED_INT)) ||
+		((static_cast<size_t>(buffers.indexCount) * indexSize) > buffers.indexBytes))
+	{
+		return(false);
+	}
+
+	size_t vertexCount = buffers.vertexBytes / vertexSize;
+	if (buffers.format == VERTEX_FORMAT_PACKED)
+	{
+		mesh.vertices.resize(vertexCount * MESH_DATA::FLOATS_PER_VERTEX);
+		const unsigned char* pSource = static_cast<const unsigned char*>(buffers.vertices);
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			PACKED_VERTEX packed;
+			memcpy(&packed, pSource + (i * sizeof(PACKED_VERTEX)), sizeof(PACKED_VERTEX));
+			float* vertex = &mesh.vertices[i * MESH_DATA::FLOATS_PER_VERTEX];
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				vertex[MESH_DATA::POSITION_OFFSET + axis] = buffers.positionOffset[axis] +
+					((packed.position[axis] / 65535.0f) * buffers.positionScale[axis]);
+			}
+			DecodeOctahedral(packed.normal, vertex + MESH_DATA::NORMAL_OFFSET);
+			vertex[MESH_DATA::UV_OFFSET] = HalfToFloat(packed.uv[0]);
+			vertex[MESH_DATA::UV_OFFSET + 1] = HalfToFloat(packed.uv[1]);
+		}
+	}
+	else
+	{
+		mesh.vertices.resize(vertexCount * MESH_DATA::FLOATS_PER_VERTEX);
+		memcpy(mesh.vertices.data(), buffers.vertices, mesh.vertices.size() * sizeof(float));
+	}
+
+	mesh.indices.resize(static_cast<size_t>(buffers.indexCount));
+	for (size_t i = 0; i < mesh.indices.size(); i++)
+	{
+		if (buffers.indexType == GL_UNSIGNED_SHORT)
+		{
+			uint16_t index = 0;
+			memcpy(&index, static_cast<const unsigned char*>(buffers.indices) + (i * sizeof(uint16_t)), sizeof(index));
+			mesh.indices[i] = index;
+		}
+		else
+		{
+			uint32_t index = 0;
+			memcpy(&index, static_cast<const unsigned char*>(buffers.indices) + (i * sizeof(uint32_t)), sizeof(index));
+			mesh.indices[i] = index;
+		}
+
+		if (mesh.indices[i] >= vertexCount)
+		{
+			mesh.vertices.clear();
+			mesh.indices.clear();
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindMesh()
+ *
+ *  This method is used for getting the index of the loaded
+ *  mesh associated with the passed in tag.
+ ***********************************************************/
+int MeshLibrary::FindMesh(std::string tag)
+{
+	for (size_t i = 0; i < m_meshes.size(); i++)
+	{
+		if ((m_meshes[i].bLoaded == true) && (m_meshes[i].tag.compare(tag) == 0))
+		{
+			return(static_cast<int>(i));
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  GetMeshTag()
+ *
+ *  This method is used for getting the tag of a loaded
+ *  mesh, the empty string for an unknown index.
+ ***********************************************************/
+std::string MeshLibrary::GetMeshTag(int index) const
+{
+	if (IsLoaded(index) == false)
+	{
+		return("");
+	}
+
+	return(m_meshes[index].tag);
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing a loaded mesh.  The
+ *  shader is told how the vertices of the mesh are stored.
+ *  The scene shader draws an instance into each view, so
+ *  more than one instance draws the mesh into several views
+ *  with one draw command.
+ ***********************************************************/
+void MeshLibrary::DrawMesh(int index, ShaderManager* pShaderManager, int instanceCount)
+{
+	if (IsLoaded(index) == false)
+	{
+		return;
+	}
+
+	const GL_MESH& glMesh = m_meshes[index];
+
+	if (NULL != pShaderManager)
+	{
+		bool bPacked = (glMesh.format == VERTEX_FORMAT_PACKED);
+		GLState::SetUniform(pShaderManager, g_PackedVerticesName, bPacked);
+		if (bPacked == true)
+		{
+			GLState::SetUniform(pShaderManager, g_PositionOffsetName, glMesh.positionOffset);
+			GLState::SetUniform(pShaderManager, g_PositionScaleName, glMesh.positionScale);
+		}
+	}
+
+	// the vertex array is shared by every mesh of the format
+	// and stays bound, so the next mesh is reached through
+	// its base vertex and index offset alone
+	BindVertexArray(glMesh.format);
+	void* indexOffset = (void*)glMesh.range.indexOffset;
+	if (instanceCount > 1)
+	{
+		glDrawElementsInstancedBaseVertex(GL_TRIANGLES, glMesh.indexCount, glMesh.indexType,
+			indexOffset, instanceCount, glMesh.baseVertex);
+	}
+	else
+	{
+		glDrawElementsBaseVertex(GL_TRIANGLES, glMesh.indexCount, glMesh.indexType,
+			indexOffset, glMesh.baseVertex);
+	}
+}
+
+/***********************************************************
+ *  BindVertexArray()
+ *
+ *  This method is used for binding the shared vertex array
+ *  of a vertex format.  The vertex array is created with
+ *  the first mesh of the format, and pointed at the arena
+ *  buffers again whenever the arena has replaced them.
+ ***********************************************************/
+void MeshLibrary::BindVertexArray(VERTEX_FORMAT format)
+{
+	if (m_vertexArrays[format] == 0)
+	{
+		glGenVertexArrays(1, &m_vertexArrays[format]);
+	}
+
+	GLState::BindVertexArray(m_vertexArrays[format]);
+	if (m_vertexArrayVersions[format] == m_arena.GetBufferVersion())
+	{
+		return;
+	}
+
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_arena.GetVertexBuffer());
+	SetVertexAttributes(format);
+	GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_arena.GetIndexBuffer());
+	m_vertexArrayVersions[format] = m_arena.GetBufferVersion();
+}
+
+/***********************************************************
+ *  SetVertexAttributes()
+ *
+ *  This method is used for describing the vertices of a
+ *  format to the bound vertex array.  The attributes start
+ *  at the beginning of the arena vertex buffer.
+ ***********************************************************/
+void MeshLibrary::SetVertexAttributes(VERTEX_FORMAT format)
+{
+	if (format == VERTEX_FORMAT_PACKED)
+	{
+		GLsizei stride = sizeof(PACKED_VERTEX);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(PACKED_VERTEX, position));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, stride, (void*)offsetof(PACKED_VERTEX, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PACKED_VERTEX, uv));
+		glEnableVertexAttribArray(2);
+	}
+	else if (format == VERTEX_FORMAT_BAKED)
+	{
+		GLsizei stride = sizeof(BAKED_VERTEX);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(BAKED_VERTEX, position));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(BAKED_VERTEX, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(BAKED_VERTEX, uv));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(BAKED_VERTEX, ambient));
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(BAKED_VERTEX, diffuse));
+		glEnableVertexAttribArray(4);
+		glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(BAKED_VERTEX, visibility));
+		glEnableVertexAttribArray(5);
+	}
+	else
+	{
+		GLsizei stride = MESH_DATA::FLOATS_PER_VERTEX * sizeof(float);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)(MESH_DATA::POSITION_OFFSET * sizeof(float)));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(MESH_DATA::NORMAL_OFFSET * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(MESH_DATA::UV_OFFSET * sizeof(float)));
+		glEnableVertexAttribArray(2);
+	}
+}
+
+/***********************************************************
+ *  IsLoaded()
+ *
+ *  This method is used for checking whether an index
+ *  belongs to a loaded mesh.
+ ***********************************************************/
+bool MeshLibrary::IsLoaded(int index) const
+{
+	return((index >= 0) && (index < static_cast<int>(m_meshes.size())) && (m_meshes[index].bLoaded == true));
+}
+
+/***********************************************************
+ *  UpdateFrameStats()
+ *
+ *  This method is used for publishing the buffer memory of
+ *  the loaded meshes, split by vertex format, and the size
+ *  of the arena buffers.
+ ***********************************************************/
+void MeshLibrary::UpdateFrameStats()
+{
+	size_t floatBytes = 0;
+	size_t packedBytes = 0;
+	size_t bakedBytes = 0;
+	size_t indexBytes = 0;
+
+	for (size_t i = 0; i < m_meshes.size(); i++)
+	{
+		if (m_meshes[i].bLoaded == false)
+		{
+			continue;
+		}
+
+		if (m_meshes[i].format == VERTEX_FORMAT_PACKED)
+		{
+			packedBytes += m_meshes[i].range.vertexBytes;
+		}
+		else if (m_meshes[i].format == VERTEX_FORMAT_BAKED)
+		{
+			bakedBytes += m_meshes[i].range.vertexBytes;
+		}
+		else
+		{
+			floatBytes += m_meshes[i].range.vertexBytes;
+		}
+		indexBytes += m_meshes[i].range.indexBytes;
+	}
+
+	FrameStats::SetBytes("mesh float vertex memory", floatBytes);
+	FrameStats::SetBytes("mesh packed vertex memory", packedBytes);
+	FrameStats::SetBytes("mesh baked vertex memory", bakedBytes);
+	FrameStats::SetBytes("mesh index memory", indexBytes);
+	// the arena buffers hold the meshes above and the free
+	// ranges between them
+	FrameStats::SetBytes("mesh arena vertex capacity", m_arena.GetVertexCapacity());
+	FrameStats::SetBytes("mesh arena index capacity", m_arena.GetIndexCapacity());
+}
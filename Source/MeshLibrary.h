@@ -0,0 +1,147 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshlibrary.h
+// ============
+// upload mesh data to OpenGL buffers in a selectable vertex format
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "MeshArena.h"
+#include "MeshData.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  MeshLibrary
+ *
+ *  This class holds the meshes that are built or loaded by
+ *  the project itself, including the basic shapes.  Each
+ *  mesh is uploaded either with full float vertices or with
+ *  packed 16 byte vertices that the vertex shader decodes.
+ *  Static objects with baked lighting are drawn with
+ *  meshes that carry the baked light in their vertices.
+ *
+ *  All of the meshes live in the shared buffers of a mesh
+ *  arena, with one vertex array per vertex format, so the
+ *  meshes of a format are drawn without binding anything
+ *  in between.
+ *
+ *  A library that does not upload only numbers its meshes
+ *  and finds them by tag, for drawing them on the CPU on a
+ *  machine without OpenGL.
+ ***********************************************************/
+class MeshLibrary
+{
+public:
+	// layout of the vertices in the vertex buffer
+	enum VERTEX_FORMAT
+	{
+		// 32 bytes - float position, normal and texture coordinate
+		VERTEX_FORMAT_FLOAT,
+		// 16 bytes - 16 bit quantized position scaled to the mesh
+		// bounds, octahedral normal in two 16 bit signed values
+		// and half float texture coordinate
+		VERTEX_FORMAT_PACKED,
+		// 60 bytes - float vertex with the baked lighting of a
+		// static object, see BAKED_VERTEX
+		VERTEX_FORMAT_BAKED,
+		VERTEX_FORMAT_COUNT
+	};
+
+	// the buffers of a mesh in the form they are uploaded in,
+	// either encoded from mesh data or read from an asset pack
+	struct MESH_BUFFERS
+	{
+		VERTEX_FORMAT format;
+		const void* vertices;
+		size_t vertexBytes;
+		const void* indices;
+		size_t indexBytes;
+		GLenum indexType;
+		GLsizei indexCount;
+		// packed positions are decoded as offset + value * scale
+		glm::vec3 positionOffset;
+		glm::vec3 positionScale;
+	};
+
+	// constructor - without uploads no OpenGL calls are made
+	MeshLibrary(bool bUpload = true);
+	// destructor
+	~MeshLibrary();
+
+	// upload a mesh in the float or packed format and return
+	// its index
+	int AddMesh(std::string tag, const MESH_DATA& mesh, VERTEX_FORMAT format);
+	// upload a mesh with baked lighting and return its index
+	int AddMesh(std::string tag, const std::vector<BAKED_VERTEX>& vertices, const std::vector<unsigned int>& indices);
+	// upload a mesh that is already encoded and return its index
+	int AddMesh(std::string tag, const MESH_BUFFERS& buffers);
+	// unload a mesh, its index is reused by a later mesh
+	void RemoveMesh(int index);
+	// read the buffers of a loaded mesh back from OpenGL - the
+	// buffer pointers point into the passed in vectors
+	bool ReadMesh(
+		int index,
+		std::vector<unsigned char>& vertices,
+		std::vector<unsigned char>& indices,
+		MESH_BUFFERS& buffers);
+	// decode the buffers of a float or packed mesh back into
+	// mesh data, returns false for baked or broken buffers
+	static bool DecodeMesh(const MESH_BUFFERS& buffers, MESH_DATA& mesh);
+	// find a mesh by tag, -1 when it is not loaded
+	int FindMesh(std::string tag);
+	// number of mesh indices, including unloaded ones, and
+	// the tag of a loaded mesh
+	int GetMeshCount() const { return(static_cast<int>(m_meshes.size())); }
+	std::string GetMeshTag(int index) const;
+	// draw a mesh, passing its vertex decoding values to the
+	// shader - more than one instance draws it once per view
+	void DrawMesh(int index, ShaderManager* pShaderManager, int instanceCount = 1);
+
+	// get the size of one vertex in the passed in format
+	static size_t GetVertexSize(VERTEX_FORMAT format);
+
+	// publish the vertex and index memory to the frame stats
+	void UpdateFrameStats();
+
+private:
+	struct GL_MESH
+	{
+		std::string tag;
+		bool bLoaded;
+		VERTEX_FORMAT format;
+		// ranges of the mesh in the arena, and the first
+		// vertex of the mesh in the vertex array
+		MeshArena::ARENA_RANGE range;
+		GLint baseVertex;
+		GLsizei indexCount;
+		GLenum indexType;
+		// packed positions are decoded as offset + value * scale
+		glm::vec3 positionOffset;
+		glm::vec3 positionScale;
+	};
+
+	// bind the vertex array of a format, pointing it at the
+	// arena buffers again when they were replaced
+	void BindVertexArray(VERTEX_FORMAT format);
+	// set the vertex attributes of a format for the bound
+	// vertex array
+	static void SetVertexAttributes(VERTEX_FORMAT format);
+	// check whether an index is a loaded mesh
+	bool IsLoaded(int index) const;
+
+	// loaded meshes, unloaded ones keep their index
+	std::vector<GL_MESH> m_meshes;
+	// whether the meshes are uploaded into the arena
+	bool m_bUpload;
+
+	// the shared buffers of all meshes
+	MeshArena m_arena;
+	// one vertex array for each vertex format, created when
+	// the first mesh of the format is loaded
+	GLuint m_vertexArrays[VERTEX_FORMAT_COUNT];
+	// arena buffer version each vertex array points at
+	unsigned int m_vertexArrayVersions[VERTEX_FORMAT_COUNT];
+};
@@ -0,0 +1,472 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// reorder mesh triangles and vertices for the GPU vertex cache and overdraw
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// declaration of the global variables and defines
+namespace
+{
+	// split clusters may have up to 5% more cache misses
+	const float OVERDRAW_THRESHOLD = 1.05f;
+	const unsigned int NO_VERTEX = 0xffffffff;
+
+	// triangle cluster sorted for overdraw
+	struct TRIANGLE_CLUSTER
+	{
+		unsigned int firstTriangle;
+		unsigned int triangleCount;
+		float sortKey;
+	};
+
+	/***********************************************************
+	 *  GetNextFanningVertex()
+	 *
+	 *  Pick the next vertex to fan triangles around - the
+	 *  candidate that is still in the cache and will stay there
+	 *  for its remaining triangles, or else a vertex from the
+	 *  dead end stack, or else the next vertex with triangles.
+	 ***********************************************************/
+	int GetNextFanningVertex(
+		const std::vector<unsigned int>& candidates,
+		const std::vector<int>& cacheTime,
+		const std::vector<unsigned int>& liveTriangles,
+		std::vector<unsigned int>& deadEnd,
+		unsigned int& cursor,
+		int timeStamp,
+		int cacheSize)
+	{
+		int bestVertex = -1;
+		int bestPriority = -1;
+
+		for (size_t i = 0; i < candidates.size(); i++)
+		{
+			unsigned int vertex = candidates[i];
+			if (liveTriangles[vertex] == 0)
+			{
+				continue;
+			}
+
+			// fanning the vertex emits up to two new vertices for
+			// each of its triangles, so it must stay cached
+			int priority = 0;
+			int age = timeStamp - cacheTime[vertex];
+			if ((age + (2 * static_cast<int>(liveTriangles[vertex]))) <= cacheSize)
+			{
+				priority = age;
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				bestVertex = static_cast<int>(vertex);
+			}
+		}
+
+		if (bestVertex >= 0)
+		{
+			return(bestVertex);
+		}
+
+		// the recently used vertices are likely still cached
+		while (deadEnd.empty() == false)
+		{
+			unsigned int vertex = deadEnd.back();
+			deadEnd.pop_back();
+			if (liveTriangles[vertex] > 0)
+			{
+				return(static_cast<int>(vertex));
+			}
+		}
+
+		while (cursor < liveTriangles.size())
+		{
+			if (liveTriangles[cursor] > 0)
+			{
+				return(static_cast<int>(cursor));
+			}
+			cursor++;
+		}
+
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  AccumulateTriangle()
+	 *
+	 *  Add the area weighted center and normal of a triangle to
+	 *  the passed in sums.
+	 ***********************************************************/
+	void AccumulateTriangle(
+		const MESH_DATA& mesh,
+		unsigned int triangle,
+		double center[3],
+		double normal[3],
+		double& area)
+	{
+		const float* p[3];
+		for (int c = 0; c < 3; c++)
+		{
+			unsigned int vertex = mesh.indices[(triangle * 3) + c];
+			p[c] = &mesh.vertices[(vertex * MESH_DATA::FLOATS_PER_VERTEX) + MESH_DATA::POSITION_OFFSET];
+		}
+
+		double e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+		double e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+		double n[3] =
+		{
+			(e1[1] * e2[2]) - (e1[2] * e2[1]),
+			(e1[2] * e2[0]) - (e1[0] * e2[2]),
+			(e1[0] * e2[1]) - (e1[1] * e2[0])
+		};
+		double triangleArea = 0.5 * std::sqrt((n[0] * n[0]) + (n[1] * n[1]) + (n[2] * n[2]));
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			center[axis] += triangleArea * (p[0][axis] + p[1][axis] + p[2][axis]) / 3.0;
+			normal[axis] += n[axis];
+		}
+		area += triangleArea;
+	}
+}
+
+/***********************************************************
+ *  AnalyzeVertexCache()
+ *
+ *  This function is used for simulating a FIFO vertex cache
+ *  of the passed in size over the triangles of the mesh.
+ ***********************************************************/
+MeshOptimizer::VERTEX_CACHE_STATS MeshOptimizer::AnalyzeVertexCache(
+	const MESH_DATA& mesh,
+	int cacheSize)
+{
+	VERTEX_CACHE_STATS stats;
+	stats.ACMR = 0.0f;
+	stats.ATVR = 0.0f;
+
+	size_t triangleCount = mesh.indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return(stats);
+	}
+
+	// a vertex is cached while less than cacheSize misses
+	// happened since it was loaded
+	std::vector<int> cacheTime(mesh.GetVertexCount(), -cacheSize - 1);
+	int misses = 0;
+	int usedVertices = 0;
+
+	for (size_t i = 0; i < (triangleCount * 3); i++)
+	{
+		unsigned int vertex = mesh.indices[i];
+		if (cacheTime[vertex] == (-cacheSize - 1))
+		{
+			usedVertices++;
+		}
+		if ((misses - cacheTime[vertex]) > cacheSize)
+		{
+			cacheTime[vertex] = misses;
+			misses++;
+		}
+	}
+
+	stats.ACMR = static_cast<float>(misses) / static_cast<float>(triangleCount);
+	stats.ATVR = static_cast<float>(misses) / static_cast<float>(usedVertices);
+
+	return(stats);
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This function is used for reordering the triangles of the
+ *  mesh with the Tipsify algorithm.  Triangles are emitted as
+ *  fans around a vertex, and the next vertex to fan around is
+ *  chosen among the vertices that are still in the cache.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexCache(MESH_DATA& mesh, int cacheSize)
+{
+	unsigned int triangleCount = static_cast<unsigned int>(mesh.indices.size() / 3);
+	unsigned int vertexCount = mesh.GetVertexCount();
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// list the triangles that use each vertex
+	std::vector<unsigned int> liveTriangles(vertexCount, 0);
+	for (size_t i = 0; i < (triangleCount * 3); i++)
+	{
+		liveTriangles[mesh.indices[i]]++;
+	}
+
+	std::vector<unsigned int> firstAdjacent(vertexCount + 1, 0);
+	for (unsigned int v = 0; v < vertexCount; v++)
+	{
+		firstAdjacent[v + 1] = firstAdjacent[v] + liveTriangles[v];
+	}
+
+	std::vector<unsigned int> adjacent(triangleCount * 3);
+	std::vector<unsigned int> fill(firstAdjacent.begin(), firstAdjacent.end() - 1);
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			adjacent[fill[mesh.indices[(t * 3) + c]]++] = t;
+		}
+	}
+
+	std::vector<int> cacheTime(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<unsigned int> deadEnd;
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> optimized;
+	optimized.reserve(triangleCount * 3);
+
+	int timeStamp = cacheSize + 1;
+	unsigned int cursor = 0;
+	int fanning = static_cast<int>(mesh.indices[0]);
+
+	while (fanning >= 0)
+	{
+		candidates.clear();
+
+		// emit every remaining triangle around the fanning vertex
+		for (unsigned int i = firstAdjacent[fanning]; i < firstAdjacent[fanning + 1]; i++)
+		{
+			unsigned int triangle = adjacent[i];
+			if (emitted[triangle] == true)
+			{
+				continue;
+			}
+
+			for (int c = 0; c < 3; c++)
+			{
+				unsigned int vertex = mesh.indices[(triangle * 3) + c];
+				optimized.push_back(vertex);
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+				if ((timeStamp - cacheTime[vertex]) > cacheSize)
+				{
+					cacheTime[vertex] = timeStamp;
+					timeStamp++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		fanning = GetNextFanningVertex(
+			candidates, cacheTime, liveTriangles, deadEnd, cursor, timeStamp, cacheSize);
+	}
+
+	mesh.indices.swap(optimized);
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  This function is used for splitting the cache optimized
+ *  triangles into clusters and drawing the clusters that
+ *  face away from the center of the mesh first, since they
+ *  are the most likely to hide the others.  Clusters start
+ *  where the cache would be empty anyway, and are split
+ *  further while the cache efficiency stays within the
+ *  threshold.
+ ***********************************************************/
+void MeshOptimizer::OptimizeOverdraw(MESH_DATA& mesh, int cacheSize, float threshold)
+{
+	unsigned int triangleCount = static_cast<unsigned int>(mesh.indices.size() / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	float targetACMR = AnalyzeVertexCache(mesh, cacheSize).ACMR * threshold;
+
+	// simulate the cache over the whole mesh, and over each
+	// cluster as if it was drawn on its own
+	std::vector<int> cacheTime(mesh.GetVertexCount(), -cacheSize - 1);
+	std::vector<int> clusterCacheTime(mesh.GetVertexCount(), -cacheSize - 1);
+	int misses = 0;
+	int clusterMisses = 0;
+	int clusterStartMisses = 0;
+
+	std::vector<TRIANGLE_CLUSTER> clusters;
+	TRIANGLE_CLUSTER cluster;
+	cluster.firstTriangle = 0;
+	cluster.triangleCount = 0;
+	cluster.sortKey = 0.0f;
+
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		int triangleMisses = 0;
+		for (int c = 0; c < 3; c++)
+		{
+			unsigned int vertex = mesh.indices[(t * 3) + c];
+			if ((misses - cacheTime[vertex]) > cacheSize)
+			{
+				cacheTime[vertex] = misses;
+				misses++;
+				triangleMisses++;
+			}
+		}
+
+		// a triangle with no cached vertices starts a cluster
+		if ((triangleMisses == 3) && (cluster.triangleCount > 0))
+		{
+			clusters.push_back(cluster);
+			cluster.firstTriangle = t;
+			cluster.triangleCount = 0;
+			clusterStartMisses = clusterMisses + cacheSize + 1;
+			clusterMisses = clusterStartMisses;
+		}
+
+		for (int c = 0; c < 3; c++)
+		{
+			unsigned int vertex = mesh.indices[(t * 3) + c];
+			if ((clusterMisses - clusterCacheTime[vertex]) > cacheSize)
+			{
+				clusterCacheTime[vertex] = clusterMisses;
+				clusterMisses++;
+			}
+		}
+		cluster.triangleCount++;
+
+		// split once the cluster on its own is efficient enough
+		float clusterACMR = static_cast<float>(clusterMisses - clusterStartMisses) / cluster.triangleCount;
+		if ((clusterACMR <= targetACMR) && ((t + 1) < triangleCount))
+		{
+			clusters.push_back(cluster);
+			cluster.firstTriangle = t + 1;
+			cluster.triangleCount = 0;
+			clusterStartMisses = clusterMisses + cacheSize + 1;
+			clusterMisses = clusterStartMisses;
+		}
+	}
+	if (cluster.triangleCount > 0)
+	{
+		clusters.push_back(cluster);
+	}
+
+	if (clusters.size() < 2)
+	{
+		return;
+	}
+
+	// the area weighted center of the whole mesh
+	double meshCenter[3] = { 0.0, 0.0, 0.0 };
+	double meshNormal[3] = { 0.0, 0.0, 0.0 };
+	double meshArea = 0.0;
+	for (unsigned int t = 0; t < triangleCount; t++)
+	{
+		AccumulateTriangle(mesh, t, meshCenter, meshNormal, meshArea);
+	}
+	if (meshArea > 0.0)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			meshCenter[axis] /= meshArea;
+		}
+	}
+
+	// clusters further out along their own facing are drawn first
+	for (size_t i = 0; i < clusters.size(); i++)
+	{
+		double center[3] = { 0.0, 0.0, 0.0 };
+		double normal[3] = { 0.0, 0.0, 0.0 };
+		double area = 0.0;
+		for (unsigned int t = 0; t < clusters[i].triangleCount; t++)
+		{
+			AccumulateTriangle(mesh, clusters[i].firstTriangle + t, center, normal, area);
+		}
+
+		double normalLength = std::sqrt((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+		double key = 0.0;
+		if ((area > 0.0) && (normalLength > 0.0))
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				key += ((center[axis] / area) - meshCenter[axis]) * (normal[axis] / normalLength);
+			}
+		}
+		clusters[i].sortKey = static_cast<float>(key);
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(),
+		[](const TRIANGLE_CLUSTER& a, const TRIANGLE_CLUSTER& b)
+		{
+			return(a.sortKey > b.sortKey);
+		});
+
+	std::vector<unsigned int> sorted;
+	sorted.reserve(mesh.indices.size());
+	for (size_t i = 0; i < clusters.size(); i++)
+	{
+		std::vector<unsigned int>::const_iterator first =
+			mesh.indices.begin() + (clusters[i].firstTriangle * 3);
+		sorted.insert(sorted.end(), first, first + (clusters[i].triangleCount * 3));
+	}
+
+	mesh.indices.swap(sorted);
+}
+
+/***********************************************************
+ *  OptimizeVertexFetch()
+ *
+ *  This function is used for storing the vertices in the
+ *  order the triangles first use them, so the vertex fetch
+ *  reads memory mostly in order.  Unused vertices are
+ *  dropped.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexFetch(MESH_DATA& mesh)
+{
+	std::vector<unsigned int> remap(mesh.GetVertexCount(), NO_VERTEX);
+	std::vector<float> vertices;
+	vertices.reserve(mesh.vertices.size());
+	unsigned int nextVertex = 0;
+
+	for (size_t i = 0; i < mesh.indices.size(); i++)
+	{
+		unsigned int vertex = mesh.indices[i];
+		if (remap[vertex] == NO_VERTEX)
+		{
+			remap[vertex] = nextVertex++;
+			std::vector<float>::const_iterator first =
+				mesh.vertices.begin() + (vertex * MESH_DATA::FLOATS_PER_VERTEX);
+			vertices.insert(vertices.end(), first, first + MESH_DATA::FLOATS_PER_VERTEX);
+		}
+		mesh.indices[i] = remap[vertex];
+	}
+
+	mesh.vertices.swap(vertices);
+}
+
+/***********************************************************
+ *  OptimizeMesh()
+ *
+ *  This function is used for running all the optimizations
+ *  on a mesh when it is loaded, and reporting the simulated
+ *  vertex cache efficiency before and after.
+ ***********************************************************/
+void MeshOptimizer::OptimizeMesh(MESH_DATA& mesh, std::string tag)
+{
+	VERTEX_CACHE_STATS before = AnalyzeVertexCache(mesh, VERTEX_CACHE_SIZE);
+
+	OptimizeVertexCache(mesh, VERTEX_CACHE_SIZE);
+	OptimizeOverdraw(mesh, VERTEX_CACHE_SIZE, OVERDRAW_THRESHOLD);
+	OptimizeVertexFetch(mesh);
+
+	VERTEX_CACHE_STATS after = AnalyzeVertexCache(mesh, VERTEX_CACHE_SIZE);
+
+	LOG_INFO("MESH OPTIMIZER: " << tag << ", "
+		<< (mesh.indices.size() / 3) << " triangles");
+	LOG_INFO("    ACMR: " << before.ACMR << " -> " << after.ACMR);
+	LOG_INFO("    ATVR: " << before.ATVR << " -> " << after.ATVR);
+}
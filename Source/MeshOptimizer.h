@@ -0,0 +1,52 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// reorder mesh triangles and vertices for the GPU vertex cache and overdraw
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+#include <string>
+
+/***********************************************************
+ *  MeshOptimizer
+ *
+ *  These functions reorder the indexed triangles of a mesh
+ *  without changing the rendered result.  The triangles are
+ *  ordered for the post-transform vertex cache with the
+ *  Tipsify algorithm, clusters of triangles are then sorted
+ *  to reduce overdraw, and finally the vertices are stored
+ *  in the order they are first used.
+ ***********************************************************/
+namespace MeshOptimizer
+{
+	// number of entries in the simulated FIFO vertex cache
+	const int VERTEX_CACHE_SIZE = 16;
+
+	// simulated vertex cache efficiency of a mesh
+	struct VERTEX_CACHE_STATS
+	{
+		// average cache misses per triangle, 0.5 at best
+		float ACMR;
+		// average cache misses per vertex, 1.0 at best
+		float ATVR;
+	};
+
+	// simulate a FIFO vertex cache over the triangles of the mesh
+	VERTEX_CACHE_STATS AnalyzeVertexCache(const MESH_DATA& mesh, int cacheSize);
+
+	// reorder the triangles for the vertex cache
+	void OptimizeVertexCache(MESH_DATA& mesh, int cacheSize);
+	// reorder clusters of triangles so the outward facing ones
+	// are drawn first - the threshold is how much worse than
+	// the current ACMR the split clusters are allowed to be
+	void OptimizeOverdraw(MESH_DATA& mesh, int cacheSize, float threshold);
+	// store the vertices in the order the triangles use them
+	void OptimizeVertexFetch(MESH_DATA& mesh);
+
+	// run all optimizations and report the cache efficiency
+	// before and after
+	void OptimizeMesh(MESH_DATA& mesh, std::string tag);
+}
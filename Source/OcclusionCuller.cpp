@@ -0,0 +1,240 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.cpp
+// ============
+// skip drawing scene objects that were hidden in the previous frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionCuller.h"
+#include "FrameStats.h"
+#include "GLState.h"
+
+#include <glm/gtx/transform.hpp>
+
+// declaration of the global variables and defines
+namespace
+{
+	const char* g_ModelName = "model";
+	const char* g_ViewProjectionName = "viewProjection";
+
+	// bounds are grown by this amount so that flat objects
+	// still cover some pixels
+	const float BOUNDS_PADDING = 0.01f;
+}
+
+/***********************************************************
+ *  OcclusionCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OcclusionCuller::OcclusionCuller(ShapeMeshes* pBasicMeshes)
+{
+	m_pBasicMeshes = pBasicMeshes;
+	m_currentQuerySet = 0;
+	m_cameraPosition = glm::vec3(0.0f);
+	m_bEnabled = true;
+
+	m_pBoundsShader = new ShaderManager();
+	m_pBoundsShader->LoadShaders(
+		"shaders/boundsVertexShader.glsl",
+		"shaders/boundsFragmentShader.glsl");
+}
+
+/***********************************************************
+ *  ~OcclusionCuller()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OcclusionCuller::~OcclusionCuller()
+{
+	for (size_t i = 0; i < m_objectQueries.size(); i++)
+	{
+		glDeleteQueries(2, m_objectQueries[i].query);
+	}
+	m_objectQueries.clear();
+
+	m_pBasicMeshes = NULL;
+	if (NULL != m_pBoundsShader)
+	{
+		delete m_pBoundsShader;
+		m_pBoundsShader = NULL;
+	}
+}
+
+/***********************************************************
+ *  SetObjectCount()
+ *
+ *  This method is used for creating the queries for objects
+ *  that were added to the scene.
+ ***********************************************************/
+void OcclusionCuller::SetObjectCount(int count)
+{
+	while (static_cast<int>(m_objectQueries.size()) < count)
+	{
+		OBJECT_QUERIES queries;
+		glGenQueries(2, queries.query);
+		queries.bIssued[0] = false;
+		queries.bIssued[1] = false;
+		m_objectQueries.push_back(queries);
+	}
+}
+
+/***********************************************************
+ *  GetVisibility()
+ *
+ *  This method is used for deciding if an object is drawn,
+ *  based on the query issued in the previous frame.  When
+ *  the result has not arrived yet, the object is drawn with
+ *  a conditional render instead of waiting for it.
+ ***********************************************************/
+OcclusionCuller::VISIBILITY OcclusionCuller::GetVisibility(int index)
+{
+	if ((m_bEnabled == false) ||
+		(index < 0) || (index >= static_cast<int>(m_objectQueries.size())))
+	{
+		return(OBJECT_VISIBLE);
+	}
+
+	OBJECT_QUERIES& queries = m_objectQueries[index];
+	int previousSet = 1 - m_currentQuerySet;
+
+	// objects without a test from the previous frame are drawn
+	if (queries.bIssued[previousSet] == false)
+	{
+		return(OBJECT_VISIBLE);
+	}
+
+	GLint available = 0;
+	glGetQueryObjectiv(queries.query[previousSet], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available != 0)
+	{
+		GLuint anySamplesPassed = 0;
+		glGetQueryObjectuiv(queries.query[previousSet], GL_QUERY_RESULT, &anySamplesPassed);
+		queries.bIssued[previousSet] = false;
+
+		if (anySamplesPassed == 0)
+		{
+			FrameStats::AddCounter("occluded objects", 1);
+			return(OBJECT_OCCLUDED);
+		}
+		return(OBJECT_VISIBLE);
+	}
+
+	// let the GPU skip the draw if the result arrives in time
+	FrameStats::AddCounter("occlusion conditional draws", 1);
+
+	return(OBJECT_CONDITIONAL);
+}
+
+/***********************************************************
+ *  BeginObject()
+ *
+ *  This method is used for starting the conditional render
+ *  of an object whose query result has not arrived yet.
+ ***********************************************************/
+void OcclusionCuller::BeginObject(int index, VISIBILITY visibility)
+{
+	if (visibility == OBJECT_CONDITIONAL)
+	{
+		int previousSet = 1 - m_currentQuerySet;
+		glBeginConditionalRender(m_objectQueries[index].query[previousSet], GL_QUERY_NO_WAIT);
+	}
+}
+
+/***********************************************************
+ *  EndObject()
+ *
+ *  This method is used for finishing the conditional render
+ *  of an object, when one was started.
+ ***********************************************************/
+void OcclusionCuller::EndObject(int index, VISIBILITY visibility)
+{
+	if (visibility == OBJECT_CONDITIONAL)
+	{
+		glEndConditionalRender();
+	}
+}
+
+/***********************************************************
+ *  BeginBoundsTests()
+ *
+ *  This method is used for setting up the render state for
+ *  testing the object bounds against the depth buffer.
+ ***********************************************************/
+void OcclusionCuller::BeginBoundsTests(glm::mat4 view, glm::mat4 projection)
+{
+	m_cameraPosition = glm::vec3(glm::inverse(view)[3]);
+
+	if (m_bEnabled == false)
+	{
+		return;
+	}
+
+	// the bounds only test the depth, nothing is written
+	GLState::ColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	GLState::DepthMask(GL_FALSE);
+	GLState::DepthFunc(GL_LEQUAL);
+
+	GLState::UseShader(m_pBoundsShader);
+	GLState::SetUniform(m_pBoundsShader, g_ViewProjectionName, projection * view);
+}
+
+/***********************************************************
+ *  TestObjectBounds()
+ *
+ *  This method is used for issuing the occlusion query of an
+ *  object, by drawing its bounding box.
+ ***********************************************************/
+void OcclusionCuller::TestObjectBounds(int index, glm::vec3 boundsMin, glm::vec3 boundsMax)
+{
+	if ((m_bEnabled == false) ||
+		(index < 0) || (index >= static_cast<int>(m_objectQueries.size())))
+	{
+		return;
+	}
+
+	OBJECT_QUERIES& queries = m_objectQueries[index];
+	boundsMin -= glm::vec3(BOUNDS_PADDING);
+	boundsMax += glm::vec3(BOUNDS_PADDING);
+
+	// the bounds would be clipped by the near plane when the
+	// camera is inside them, so these objects are always drawn
+	if ((m_cameraPosition.x >= boundsMin.x) && (m_cameraPosition.x <= boundsMax.x) &&
+		(m_cameraPosition.y >= boundsMin.y) && (m_cameraPosition.y <= boundsMax.y) &&
+		(m_cameraPosition.z >= boundsMin.z) && (m_cameraPosition.z <= boundsMax.z))
+	{
+		queries.bIssued[m_currentQuerySet] = false;
+		return;
+	}
+
+	// the box mesh is a unit cube around the origin
+	glm::mat4 model =
+		glm::translate((boundsMin + boundsMax) * 0.5f) *
+		glm::scale(boundsMax - boundsMin);
+	GLState::SetUniform(m_pBoundsShader, g_ModelName, model);
+
+	glBeginQuery(GL_ANY_SAMPLES_PASSED, queries.query[m_currentQuerySet]);
+	m_pBasicMeshes->DrawBoxMesh();
+	glEndQuery(GL_ANY_SAMPLES_PASSED);
+	GLState::InvalidateVertexArray();
+
+	queries.bIssued[m_currentQuerySet] = true;
+	FrameStats::AddCounter("occlusion tests", 1);
+}
+
+/***********************************************************
+ *  EndBoundsTests()
+ *
+ *  This method is used for restoring the render state after
+ *  the bounds tests and switching to the other query set.
+ ***********************************************************/
+void OcclusionCuller::EndBoundsTests()
+{
+	if (m_bEnabled == true)
+	{
+		GLState::ColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		GLState::DepthMask(GL_TRUE);
+		GLState::DepthFunc(GL_LESS);
+	}
+
+	m_currentQuerySet = 1 - m_currentQuerySet;
+}
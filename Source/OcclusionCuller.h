@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionculler.h
+// ============
+// skip drawing scene objects that were hidden in the previous frame
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+
+#include <vector>
+
+/***********************************************************
+ *  OcclusionCuller
+ *
+ *  This class tests the bounding box of every scene object
+ *  with an occlusion query after the scene has been drawn.
+ *  The results are used in the next frame, so the bounds
+ *  are tested against the previous frame's depth.  Results
+ *  that have arrived are read back on the CPU and hidden
+ *  objects are skipped, results that are still in flight
+ *  are left to the GPU with conditional rendering, so the
+ *  CPU never waits for a query.
+ ***********************************************************/
+class OcclusionCuller
+{
+public:
+	// visibility of an object decided for the current frame
+	enum VISIBILITY
+	{
+		// draw the object normally
+		OBJECT_VISIBLE,
+		// skip the object
+		OBJECT_OCCLUDED,
+		// draw the object inside a conditional render
+		OBJECT_CONDITIONAL
+	};
+
+	// constructor
+	OcclusionCuller(ShapeMeshes* pBasicMeshes);
+	// destructor
+	~OcclusionCuller();
+
+	// make sure there are queries for the passed in number of objects
+	void SetObjectCount(int count);
+
+	// decide if an object is drawn in the current frame
+	VISIBILITY GetVisibility(int index);
+	// start and finish drawing an object with the decided
+	// visibility
+	void BeginObject(int index, VISIBILITY visibility);
+	void EndObject(int index, VISIBILITY visibility);
+
+	// start the bounding box tests for the next frame
+	void BeginBoundsTests(glm::mat4 view, glm::mat4 projection);
+	// test the world space bounds of an object
+	void TestObjectBounds(int index, glm::vec3 boundsMin, glm::vec3 boundsMax);
+	// finish the bounding box tests and restore the render state
+	void EndBoundsTests();
+
+	// turn the culling on or off
+	void SetEnabled(bool bEnabled) { m_bEnabled = bEnabled; }
+	bool IsEnabled() { return(m_bEnabled); }
+
+private:
+	struct OBJECT_QUERIES
+	{
+		// one query per frame parity, so a query is never
+		// issued again before its result has been used
+		GLuint query[2];
+		bool bIssued[2];
+	};
+
+	// pointer to basic shapes object, the box mesh is used
+	// for drawing the bounds
+	ShapeMeshes* m_pBasicMeshes;
+	// shader for drawing the bounds without any shading
+	ShaderManager* m_pBoundsShader;
+	// queries for every scene object
+	std::vector<OBJECT_QUERIES> m_objectQueries;
+	// the query set written in the current frame
+	int m_currentQuerySet;
+	// camera position for the bounds tests
+	glm::vec3 m_cameraPosition;
+	bool m_bEnabled;
+};
@@ -0,0 +1,240 @@
+///////////////////////////////////////////////////////////////////////////////
+// raycast.cpp
+// ============
+// intersect rays with bounding boxes and the analytic basic shapes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RayCast.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of the global variables and defines
+namespace
+{
+	// rays closer to parallel than this miss flat surfaces
+	const float PARALLEL_EPSILON = 1.0e-8f;
+
+	/***********************************************************
+	 *  KeepNearest()
+	 *
+	 *  Keep the passed in hit distance when it is in front of
+	 *  the ray and nearer than the hit found so far.
+	 ***********************************************************/
+	void KeepNearest(float t, bool& bHit, float& distance)
+	{
+		if ((t >= 0.0f) && ((bHit == false) || (t < distance)))
+		{
+			distance = t;
+			bHit = true;
+		}
+	}
+
+	/***********************************************************
+	 *  IntersectDisk()
+	 *
+	 *  Intersect the ray with a horizontal disk at the passed
+	 *  in height.
+	 ***********************************************************/
+	void IntersectDisk(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float height,
+		float radius,
+		bool& bHit,
+		float& distance)
+	{
+		if ((radius <= 0.0f) || (std::fabs(direction.y) < PARALLEL_EPSILON))
+		{
+			return;
+		}
+
+		float t = (height - origin.y) / direction.y;
+		float x = origin.x + t * direction.x;
+		float z = origin.z + t * direction.z;
+		if ((x * x + z * z) <= (radius * radius))
+		{
+			KeepNearest(t, bHit, distance);
+		}
+	}
+}
+
+/***********************************************************
+ *  IntersectBounds()
+ *
+ *  This function is used for intersecting the ray with an
+ *  axis aligned box using the slab test.  A ray starting
+ *  inside the box hits it at distance 0.
+ ***********************************************************/
+bool RayCast::IntersectBounds(
+	const glm::vec3& origin,
+	const glm::vec3& inverseDirection,
+	const glm::vec3& boundsMin,
+	const glm::vec3& boundsMax,
+	float maxDistance,
+	float& distance)
+{
+	float tNear = 0.0f;
+	float tFar = maxDistance;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float t0 = (boundsMin[axis] - origin[axis]) * inverseDirection[axis];
+		float t1 = (boundsMax[axis] - origin[axis]) * inverseDirection[axis];
+		if (t0 > t1)
+		{
+			std::swap(t0, t1);
+		}
+
+		// written so a NaN from a ray lying in a slab plane
+		// leaves the range unchanged
+		tNear = (t0 > tNear) ? t0 : tNear;
+		tFar = (t1 < tFar) ? t1 : tFar;
+		if (tNear > tFar)
+		{
+			return(false);
+		}
+	}
+
+	distance = tNear;
+	return(true);
+}
+
+/***********************************************************
+ *  IntersectPlane()
+ *
+ *  This function is used for intersecting the ray with the
+ *  basic plane shape.
+ ***********************************************************/
+bool RayCast::IntersectPlane(const glm::vec3& origin, const glm::vec3& direction, float& distance)
+{
+	if (std::fabs(direction.y) < PARALLEL_EPSILON)
+	{
+		return(false);
+	}
+
+	float t = -origin.y / direction.y;
+	if (t < 0.0f)
+	{
+		return(false);
+	}
+
+	float x = origin.x + t * direction.x;
+	float z = origin.z + t * direction.z;
+	if ((std::fabs(x) > 1.0f) || (std::fabs(z) > 1.0f))
+	{
+		return(false);
+	}
+
+	distance = t;
+	return(true);
+}
+
+/***********************************************************
+ *  IntersectBox()
+ *
+ *  This function is used for intersecting the ray with the
+ *  basic box shape.
+ ***********************************************************/
+bool RayCast::IntersectBox(const glm::vec3& origin, const glm::vec3& direction, float& distance)
+{
+	glm::vec3 inverseDirection = 1.0f / direction;
+	return(IntersectBounds(
+		origin,
+		inverseDirection,
+		glm::vec3(-0.5f),
+		glm::vec3(0.5f),
+		INFINITY,
+		distance));
+}
+
+/***********************************************************
+ *  IntersectSphere()
+ *
+ *  This function is used for intersecting the ray with the
+ *  basic sphere shape.
+ ***********************************************************/
+bool RayCast::IntersectSphere(const glm::vec3& origin, const glm::vec3& direction, float& distance)
+{
+	float a = glm::dot(direction, direction);
+	float b = glm::dot(origin, direction);
+	float c = glm::dot(origin, origin) - 1.0f;
+
+	float discriminant = b * b - a * c;
+	if ((discriminant < 0.0f) || (a <= 0.0f))
+	{
+		return(false);
+	}
+
+	float root = std::sqrt(discriminant);
+	bool bHit = false;
+	KeepNearest((-b - root) / a, bHit, distance);
+	KeepNearest((-b + root) / a, bHit, distance);
+
+	return(bHit);
+}
+
+/***********************************************************
+ *  IntersectTaperedCylinder()
+ *
+ *  This function is used for intersecting the ray with a
+ *  shape whose radius changes linearly from the bottom to
+ *  the top.  The side is the quadric
+ *  x^2 + z^2 = (bottomRadius + slope * y)^2, cut at y = 0
+ *  and y = 1, and the ends are closed with disks.
+ ***********************************************************/
+bool RayCast::IntersectTaperedCylinder(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float bottomRadius,
+	float topRadius,
+	float& distance)
+{
+	float slope = topRadius - bottomRadius;
+	float originRadius = bottomRadius + slope * origin.y;
+
+	float a = direction.x * direction.x + direction.z * direction.z
+		- slope * slope * direction.y * direction.y;
+	float b = 2.0f * (origin.x * direction.x + origin.z * direction.z
+		- slope * direction.y * originRadius);
+	float c = origin.x * origin.x + origin.z * origin.z - originRadius * originRadius;
+
+	bool bHit = false;
+	float roots[2];
+	int rootCount = 0;
+
+	if (std::fabs(a) < PARALLEL_EPSILON)
+	{
+		// the ray runs parallel to a line of the side
+		if (std::fabs(b) >= PARALLEL_EPSILON)
+		{
+			roots[rootCount++] = -c / b;
+		}
+	}
+	else
+	{
+		float discriminant = b * b - 4.0f * a * c;
+		if (discriminant >= 0.0f)
+		{
+			float root = std::sqrt(discriminant);
+			roots[rootCount++] = (-b - root) / (2.0f * a);
+			roots[rootCount++] = (-b + root) / (2.0f * a);
+		}
+	}
+
+	for (int i = 0; i < rootCount; i++)
+	{
+		// the quadric continues past the ends and through the
+		// apex, only the part between the ends is the side
+		float y = origin.y + roots[i] * direction.y;
+		if ((y >= 0.0f) && (y <= 1.0f) && ((bottomRadius + slope * y) >= 0.0f))
+		{
+			KeepNearest(roots[i], bHit, distance);
+		}
+	}
+
+	IntersectDisk(origin, direction, 0.0f, bottomRadius, bHit, distance);
+	IntersectDisk(origin, direction, 1.0f, topRadius, bHit, distance);
+
+	return(bHit);
+}
@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////
+// raycast.h
+// ============
+// intersect rays with bounding boxes and the analytic basic shapes
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  RayCast
+ *
+ *  These functions intersect a ray, origin + t * direction,
+ *  with a bounding box or with one of the basic shapes in
+ *  its local space.  The direction does not need to be
+ *  normalized, so a ray moved into the local space of an
+ *  object keeps the same t for the same point.  Each test
+ *  returns true and the nearest t >= 0 when the ray hits.
+ ***********************************************************/
+namespace RayCast
+{
+	// axis aligned box - the inverse direction is passed in so
+	// it is only calculated once per ray
+	bool IntersectBounds(
+		const glm::vec3& origin,
+		const glm::vec3& inverseDirection,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax,
+		float maxDistance,
+		float& distance);
+
+	// square plane at y = 0 from -1 to 1 in x and z
+	bool IntersectPlane(const glm::vec3& origin, const glm::vec3& direction, float& distance);
+	// box from -0.5 to 0.5 on every axis
+	bool IntersectBox(const glm::vec3& origin, const glm::vec3& direction, float& distance);
+	// sphere of radius 1 around the origin
+	bool IntersectSphere(const glm::vec3& origin, const glm::vec3& direction, float& distance);
+	// closed shape standing on y = 0 and reaching y = 1, with
+	// the passed in radius at the bottom and the top - this
+	// covers the cylinder, the cone and the tapered cylinder
+	bool IntersectTaperedCylinder(
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float bottomRadius,
+		float topRadius,
+		float& distance);
+}
@@ -0,0 +1,427 @@
+///////////////////////////////////////////////////////////////////////////////
+// resolutionscaler.cpp
+// ============
+// render the scene at a scaled resolution chosen from the GPU frame time
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ResolutionScaler.h"
+#include "FrameStats.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of the global variables and defines
+namespace
+{
+	const char* g_SourceTextureName = "sourceTexture";
+
+	// texture unit of the scene while it is upscaled - past
+	// the units used by the scene textures and shadow maps
+	const int UPSCALE_TEXTURE_UNIT = 16;
+
+	// default bounds of the resolution scale
+	const float DEFAULT_MIN_SCALE = 0.5f;
+	const float DEFAULT_MAX_SCALE = 1.0f;
+	// the scale is kept to multiples of this step, so that
+	// small changes in the frame time do not resize the scene
+	const float SCALE_STEP = 0.05f;
+	// largest change of the scale at once
+	const float MAX_SCALE_DECREASE = 0.15f;
+	const float MAX_SCALE_INCREASE = 0.05f;
+
+	// hysteresis - the scale is lowered after a few frames
+	// over the target time, and only raised after many frames
+	// well under it, so it does not flip between two values
+	const double OVER_TARGET_FRACTION = 1.0;
+	const double UNDER_TARGET_FRACTION = 0.8;
+	const int FRAMES_BEFORE_DECREASE = 3;
+	const int FRAMES_BEFORE_INCREASE = 30;
+
+	// weight of a new measurement in the smoothed frame time
+	const double FRAME_TIME_SMOOTHING = 0.25;
+
+	// sharpening applied at the lowest scale, it fades out
+	// towards the window resolution
+	const float MAX_SHARPNESS = 0.5f;
+}
+
+/***********************************************************
+ *  ResolutionScaler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ResolutionScaler::ResolutionScaler()
+{
+	m_framebuffer = 0;
+	m_colorTexture = 0;
+	m_depthRenderbuffer = 0;
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_windowWidth = 1;
+	m_windowHeight = 1;
+	m_renderWidth = 1;
+	m_renderHeight = 1;
+
+	m_currentTimer = 0;
+	m_bTimingFrame = false;
+	for (int i = 0; i < TIMER_FRAMES; i++)
+	{
+		glGenQueries(2, m_timers[i].queries);
+		m_timers[i].bPending = false;
+	}
+
+	m_bEnabled = true;
+	m_minScale = DEFAULT_MIN_SCALE;
+	m_maxScale = DEFAULT_MAX_SCALE;
+	m_scale = m_maxScale;
+	m_targetMilliseconds = 1000.0 / 60.0;
+	m_smoothedMilliseconds = 0.0;
+	m_framesOver = 0;
+	m_framesUnder = 0;
+	m_settleFrames = 0;
+
+	m_pUpscaleShader = new ShaderManager();
+	m_pUpscaleShader->LoadShaders(
+		"shaders/upscaleVertexShader.glsl",
+		"shaders/upscaleFragmentShader.glsl");
+
+	// the fullscreen triangle is made in the vertex shader, but
+	// a vertex array still has to be bound for drawing
+	glGenVertexArrays(1, &m_vertexArray);
+}
+
+/***********************************************************
+ *  ~ResolutionScaler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ResolutionScaler::~ResolutionScaler()
+{
+	for (int i = 0; i < TIMER_FRAMES; i++)
+	{
+		glDeleteQueries(2, m_timers[i].queries);
+	}
+
+	if (m_framebuffer != 0)
+	{
+		ResourceTracker::Release(ResourceTracker::RESOURCE_TEXTURE, m_colorTexture);
+		ResourceTracker::Release(ResourceTracker::RESOURCE_RENDERBUFFER, m_depthRenderbuffer);
+		glDeleteFramebuffers(1, &m_framebuffer);
+		glDeleteTextures(1, &m_colorTexture);
+		glDeleteRenderbuffers(1, &m_depthRenderbuffer);
+	}
+	glDeleteVertexArrays(1, &m_vertexArray);
+
+	if (NULL != m_pUpscaleShader)
+	{
+		delete m_pUpscaleShader;
+		m_pUpscaleShader = NULL;
+	}
+}
+
+/***********************************************************
+ *  ResizeTarget()
+ *
+ *  This method is used for creating the offscreen target
+ *  again when the window needs a different size.  The
+ *  target is sized for the highest scale, and lower scales
+ *  only draw into part of it, so changing the scale never
+ *  creates a new target.
+ ***********************************************************/
+void ResolutionScaler::ResizeTarget(int width, int height)
+{
+	if ((width == m_targetWidth) && (height == m_targetHeight))
+	{
+		return;
+	}
+
+	if (m_framebuffer == 0)
+	{
+		glGenFramebuffers(1, &m_framebuffer);
+		glGenTextures(1, &m_colorTexture);
+		glGenRenderbuffers(1, &m_depthRenderbuffer);
+	}
+
+	GLState::ActiveTexture(GL_TEXTURE0 + UPSCALE_TEXTURE_UNIT);
+	GLState::BindTexture(GL_TEXTURE_2D, m_colorTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLState::ActiveTexture(GL_TEXTURE0);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
+
+	m_targetWidth = width;
+	m_targetHeight = height;
+
+	// the resized target replaces the records of the old size
+	ResourceTracker::Track(ResourceTracker::RESOURCE_TEXTURE, m_colorTexture,
+		ResourceTracker::GetTextureBytes(width, height, 1, 4, false),
+		ResourceTracker::CATEGORY_RENDER_TARGET, "scaled color target");
+	ResourceTracker::Track(ResourceTracker::RESOURCE_RENDERBUFFER, m_depthRenderbuffer,
+		ResourceTracker::GetTextureBytes(width, height, 1, 4, false),
+		ResourceTracker::CATEGORY_RENDER_TARGET, "scaled depth target");
+
+	FrameStats::SetBytes("scaled render target memory",
+		static_cast<size_t>(width) * static_cast<size_t>(height) * 8);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for binding the offscreen target and
+ *  the viewport of the scaled scene, and for starting the
+ *  GPU timing of the frame.
+ ***********************************************************/
+void ResolutionScaler::BeginFrame(GLFWwindow* window)
+{
+	int width = 0;
+	int height = 0;
+	glfwGetFramebufferSize(window, &width, &height);
+	m_windowWidth = std::max(width, 1);
+	m_windowHeight = std::max(height, 1);
+
+	ResizeTarget(
+		static_cast<int>(std::ceil(m_windowWidth * m_maxScale)),
+		static_cast<int>(std::ceil(m_windowHeight * m_maxScale)));
+
+	CollectTimerQueries();
+
+	m_renderWidth = std::min(std::max(
+		static_cast<int>(m_windowWidth * m_scale + 0.5f), 1), m_targetWidth);
+	m_renderHeight = std::min(std::max(
+		static_cast<int>(m_windowHeight * m_scale + 0.5f), 1), m_targetHeight);
+
+	// a frame is only timed when its timestamps are free, so
+	// the CPU never waits for a result
+	m_bTimingFrame = (m_timers[m_currentTimer].bPending == false);
+	if (m_bTimingFrame == true)
+	{
+		glQueryCounter(m_timers[m_currentTimer].queries[0], GL_TIMESTAMP);
+	}
+
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	GLState::Viewport(0, 0, m_renderWidth, m_renderHeight);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for drawing the scaled scene into
+ *  the window.  A scene at the window resolution is copied
+ *  with a blit, a smaller one is upscaled and sharpened.
+ ***********************************************************/
+void ResolutionScaler::EndFrame()
+{
+	GLState::Disable(GL_DEPTH_TEST);
+
+	if ((m_renderWidth == m_windowWidth) && (m_renderHeight == m_windowHeight))
+	{
+		GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+		GLState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		glBlitFramebuffer(
+			0, 0, m_renderWidth, m_renderHeight,
+			0, 0, m_windowWidth, m_windowHeight,
+			GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	}
+	else
+	{
+		GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+		GLState::Viewport(0, 0, m_windowWidth, m_windowHeight);
+
+		GLState::ActiveTexture(GL_TEXTURE0 + UPSCALE_TEXTURE_UNIT);
+		GLState::BindTexture(GL_TEXTURE_2D, m_colorTexture);
+		GLState::ActiveTexture(GL_TEXTURE0);
+
+		// sharpen more the further the scene was scaled down
+		float sharpness = MAX_SHARPNESS *
+			std::min(std::max((1.0f / m_scale) - 1.0f, 0.0f), 1.0f);
+
+		GLState::UseShader(m_pUpscaleShader);
+		GLState::SetSampler(m_pUpscaleShader, g_SourceTextureName, UPSCALE_TEXTURE_UNIT);
+		GLState::SetUniform(m_pUpscaleShader, "sourceScale", glm::vec2(
+			static_cast<float>(m_renderWidth) / m_targetWidth,
+			static_cast<float>(m_renderHeight) / m_targetHeight));
+		GLState::SetUniform(m_pUpscaleShader, "sourceTexelSize", glm::vec2(
+			1.0f / m_targetWidth,
+			1.0f / m_targetHeight));
+		GLState::SetUniform(m_pUpscaleShader, "sharpness", sharpness);
+
+		GLState::BindVertexArray(m_vertexArray);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+
+	if (m_bTimingFrame == true)
+	{
+		glQueryCounter(m_timers[m_currentTimer].queries[1], GL_TIMESTAMP);
+		m_timers[m_currentTimer].bPending = true;
+	}
+	m_currentTimer = (m_currentTimer + 1) % TIMER_FRAMES;
+
+	FrameStats::SetValue("resolution scale", m_scale);
+	FrameStats::SetValue("render width", m_renderWidth);
+	FrameStats::SetValue("render height", m_renderHeight);
+}
+
+/***********************************************************
+ *  CollectTimerQueries()
+ *
+ *  This method is used for reading back the frame timers
+ *  that have finished, oldest first, without waiting on the
+ *  ones that have not.
+ ***********************************************************/
+void ResolutionScaler::CollectTimerQueries()
+{
+	for (int i = 0; i < TIMER_FRAMES; i++)
+	{
+		FRAME_TIMER& timer = m_timers[(m_currentTimer + i) % TIMER_FRAMES];
+		if (timer.bPending == false)
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(timer.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == 0)
+		{
+			// the later frames can't have finished either
+			return;
+		}
+
+		GLuint64 start = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(timer.queries[0], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(timer.queries[1], GL_QUERY_RESULT, &end);
+		timer.bPending = false;
+
+		UpdateScale(static_cast<double>(end - start) / 1000000.0);
+	}
+}
+
+/***********************************************************
+ *  UpdateScale()
+ *
+ *  This method is used for choosing the resolution scale
+ *  from a measured GPU frame time.  The GPU time is taken to
+ *  follow the number of pixels, so the scale changes with
+ *  the square root of the time ratio.
+ ***********************************************************/
+void ResolutionScaler::UpdateScale(double gpuMilliseconds)
+{
+	if (m_smoothedMilliseconds <= 0.0)
+	{
+		m_smoothedMilliseconds = gpuMilliseconds;
+	}
+	else
+	{
+		m_smoothedMilliseconds +=
+			(gpuMilliseconds - m_smoothedMilliseconds) * FRAME_TIME_SMOOTHING;
+	}
+	FrameStats::SetMilliseconds("GPU frame time", m_smoothedMilliseconds);
+
+	// the frames in flight at the last change were rendered
+	// at the old scale
+	if (m_settleFrames > 0)
+	{
+		m_settleFrames--;
+		return;
+	}
+
+	if (m_bEnabled == false)
+	{
+		return;
+	}
+
+	if (m_smoothedMilliseconds > (m_targetMilliseconds * OVER_TARGET_FRACTION))
+	{
+		m_framesOver++;
+		m_framesUnder = 0;
+	}
+	else if (m_smoothedMilliseconds < (m_targetMilliseconds * UNDER_TARGET_FRACTION))
+	{
+		m_framesUnder++;
+		m_framesOver = 0;
+	}
+	else
+	{
+		m_framesOver = 0;
+		m_framesUnder = 0;
+	}
+
+	if ((m_framesOver < FRAMES_BEFORE_DECREASE) && (m_framesUnder < FRAMES_BEFORE_INCREASE))
+	{
+		return;
+	}
+
+	float ratio = static_cast<float>(std::sqrt(m_targetMilliseconds / m_smoothedMilliseconds));
+	float scale = m_scale * ratio;
+	scale = std::min(std::max(scale, m_scale - MAX_SCALE_DECREASE), m_scale + MAX_SCALE_INCREASE);
+	// round down, so an increase never lands back over the
+	// target - the small bias keeps exact steps from rounding
+	// down a whole step
+	scale = std::floor((scale / SCALE_STEP) + 0.001f) * SCALE_STEP;
+	scale = std::min(std::max(scale, m_minScale), m_maxScale);
+
+	m_framesOver = 0;
+	m_framesUnder = 0;
+	if (scale != m_scale)
+	{
+		m_scale = scale;
+		m_settleFrames = TIMER_FRAMES;
+	}
+}
+
+/***********************************************************
+ *  SetTargetFrameTime()
+ *
+ *  This method is used for setting the GPU time per frame,
+ *  in milliseconds, that the resolution scale should hold.
+ ***********************************************************/
+void ResolutionScaler::SetTargetFrameTime(double milliseconds)
+{
+	if (milliseconds > 0.0)
+	{
+		m_targetMilliseconds = milliseconds;
+	}
+}
+
+/***********************************************************
+ *  SetScaleBounds()
+ *
+ *  This method is used for setting the lowest and highest
+ *  resolution scale.
+ ***********************************************************/
+void ResolutionScaler::SetScaleBounds(float minScale, float maxScale)
+{
+	m_maxScale = std::min(std::max(maxScale, SCALE_STEP), 1.0f);
+	m_minScale = std::min(std::max(minScale, SCALE_STEP), m_maxScale);
+	m_scale = std::min(std::max(m_scale, m_minScale), m_maxScale);
+}
+
+/***********************************************************
+ *  SetEnabled()
+ *
+ *  This method is used for turning the scale adjustment on
+ *  or off.  While it is off the scene is drawn at the
+ *  highest scale.
+ ***********************************************************/
+void ResolutionScaler::SetEnabled(bool bEnabled)
+{
+	m_bEnabled = bEnabled;
+	if (m_bEnabled == false)
+	{
+		m_scale = m_maxScale;
+	}
+	m_framesOver = 0;
+	m_framesUnder = 0;
+}
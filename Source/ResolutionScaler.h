@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// resolutionscaler.h
+// ============
+// render the scene at a scaled resolution chosen from the GPU frame time
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+// GLFW library
+#include "GLFW/glfw3.h"
+
+/***********************************************************
+ *  ResolutionScaler
+ *
+ *  This class owns an offscreen target the scene is drawn
+ *  into at a fraction of the window resolution.  The GPU
+ *  time of each frame is measured with timestamp queries,
+ *  and the scale is lowered when the frames go over the
+ *  target time and raised again when they stay well under
+ *  it.  The scene is then upscaled to the window with a
+ *  sharpening filter that makes up for the lost detail.
+ ***********************************************************/
+class ResolutionScaler
+{
+public:
+	// constructor
+	ResolutionScaler();
+	// destructor
+	~ResolutionScaler();
+
+	// bind the offscreen target and the scaled viewport
+	void BeginFrame(GLFWwindow* window);
+	// upscale the offscreen target to the window
+	void EndFrame();
+
+	// set the GPU time the scale is adjusted to hold
+	void SetTargetFrameTime(double milliseconds);
+	// set the lowest and highest resolution scale
+	void SetScaleBounds(float minScale, float maxScale);
+	// turn the scale adjustment on or off - when off the
+	// highest scale is used
+	void SetEnabled(bool bEnabled);
+
+	// get the resolution scale of the current frame
+	float GetScale() const { return(m_scale); }
+
+private:
+	// number of frames of timestamps in flight
+	static const int TIMER_FRAMES = 4;
+
+	struct FRAME_TIMER
+	{
+		// timestamps at the start and the end of the frame
+		GLuint queries[2];
+		bool bPending;
+	};
+
+	// make the offscreen target large enough for the window
+	void ResizeTarget(int width, int height);
+	// read back the finished frame timers
+	void CollectTimerQueries();
+	// choose the scale for the next frames
+	void UpdateScale(double gpuMilliseconds);
+
+	// shader for upscaling and sharpening the scene
+	ShaderManager* m_pUpscaleShader;
+	// empty vertex array for the fullscreen triangle
+	GLuint m_vertexArray;
+	// offscreen target, sized for the highest scale
+	GLuint m_framebuffer;
+	GLuint m_colorTexture;
+	GLuint m_depthRenderbuffer;
+	int m_targetWidth;
+	int m_targetHeight;
+	// size of the window and of the scaled scene
+	int m_windowWidth;
+	int m_windowHeight;
+	int m_renderWidth;
+	int m_renderHeight;
+
+	FRAME_TIMER m_timers[TIMER_FRAMES];
+	int m_currentTimer;
+	// whether the current frame is being timed
+	bool m_bTimingFrame;
+
+	bool m_bEnabled;
+	float m_scale;
+	float m_minScale;
+	float m_maxScale;
+	double m_targetMilliseconds;
+	// smoothed GPU frame time, 0 until a frame was measured
+	double m_smoothedMilliseconds;
+	// measured frames in a row over and under the target
+	int m_framesOver;
+	int m_framesUnder;
+	// measured frames left to ignore after a scale change
+	int m_settleFrames;
+};
@@ -0,0 +1,397 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourcetracker.cpp
+// ============
+// account for the GPU and CPU memory held by textures, meshes and buffers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ResourceTracker.h"
+#include "FrameStats.h"
+#include "Logger.h"
+
+#include <map>
+#include <utility>
+
+// declaration of the global variables and defines
+namespace
+{
+	struct RESOURCE_RECORD
+	{
+		size_t bytes;
+		ResourceTracker::CATEGORY category;
+		const char* owner;
+	};
+
+	typedef std::pair<int, uintptr_t> RESOURCE_KEY;
+
+	// the live resources - records are only added and removed
+	// when resources are created and freed, never per frame
+	std::map<RESOURCE_KEY, RESOURCE_RECORD> g_Resources;
+
+	size_t g_CategoryBytes[ResourceTracker::CATEGORY_COUNT] = { 0 };
+	int g_CategoryCounts[ResourceTracker::CATEGORY_COUNT] = { 0 };
+	size_t g_GPUBytes = 0;
+	size_t g_CPUBytes = 0;
+	size_t g_PeakGPUBytes = 0;
+	size_t g_PeakCPUBytes = 0;
+
+	// budgets, 0 when there is no budget
+	size_t g_GPUBudget = 0;
+	size_t g_CPUBudget = 0;
+	// set while over a budget, so the warning is only
+	// printed when the budget is first crossed
+	bool g_bGPUOverBudget = false;
+	bool g_bCPUOverBudget = false;
+
+	const char* g_TypeNames[] =
+	{
+		"texture",
+		"buffer",
+		"renderbuffer",
+		"cpu block"
+	};
+
+	const char* g_CategoryNames[ResourceTracker::CATEGORY_COUNT] =
+	{
+		"scene textures",
+		"meshes",
+		"upload buffers",
+		"render targets",
+		"shadow maps",
+		"scene data",
+		"asset staging",
+		"readback buffers"
+	};
+
+	const char* g_CategoryStatNames[ResourceTracker::CATEGORY_COUNT] =
+	{
+		"memory scene textures",
+		"memory meshes",
+		"memory upload buffers",
+		"memory render targets",
+		"memory shadow maps",
+		"memory scene data (cpu)",
+		"memory asset staging (cpu)",
+		"memory readback buffers"
+	};
+
+	/***********************************************************
+	 *  ToMegabytes()
+	 *
+	 *  Convert a size in bytes into megabytes for printing.
+	 ***********************************************************/
+	double ToMegabytes(size_t bytes)
+	{
+		return(bytes / (1024.0 * 1024.0));
+	}
+
+	/***********************************************************
+	 *  CheckBudget()
+	 *
+	 *  Check a total against its budget, and warn when it
+	 *  crosses the budget.
+	 ***********************************************************/
+	bool CheckBudget(size_t used, size_t budget, bool& bOverBudget, const char* memoryName, const char* owner)
+	{
+		if ((budget == 0) || (used <= budget))
+		{
+			bOverBudget = false;
+			return(true);
+		}
+
+		if (bOverBudget == false)
+		{
+			LOG_WARNING(memoryName << " memory over budget, "
+				<< ToMegabytes(used) << " MB of " << ToMegabytes(budget)
+				<< " MB after allocating " << owner);
+			bOverBudget = true;
+		}
+
+		return(false);
+	}
+}
+
+/***********************************************************
+ *  Track()
+ *
+ *  This function is used for recording an allocation.  A
+ *  resource that is tracked again, like a render target
+ *  that was resized, replaces its earlier record.
+ ***********************************************************/
+bool ResourceTracker::Track(RESOURCE_TYPE type, uintptr_t id, size_t bytes, CATEGORY category, const char* owner)
+{
+	RESOURCE_KEY key(static_cast<int>(type), id);
+	std::map<RESOURCE_KEY, RESOURCE_RECORD>::iterator existing = g_Resources.find(key);
+	if (existing != g_Resources.end())
+	{
+		Release(type, id);
+	}
+
+	RESOURCE_RECORD record;
+	record.bytes = bytes;
+	record.category = category;
+	record.owner = owner;
+	g_Resources[key] = record;
+
+	g_CategoryBytes[category] += bytes;
+	g_CategoryCounts[category]++;
+
+	if (type == RESOURCE_CPU)
+	{
+		g_CPUBytes += bytes;
+		if (g_CPUBytes > g_PeakCPUBytes)
+		{
+			g_PeakCPUBytes = g_CPUBytes;
+		}
+		return(CheckBudget(g_CPUBytes, g_CPUBudget, g_bCPUOverBudget, "CPU", owner));
+	}
+
+	g_GPUBytes += bytes;
+	if (g_GPUBytes > g_PeakGPUBytes)
+	{
+		g_PeakGPUBytes = g_GPUBytes;
+	}
+	return(CheckBudget(g_GPUBytes, g_GPUBudget, g_bGPUOverBudget, "GPU", owner));
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This function is used for removing the record of a freed
+ *  resource.  Resources that were never tracked, like the
+ *  0 name, are ignored.
+ ***********************************************************/
+void ResourceTracker::Release(RESOURCE_TYPE type, uintptr_t id)
+{
+	std::map<RESOURCE_KEY, RESOURCE_RECORD>::iterator existing =
+		g_Resources.find(RESOURCE_KEY(static_cast<int>(type), id));
+	if (existing == g_Resources.end())
+	{
+		return;
+	}
+
+	const RESOURCE_RECORD& record = existing->second;
+	g_CategoryBytes[record.category] -= record.bytes;
+	g_CategoryCounts[record.category]--;
+	if (type == RESOURCE_CPU)
+	{
+		g_CPUBytes -= record.bytes;
+	}
+	else
+	{
+		g_GPUBytes -= record.bytes;
+	}
+
+	g_Resources.erase(existing);
+}
+
+/***********************************************************
+ *  FitsBudget()
+ *
+ *  This function is used for checking whether an optional
+ *  allocation, like a scene texture, still fits into the
+ *  budget, so it can be skipped instead of made.
+ ***********************************************************/
+bool ResourceTracker::FitsBudget(RESOURCE_TYPE type, size_t bytes)
+{
+	if (type == RESOURCE_CPU)
+	{
+		return((g_CPUBudget == 0) || ((g_CPUBytes + bytes) <= g_CPUBudget));
+	}
+
+	return((g_GPUBudget == 0) || ((g_GPUBytes + bytes) <= g_GPUBudget));
+}
+
+/***********************************************************
+ *  SetGPUBudget()
+ *
+ *  This function is used for setting the budget of the
+ *  textures, buffers and renderbuffers.
+ ***********************************************************/
+void ResourceTracker::SetGPUBudget(size_t bytes)
+{
+	g_GPUBudget = bytes;
+}
+
+/***********************************************************
+ *  SetCPUBudget()
+ *
+ *  This function is used for setting the budget of the
+ *  tracked CPU blocks.
+ ***********************************************************/
+void ResourceTracker::SetCPUBudget(size_t bytes)
+{
+	g_CPUBudget = bytes;
+}
+
+/***********************************************************
+ *  GetCategoryBytes()
+ *
+ *  This function is used for getting the memory held by
+ *  the resources of a category.
+ ***********************************************************/
+size_t ResourceTracker::GetCategoryBytes(CATEGORY category)
+{
+	if ((category < 0) || (category >= CATEGORY_COUNT))
+	{
+		return(0);
+	}
+
+	return(g_CategoryBytes[category]);
+}
+
+/***********************************************************
+ *  GetGPUBytes()
+ *
+ *  This function is used for getting the memory held by the
+ *  tracked OpenGL resources.
+ ***********************************************************/
+size_t ResourceTracker::GetGPUBytes()
+{
+	return(g_GPUBytes);
+}
+
+/***********************************************************
+ *  GetCPUBytes()
+ *
+ *  This function is used for getting the memory held by the
+ *  tracked CPU blocks.
+ ***********************************************************/
+size_t ResourceTracker::GetCPUBytes()
+{
+	return(g_CPUBytes);
+}
+
+/***********************************************************
+ *  GetPeakGPUBytes()
+ *
+ *  This function is used for getting the highest memory the
+ *  tracked OpenGL resources held at one time.
+ ***********************************************************/
+size_t ResourceTracker::GetPeakGPUBytes()
+{
+	return(g_PeakGPUBytes);
+}
+
+/***********************************************************
+ *  GetPeakCPUBytes()
+ *
+ *  This function is used for getting the highest memory the
+ *  tracked CPU blocks held at one time.
+ ***********************************************************/
+size_t ResourceTracker::GetPeakCPUBytes()
+{
+	return(g_PeakCPUBytes);
+}
+
+/***********************************************************
+ *  GetResourceCount()
+ *
+ *  This function is used for getting the number of live
+ *  tracked resources.
+ ***********************************************************/
+int ResourceTracker::GetResourceCount()
+{
+	return(static_cast<int>(g_Resources.size()));
+}
+
+/***********************************************************
+ *  GetTextureBytes()
+ *
+ *  This function is used for calculating the size of a
+ *  texture, adding every mip level down to 1x1 when the
+ *  texture has mipmaps.
+ ***********************************************************/
+size_t ResourceTracker::GetTextureBytes(int width, int height, int layers, int bytesPerTexel, bool bMipmaps)
+{
+	size_t bytes = 0;
+
+	while ((width > 0) && (height > 0))
+	{
+		bytes += static_cast<size_t>(width) * static_cast<size_t>(height) *
+			static_cast<size_t>(layers) * static_cast<size_t>(bytesPerTexel);
+		if ((bMipmaps == false) || ((width == 1) && (height == 1)))
+		{
+			break;
+		}
+		width = (width > 1) ? (width / 2) : 1;
+		height = (height > 1) ? (height / 2) : 1;
+	}
+
+	return(bytes);
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  This function is used for printing the memory of every
+ *  category with the totals, peaks and budgets.
+ ***********************************************************/
+void ResourceTracker::PrintReport()
+{
+	// the totals are put together into one message, which is
+	// queued when it goes out of scope
+	{
+		Logger::LogMessage totals(Logger::LEVEL_INFO);
+		totals << "MEMORY: " << g_Resources.size() << " resources, GPU "
+			<< ToMegabytes(g_GPUBytes) << " MB (peak " << ToMegabytes(g_PeakGPUBytes) << " MB";
+		if (g_GPUBudget > 0)
+		{
+			totals << ", budget " << ToMegabytes(g_GPUBudget) << " MB";
+		}
+		totals << "), CPU " << ToMegabytes(g_CPUBytes) << " MB (peak " << ToMegabytes(g_PeakCPUBytes) << " MB";
+		if (g_CPUBudget > 0)
+		{
+			totals << ", budget " << ToMegabytes(g_CPUBudget) << " MB";
+		}
+		totals << ")";
+	}
+
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		LOG_INFO("    " << g_CategoryNames[i] << ": " << g_CategoryCounts[i]
+			<< " resources, " << ToMegabytes(g_CategoryBytes[i]) << " MB");
+	}
+}
+
+/***********************************************************
+ *  ReportLeaks()
+ *
+ *  This function is used for printing every resource that
+ *  is still tracked.  Called after everything was freed at
+ *  shutdown, each of them is a leak.
+ ***********************************************************/
+int ResourceTracker::ReportLeaks()
+{
+	std::map<RESOURCE_KEY, RESOURCE_RECORD>::const_iterator it;
+	for (it = g_Resources.begin(); it != g_Resources.end(); ++it)
+	{
+		LOG_INFO("LEAK: " << g_TypeNames[it->first.first] << " " << it->first.second
+			<< " of " << it->second.owner << " (" << g_CategoryNames[it->second.category]
+			<< "), " << it->second.bytes << " bytes");
+	}
+
+	if (g_Resources.empty() == false)
+	{
+		LOG_INFO("LEAK: " << g_Resources.size() << " resources holding "
+			<< ToMegabytes(g_GPUBytes) << " MB GPU and " << ToMegabytes(g_CPUBytes)
+			<< " MB CPU memory were not freed");
+	}
+
+	return(static_cast<int>(g_Resources.size()));
+}
+
+/***********************************************************
+ *  UpdateFrameStats()
+ *
+ *  This function is used for publishing the memory of every
+ *  category and the totals.
+ ***********************************************************/
+void ResourceTracker::UpdateFrameStats()
+{
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		FrameStats::SetBytes(g_CategoryStatNames[i], g_CategoryBytes[i]);
+	}
+	FrameStats::SetBytes("memory total gpu", g_GPUBytes);
+	FrameStats::SetBytes("memory total cpu", g_CPUBytes);
+}
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourcetracker.h
+// ============
+// account for the GPU and CPU memory held by textures, meshes and buffers
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  ResourceTracker
+ *
+ *  These functions keep a record of every OpenGL texture,
+ *  buffer and renderbuffer the project allocates, and of
+ *  the larger CPU side blocks, with its size, category and
+ *  owner.  The totals can be held to a budget, are
+ *  published to the frame stats, and the records still
+ *  alive at shutdown are reported as leaks.
+ *
+ *  The owner names must be string literals or other strings
+ *  that stay alive for the whole run, since only the
+ *  pointers are stored.  Memory allocated inside ShapeMeshes
+ *  is not visible to the tracker.
+ ***********************************************************/
+namespace ResourceTracker
+{
+	// kind of a tracked resource - the ids of each kind are
+	// separate, CPU blocks use their address as the id
+	enum RESOURCE_TYPE
+	{
+		RESOURCE_TEXTURE,
+		RESOURCE_BUFFER,
+		RESOURCE_RENDERBUFFER,
+		RESOURCE_CPU
+	};
+
+	// what a resource is used for
+	enum CATEGORY
+	{
+		CATEGORY_SCENE_TEXTURE,
+		CATEGORY_MESH,
+		CATEGORY_UPLOAD_BUFFER,
+		CATEGORY_RENDER_TARGET,
+		CATEGORY_SHADOW_MAP,
+		CATEGORY_SCENE_DATA,
+		CATEGORY_ASSET_STAGING,
+		CATEGORY_READBACK,
+		CATEGORY_COUNT
+	};
+
+	// record an allocation, replacing the record of the same
+	// resource - returns false when it went over the budget
+	bool Track(RESOURCE_TYPE type, uintptr_t id, size_t bytes, CATEGORY category, const char* owner);
+	// remove the record of a freed resource
+	void Release(RESOURCE_TYPE type, uintptr_t id);
+	// check whether an allocation fits into the budget
+	// before making it
+	bool FitsBudget(RESOURCE_TYPE type, size_t bytes);
+
+	// set the memory budgets in bytes, 0 for no budget
+	void SetGPUBudget(size_t bytes);
+	void SetCPUBudget(size_t bytes);
+
+	// current and highest memory use
+	size_t GetCategoryBytes(CATEGORY category);
+	size_t GetGPUBytes();
+	size_t GetCPUBytes();
+	size_t GetPeakGPUBytes();
+	size_t GetPeakCPUBytes();
+	int GetResourceCount();
+
+	// size of a texture with the passed in texel size, with
+	// or without its whole mip chain
+	size_t GetTextureBytes(int width, int height, int layers, int bytesPerTexel, bool bMipmaps);
+
+	// print the memory of every category
+	void PrintReport();
+	// print the resources that were never released and
+	// return their number
+	int ReportLeaks();
+	// publish the memory of every category to the frame stats
+	void UpdateFrameStats();
+}
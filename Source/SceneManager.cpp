@@ -8,6 +8,17 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "MeshGenerator.h"
+#include "MeshOptimizer.h"
+#include "FramePacer.h"
+#include "GLState.h"
+#include "FrameStats.h"
+#include "RayCast.h"
+#include "AssetPackWriter.h"
+#include "ResourceTracker.h"
+#include "LightBaker.h"
+#include "MeshImporter.h"
+#include "Logger.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -15,6 +26,11 @@
 #endif
 
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 // declaration of global variables
 namespace
@@ -24,8 +40,180 @@ namespace
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_ObjectDataBlockName = "ObjectData";
+	const char* g_FirstViewName = "firstView";
+	const char* g_ViewportArrayName = "bViewportArray";
+
+	// uniform buffer binding point of the per-object values
+	const GLuint g_ObjectDataBinding = 0;
+	// the per-object values of up to 1024 draws per frame, the
+	// buffer grows when there are more dynamic objects
+	const GLsizeiptr g_ObjectDataFrameSize = 1024 * 256;
+	// number of frames the CPU may run ahead of the GPU
+	const int g_FramesInFlight = 3;
+
+	// an image file of the scene and the tag its texture is
+	// found by
+	struct TEXTURE_FILE
+	{
+		const char* filename;
+		const char* tag;
+	};
+
+	// the textures loaded from the loose image files - the
+	// textures of each size and format share a texture array,
+	// and up to 14 arrays fit below the shadow map slots
+	const TEXTURE_FILE g_SceneTextureFiles[] =
+	{
+		{ "textures/deskTop.jpg", "deskTop" },
+		{ "textures/deskRod.jpg", "deskRod" },
+		{ "textures/deskRim.jpg", "deskRim" },
+		{ "textures/granite.jpg", "quartz" },
+		{ "textures/copper.jpg", "copper" },
+		{ "textures/pencil.jpg", "pencil" },
+		{ "textures/erase.jpg", "erase" },
+		{ "textures/grain.jpg", "grain" }
+	};
+	const int g_SceneTextureFileCount = sizeof(g_SceneTextureFiles) / sizeof(g_SceneTextureFiles[0]);
+
+	// bounds of the basic meshes in their own space, in the
+	// order of SceneManager::MESH_TYPE - the cylinders and the
+	// cone stand on the origin
+	constexpr StaticScene::LOCAL_BOUNDS g_MeshBounds[] =
+	{
+		{ { -1.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 1.0f } },     // plane
+		{ { -0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, 0.5f } },    // box
+		{ { -1.0f, 0.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } },     // cylinder
+		{ { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } },    // sphere
+		{ { -1.0f, 0.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } },     // cone
+		{ { -1.0f, 0.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } }      // tapered cylinder
+	};
+	static_assert(sizeof(g_MeshBounds) / sizeof(g_MeshBounds[0]) == SceneManager::TAPERED_CYLINDER_MESH + 1,
+		"every basic mesh needs its bounds");
+
+	// the desk scene - tag, mesh, scale, rotation in degrees
+	// around x, y and z, position, color, texture, UV scale,
+	// material and the library mesh drawn instead of the
+	// basic mesh
+	constexpr StaticScene::OBJECT g_DeskSceneObjects[] =
+	{
+		// Floor
+		{ "floor", SceneManager::PLANE_MESH, { 30.0f, 1.0f, 30.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f },
+			{ 1.0f, 1.0f, 1.0f, 1.0f }, "quartz", { 1.0f, 1.0f }, "shiny", NULL },
+		// Back wall
+		{ "back wall", SceneManager::PLANE_MESH, { 30.0f, 1.0f, 30.0f }, { 90.0f, 0.0f, 0.0f }, { 0.0f, 30.0f, -30.0f },
+			{ 1.0f, 1.0f, 1.0f, 1.0f }, "quartz", { 1.0f, 1.0f }, "shiny", NULL },
+		// Lower box for desk
+		{ "desk", SceneManager::BOX_MESH, { 25.0f, 2.0f, 15.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 10.0f, 0.0f },
+			{ 0.65f, 0.16f, 0.16f, 1.0f }, "deskRim", { 1.0f, 1.0f }, "nonReflective", NULL },
+		// Top box for desk
+		{ "desk top", SceneManager::BOX_MESH, { 25.5f, 0.5f, 15.5f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 11.0f, 0.0f },
+			{ 0.65f, 0.16f, 0.16f, 1.0f }, "deskTop", { 1.0f, 1.0f }, "nonReflective", NULL },
+		// Right leg backward
+		{ "desk leg", SceneManager::CYLINDER_MESH, { 1.0f, 10.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 10.0f, 0.0f, -5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "deskRod", { 2.0f, 2.0f }, "shiny", NULL },
+		// Right leg forward
+		{ "desk leg", SceneManager::CYLINDER_MESH, { 1.0f, 10.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 10.0f, 0.0f, 5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "deskRod", { 2.0f, 2.0f }, "shiny", NULL },
+		// Left leg backward
+		{ "desk leg", SceneManager::CYLINDER_MESH, { 1.0f, 10.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { -10.0f, 0.0f, -5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "deskRod", { 2.0f, 2.0f }, "shiny", NULL },
+		// Left leg forward
+		{ "desk leg", SceneManager::CYLINDER_MESH, { 1.0f, 10.0f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { -10.0f, 0.0f, 5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "deskRod", { 2.0f, 2.0f }, "shiny", NULL },
+		// Left leg bracer
+		{ "desk leg bracer", SceneManager::CYLINDER_MESH, { 1.0f, 10.0f, 1.0f }, { 90.0f, 0.0f, 0.0f }, { -10.0f, 5.0f, -5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "deskRod", { 2.0f, 2.0f }, "shiny", NULL },
+		// Right leg bracer
+		{ "desk leg bracer", SceneManager::CYLINDER_MESH, { 1.0f, 10.0f, 1.0f }, { 90.0f, 0.0f, 0.0f }, { 10.0f, 5.0f, -5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "deskRod", { 2.0f, 2.0f }, "shiny", NULL },
+		// Lamp base
+		{ "lamp base", SceneManager::CYLINDER_MESH, { 2.0f, 1.0f, 2.0f }, { 0.0f, 0.0f, 0.0f }, { 8.0f, 11.0f, -5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "copper", { 1.0f, 1.0f }, "shiny", NULL },
+		// Lamp base top
+		{ "lamp base top", SceneManager::SPHERE_MESH, { 2.0f, 1.0f, 2.0f }, { 0.0f, 0.0f, 0.0f }, { 8.0f, 12.0f, -5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "copper", { 1.0f, 1.0f }, "shiny", "smoothSphere" },
+		// Lamp bottom pipe connect bottom
+		{ "lamp pipe connector", SceneManager::CYLINDER_MESH, { 0.5f, 1.0f, 0.5f }, { 0.0f, 0.0f, 0.0f }, { 8.0f, 12.5f, -5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "copper", { 1.0f, 1.0f }, "shiny", NULL },
+		// Lamp bottom pipe
+		{ "lamp bottom pipe", SceneManager::CYLINDER_MESH, { 0.25f, 7.5f, 0.25f }, { 0.0f, 0.0f, -15.0f }, { 7.75f, 12.5f, -5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "copper", { 1.0f, 1.0f }, "shiny", NULL },
+		// Lamp bottom pipe connect top
+		{ "lamp pipe connector", SceneManager::CYLINDER_MESH, { 0.5f, 0.5f, 0.5f }, { 0.0f, 0.0f, -15.0f }, { 9.65f, 19.5f, -5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "copper", { 1.0f, 1.0f }, "shiny", NULL },
+		// Lamp joint
+		{ "lamp joint", SceneManager::SPHERE_MESH, { 0.65f, 0.65f, 0.65f }, { 0.0f, 0.0f, 0.0f }, { 9.80f, 20.25f, -5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "copper", { 1.0f, 1.0f }, "shiny", "smoothSphere" },
+		// Top Rod
+		{ "lamp top rod", SceneManager::CYLINDER_MESH, { 0.25f, 7.5f, 0.25f }, { 45.0f, 0.0f, 90.0f }, { 9.80f, 20.25f, -5.0f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "copper", { 1.0f, 1.0f }, "shiny", NULL },
+		// Base Shell
+		{ "lamp shell", SceneManager::CYLINDER_MESH, { 1.0f, 1.5f, 1.0f }, { 0.0f, 0.0f, 0.0f }, { 4.0f, 19.5f, 0.5f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "copper", { 1.0f, 1.0f }, "shiny", NULL },
+		// Light Base Shell
+		{ "lamp light shell", SceneManager::TAPERED_CYLINDER_MESH, { 1.5f, 1.0f, 1.5f }, { 0.0f, 0.0f, 0.0f }, { 4.0f, 19.0f, 0.5f },
+			{ 0.5f, 0.5f, 0.5f, 1.0f }, "copper", { 1.0f, 1.0f }, "shiny", NULL },
+		// Paper
+		{ "paper", SceneManager::BOX_MESH, { 5.0f, 0.05f, 5.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 11.25f, 2.5f },
+			{ 1.0f, 1.0f, 1.0f, 1.0f }, "", { 1.0f, 1.0f }, "nonReflective", NULL },
+		// Pencil rod
+		{ "pencil", SceneManager::CYLINDER_MESH, { 0.10f, 2.0f, 0.10f }, { 90.0f, 0.0f, 0.0f }, { 5.0f, 11.35f, 2.5f },
+			{ 1.0f, 0.6f, 0.2f, 1.0f }, "", { 1.0f, 1.0f }, "nonReflective", NULL },
+		// Pencil wood before tip
+		{ "pencil wood", SceneManager::TAPERED_CYLINDER_MESH, { 0.10f, 0.08f, 0.10f }, { 90.0f, 0.0f, 0.0f }, { 5.0f, 11.35f, 4.5f },
+			{ 0.55f, 0.27f, 0.07f, 1.0f }, "", { 1.0f, 1.0f }, "nonReflective", NULL },
+		// Pencil tip
+		{ "pencil tip", SceneManager::CONE_MESH, { 0.06f, 0.2f, 0.05f }, { 90.0f, 0.0f, 0.0f }, { 5.0f, 11.35f, 4.58f },
+			{ 0.0f, 0.0f, 0.0f, 1.0f }, "", { 1.0f, 1.0f }, "nonReflective", NULL },
+		// Pencil eraser
+		{ "pencil eraser", SceneManager::CYLINDER_MESH, { 0.10f, 0.25f, 0.10f }, { 90.0f, 0.0f, 0.0f }, { 5.0f, 11.35f, 2.25f },
+			{ 1.0f, 1.0f, 1.0f, 1.0f }, "erase", { 1.0f, 1.0f }, "nonReflective", NULL }
+	};
+
+	// the desk scene compiled into its model matrices, bounds
+	// and draw order while the project is built
+	constexpr StaticScene::TABLE<sizeof(g_DeskSceneObjects) / sizeof(g_DeskSceneObjects[0])> g_DeskScene =
+		StaticScene::CompileScene(g_DeskSceneObjects, g_MeshBounds);
+
+	/***********************************************************
+	 *  KeepsBakedGeometry()
+	 *
+	 *  Check that a baked mesh spans the same local box as the
+	 *  mesh it was baked from.  Refining only splits the
+	 *  triangles, so a baked mesh with other bounds was baked
+	 *  from other geometry than the object is drawn with.
+	 ***********************************************************/
+	bool KeepsBakedGeometry(const MESH_DATA& mesh, const std::vector<BAKED_VERTEX>& vertices)
+	{
+		unsigned int vertexCount = mesh.GetVertexCount();
+		if ((vertexCount == 0) || (vertices.empty() == true))
+		{
+			return(false);
+		}
 
+		glm::vec3 meshMin = glm::make_vec3(&mesh.vertices[MESH_DATA::POSITION_OFFSET]);
+		glm::vec3 meshMax = meshMin;
+		for (unsigned int i = 1; i < vertexCount; i++)
+		{
+			glm::vec3 position = glm::make_vec3(&mesh.vertices[(i * MESH_DATA::FLOATS_PER_VERTEX) + MESH_DATA::POSITION_OFFSET]);
+			meshMin = glm::min(meshMin, position);
+			meshMax = glm::max(meshMax, position);
+		}
+
+		glm::vec3 bakedMin = glm::make_vec3(vertices[0].position);
+		glm::vec3 bakedMax = bakedMin;
+		for (size_t i = 1; i < vertices.size(); i++)
+		{
+			glm::vec3 position = glm::make_vec3(vertices[i].position);
+			bakedMin = glm::min(bakedMin, position);
+			bakedMax = glm::max(bakedMax, position);
+		}
 
+		float tolerance = 0.001f * std::max(glm::length(meshMax - meshMin), 1.0f);
+		glm::vec3 difference = glm::max(glm::abs(bakedMin - meshMin), glm::abs(bakedMax - meshMax));
+		return(std::max(difference.x, std::max(difference.y, difference.z)) <= tolerance);
+	}
 }
 
 /***********************************************************
@@ -36,7 +224,73 @@ namespace
 SceneManager::SceneManager(ShaderManager *pShaderManager)
 {
 	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
+	m_basicMeshes = NULL;
+	m_loadedTextures = 0;
+	m_dynamicObjectCount = 0;
+	m_textureSlot = -1;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewCount = 0;
+	m_bLoadedFromPack = false;
+	m_pAssetPack = NULL;
+	m_pTextureStreamer = new TextureStreamer();
+	m_bLightBaking = true;
+	m_importedMesh.format = MeshLibrary::VERTEX_FORMAT_PACKED;
+	m_bBakedLighting = false;
+	m_pLightBaker = NULL;
+	m_staticGeneration = 0;
+	m_bakeGeneration = 0;
+	m_pSoftwareRasterizer = NULL;
+	m_softwareTextureCount = 0;
+	m_pObjectBVH = new BoundsBVH();
+	m_bObjectBVHDirty = true;
+	m_bObjectBVHMoved = false;
+
+	// the views can pick their viewport in the vertex shader
+	// when indexed viewports can be written from it
+#ifndef __APPLE__
+	m_bViewportArrays = (NULL != m_pShaderManager) &&
+		(GLEW_VERSION_4_1 || GLEW_ARB_viewport_array) &&
+		GLEW_ARB_shader_viewport_layer_array;
+#else
+	m_bViewportArrays = false;
+#endif
+
+	// the shadow manager loads its own depth shader, so the
+	// scene shader is made active again once it is compiled -
+	// a scene drawn only on the CPU needs none of the OpenGL
+	// objects, and its meshes are not uploaded
+	m_pShadowManager = NULL;
+	m_pOcclusionCuller = NULL;
+	m_pObjectDataBuffer = NULL;
+	if (NULL != m_pShaderManager)
+	{
+		m_basicMeshes = new ShapeMeshes();
+		m_pShadowManager = new ShadowManager();
+		m_pOcclusionCuller = new OcclusionCuller(m_basicMeshes);
+		m_pObjectDataBuffer = new DynamicUploadBuffer(
+			GL_UNIFORM_BUFFER, g_ObjectDataFrameSize, g_FramesInFlight);
+	}
+	m_pMeshLibrary = new MeshLibrary(NULL != m_pShaderManager);
+	for (int i = 0; i <= TAPERED_CYLINDER_MESH; i++)
+	{
+		m_basicLibraryMeshes[i] = -1;
+	}
+	m_bObjectDataOverflow = false;
+	m_staticObjectBuffer = 0;
+	m_bStaticObjectDataDirty = true;
+	m_pFrameArena = new FrameArena("frame arena");
+	m_drawList = NULL;
+	m_drawCount = 0;
+	m_objectData.model = glm::mat4(1.0f);
+	m_objectData.color = glm::vec4(1.0f);
+	m_objectData.UVscale = glm::vec2(1.0f, 1.0f);
+	m_objectData.materialIndex = 0;
+	m_objectData.bUseTexture = false;
+	m_objectData.textureLayer = 0;
+	m_objectData.bBakedLighting = false;
+	m_objectData.padding[0] = 0;
+	m_objectData.padding[1] = 0;
 
 	//Sunset vibe rather than the disco red-blue vibe from last assignment
 
@@ -55,8 +309,31 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 	m_directionalLight2.specular = glm::vec3(0.5f, 0.6f, 1.0f);      // Cool blue specular highlights
 	m_directionalLight2.bActive = true;
 
+	// The point lights from the last assignment are kept but turned off
+	m_pointLight1.position = glm::vec3(-10.0f, 20.0f, 5.0f);
+	m_pointLight1.ambient = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_pointLight1.diffuse = glm::vec3(0.0f, 0.0f, 0.6f);
+	m_pointLight1.specular = glm::vec3(0.0f, 0.0f, 0.8f);
+	m_pointLight1.bActive = false;
 
-	
+	m_pointLight2.position = glm::vec3(10.0f, 20.0f, 5.0f);
+	m_pointLight2.ambient = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_pointLight2.diffuse = glm::vec3(0.6f, 0.0f, 0.0f);
+	m_pointLight2.specular = glm::vec3(0.8f, 0.0f, 0.0f);
+	m_pointLight2.bActive = false;
+
+	// Desk lamp shining down from under the lamp shell
+	m_spotLight.position = glm::vec3(4.0f, 18.8f, 0.5f);
+	m_spotLight.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_spotLight.cutOff = glm::cos(glm::radians(25.0f));
+	m_spotLight.outerCutOff = glm::cos(glm::radians(35.0f));
+	m_spotLight.constant = 1.0f;
+	m_spotLight.linear = 0.045f;
+	m_spotLight.quadratic = 0.0075f;
+	m_spotLight.ambient = glm::vec3(0.05f, 0.05f, 0.05f);
+	m_spotLight.diffuse = glm::vec3(1.0f, 0.9f, 0.7f);
+	m_spotLight.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+	m_spotLight.bActive = true;
 
 
 
@@ -70,99 +347,124 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
  ***********************************************************/
 SceneManager::~SceneManager()
 {
+	DestroyGLTextures();
+	ResourceTracker::Release(ResourceTracker::RESOURCE_CPU, reinterpret_cast<uintptr_t>(&m_sceneObjects));
+
 	m_pShaderManager = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
+	delete m_pShadowManager;
+	m_pShadowManager = NULL;
+	delete m_pOcclusionCuller;
+	m_pOcclusionCuller = NULL;
+	delete m_pMeshLibrary;
+	m_pMeshLibrary = NULL;
+	delete m_pObjectDataBuffer;
+	m_pObjectDataBuffer = NULL;
+	if (0 != m_staticObjectBuffer)
+	{
+		ResourceTracker::Release(ResourceTracker::RESOURCE_BUFFER, m_staticObjectBuffer);
+		GLState::DeleteBuffer(m_staticObjectBuffer);
+		m_staticObjectBuffer = 0;
+	}
+	delete m_pFrameArena;
+	m_pFrameArena = NULL;
+	m_drawList = NULL;
+	delete m_pObjectBVH;
+	m_pObjectBVH = NULL;
+	delete m_pLightBaker;
+	m_pLightBaker = NULL;
+	delete m_pSoftwareRasterizer;
+	m_pSoftwareRasterizer = NULL;
+	// the streamer reads from the pack until it is deleted
+	delete m_pTextureStreamer;
+	m_pTextureStreamer = NULL;
+	delete m_pAssetPack;
+	m_pAssetPack = NULL;
 }
 
 /***********************************************************
  *  CreateGLTexture()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  This method is used for loading textures from image files
+ *  and registering the read texture by its tag.  The texture
+ *  streamer builds the
+ *  mipmaps and only uploads the small levels, the larger
+ *  ones are streamed in when the objects need them.  A
+ *  texture that does not fit into the memory budget is not
+ *  loaded.
  ***********************************************************/
 bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 {
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
+	int textureIndex = m_pTextureStreamer->AddFileTexture(filename);
+	if (textureIndex < 0)
+	{
+		return false;
+	}
+
+	// register the loaded texture and associate it with the special tag string
+	TEXTURE_INFO texture;
+	texture.ID = static_cast<uint32_t>(textureIndex);
+	texture.tag = tag;
+	m_textureIDs.push_back(texture);
+	m_loadedTextures++;
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+	return true;
+}
 
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+/***********************************************************
+ *  LoadDecodedTextures()
+ *
+ *  This method is used for registering the scene textures
+ *  that were reserved and decoded by the startup tasks, in
+ *  the order of the texture files, and putting them into
+ *  texture arrays.  The objects were drawn without their
+ *  textures until now.
+ ***********************************************************/
+void SceneManager::LoadDecodedTextures(const std::vector<int>& textureIndices)
+{
+	for (size_t i = 0; i < textureIndices.size(); i++)
+	{
+		if (m_pTextureStreamer->IsTextureLoaded(textureIndices[i]) == false)
+		{
+			LOG_ERROR("Failed to load " << g_SceneTextureFiles[i].filename << " texture!");
+			continue;
+		}
 
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
+		TEXTURE_INFO texture;
+		texture.ID = static_cast<uint32_t>(textureIndices[i]);
+		texture.tag = g_SceneTextureFiles[i].tag;
+		m_textureIDs.push_back(texture);
 		m_loadedTextures++;
-
-		return true;
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
+	BindGLTextures();
+	FramePacer::RequestRedraw();
 }
 
 /***********************************************************
  *  BindGLTextures()
  *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  This method is used for putting the loaded textures into
+ *  texture arrays, one for each size and format, and
+ *  binding the arrays to OpenGL texture memory slots.  The
+ *  number of textures is not limited by the slots, only
+ *  the number of different sizes and formats is.
  ***********************************************************/
 void SceneManager::BindGLTextures()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	// without OpenGL the CPU renderer reads the textures from
+	// their sources
+	if (NULL == m_pShaderManager)
 	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		return;
 	}
+
+	m_pTextureStreamer->CreateArrays();
+
+	// the static objects keep the slots and layers of their
+	// textures
+	m_bStaticObjectDataDirty = true;
 }
 
 /***********************************************************
@@ -173,36 +475,9 @@ void SceneManager::BindGLTextures()
  ***********************************************************/
 void SceneManager::DestroyGLTextures()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  FindTextureID()
- *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
-{
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureID);
+	m_pTextureStreamer->DestroyTextures();
+	m_textureIDs.clear();
+	m_loadedTextures = 0;
 }
 
 /***********************************************************
@@ -211,7 +486,7 @@ int SceneManager::FindTextureID(std::string tag)
  *  This method is used for getting a slot index for the previously
  *  loaded texture bitmap associated with the passed in tag.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+int SceneManager::FindTextureSlot(const std::string& tag)
 {
 	int textureSlot = -1;
 	int index = 0;
@@ -221,7 +496,7 @@ int SceneManager::FindTextureSlot(std::string tag)
 	{
 		if (m_textureIDs[index].tag.compare(tag) == 0)
 		{
-			textureSlot = index;
+			textureSlot = static_cast<int>(m_textureIDs[index].ID);
 			bFound = true;
 		}
 		else
@@ -237,7 +512,7 @@ int SceneManager::FindTextureSlot(std::string tag)
  *  This method is used for getting a material from the previously
  *  defined materials list that is associated with the passed in tag.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+bool SceneManager::FindMaterial(const std::string& tag, OBJECT_MATERIAL& material)
 {
 	if (m_objectMaterials.size() == 0)
 	{
@@ -264,66 +539,54 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 	return(true);
 }
 
-void SceneManager::LoadSceneTextures()
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of the defined
+ *  material associated with the passed in tag.  The index
+ *  selects the material in the shader.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(const std::string& tag)
 {
-	/*** STUDENTS - add the code BELOW for loading the textures that ***/
-	/*** will be used for mapping to objects in the 3D scene. Up to  ***/
-	/*** 16 textures can be loaded per scene. Refer to the code in   ***/
-	/*** the OpenGL Sample for help.                                 ***/
-
-	if (!CreateGLTexture("textures/deskTop.jpg", "deskTop"))
-	{
-		std::cout << "Failed to load desktop.jpg texture!" << std::endl;
-	}
-
-	if (!CreateGLTexture("textures/deskRod.jpg", "deskRod"))
-	{
-		std::cout << "Failed to load deskRod.jpg texture!" << std::endl;
-	}
-
-	if (!CreateGLTexture("textures/deskRim.jpg", "deskRim"))
-	{
-		std::cout << "Failed to load deskRim.jpg texture!" << std::endl;
-	}
-
-	if (!CreateGLTexture("textures/granite.jpg", "quartz"))
+	for (size_t index = 0; index < m_objectMaterials.size(); index++)
 	{
-		std::cout << "Failed to load granite.jpg texture!" << std::endl;
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			return(static_cast<int>(index));
+		}
 	}
 
-	if (!CreateGLTexture("textures/copper.jpg", "copper"))
-	{
-		std::cout << "Failed to load copper.jpg texture!" << std::endl;
-	}
+	return(-1);
+}
 
-	if (!CreateGLTexture("textures/pencil.jpg", "pencil"))
-	{
-		std::cout << "Failed to load pencil.jpg texture!" << std::endl;
-	}
+void SceneManager::LoadSceneTextures()
+{
+	/*** STUDENTS - add the code BELOW for loading the textures that ***/
+	/*** will be used for mapping to objects in the 3D scene. Any    ***/
+	/*** number of textures can be loaded, in up to 14 different     ***/
+	/*** sizes and formats. Refer to the OpenGL Sample for help.     ***/
 
-	if (!CreateGLTexture("textures/erase.jpg", "erase"))
-	{
-		std::cout << "Failed to load erase.jpg texture!" << std::endl;
-	}
-	if (!CreateGLTexture("textures/grain.jpg", "grain"))
+	for (int i = 0; i < g_SceneTextureFileCount; i++)
 	{
-		std::cout << "Failed to load grain.jpg texture!" << std::endl;
+		if (!CreateGLTexture(g_SceneTextureFiles[i].filename, g_SceneTextureFiles[i].tag))
+		{
+			LOG_ERROR("Failed to load " << g_SceneTextureFiles[i].filename << " texture!");
+		}
 	}
 
-
-	
 	// after the texture image data is loaded into memory, the
-	// loaded textures need to be bound to texture slots - there
-	// are a total of 16 available slots for scene textures
+	// loaded textures are put into texture arrays - there are
+	// TextureStreamer::MAX_TEXTURE_ARRAYS units for the arrays,
+	// one for each size and format of the scene textures
 	BindGLTextures();
 }
 /***********************************************************
- *  SetTransformations()
+ *  CalculateModelMatrix()
  *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
+ *  This method is used for calculating the model matrix
+ *  from the passed in transformation values.
  ***********************************************************/
-void SceneManager::SetTransformations(
+glm::mat4 SceneManager::CalculateModelMatrix(
 	glm::vec3 scaleXYZ,
 	float XrotationDegrees,
 	float YrotationDegrees,
@@ -349,10 +612,31 @@ void SceneManager::SetTransformations(
 
 	modelView = translation * rotationZ * rotationY * rotationX * scale;
 
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
+	return(modelView);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.  The values
+ *  reach the shader with the next WriteObjectData().
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	glm::mat4 modelView = CalculateModelMatrix(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	m_objectData.model = modelView;
 }
 
 /***********************************************************
@@ -375,30 +659,27 @@ void SceneManager::SetShaderColor(
 	currentColor.b = blueColorValue;
 	currentColor.a = alphaValue;
 
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
+	m_objectData.bUseTexture = false;
+	m_objectData.color = currentColor;
 }
 
 /***********************************************************
  *  SetShaderTexture()
  *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
+ *  This method is used for selecting the texture associated
+ *  with the passed in tag for the next draw command.  The
+ *  layer goes into the per-object values, and the texture
+ *  unit of its array is passed to the shader when the
+ *  object is drawn.
  ***********************************************************/
 void SceneManager::SetShaderTexture(
-	std::string textureTag)
+	const std::string& textureTag)
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
+	// an object whose texture is not loaded yet is drawn
+	// with its color
+	m_textureSlot = FindTextureSlot(textureTag);
+	m_objectData.bUseTexture = (m_textureSlot >= 0) ? 1 : 0;
+	m_objectData.textureLayer = m_pTextureStreamer->GetTextureLayer(m_textureSlot);
 }
 
 /***********************************************************
@@ -409,483 +690,2212 @@ void SceneManager::SetShaderTexture(
  ***********************************************************/
 void SceneManager::SetTextureUVScale(float u, float v)
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
+	m_objectData.UVscale = glm::vec2(u, v);
 }
 
 /***********************************************************
  *  SetShaderMaterial()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for selecting the material the
+ *  shader uses for the next draw command.  The material
+ *  values themselves are passed in once when they are
+ *  defined.
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+	const std::string& materialTag)
 {
-	if (m_objectMaterials.size() > 0)
+	int materialIndex = FindMaterialIndex(materialTag);
+	if (materialIndex >= 0)
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
+		m_objectData.materialIndex = materialIndex;
 	}
 }
 
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
 
 /***********************************************************
- *  PrepareScene()
+ *  AddSceneObject()
  *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
+ *  This method is used for adding an object to the 3D scene.
+ *  The index of the new object is returned.
  ***********************************************************/
-void SceneManager::PrepareScene()
-
-// load the textures for the 3D scene
+int SceneManager::AddSceneObject(
+	std::string tag,
+	MESH_TYPE mesh,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	glm::vec4 color,
+	std::string textureTag,
+	glm::vec2 UVscale,
+	std::string materialTag,
+	bool bStatic)
 {
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-
-	LoadSceneTextures();
-
-
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadSphereMesh();
-	m_basicMeshes->LoadConeMesh();
-	m_basicMeshes->LoadTaperedCylinderMesh();
+	SCENE_OBJECT object;
+
+	object.tag = tag;
+	object.mesh = mesh;
+	object.scaleXYZ = scaleXYZ;
+	object.XrotationDegrees = XrotationDegrees;
+	object.YrotationDegrees = YrotationDegrees;
+	object.ZrotationDegrees = ZrotationDegrees;
+	object.positionXYZ = positionXYZ;
+	object.color = color;
+	object.textureTag = textureTag;
+	object.UVscale = UVscale;
+	object.materialTag = materialTag;
+	object.bStatic = bStatic;
+	object.libraryMesh = -1;
+	object.bakedMesh = -1;
+	object.model = CalculateModelMatrix(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	CalculateObjectBounds(object);
+
+	return(InsertSceneObject(object));
 }
 
 /***********************************************************
- *  RenderScene()
+ *  AddStaticScene()
  *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
+ *  This method is used for adding the objects of a scene
+ *  that was compiled while the project was built.  The
+ *  model matrices and bounds are taken from the table, and
+ *  the objects are added in its draw order.
  ***********************************************************/
-void SceneManager::RenderScene()
+void SceneManager::AddStaticScene(const StaticScene::COMPILED_OBJECT* objects, size_t count)
 {
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-
+	m_sceneObjects.reserve(m_sceneObjects.size() + count);
 
+	for (size_t i = 0; i < count; i++)
+	{
+		const StaticScene::COMPILED_OBJECT& compiled = objects[i];
+		const StaticScene::OBJECT& source = compiled.object;
+
+		SCENE_OBJECT object;
+		object.tag = source.tag;
+		object.mesh = static_cast<MESH_TYPE>(source.mesh);
+		object.scaleXYZ = glm::make_vec3(source.scale);
+		object.XrotationDegrees = source.rotationDegrees[0];
+		object.YrotationDegrees = source.rotationDegrees[1];
+		object.ZrotationDegrees = source.rotationDegrees[2];
+		object.positionXYZ = glm::make_vec3(source.position);
+		object.model = glm::make_mat4(compiled.model.m);
+		object.color = glm::make_vec4(source.color);
+		object.textureTag = source.textureTag;
+		object.UVscale = glm::make_vec2(source.UVscale);
+		object.materialTag = source.materialTag;
+		object.bStatic = true;
+		object.boundsMin = glm::make_vec3(compiled.boundsMin);
+		object.boundsMax = glm::make_vec3(compiled.boundsMax);
+		object.libraryMesh = -1;
+		object.bakedMesh = -1;
+
+		int objectIndex = InsertSceneObject(object);
+		if (NULL != source.libraryMesh)
+		{
+			SetObjectMesh(objectIndex, source.libraryMesh);
+		}
+	}
+}
 
+/***********************************************************
+ *  InsertSceneObject()
+ *
+ *  This method is used for putting an object into the 3D
+ *  scene once its model matrix and bounds are set.  The
+ *  index of the new object is returned.
+ ***********************************************************/
+int SceneManager::InsertSceneObject(const SCENE_OBJECT& object)
+{
+	m_sceneObjects.push_back(object);
+	m_sceneObjects.back().textureSlot = -1;
+	m_sceneObjects.back().staticDataOffset = -1;
+	if (NULL != m_pOcclusionCuller)
+	{
+		m_pOcclusionCuller->SetObjectCount(static_cast<int>(m_sceneObjects.size()));
+	}
+	ResourceTracker::Track(ResourceTracker::RESOURCE_CPU, reinterpret_cast<uintptr_t>(&m_sceneObjects),
+		m_sceneObjects.capacity() * sizeof(SCENE_OBJECT), ResourceTracker::CATEGORY_SCENE_DATA, "scene objects");
+	m_bObjectBVHDirty = true;
 
+	FramePacer::RequestRedraw();
 
-	m_pShaderManager->setBoolValue("bUseLighting", true);
+	// a new static object changes the cached shadows, and
+	// the baked ones, and needs its values written
+	if (object.bStatic == true)
+	{
+		if (NULL != m_pShadowManager)
+		{
+			m_pShadowManager->MarkStaticGeometryDirty();
+		}
+		ReleaseBakedMeshes();
+		m_bStaticObjectDataDirty = true;
+		m_staticGeneration++;
+	}
+	else
+	{
+		m_dynamicObjectCount++;
+	}
 
-	// Pass the first directional light to the shader
-	m_pShaderManager->setVec3Value("directionalLight1.direction", m_directionalLight1.direction);
-	m_pShaderManager->setVec3Value("directionalLight1.ambient", m_directionalLight1.ambient);
-	m_pShaderManager->setVec3Value("directionalLight1.diffuse", m_directionalLight1.diffuse);
-	m_pShaderManager->setVec3Value("directionalLight1.specular", m_directionalLight1.specular);
-	m_pShaderManager->setBoolValue("directionalLight1.bActive", m_directionalLight1.bActive);
+	return(static_cast<int>(m_sceneObjects.size()) - 1);
+}
 
-	// Pass the second directional light to the shader
-	m_pShaderManager->setVec3Value("directionalLight2.direction", m_directionalLight2.direction);
-	m_pShaderManager->setVec3Value("directionalLight2.ambient", m_directionalLight2.ambient);
-	m_pShaderManager->setVec3Value("directionalLight2.diffuse", m_directionalLight2.diffuse);
-	m_pShaderManager->setVec3Value("directionalLight2.specular", m_directionalLight2.specular);
-	m_pShaderManager->setBoolValue("directionalLight2.bActive", m_directionalLight2.bActive);
+/***********************************************************
+ *  SetObjectTransformations()
+ *
+ *  This method is used for moving an object that is already
+ *  in the 3D scene.
+ ***********************************************************/
+void SceneManager::SetObjectTransformations(
+	int index,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	if ((index < 0) || (index >= static_cast<int>(m_sceneObjects.size())))
+	{
+		return;
+	}
 
-	// Pass the blue point light to the shader
-	m_pShaderManager->setVec3Value("pointLights[0].position", m_pointLight1.position);
-	m_pShaderManager->setVec3Value("pointLights[0].ambient", m_pointLight1.ambient);
-	m_pShaderManager->setVec3Value("pointLights[0].diffuse", m_pointLight1.diffuse);
-	m_pShaderManager->setVec3Value("pointLights[0].specular", m_pointLight1.specular);
-	m_pShaderManager->setBoolValue("pointLights[0].bActive", m_pointLight1.bActive);
+	SCENE_OBJECT& object = m_sceneObjects[index];
+	object.scaleXYZ = scaleXYZ;
+	object.XrotationDegrees = XrotationDegrees;
+	object.YrotationDegrees = YrotationDegrees;
+	object.ZrotationDegrees = ZrotationDegrees;
+	object.positionXYZ = positionXYZ;
+	object.model = CalculateModelMatrix(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	CalculateObjectBounds(object);
+	m_bObjectBVHMoved = true;
+	FramePacer::RequestRedraw();
+
+	// dynamic objects are drawn into the shadows every frame,
+	// only a static object invalidates the cached shadows -
+	// and the baked lighting, so every object is lit live
+	// from then on
+	if (object.bStatic == true)
+	{
+		if (NULL != m_pShadowManager)
+		{
+			m_pShadowManager->MarkStaticGeometryDirty();
+		}
+		ReleaseBakedMeshes();
+		m_bStaticObjectDataDirty = true;
+		m_staticGeneration++;
+	}
+}
 
-	// Pass the red point light to the shader
-	m_pShaderManager->setVec3Value("pointLights[1].position", m_pointLight2.position);
-	m_pShaderManager->setVec3Value("pointLights[1].ambient", m_pointLight2.ambient);
-	m_pShaderManager->setVec3Value("pointLights[1].diffuse", m_pointLight2.diffuse);
-	m_pShaderManager->setVec3Value("pointLights[1].specular", m_pointLight2.specular);
-	m_pShaderManager->setBoolValue("pointLights[1].bActive", m_pointLight2.bActive);
+/***********************************************************
+ *  SetViews()
+ *
+ *  This method is used for passing in the views that the
+ *  current frame is rendered with.  The planes of every
+ *  view frustum are extracted for culling the objects.
+ ***********************************************************/
+void SceneManager::SetViews(const SCENE_VIEW* views, int count)
+{
+	m_viewCount = std::min(std::max(count, 1), static_cast<int>(SCENE_VIEW::MAX_VIEWS));
+	for (int i = 0; i < m_viewCount; i++)
+	{
+		m_views[i] = views[i];
 
-	// Pass the spotlight to the shader
-	m_pShaderManager->setVec3Value("spotLight.position", m_spotLight.position);
-	m_pShaderManager->setVec3Value("spotLight.direction", m_spotLight.direction);
-	m_pShaderManager->setFloatValue("spotLight.cutOff", m_spotLight.cutOff);
-	m_pShaderManager->setFloatValue("spotLight.outerCutOff", m_spotLight.outerCutOff);
-	m_pShaderManager->setFloatValue("spotLight.constant", m_spotLight.constant);
-	m_pShaderManager->setFloatValue("spotLight.linear", m_spotLight.linear);
-	m_pShaderManager->setFloatValue("spotLight.quadratic", m_spotLight.quadratic);
-	m_pShaderManager->setVec3Value("spotLight.ambient", m_spotLight.ambient);
-	m_pShaderManager->setVec3Value("spotLight.diffuse", m_spotLight.diffuse);
-	m_pShaderManager->setVec3Value("spotLight.specular", m_spotLight.specular);
-	m_pShaderManager->setBoolValue("spotLight.bActive", m_spotLight.bActive);
+		// the planes are sums and differences of the rows of
+		// the view projection matrix
+		glm::mat4 viewProjection = views[i].projection * views[i].view;
+		glm::vec4 rows[4];
+		for (int row = 0; row < 4; row++)
+		{
+			rows[row] = glm::vec4(
+				viewProjection[0][row],
+				viewProjection[1][row],
+				viewProjection[2][row],
+				viewProjection[3][row]);
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			m_viewPlanes[i][axis * 2] = rows[3] + rows[axis];
+			m_viewPlanes[i][axis * 2 + 1] = rows[3] - rows[axis];
+		}
+	}
 
+	m_viewMatrix = views[0].view;
+	m_projectionMatrix = views[0].projection;
+}
 
+/***********************************************************
+ *  WriteObjectData()
+ *
+ *  This method is used for writing the per-object values
+ *  for the next draw command into the upload buffer.  The
+ *  returned offset is bound to the shader's ObjectData
+ *  block when the object is drawn.
+ ***********************************************************/
+GLintptr SceneManager::WriteObjectData()
+{
+	return(m_pObjectDataBuffer->Write(&m_objectData, sizeof(OBJECT_DATA)));
+}
 
+/***********************************************************
+ *  ReserveObjectData()
+ *
+ *  This method is used for growing the upload buffer before
+ *  a frame when the values of every dynamic object no
+ *  longer fit into a frame of it.  The static objects are
+ *  drawn from the static object buffer and take no room.
+ *  The size is at least doubled, so objects that are added
+ *  one at a time do not replace the buffer every frame.
+ ***********************************************************/
+void SceneManager::ReserveObjectData()
+{
+	GLintptr alignment = m_pObjectDataBuffer->GetAlignment();
+	GLsizeiptr writeSize = ((sizeof(OBJECT_DATA) + alignment - 1) / alignment) * alignment;
+	GLsizeiptr neededSize = writeSize * m_dynamicObjectCount;
+	GLsizeiptr frameSize = m_pObjectDataBuffer->GetFrameSize();
+	if (neededSize <= frameSize)
+	{
+		return;
+	}
 
+	// the new buffer is made before the old one is deleted,
+	// so it gets a name of its own, and OpenGL only frees the
+	// old one once the frames in flight have read it
+	frameSize = std::max(neededSize, frameSize * 2);
+	DynamicUploadBuffer* pOldBuffer = m_pObjectDataBuffer;
+	m_pObjectDataBuffer = new DynamicUploadBuffer(GL_UNIFORM_BUFFER, frameSize, g_FramesInFlight);
+	delete pOldBuffer;
+	m_bObjectDataOverflow = false;
+
+	LOG_INFO("INFO: Grew the object data buffer to " << frameSize << " bytes per frame for "
+		<< m_dynamicObjectCount << " dynamic objects");
+}
 
+/***********************************************************
+ *  SetObjectValues()
+ *
+ *  This method is used for setting the per-object values
+ *  and the texture of a scene object for the next draw
+ *  command.  The texture and the material are looked up
+ *  by their tags.
+ ***********************************************************/
+void SceneManager::SetObjectValues(const SCENE_OBJECT& object)
+{
+	m_objectData.model = object.model;
+	SetShaderColor(object.color.r, object.color.g, object.color.b, object.color.a);
+	m_textureSlot = -1;
+	if (object.textureTag.empty() == false)
+	{
+		SetShaderTexture(object.textureTag);
+		SetTextureUVScale(object.UVscale.x, object.UVscale.y);
+	}
+	// an unknown material is drawn with the first one, as
+	// it is baked
+	m_objectData.materialIndex = 0;
+	SetShaderMaterial(object.materialTag);
+	m_objectData.bBakedLighting = (UsesBakedLighting(object) == true) ? 1 : 0;
+}
 
+/***********************************************************
+ *  WriteStaticObjectData()
+ *
+ *  This method is used for writing the per-object values
+ *  of every static object into a buffer of their own, so
+ *  the static objects are drawn without looking up their
+ *  textures and materials or writing their values every
+ *  frame.  It runs once the scene is loaded, and again
+ *  only when a static object, the baked lighting, the
+ *  textures or the materials change.
+ ***********************************************************/
+void SceneManager::WriteStaticObjectData()
+{
+	m_bStaticObjectDataDirty = false;
+
+	// every object starts at an offset the uniform block can
+	// be bound at
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	GLsizeiptr stride = sizeof(OBJECT_DATA);
+	if (alignment > 0)
+	{
+		stride = ((stride + alignment - 1) / alignment) * alignment;
+	}
 
+	std::vector<unsigned char> data;
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		SCENE_OBJECT& object = m_sceneObjects[i];
+		if (object.bStatic == false)
+		{
+			continue;
+		}
 
+		SetObjectValues(object);
+		object.textureSlot = m_textureSlot;
+		object.staticDataOffset = static_cast<GLintptr>(data.size());
+		data.resize(data.size() + stride, 0);
+		memcpy(&data[object.staticDataOffset], &m_objectData, sizeof(OBJECT_DATA));
+	}
+	if (data.empty() == true)
+	{
+		return;
+	}
 
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(30.0f, 1.0f, 30.0f);
+	if (0 == m_staticObjectBuffer)
+	{
+		glGenBuffers(1, &m_staticObjectBuffer);
+	}
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_staticObjectBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(data.size()), &data[0], GL_STATIC_DRAW);
+	ResourceTracker::Track(ResourceTracker::RESOURCE_BUFFER, m_staticObjectBuffer, data.size(),
+		ResourceTracker::CATEGORY_SCENE_DATA, "static object data");
+}
 
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
+/***********************************************************
+ *  SetObjectMesh()
+ *
+ *  This method is used for drawing a scene object with a
+ *  mesh from the mesh library instead of its basic mesh.
+ *  The library mesh is expected to have the same local
+ *  placement as the basic mesh, so the bounds still fit.
+ ***********************************************************/
+void SceneManager::SetObjectMesh(int index, std::string meshTag)
+{
+	if ((index < 0) || (index >= static_cast<int>(m_sceneObjects.size())))
+	{
+		return;
+	}
 
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
+	SCENE_OBJECT& object = m_sceneObjects[index];
+	int libraryMesh = m_pMeshLibrary->FindMesh(meshTag);
+	if (libraryMesh == object.libraryMesh)
+	{
+		return;
+	}
+	object.libraryMesh = libraryMesh;
+	FramePacer::RequestRedraw();
 
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
+	// the cached shadows and the baked lighting were made
+	// with the old mesh of a static object, so every object
+	// is lit live from then on, as after moving it
+	if (object.bStatic == true)
+	{
+		if (NULL != m_pShadowManager)
+		{
+			m_pShadowManager->MarkStaticGeometryDirty();
+		}
+		ReleaseBakedMeshes();
+		m_staticGeneration++;
+	}
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing the mesh of a scene
+ *  object from the mesh library.  The passed in shader is
+ *  told whether the vertices need to be decoded.
+ ***********************************************************/
+void SceneManager::DrawMesh(const SCENE_OBJECT& object, ShaderManager* pShader, int instanceCount)
+{
+	m_pMeshLibrary->DrawMesh(GetObjectMesh(object, pShader), pShader, instanceCount);
+}
+
+/***********************************************************
+ *  GetObjectMesh()
+ *
+ *  This method is used for getting the library mesh a scene
+ *  object is drawn with - its own library mesh or the one
+ *  for its basic shape.  The scene shader draws an object
+ *  with baked lighting with its baked mesh, the shadow maps
+ *  keep using the plain one.
+ ***********************************************************/
+int SceneManager::GetObjectMesh(const SCENE_OBJECT& object, ShaderManager* pShader) const
+{
+	if ((pShader == m_pShaderManager) && (UsesBakedLighting(object) == true))
+	{
+		return(object.bakedMesh);
+	}
+	if (object.libraryMesh >= 0)
+	{
+		return(object.libraryMesh);
+	}
+
+	return(m_basicLibraryMeshes[object.mesh]);
+}
+
+/***********************************************************
+ *  KeepLibraryShape()
+ *
+ *  This method is used for keeping the mesh data of a mesh
+ *  loaded into the library, so the light baker and the CPU
+ *  renderer work on the same geometry that is drawn.
+ ***********************************************************/
+void SceneManager::KeepLibraryShape(int meshIndex, const MESH_DATA& data)
+{
+	if (meshIndex < 0)
+	{
+		return;
+	}
+
+	if (meshIndex >= static_cast<int>(m_libraryShapes.size()))
+	{
+		m_libraryShapes.resize(meshIndex + 1);
+	}
+	m_libraryShapes[meshIndex] = data;
+}
+
+/***********************************************************
+ *  GetObjectShape()
+ *
+ *  This method is used for getting the mesh data of the
+ *  mesh a scene object is drawn with - its library mesh,
+ *  or its basic shape.
+ ***********************************************************/
+const MESH_DATA& SceneManager::GetObjectShape(const SCENE_OBJECT& object) const
+{
+	if ((object.libraryMesh >= 0) && (object.libraryMesh < static_cast<int>(m_libraryShapes.size())) &&
+		(m_libraryShapes[object.libraryMesh].indices.empty() == false))
+	{
+		return(m_libraryShapes[object.libraryMesh]);
+	}
+
+	return(m_basicShapes[object.mesh]);
+}
+
+/***********************************************************
+ *  CalculateObjectBounds()
+ *
+ *  This method is used for calculating the world space
+ *  bounding box of a scene object from the local bounds of
+ *  its basic mesh.
+ ***********************************************************/
+void SceneManager::CalculateObjectBounds(SCENE_OBJECT& object)
+{
+	const StaticScene::LOCAL_BOUNDS& bounds = g_MeshBounds[object.mesh];
+	glm::vec3 localMin = glm::make_vec3(bounds.min);
+	glm::vec3 localMax = glm::make_vec3(bounds.max);
+	const glm::mat4& model = object.model;
+
+	// transform all eight corners of the local bounds
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec3 corner(
+			(i & 1) ? localMax.x : localMin.x,
+			(i & 2) ? localMax.y : localMin.y,
+			(i & 4) ? localMax.z : localMin.z);
+		glm::vec3 worldCorner = glm::vec3(model * glm::vec4(corner, 1.0f));
+
+		if (i == 0)
+		{
+			object.boundsMin = worldCorner;
+			object.boundsMax = worldCorner;
+		}
+		else
+		{
+			object.boundsMin = glm::min(object.boundsMin, worldCorner);
+			object.boundsMax = glm::max(object.boundsMax, worldCorner);
+		}
+	}
+}
+
+/***********************************************************
+ *  CalculateViewMask()
+ *
+ *  This method is used for testing the bounds of a scene
+ *  object against the frustum of every view.  A bit is set
+ *  for each view the bounds are at least partly inside.
+ ***********************************************************/
+unsigned int SceneManager::CalculateViewMask(const SCENE_OBJECT& object)
+{
+	unsigned int viewMask = 0;
+
+	for (int i = 0; i < m_viewCount; i++)
+	{
+		bool bInside = true;
+		for (int plane = 0; (plane < 6) && (bInside == true); plane++)
+		{
+			// test the corner furthest along the plane normal
+			const glm::vec4& p = m_viewPlanes[i][plane];
+			glm::vec3 corner(
+				(p.x >= 0.0f) ? object.boundsMax.x : object.boundsMin.x,
+				(p.y >= 0.0f) ? object.boundsMax.y : object.boundsMin.y,
+				(p.z >= 0.0f) ? object.boundsMax.z : object.boundsMin.z);
+			bInside = (glm::dot(glm::vec3(p), corner) + p.w) >= 0.0f;
+		}
+
+		if (bInside == true)
+		{
+			viewMask |= (1u << i);
+		}
+	}
+
+	return(viewMask);
+}
+
+/***********************************************************
+ *  CalculateTextureLevel()
+ *
+ *  This method is used for choosing the finest mip level an
+ *  object needs from its texture.  The bounding sphere of
+ *  the object is projected into each view it is drawn into,
+ *  and the level is picked so that a texel covers at least
+ *  about one pixel where the object is largest on screen.
+ ***********************************************************/
+int SceneManager::CalculateTextureLevel(
+	const SCENE_OBJECT& object,
+	unsigned int viewMask,
+	int textureSize,
+	int frameHeight)
+{
+	glm::vec3 center = (object.boundsMin + object.boundsMax) * 0.5f;
+	float radius = glm::length(object.boundsMax - object.boundsMin) * 0.5f;
+	// texels across the object, with the texture repeated
+	// the number of times the UV scale says
+	float texels = textureSize * std::max(object.UVscale.x, object.UVscale.y);
+
+	float pixels = 0.0f;
+	for (int i = 0; i < m_viewCount; i++)
+	{
+		if ((viewMask & (1u << i)) == 0)
+		{
+			continue;
+		}
+
+		// projection[1][1] turns a size at a distance of one
+		// into a fraction of half the view height
+		float halfHeight = 0.5f * frameHeight * m_views[i].viewport.w;
+		float viewPixels = 2.0f * radius * m_views[i].projection[1][1] * halfHeight;
+		if (m_views[i].projection[3][3] == 0.0f)
+		{
+			// in a perspective view the camera can be inside
+			// of the bounds, then the finest level is needed
+			float distance = glm::length(center - m_views[i].position) - radius;
+			if (distance <= 0.0f)
+			{
+				return(0);
+			}
+			viewPixels /= distance;
+		}
+		pixels = std::max(pixels, viewPixels);
+	}
+
+	if ((pixels <= 0.0f) || (texels <= pixels))
+	{
+		return(0);
+	}
+
+	return(static_cast<int>(std::floor(std::log2(texels / pixels))));
+}
+
+/***********************************************************
+ *  CollectDraws()
+ *
+ *  This method is used for walking the scene objects once
+ *  for all of the views.  Objects outside every view, or
+ *  hidden in the previous frame, are skipped, and the
+ *  values of the other dynamic objects are written into
+ *  the upload buffer so each view only has to bind them.
+ *  The static objects are drawn with the values written
+ *  into the static object buffer.
+ ***********************************************************/
+void SceneManager::CollectDraws()
+{
+	if (m_bStaticObjectDataDirty == true)
+	{
+		WriteStaticObjectData();
+	}
+
+	// room for every object, so the list never has to grow
+	m_drawList = m_pFrameArena->AllocateArray<DRAW_RECORD>(m_sceneObjects.size());
+	m_drawCount = 0;
+	if (NULL == m_drawList)
+	{
+		return;
+	}
+
+	// the occlusion tests are drawn from the first view, so
+	// they only decide the visibility of a single view
+	bool bUseOcclusion = (m_viewCount == 1);
+
+	// the texture levels are chosen for the pixel size of
+	// the views
+	int frameViewport[4];
+	GLState::GetViewport(frameViewport);
+
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+
+		DRAW_RECORD record;
+		record.objectIndex = static_cast<int>(i);
+		record.viewMask = CalculateViewMask(object);
+		if (record.viewMask == 0)
+		{
+			FrameStats::AddCounter("frustum culled objects", 1);
+			continue;
+		}
+
+		record.visibility = OcclusionCuller::OBJECT_VISIBLE;
+		if (bUseOcclusion == true)
+		{
+			record.visibility = m_pOcclusionCuller->GetVisibility(record.objectIndex);
+			if (record.visibility == OcclusionCuller::OBJECT_OCCLUDED)
+			{
+				continue;
+			}
+		}
+
+		if (object.staticDataOffset >= 0)
+		{
+			record.dataOffset = object.staticDataOffset;
+			record.bStaticData = true;
+			record.textureSlot = object.textureSlot;
+		}
+		else
+		{
+			SetObjectValues(object);
+			record.dataOffset = WriteObjectData();
+			record.bStaticData = false;
+			record.textureSlot = m_textureSlot;
+			if (record.dataOffset < 0)
+			{
+				// the buffer is sized for every dynamic object
+				// before the frame, so an object that is added
+				// during it is not drawn until the next one
+				if (m_bObjectDataOverflow == false)
+				{
+					LOG_WARNING("The object data buffer is full, objects are not drawn:" << object.tag);
+					m_bObjectDataOverflow = true;
+				}
+				continue;
+			}
+		}
+
+		if (record.textureSlot >= 0)
+		{
+			m_pTextureStreamer->RequestLevel(record.textureSlot, CalculateTextureLevel(
+				object,
+				record.viewMask,
+				m_pTextureStreamer->GetTextureSize(record.textureSlot),
+				frameViewport[3]));
+		}
+
+		m_drawList[m_drawCount] = record;
+		m_drawCount++;
+	}
+}
+
+/***********************************************************
+ *  BindDrawRecord()
+ *
+ *  This method is used for binding the per-object values
+ *  and the texture unit of a collected object.
+ ***********************************************************/
+void SceneManager::BindDrawRecord(const DRAW_RECORD& record)
+{
+	if (record.bStaticData == true)
+	{
+		GLState::BindBufferRange(GL_UNIFORM_BUFFER, g_ObjectDataBinding, m_staticObjectBuffer,
+			record.dataOffset, sizeof(OBJECT_DATA));
+	}
+	else
+	{
+		m_pObjectDataBuffer->BindRange(g_ObjectDataBinding, record.dataOffset, sizeof(OBJECT_DATA));
+	}
+	// draws with textures in the same array only differ in
+	// their layer, so the sampler stays the same
+	int textureUnit = m_pTextureStreamer->GetTextureUnit(record.textureSlot);
+	if (textureUnit >= 0)
+	{
+		GLState::SetSampler(m_pShaderManager, g_TextureValueName, textureUnit);
+	}
+}
+
+/***********************************************************
+ *  SubmitDraws()
+ *
+ *  This method is used for drawing the collected objects
+ *  into every view.  With indexed viewports the vertex
+ *  shader picks the viewport of each view, and an object
+ *  seen in all of the views is drawn into them with one
+ *  instanced draw when its mesh allows it.  Otherwise the
+ *  objects are drawn once per view with that view's
+ *  viewport.
+ ***********************************************************/
+void SceneManager::SubmitDraws()
+{
+	// the views are placed inside the viewport of the frame
+	int frameViewport[4];
+	GLState::GetViewport(frameViewport);
+
+	int viewports[SCENE_VIEW::MAX_VIEWS][4];
+	for (int i = 0; i < m_viewCount; i++)
+	{
+		const glm::vec4& fraction = m_views[i].viewport;
+		int left = frameViewport[0] + static_cast<int>(fraction.x * frameViewport[2] + 0.5f);
+		int right = frameViewport[0] + static_cast<int>((fraction.x + fraction.z) * frameViewport[2] + 0.5f);
+		int bottom = frameViewport[1] + static_cast<int>(fraction.y * frameViewport[3] + 0.5f);
+		int top = frameViewport[1] + static_cast<int>((fraction.y + fraction.w) * frameViewport[3] + 0.5f);
+		viewports[i][0] = left;
+		viewports[i][1] = bottom;
+		viewports[i][2] = std::max(right - left, 1);
+		viewports[i][3] = std::max(top - bottom, 1);
+	}
+
+	if (m_viewCount == 1)
+	{
+		GLState::Viewport(viewports[0][0], viewports[0][1], viewports[0][2], viewports[0][3]);
+		GLState::SetUniform(m_pShaderManager, g_FirstViewName, 0);
+
+		for (int i = 0; i < m_drawCount; i++)
+		{
+			const DRAW_RECORD& record = m_drawList[i];
+			BindDrawRecord(record);
+			m_pOcclusionCuller->BeginObject(record.objectIndex, record.visibility);
+			DrawMesh(m_sceneObjects[record.objectIndex], m_pShaderManager);
+			m_pOcclusionCuller->EndObject(record.objectIndex, record.visibility);
+		}
+	}
+	else if (m_bViewportArrays == true)
+	{
+		// glViewport sets every indexed viewport, so the first
+		// one goes through the state layer
+		GLState::Viewport(viewports[0][0], viewports[0][1], viewports[0][2], viewports[0][3]);
+		for (int i = 1; i < m_viewCount; i++)
+		{
+			GLState::ViewportIndexed(i, viewports[i][0], viewports[i][1], viewports[i][2], viewports[i][3]);
+		}
+		GLState::SetUniform(m_pShaderManager, g_ViewportArrayName, true);
+
+		unsigned int allViews = (1u << m_viewCount) - 1;
+		for (int i = 0; i < m_drawCount; i++)
+		{
+			const DRAW_RECORD& record = m_drawList[i];
+			const SCENE_OBJECT& object = m_sceneObjects[record.objectIndex];
+			BindDrawRecord(record);
+
+			if ((record.viewMask == allViews) &&
+				(GetObjectMesh(object, m_pShaderManager) >= 0))
+			{
+				GLState::SetUniform(m_pShaderManager, g_FirstViewName, 0);
+				DrawMesh(object, m_pShaderManager, m_viewCount);
+				continue;
+			}
+
+			for (int view = 0; view < m_viewCount; view++)
+			{
+				if ((record.viewMask & (1u << view)) != 0)
+				{
+					GLState::SetUniform(m_pShaderManager, g_FirstViewName, view);
+					DrawMesh(object, m_pShaderManager);
+				}
+			}
+		}
+
+		GLState::SetUniform(m_pShaderManager, g_ViewportArrayName, false);
+	}
+	else
+	{
+		for (int view = 0; view < m_viewCount; view++)
+		{
+			GLState::Viewport(viewports[view][0], viewports[view][1], viewports[view][2], viewports[view][3]);
+			GLState::SetUniform(m_pShaderManager, g_FirstViewName, view);
+
+			for (int i = 0; i < m_drawCount; i++)
+			{
+				const DRAW_RECORD& record = m_drawList[i];
+				if ((record.viewMask & (1u << view)) != 0)
+				{
+					BindDrawRecord(record);
+					DrawMesh(m_sceneObjects[record.objectIndex], m_pShaderManager);
+				}
+			}
+		}
+	}
+
+	FrameStats::AddCounter("drawn objects", m_drawCount);
+
+	// the occlusion tests and the next frame use the frame's
+	// own viewport
+	GLState::Viewport(frameViewport[0], frameViewport[1], frameViewport[2], frameViewport[3]);
+}
+
+/***********************************************************
+ *  TestOcclusion()
+ *
+ *  This method is used for testing the bounds of every
+ *  scene object against the depth of the drawn frame.  The
+ *  results decide which objects are drawn in the next frame.
+ ***********************************************************/
+void SceneManager::TestOcclusion()
+{
+	m_pOcclusionCuller->BeginBoundsTests(m_viewMatrix, m_projectionMatrix);
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		m_pOcclusionCuller->TestObjectBounds(
+			static_cast<int>(i),
+			m_sceneObjects[i].boundsMin,
+			m_sceneObjects[i].boundsMax);
+	}
+	m_pOcclusionCuller->EndBoundsTests();
+
+	// switch back to the scene shader
+	GLState::UseShader(m_pShaderManager);
+}
+
+/***********************************************************
+ *  UpdateObjectBVH()
+ *
+ *  This method is used for bringing the picking hierarchy
+ *  up to date.  Added objects rebuild it, while objects
+ *  that only moved refit the bounds of the existing nodes.
+ ***********************************************************/
+void SceneManager::UpdateObjectBVH()
+{
+	if ((m_bObjectBVHDirty == false) && (m_bObjectBVHMoved == false))
+	{
+		return;
+	}
+
+	std::vector<BoundsBVH::BOUNDS> bounds(m_sceneObjects.size());
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		bounds[i].boundsMin = m_sceneObjects[i].boundsMin;
+		bounds[i].boundsMax = m_sceneObjects[i].boundsMax;
+	}
+
+	if (m_bObjectBVHDirty == true)
+	{
+		m_pObjectBVH->Build(bounds);
+	}
+	else
+	{
+		m_pObjectBVH->Refit(bounds);
+	}
+
+	m_bObjectBVHDirty = false;
+	m_bObjectBVHMoved = false;
+}
+
+/***********************************************************
+ *  IntersectObject()
+ *
+ *  This method is used for intersecting a ray with the
+ *  analytic shape of a scene object.  The ray is moved into
+ *  the local space of the object, where the basic shapes
+ *  have their fixed size, without normalizing it, so the
+ *  hit distance is the same in both spaces.
+ ***********************************************************/
+bool SceneManager::IntersectObject(
+	void* pContext,
+	int objectIndex,
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float& distance)
+{
+	SceneManager* pScene = static_cast<SceneManager*>(pContext);
+	const SCENE_OBJECT& object = pScene->m_sceneObjects[objectIndex];
+
+	glm::mat4 inverseModel = glm::inverse(object.model);
+	glm::vec3 localOrigin = glm::vec3(inverseModel * glm::vec4(origin, 1.0f));
+	glm::vec3 localDirection = glm::vec3(inverseModel * glm::vec4(direction, 0.0f));
+
+	switch (object.mesh)
+	{
+	case PLANE_MESH:
+		return(RayCast::IntersectPlane(localOrigin, localDirection, distance));
+	case BOX_MESH:
+		return(RayCast::IntersectBox(localOrigin, localDirection, distance));
+	case SPHERE_MESH:
+		return(RayCast::IntersectSphere(localOrigin, localDirection, distance));
+	case CYLINDER_MESH:
+		return(RayCast::IntersectTaperedCylinder(localOrigin, localDirection, 1.0f, 1.0f, distance));
+	case CONE_MESH:
+		return(RayCast::IntersectTaperedCylinder(localOrigin, localDirection, 1.0f, 0.0f, distance));
+	case TAPERED_CYLINDER_MESH:
+		return(RayCast::IntersectTaperedCylinder(localOrigin, localDirection, 1.0f, 0.5f, distance));
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  IntersectStaticObject()
+ *
+ *  This method is used for intersecting a ray with a scene
+ *  object for the baked shadows.  Only the static objects
+ *  cast baked shadows, since the others can move.
+ ***********************************************************/
+bool SceneManager::IntersectStaticObject(
+	void* pContext,
+	int objectIndex,
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float& distance)
+{
+	SceneManager* pScene = static_cast<SceneManager*>(pContext);
+	if (pScene->m_sceneObjects[objectIndex].bStatic == false)
+	{
+		return(false);
+	}
+
+	return(IntersectObject(pContext, objectIndex, origin, direction, distance));
+}
+
+/***********************************************************
+ *  PickObject()
+ *
+ *  This method is used for finding the nearest scene object
+ *  hit by a world space ray.  The hierarchy over the object
+ *  bounds limits the exact shape tests to the objects along
+ *  the ray.
+ ***********************************************************/
+bool SceneManager::PickObject(glm::vec3 origin, glm::vec3 direction, PICK_RESULT& result)
+{
+	UpdateObjectBVH();
+
+	float distance = 0.0f;
+	int objectIndex = m_pObjectBVH->CastRay(
+		origin, direction, INFINITY, &SceneManager::IntersectObject, this, distance);
+
+	FrameStats::SetValue("pick shape tests", m_pObjectBVH->GetLastTestCount());
+	if (objectIndex < 0)
+	{
+		return(false);
+	}
+
+	result.objectIndex = objectIndex;
+	result.tag = m_sceneObjects[objectIndex].tag;
+	result.position = origin + direction * distance;
+	result.distance = distance;
+
+	return(true);
+}
+
+/***********************************************************
+ *  UsesBakedLighting()
+ *
+ *  This method is used for checking whether an object is
+ *  drawn with the lighting baked into its mesh.
+ ***********************************************************/
+bool SceneManager::UsesBakedLighting(const SCENE_OBJECT& object) const
+{
+	return((m_bBakedLighting == true) && (object.bakedMesh >= 0));
+}
+
+/***********************************************************
+ *  ReleaseBakedMeshes()
+ *
+ *  This method is used for unloading the baked meshes once
+ *  the static scene has changed, so their arena ranges are
+ *  used by the next meshes.  Every object is lit live from
+ *  then on.
+ ***********************************************************/
+void SceneManager::ReleaseBakedMeshes()
+{
+	m_bBakedLighting = false;
+	m_bStaticObjectDataDirty = true;
+
+	bool bReleased = false;
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		if (m_sceneObjects[i].bakedMesh >= 0)
+		{
+			m_pMeshLibrary->RemoveMesh(m_sceneObjects[i].bakedMesh);
+			m_sceneObjects[i].bakedMesh = -1;
+			bReleased = true;
+		}
+	}
+
+	if (bReleased == true)
+	{
+		m_pMeshLibrary->UpdateFrameStats();
+	}
+}
+
+/***********************************************************
+ *  BakeStaticLighting()
+ *
+ *  This method is used for baking the ambient and diffuse
+ *  lighting of the static objects into copies of their
+ *  meshes, on all cores.  It only reads the scene and makes
+ *  no OpenGL calls, so it can run on a worker while the
+ *  frames are drawn, and the baked meshes are loaded by
+ *  LoadBakedMeshes() afterwards.  The lights and the static objects
+ *  never change, so the fragment shader only adds the
+ *  specular highlights of the baked objects.  The shadows
+ *  of the directional lights and the spotlight are cast
+ *  with rays against the exact shapes of the static
+ *  objects, and their visibility is kept in the vertices
+ *  for the highlights, so the baked objects do not sample
+ *  the shadow maps.
+ ***********************************************************/
+void SceneManager::BakeStaticLighting()
+{
+	delete m_pLightBaker;
+	m_pLightBaker = new LightBaker();
+	m_bakedObjects.clear();
+	m_bakeGeneration = m_staticGeneration;
+
+	LightBaker& baker = *m_pLightBaker;
+	LightBaker::BAKE_LIGHT light = LightBaker::BAKE_LIGHT();
+
+	// the lights with shadows in the shader keep their
+	// visibility in the channels the shader reads it from
+	light.type = LightBaker::LIGHT_DIRECTIONAL;
+	light.shadowChannel = 0;
+	light.direction = m_directionalLight1.direction;
+	light.ambient = m_directionalLight1.ambient;
+	light.diffuse = m_directionalLight1.diffuse;
+	if (m_directionalLight1.bActive == true)
+	{
+		baker.AddLight(light);
+	}
+	light.shadowChannel = 1;
+	light.direction = m_directionalLight2.direction;
+	light.ambient = m_directionalLight2.ambient;
+	light.diffuse = m_directionalLight2.diffuse;
+	if (m_directionalLight2.bActive == true)
+	{
+		baker.AddLight(light);
+	}
+
+	light.type = LightBaker::LIGHT_POINT;
+	light.shadowChannel = -1;
+	light.position = m_pointLight1.position;
+	light.ambient = m_pointLight1.ambient;
+	light.diffuse = m_pointLight1.diffuse;
+	if (m_pointLight1.bActive == true)
+	{
+		baker.AddLight(light);
+	}
+	light.position = m_pointLight2.position;
+	light.ambient = m_pointLight2.ambient;
+	light.diffuse = m_pointLight2.diffuse;
+	if (m_pointLight2.bActive == true)
+	{
+		baker.AddLight(light);
+	}
+
+	light.type = LightBaker::LIGHT_SPOT;
+	light.shadowChannel = 2;
+	light.position = m_spotLight.position;
+	light.direction = m_spotLight.direction;
+	light.ambient = m_spotLight.ambient;
+	light.diffuse = m_spotLight.diffuse;
+	light.cutOff = m_spotLight.cutOff;
+	light.outerCutOff = m_spotLight.outerCutOff;
+	light.constant = m_spotLight.constant;
+	light.linear = m_spotLight.linear;
+	light.quadratic = m_spotLight.quadratic;
+	if (m_spotLight.bActive == true)
+	{
+		baker.AddLight(light);
+	}
+
+	std::vector<BoundsBVH::BOUNDS> bounds(m_sceneObjects.size());
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		bounds[i].boundsMin = m_sceneObjects[i].boundsMin;
+		bounds[i].boundsMax = m_sceneObjects[i].boundsMax;
+	}
+	baker.SetOccluders(bounds, &SceneManager::IntersectStaticObject, this);
+
+	// the meshes were generated or loaded once for all of
+	// the objects, the baker refines them to the size of each
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		if (object.bStatic == false)
+		{
+			continue;
+		}
+
+		int materialIndex = std::max(FindMaterialIndex(object.materialTag), 0);
+		glm::vec3 diffuseColor(1.0f);
+		if (materialIndex < static_cast<int>(m_objectMaterials.size()))
+		{
+			diffuseColor = m_objectMaterials[materialIndex].diffuseColor;
+		}
+
+		baker.AddObject(
+			GetObjectShape(object),
+			object.model,
+			diffuseColor);
+		m_bakedObjects.push_back(static_cast<int>(i));
+	}
+
+	baker.Bake();
+}
+
+/***********************************************************
+ *  LoadBakedMeshes()
+ *
+ *  This method is used for loading the meshes of the last
+ *  bake into the mesh library, in place of the ones baked
+ *  before, and drawing the static objects with them.
+ ***********************************************************/
+void SceneManager::LoadBakedMeshes()
+{
+	if (NULL == m_pLightBaker)
+	{
+		return;
+	}
+
+	// a static object was added, moved or given another mesh
+	// while the bake ran, so the baked light and shadows no
+	// longer fit the scene and every object stays lit live
+	if (m_bakeGeneration != m_staticGeneration)
+	{
+		LOG_WARNING("The static scene changed during the light bake, the baked lighting is not used");
+		delete m_pLightBaker;
+		m_pLightBaker = NULL;
+		m_bakedObjects.clear();
+		return;
+	}
+
+	ReleaseBakedMeshes();
+
+	// an object whose baked mesh does not fit into the memory
+	// budget, or no longer matches the mesh it is drawn with,
+	// stays lit live
+	for (size_t i = 0; i < m_bakedObjects.size(); i++)
+	{
+		SCENE_OBJECT& object = m_sceneObjects[m_bakedObjects[i]];
+		if (KeepsBakedGeometry(GetObjectShape(object), m_pLightBaker->GetVertices(static_cast<int>(i))) == false)
+		{
+			LOG_ERROR("Baked mesh does not match the mesh of the object, it stays lit live:" << object.tag);
+			continue;
+		}
+		object.bakedMesh = m_pMeshLibrary->AddMesh(
+			"baked " + object.tag,
+			m_pLightBaker->GetVertices(static_cast<int>(i)),
+			m_pLightBaker->GetIndices(static_cast<int>(i)));
+	}
+	m_pMeshLibrary->UpdateFrameStats();
+
+	delete m_pLightBaker;
+	m_pLightBaker = NULL;
+	m_bakedObjects.clear();
+
+	m_bBakedLighting = true;
+	m_bStaticObjectDataDirty = true;
+	FramePacer::RequestRedraw();
+}
+
+/***********************************************************
+ *  DrawShadowCasters()
+ *
+ *  This method is used for drawing either the static or the
+ *  dynamic scene objects with the shadow depth shader.
+ ***********************************************************/
+void SceneManager::DrawShadowCasters(bool bStatic)
+{
+	ShaderManager* pDepthShader = m_pShadowManager->GetDepthShader();
+
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		if (object.bStatic != bStatic)
+		{
+			continue;
+		}
+
+		GLState::SetUniform(pDepthShader, g_ModelName, object.model);
+		DrawMesh(object, pDepthShader);
+	}
+}
+
+/***********************************************************
+ *  RenderShadowMaps()
+ *
+ *  This method is used for re-rendering the cached static
+ *  shadow maps that are out of date, and compositing the
+ *  dynamic objects on top of them.
+ ***********************************************************/
+void SceneManager::RenderShadowMaps()
+{
+	// changed lights invalidate their cached shadow maps
+	m_pShadowManager->SetDirectionalLight(0, m_directionalLight1.direction, m_directionalLight1.bActive);
+	m_pShadowManager->SetDirectionalLight(1, m_directionalLight2.direction, m_directionalLight2.bActive);
+	m_pShadowManager->SetSpotLight(
+		m_spotLight.position,
+		m_spotLight.direction,
+		m_spotLight.outerCutOff,
+		m_spotLight.bActive);
+
+	m_pShadowManager->PrepareShadowViews(m_viewMatrix, m_projectionMatrix);
+
+	for (int i = 0; i < ShadowManager::NUM_SHADOW_VIEWS; i++)
+	{
+		if (m_pShadowManager->BeginStaticShadowView(i))
+		{
+			DrawShadowCasters(true);
+			m_pShadowManager->EndShadowView(i);
+		}
+	}
+
+	if (m_dynamicObjectCount > 0)
+	{
+		for (int i = 0; i < ShadowManager::NUM_SHADOW_VIEWS; i++)
+		{
+			if (m_pShadowManager->BeginDynamicShadowView(i))
+			{
+				DrawShadowCasters(false);
+				m_pShadowManager->EndShadowView(i);
+			}
+		}
+	}
+
+	m_pShadowManager->EndShadowPasses();
+	m_pShadowManager->UpdateFrameStats();
+
+	// switch back to the scene shader
+	GLState::UseShader(m_pShaderManager);
+}
+
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+
+
+/***********************************************************
+ *  DefineObjectMaterials()
+ *
+ *  This method is used for configuring the various material
+ *  settings for all of the objects within the 3D scene.
+ ***********************************************************/
+void SceneManager::DefineObjectMaterials()
+{
+	OBJECT_MATERIAL shinyMaterial;
+	shinyMaterial.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f);  // Base white color
+	shinyMaterial.specularColor = glm::vec3(1.0f, 1.0f, 1.0f); // Strong white specular highlights
+	shinyMaterial.shininess = 128.0f;  // Very shiny
+	shinyMaterial.tag = "shiny";
+	m_objectMaterials.push_back(shinyMaterial);
+
+	// Material for non-reflective objects
+	OBJECT_MATERIAL nonReflectiveMaterial;
+	nonReflectiveMaterial.diffuseColor = glm::vec3(0.65f, 0.16f, 0.16f);  // Brown color
+	nonReflectiveMaterial.specularColor = glm::vec3(0.2f, 0.2f, 0.2f);    // Low reflectivity
+	nonReflectiveMaterial.shininess = 16.0f;                              // Low shininess
+	nonReflectiveMaterial.tag = "nonReflective";
+	m_objectMaterials.push_back(nonReflectiveMaterial);
+
+	UploadObjectMaterials();
+}
+
+/***********************************************************
+ *  UploadObjectMaterials()
+ *
+ *  This method is used for passing the material values into
+ *  the shader once.  The objects select them by index.
+ ***********************************************************/
+void SceneManager::UploadObjectMaterials()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_objectMaterials.size(); i++)
+	{
+		std::string name = "materials[" + std::to_string(i) + "].";
+		m_pShaderManager->setVec3Value(name + "diffuseColor", m_objectMaterials[i].diffuseColor);
+		m_pShaderManager->setVec3Value(name + "specularColor", m_objectMaterials[i].specularColor);
+		m_pShaderManager->setFloatValue(name + "shininess", m_objectMaterials[i].shininess);
+	}
+
+	// the static objects keep the indices of their materials
+	m_bStaticObjectDataDirty = true;
+}
+
+/***********************************************************
+ *  ConnectShader()
+ *
+ *  This method is used for making the compiled scene shader
+ *  active and connecting its per-object uniform block to
+ *  the binding the values are written to.
+ ***********************************************************/
+void SceneManager::ConnectShader()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	m_pShaderManager->use();
+
+	// connect the per-object uniform block to its binding
+	GLint program = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	GLuint blockIndex = glGetUniformBlockIndex(program, g_ObjectDataBlockName);
+	if (blockIndex != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(program, blockIndex, g_ObjectDataBinding);
+	}
+}
+
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by adding
+ *  the startup tasks that load the shapes, textures in
+ *  memory to support the 3D scene rendering.  The images
+ *  are decoded and the meshes generated on the workers,
+ *  and the OpenGL uploads and the scene definitions run on
+ *  the context thread, which draws the frames.  The objects
+ *  are defined without waiting for their textures or the
+ *  baked lighting, so the first frame only waits for the
+ *  shaders, the meshes and the materials.  When an asset
+ *  pack is passed in, the textures, library meshes,
+ *  materials and objects are loaded from it instead of the
+ *  loose files.
+ ***********************************************************/
+int SceneManager::PrepareScene(TaskGraph& startup, int shaderTask, const char* assetPackFilename)
+
+// load the textures for the 3D scene
+{
+	// only one instance of a particular mesh needs to be
+	// loaded in memory no matter how many times it is drawn
+	// in the rendered 3D scene
+	int connectTask = startup.AddTask("connect scene shader", TaskGraph::THREAD_CONTEXT,
+		[this]() { ConnectShader(); },
+		{ shaderTask });
+	int generateBasicTask = startup.AddTask("generate basic meshes", TaskGraph::THREAD_WORKER,
+		[this]() { GenerateBasicMeshes(); });
+	// the occlusion tests draw the box of the basic shapes,
+	// the objects are drawn from the mesh library
+	int basicTask = startup.AddTask("load basic meshes", TaskGraph::THREAD_CONTEXT,
+		[this]()
+		{
+			m_basicMeshes->LoadBoxMesh();
+			LoadBasicMeshes();
+		},
+		{ generateBasicTask });
+
+	int sceneTask = -1;
+	m_bLoadedFromPack = false;
+	if (NULL != assetPackFilename)
+	{
+		int openTask = startup.AddTask("open asset pack", TaskGraph::THREAD_WORKER,
+			[this, assetPackFilename]() { OpenAssetPack(assetPackFilename); });
+		sceneTask = startup.AddTask("load asset pack", TaskGraph::THREAD_CONTEXT,
+			[this]() { LoadAssetPack(); },
+			{ openTask, connectTask, basicTask });
+	}
+	else
+	{
+		// the textures are numbered before the workers decode
+		// them, in the order of the texture files
+		std::vector<int> textureIndices;
+		std::vector<int> decodeTasks;
+		for (int i = 0; i < g_SceneTextureFileCount; i++)
+		{
+			int textureIndex = m_pTextureStreamer->ReserveFileTexture(g_SceneTextureFiles[i].filename);
+			textureIndices.push_back(textureIndex);
+			decodeTasks.push_back(startup.AddTask(
+				std::string("decode ") + g_SceneTextureFiles[i].filename, TaskGraph::THREAD_WORKER,
+				[this, textureIndex]() { m_pTextureStreamer->DecodeFileTexture(textureIndex); }));
+		}
+		startup.AddTask("create texture arrays", TaskGraph::THREAD_CONTEXT,
+			[this, textureIndices]() { LoadDecodedTextures(textureIndices); },
+			decodeTasks);
+
+		int materialTask = startup.AddTask("define materials", TaskGraph::THREAD_CONTEXT,
+			[this]() { DefineObjectMaterials(); },
+			{ connectTask });
+		int generateLibraryTask = startup.AddTask("generate library meshes", TaskGraph::THREAD_WORKER,
+			[this]() { GenerateLibraryMeshes(); });
+		int libraryTask = startup.AddTask("load library meshes", TaskGraph::THREAD_CONTEXT,
+			[this]() { LoadLibraryMeshes(); },
+			{ generateLibraryTask });
+		sceneTask = startup.AddTask("define scene objects", TaskGraph::THREAD_CONTEXT,
+			[this]() { DefineSceneObjects(); },
+			{ basicTask, materialTask, libraryTask });
+	}
 
-	SetShaderColor(1, 1, 1, 1);
+	// the objects are lit live until their baked meshes are
+	// loaded
+	int bakeTask = -1;
+	if (m_bLightBaking == true)
+	{
+		bakeTask = startup.AddTask("bake static lighting", TaskGraph::THREAD_WORKER,
+			[this]() { BakeStaticLighting(); },
+			{ sceneTask });
+		startup.AddTask("load baked meshes", TaskGraph::THREAD_CONTEXT,
+			[this]() { LoadBakedMeshes(); },
+			{ bakeTask });
+	}
 
-	// draw the mesh with transformation values
-	SetShaderTexture("quartz");
+	// the imported mesh is read on a worker and placed once
+	// the scene is defined - after the bake, which reads the
+	// scene objects
+	if (m_importMeshFilename.empty() == false)
+	{
+		int importTask = startup.AddTask("import mesh", TaskGraph::THREAD_WORKER,
+			[this]() { ImportMesh(); });
+		std::vector<int> placeDependencies = { importTask, sceneTask };
+		if (bakeTask >= 0)
+		{
+			placeDependencies.push_back(bakeTask);
+		}
+		startup.AddTask("place imported mesh", TaskGraph::THREAD_CONTEXT,
+			[this]() { PlaceImportedMesh(); },
+			placeDependencies);
+	}
 
+	return(sceneTask);
+}
 
+/***********************************************************
+ *  PrepareSceneSoftware()
+ *
+ *  This method is used for preparing the 3D scene for the
+ *  CPU renderer on a machine without a GPU.  The scene is
+ *  loaded one step after the other on this thread, from the
+ *  asset pack when one is passed in, and the meshes and
+ *  textures are only kept in memory - no OpenGL calls are
+ *  made.  The lighting is not baked, because the CPU
+ *  renderer lights every object live.
+ ***********************************************************/
+void SceneManager::PrepareSceneSoftware(const char* assetPackFilename)
+{
+	GenerateBasicMeshes();
 
+	m_bLoadedFromPack = false;
+	if (NULL != assetPackFilename)
+	{
+		OpenAssetPack(assetPackFilename);
+		LoadAssetPack();
+	}
+	else
+	{
+		LoadSceneTextures();
+		DefineObjectMaterials();
+		GenerateLibraryMeshes();
+		LoadLibraryMeshes();
+		DefineSceneObjects();
+	}
 
-	Material shinyMaterial;
-	shinyMaterial.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f);  // Base white color
-	shinyMaterial.specularColor = glm::vec3(1.0f, 1.0f, 1.0f); // Strong white specular highlights
-	shinyMaterial.shininess = 128.0f;  // Very shiny
+	if (m_importMeshFilename.empty() == false)
+	{
+		ImportMesh();
+		PlaceImportedMesh();
+	}
+}
 
-	// Pass the material to the shader
-	m_pShaderManager->setVec3Value("material.diffuseColor", shinyMaterial.diffuseColor);
-	m_pShaderManager->setVec3Value("material.specularColor", shinyMaterial.specularColor);
-	m_pShaderManager->setFloatValue("material.shininess", shinyMaterial.shininess);
+/***********************************************************
+ *  OpenAssetPack()
+ *
+ *  This method is used for opening a cooked asset pack and
+ *  checking the whole pack before anything is uploaded, so
+ *  a bad pack leaves the scene empty for the loose files.
+ *  It makes no OpenGL calls, so it can run on a worker.
+ ***********************************************************/
+bool SceneManager::OpenAssetPack(const char* filename)
+{
+	m_pAssetPack = new AssetPack();
+	if (m_pAssetPack->Open(filename) == false)
+	{
+		delete m_pAssetPack;
+		m_pAssetPack = NULL;
+		return(false);
+	}
 
+	const AssetPack& pack = *m_pAssetPack;
 
+	const AssetPack::PACK_HEADER& header = pack.GetHeader();
+	bool bValid = true;
 
+	// the CPU renderer decodes the compressed textures itself
+	bool bS3TC = (NULL == m_pShaderManager) || GLEW_EXT_texture_compression_s3tc;
 
-	m_basicMeshes->DrawPlaneMesh();
-	/****************************************************************/
+	for (uint32_t i = 0; (i < header.textureCount) && (bValid == true); i++)
+	{
+		const AssetPack::PACK_TEXTURE& texture = pack.GetTextures()[i];
+		bool bCompressed = (texture.internalFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) ||
+			(texture.internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+
+		bValid = ((bCompressed == true) || (texture.internalFormat == GL_RGBA8)) &&
+			((bCompressed == false) || (bS3TC == true)) &&
+			(texture.width > 0) && (texture.height > 0) &&
+			(texture.levelCount > 0) && (texture.levelCount <= AssetPack::MAX_TEXTURE_LEVELS);
+		for (uint32_t level = 0; (level < texture.levelCount) && (bValid == true); level++)
+		{
+			bValid = (NULL != pack.GetData(texture.levelOffsets[level], texture.levelBytes[level]));
+		}
+	}
+	for (uint32_t i = 0; (i < header.meshCount) && (bValid == true); i++)
+	{
+		const AssetPack::PACK_MESH& mesh = pack.GetMeshes()[i];
+		bValid = (mesh.format <= MeshLibrary::VERTEX_FORMAT_PACKED) &&
+			((mesh.indexType == GL_UNSIGNED_SHORT) || (mesh.indexType == GL_UNSIGNED_INT)) &&
+			(NULL != pack.GetData(mesh.vertexOffset, mesh.vertexBytes)) &&
+			(NULL != pack.GetData(mesh.indexOffset, mesh.indexBytes));
+	}
+	for (uint32_t i = 0; (i < header.objectCount) && (bValid == true); i++)
+	{
+		bValid = (pack.GetObjects()[i].mesh <= TAPERED_CYLINDER_MESH);
+	}
 
-	//Lower box for desk
-	XrotationDegrees = 90.0f;
-	scaleXYZ = glm::vec3(30.0f, 1.0f, 30.0f);
-	positionXYZ = glm::vec3(0.0f, 30.0f, -30.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(1, 1, 1, 1);  // Brown color
-	SetTextureUVScale(1.0f, 1.0f);  // Apply tiling to deskRod texture (adjust tiling as needed)
+	if (bValid == false)
+	{
+		LOG_ERROR("Asset pack has invalid records:" << filename);
+		delete m_pAssetPack;
+		m_pAssetPack = NULL;
+		return(false);
+	}
 
+	LOG_INFO("Opened asset pack:" << filename << ", bytes:" << pack.GetFileSize());
 
+	return(true);
+}
 
-	SetShaderTexture("quartz");
-	m_basicMeshes->DrawPlaneMesh();
-	/****************************************************************/
+/***********************************************************
+ *  LoadAssetPack()
+ *
+ *  This method is used for loading the scene from the
+ *  opened asset pack.  The mesh data is passed to OpenGL
+ *  straight from the mapped file, and the pack stays mapped
+ *  for streaming the texture levels.  When the pack could
+ *  not be opened, the scene is loaded from the loose files
+ *  one step after the other instead.
+ ***********************************************************/
+void SceneManager::LoadAssetPack()
+{
+	if (NULL == m_pAssetPack)
+	{
+		LOG_WARNING("Loading the scene from the loose files instead");
+		LoadSceneTextures();
+		DefineObjectMaterials();
+		GenerateLibraryMeshes();
+		LoadLibraryMeshes();
+		DefineSceneObjects();
+		return;
+	}
 
+	const AssetPack& pack = *m_pAssetPack;
+	const AssetPack::PACK_HEADER& header = pack.GetHeader();
 
+	for (uint32_t i = 0; i < header.textureCount; i++)
+	{
+		CreatePackedTexture(pack, pack.GetTextures()[i]);
+	}
+	BindGLTextures();
 
-	// Material for non-reflective objects
-	Material nonReflectiveMaterial;
-	nonReflectiveMaterial.diffuseColor = glm::vec3(0.65f, 0.16f, 0.16f);  // Brown color
-	nonReflectiveMaterial.specularColor = glm::vec3(0.2f, 0.2f, 0.2f);    // Low reflectivity
-	nonReflectiveMaterial.shininess = 16.0f;                              // Low shininess
+	for (uint32_t i = 0; i < header.materialCount; i++)
+	{
+		const AssetPack::PACK_MATERIAL& packed = pack.GetMaterials()[i];
+		OBJECT_MATERIAL material;
+		material.diffuseColor = glm::vec3(packed.diffuseColor[0], packed.diffuseColor[1], packed.diffuseColor[2]);
+		material.specularColor = glm::vec3(packed.specularColor[0], packed.specularColor[1], packed.specularColor[2]);
+		material.shininess = packed.shininess;
+		material.tag = pack.GetString(packed.tagOffset);
+		m_objectMaterials.push_back(material);
+	}
+	UploadObjectMaterials();
+
+	for (uint32_t i = 0; i < header.meshCount; i++)
+	{
+		const AssetPack::PACK_MESH& packed = pack.GetMeshes()[i];
+		MeshLibrary::MESH_BUFFERS buffers;
+		buffers.format = static_cast<MeshLibrary::VERTEX_FORMAT>(packed.format);
+		buffers.vertices = pack.GetData(packed.vertexOffset, packed.vertexBytes);
+		buffers.vertexBytes = static_cast<size_t>(packed.vertexBytes);
+		buffers.indices = pack.GetData(packed.indexOffset, packed.indexBytes);
+		buffers.indexBytes = static_cast<size_t>(packed.indexBytes);
+		buffers.indexType = packed.indexType;
+		buffers.indexCount = static_cast<GLsizei>(packed.indexCount);
+		buffers.positionOffset = glm::vec3(packed.positionOffset[0], packed.positionOffset[1], packed.positionOffset[2]);
+		buffers.positionScale = glm::vec3(packed.positionScale[0], packed.positionScale[1], packed.positionScale[2]);
+		int meshIndex = m_pMeshLibrary->AddMesh(pack.GetString(packed.tagOffset), buffers);
+		MESH_DATA data;
+		if ((meshIndex >= 0) && (MeshLibrary::DecodeMesh(buffers, data) == true))
+		{
+			KeepLibraryShape(meshIndex, data);
+		}
+	}
+	m_pMeshLibrary->UpdateFrameStats();
+
+	for (uint32_t i = 0; i < header.objectCount; i++)
+	{
+		const AssetPack::PACK_OBJECT& packed = pack.GetObjects()[i];
+		int objectIndex = AddSceneObject(
+			pack.GetString(packed.tagOffset),
+			static_cast<MESH_TYPE>(packed.mesh),
+			glm::vec3(packed.scaleXYZ[0], packed.scaleXYZ[1], packed.scaleXYZ[2]),
+			packed.rotationDegrees[0],
+			packed.rotationDegrees[1],
+			packed.rotationDegrees[2],
+			glm::vec3(packed.positionXYZ[0], packed.positionXYZ[1], packed.positionXYZ[2]),
+			glm::vec4(packed.color[0], packed.color[1], packed.color[2], packed.color[3]),
+			pack.GetString(packed.textureTagOffset),
+			glm::vec2(packed.UVscale[0], packed.UVscale[1]),
+			pack.GetString(packed.materialTagOffset),
+			(packed.bStatic != 0));
+
+		const char* meshTag = pack.GetString(packed.meshTagOffset);
+		if (meshTag[0] != '\0')
+		{
+			SetObjectMesh(objectIndex, meshTag);
+		}
+	}
+
+	m_bLoadedFromPack = true;
+	FramePacer::RequestRedraw();
+	LOG_INFO("Loaded asset pack, textures:" << header.textureCount << ", meshes:" << header.meshCount
+		<< ", objects:" << header.objectCount);
+}
+
+/***********************************************************
+ *  CreatePackedTexture()
+ *
+ *  This method is used for creating a texture from a cooked
+ *  mip chain in the asset pack.  The levels are uploaded as
+ *  they are stored, so no mipmaps are generated, and the
+ *  larger ones are streamed from the pack when they are
+ *  needed.  A texture that does not fit into the memory
+ *  budget is not loaded.
+ ***********************************************************/
+bool SceneManager::CreatePackedTexture(const AssetPack& pack, const AssetPack::PACK_TEXTURE& texture)
+{
+	int textureIndex = m_pTextureStreamer->AddPackedTexture(&pack, texture);
+	if (textureIndex < 0)
+	{
+		return(false);
+	}
+
+	// register the texture by its tag, like the loose textures
+	TEXTURE_INFO info;
+	info.ID = static_cast<uint32_t>(textureIndex);
+	info.tag = pack.GetString(texture.tagOffset);
+	m_textureIDs.push_back(info);
+	m_loadedTextures++;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CookAssetPack()
+ *
+ *  This method is used for writing the scene that was
+ *  loaded from the loose files into an asset pack.  The
+ *  textures and library meshes are read back from OpenGL,
+ *  and the materials and objects are written as they were
+ *  defined.
+ ***********************************************************/
+bool SceneManager::CookAssetPack(const char* filename)
+{
+	AssetPackWriter writer;
+
+	// the whole mip chains are written, not just the levels
+	// that were streamed in
+	m_pTextureStreamer->LoadAllLevels();
+
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		int textureIndex = static_cast<int>(m_textureIDs[i].ID);
+		if (writer.AddTexture(
+			m_textureIDs[i].tag,
+			m_pTextureStreamer->GetArrayTexture(textureIndex),
+			m_pTextureStreamer->GetTextureLayer(textureIndex)) == false)
+		{
+			return(false);
+		}
+	}
+
+	std::vector<unsigned char> vertices;
+	std::vector<unsigned char> indices;
+	for (int i = 0; i < m_pMeshLibrary->GetMeshCount(); i++)
+	{
+		// the baked meshes are baked again and the basic shapes
+		// generated again when the pack is loaded
+		MeshLibrary::MESH_BUFFERS buffers;
+		if ((std::find(m_basicLibraryMeshes, m_basicLibraryMeshes + TAPERED_CYLINDER_MESH + 1, i) ==
+				(m_basicLibraryMeshes + TAPERED_CYLINDER_MESH + 1)) &&
+			(m_pMeshLibrary->ReadMesh(i, vertices, indices, buffers) == true) &&
+			(buffers.format != MeshLibrary::VERTEX_FORMAT_BAKED))
+		{
+			writer.AddMesh(m_pMeshLibrary->GetMeshTag(i), buffers);
+		}
+	}
+
+	for (size_t i = 0; i < m_objectMaterials.size(); i++)
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[i];
+		AssetPack::PACK_MATERIAL packed;
+		for (int c = 0; c < 3; c++)
+		{
+			packed.diffuseColor[c] = material.diffuseColor[c];
+			packed.specularColor[c] = material.specularColor[c];
+		}
+		packed.shininess = material.shininess;
+		writer.AddMaterial(material.tag, packed);
+	}
+
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		AssetPack::PACK_OBJECT packed;
+		packed.mesh = static_cast<uint32_t>(object.mesh);
+		packed.bStatic = (object.bStatic == true) ? 1 : 0;
+		for (int c = 0; c < 3; c++)
+		{
+			packed.scaleXYZ[c] = object.scaleXYZ[c];
+			packed.positionXYZ[c] = object.positionXYZ[c];
+		}
+		packed.rotationDegrees[0] = object.XrotationDegrees;
+		packed.rotationDegrees[1] = object.YrotationDegrees;
+		packed.rotationDegrees[2] = object.ZrotationDegrees;
+		for (int c = 0; c < 4; c++)
+		{
+			packed.color[c] = object.color[c];
+		}
+		packed.UVscale[0] = object.UVscale.x;
+		packed.UVscale[1] = object.UVscale.y;
+
+		writer.AddObject(
+			object.tag,
+			object.textureTag,
+			object.materialTag,
+			m_pMeshLibrary->GetMeshTag(object.libraryMesh),
+			packed);
+	}
+
+	return(writer.Write(filename));
+}
+
+/***********************************************************
+ *  GenerateLibraryMeshes()
+ *
+ *  This method is used for building the meshes that are not
+ *  covered by the basic shapes.  Finely tessellated meshes
+ *  are loaded with the packed vertex format to halve their
+ *  vertex memory, and every mesh is reordered for the
+ *  vertex cache first.  It makes no OpenGL calls, so it can
+ *  run on a worker.
+ ***********************************************************/
+void SceneManager::GenerateLibraryMeshes()
+{
+	// smooth sphere for the rounded lamp parts
+	PENDING_MESH sphere;
+	sphere.tag = "smoothSphere";
+	sphere.format = MeshLibrary::VERTEX_FORMAT_PACKED;
+	MeshGenerator::GenerateSphere(sphere.data, 64, 128);
+	MeshOptimizer::OptimizeMesh(sphere.data, "smoothSphere");
+	m_pendingMeshes.push_back(sphere);
+}
+
+/***********************************************************
+ *  LoadLibraryMeshes()
+ *
+ *  This method is used for loading the generated meshes
+ *  into the mesh library and freeing their data.
+ ***********************************************************/
+void SceneManager::LoadLibraryMeshes()
+{
+	for (size_t i = 0; i < m_pendingMeshes.size(); i++)
+	{
+		int meshIndex = m_pMeshLibrary->AddMesh(m_pendingMeshes[i].tag, m_pendingMeshes[i].data, m_pendingMeshes[i].format);
+		KeepLibraryShape(meshIndex, m_pendingMeshes[i].data);
+	}
+	std::vector<PENDING_MESH>().swap(m_pendingMeshes);
+
+	m_pMeshLibrary->UpdateFrameStats();
+}
+
+/***********************************************************
+ *  ImportMesh()
+ *
+ *  This method is used for importing the mesh file passed
+ *  on the command line, scaled to the size of the basic
+ *  box and optimized like the generated meshes.  It makes
+ *  no OpenGL calls, so it can run on a worker.
+ ***********************************************************/
+void SceneManager::ImportMesh()
+{
+	m_importedMesh.tag = "imported mesh";
+	m_importedMesh.format = MeshLibrary::VERTEX_FORMAT_PACKED;
+
+	MeshImporter importer;
+	if (importer.Import(m_importMeshFilename.c_str(), m_importedMesh.data) == false)
+	{
+		return;
+	}
+	MeshImporter::FitToUnitBox(m_importedMesh.data);
+	MeshOptimizer::OptimizeMesh(m_importedMesh.data, m_importedMesh.tag);
+
+	const MeshImporter::IMPORT_STATS& stats = importer.GetStats();
+	LOG_INFO("INFO: Imported " << m_importMeshFilename << " - " << stats.triangleCount << " triangles, "
+		<< stats.vertexCount << " vertices in " << stats.totalTime << " ms on "
+		<< stats.threadCount << " threads");
+}
+
+/***********************************************************
+ *  PlaceImportedMesh()
+ *
+ *  This method is used for loading the imported mesh into
+ *  the mesh library and placing it on the desk, as a
+ *  dynamic object, so the baked lighting does not take it
+ *  for the box it is placed like.
+ ***********************************************************/
+void SceneManager::PlaceImportedMesh()
+{
+	if (m_importedMesh.data.indices.empty() == true)
+	{
+		return;
+	}
+
+	int meshIndex = m_pMeshLibrary->AddMesh(m_importedMesh.tag, m_importedMesh.data, m_importedMesh.format);
+	KeepLibraryShape(meshIndex, m_importedMesh.data);
+	m_importedMesh.data = MESH_DATA();
+	if (meshIndex < 0)
+	{
+		return;
+	}
+
+	int objectIndex = AddSceneObject(
+		"imported mesh",
+		BOX_MESH,
+		glm::vec3(4.0f, 4.0f, 4.0f),
+		0.0f,
+		0.0f,
+		0.0f,
+		glm::vec3(-7.0f, 13.25f, -3.0f),
+		glm::vec4(0.7f, 0.7f, 0.7f, 1.0f),
+		"",
+		glm::vec2(1.0f, 1.0f),
+		"shiny",
+		false);
+	SetObjectMesh(objectIndex, m_importedMesh.tag);
+
+	m_pMeshLibrary->UpdateFrameStats();
+}
+
+/***********************************************************
+ *  GenerateBasicMeshes()
+ *
+ *  This method is used for generating the basic shapes.
+ *  They are generated on every run, also when the scene
+ *  comes from an asset pack, and kept for the light baker
+ *  to refine.  It makes no OpenGL calls, so it can run on a
+ *  worker.
+ ***********************************************************/
+void SceneManager::GenerateBasicMeshes()
+{
+	for (int i = 0; i <= TAPERED_CYLINDER_MESH; i++)
+	{
+		GenerateBasicMesh(static_cast<MESH_TYPE>(i), m_basicShapes[i]);
+	}
+}
+
+/***********************************************************
+ *  LoadBasicMeshes()
+ *
+ *  This method is used for loading the generated basic
+ *  shapes into the mesh library, so they share the arena
+ *  buffers and the vertex array with the other float
+ *  meshes.
+ ***********************************************************/
+void SceneManager::LoadBasicMeshes()
+{
+	const char* tags[TAPERED_CYLINDER_MESH + 1] =
+	{
+		"basic plane",
+		"basic box",
+		"basic cylinder",
+		"basic sphere",
+		"basic cone",
+		"basic tapered cylinder"
+	};
+
+	for (int i = 0; i <= TAPERED_CYLINDER_MESH; i++)
+	{
+		m_basicLibraryMeshes[i] = m_pMeshLibrary->AddMesh(tags[i], m_basicShapes[i], MeshLibrary::VERTEX_FORMAT_FLOAT);
+	}
+
+	m_pMeshLibrary->UpdateFrameStats();
+}
+
+/***********************************************************
+ *  GenerateBasicMesh()
+ *
+ *  This method is used for generating a basic shape with
+ *  the tessellation it is drawn with, which the light baker
+ *  refines from as well.
+ ***********************************************************/
+void SceneManager::GenerateBasicMesh(MESH_TYPE mesh, MESH_DATA& data)
+{
+	switch (mesh)
+	{
+	case PLANE_MESH:
+		MeshGenerator::GeneratePlane(data, 1);
+		break;
+	case BOX_MESH:
+		MeshGenerator::GenerateBox(data);
+		break;
+	case CYLINDER_MESH:
+		MeshGenerator::GenerateCylinder(data, 64, 1, 1.0f, true);
+		break;
+	case SPHERE_MESH:
+		MeshGenerator::GenerateSphere(data, 32, 64);
+		break;
+	case CONE_MESH:
+		MeshGenerator::GenerateCylinder(data, 64, 1, 0.0f, true);
+		break;
+	case TAPERED_CYLINDER_MESH:
+		MeshGenerator::GenerateCylinder(data, 64, 1, 0.5f, true);
+		break;
+	}
+}
+
+/***********************************************************
+ *  DefineSceneObjects()
+ *
+ *  This method is used for placing the objects of the 3D
+ *  scene.  Each object keeps the transformations, color,
+ *  texture and material it is drawn with, so the scene can
+ *  be drawn for the shadow maps as well as the final image.
+ *  The scene never changes, so it is declared in the
+ *  g_DeskSceneObjects table and compiled while the project
+ *  is built, and only the compiled table is added here.
+ ***********************************************************/
+void SceneManager::DefineSceneObjects()
+{
+	AddStaticScene(g_DeskScene.objects, g_DeskScene.GetCount());
+}
+
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by 
+ *  transforming and drawing the basic 3D shapes
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	// the transient data of the last frame is no longer used
+	m_pFrameArena->Reset();
+
+	// bring the cached shadow maps up to date first
+	RenderShadowMaps();
+
+	// wait until the per-object values of this frame's region
+	// have been read by the GPU, once there is room for the
+	// values of every dynamic object
+	ReserveObjectData();
+	m_pObjectDataBuffer->BeginFrame();
+
+	GLState::SetUniform(m_pShaderManager, "bUseLighting", true);
+
+	// Pass the first directional light to the shader - the
+	// shader takes the light directions normalized
+	GLState::SetUniform(m_pShaderManager, "directionalLight1.direction", glm::normalize(m_directionalLight1.direction));
+	GLState::SetUniform(m_pShaderManager, "directionalLight1.ambient", m_directionalLight1.ambient);
+	GLState::SetUniform(m_pShaderManager, "directionalLight1.diffuse", m_directionalLight1.diffuse);
+	GLState::SetUniform(m_pShaderManager, "directionalLight1.specular", m_directionalLight1.specular);
+	GLState::SetUniform(m_pShaderManager, "directionalLight1.bActive", m_directionalLight1.bActive);
+
+	// Pass the second directional light to the shader
+	GLState::SetUniform(m_pShaderManager, "directionalLight2.direction", glm::normalize(m_directionalLight2.direction));
+	GLState::SetUniform(m_pShaderManager, "directionalLight2.ambient", m_directionalLight2.ambient);
+	GLState::SetUniform(m_pShaderManager, "directionalLight2.diffuse", m_directionalLight2.diffuse);
+	GLState::SetUniform(m_pShaderManager, "directionalLight2.specular", m_directionalLight2.specular);
+	GLState::SetUniform(m_pShaderManager, "directionalLight2.bActive", m_directionalLight2.bActive);
+
+	// Pass the blue point light to the shader
+	GLState::SetUniform(m_pShaderManager, "pointLights[0].position", m_pointLight1.position);
+	GLState::SetUniform(m_pShaderManager, "pointLights[0].ambient", m_pointLight1.ambient);
+	GLState::SetUniform(m_pShaderManager, "pointLights[0].diffuse", m_pointLight1.diffuse);
+	GLState::SetUniform(m_pShaderManager, "pointLights[0].specular", m_pointLight1.specular);
+	GLState::SetUniform(m_pShaderManager, "pointLights[0].bActive", m_pointLight1.bActive);
+
+	// Pass the red point light to the shader
+	GLState::SetUniform(m_pShaderManager, "pointLights[1].position", m_pointLight2.position);
+	GLState::SetUniform(m_pShaderManager, "pointLights[1].ambient", m_pointLight2.ambient);
+	GLState::SetUniform(m_pShaderManager, "pointLights[1].diffuse", m_pointLight2.diffuse);
+	GLState::SetUniform(m_pShaderManager, "pointLights[1].specular", m_pointLight2.specular);
+	GLState::SetUniform(m_pShaderManager, "pointLights[1].bActive", m_pointLight2.bActive);
+
+	// Pass the spotlight to the shader - the shader holds the
+	// spotlights in an array and shadows the first one
+	GLState::SetUniform(m_pShaderManager, "spotLights[0].position", m_spotLight.position);
+	GLState::SetUniform(m_pShaderManager, "spotLights[0].direction", glm::normalize(m_spotLight.direction));
+	GLState::SetUniform(m_pShaderManager, "spotLights[0].cutOff", m_spotLight.cutOff);
+	GLState::SetUniform(m_pShaderManager, "spotLights[0].outerCutOff", m_spotLight.outerCutOff);
+	GLState::SetUniform(m_pShaderManager, "spotLights[0].constant", m_spotLight.constant);
+	GLState::SetUniform(m_pShaderManager, "spotLights[0].linear", m_spotLight.linear);
+	GLState::SetUniform(m_pShaderManager, "spotLights[0].quadratic", m_spotLight.quadratic);
+	GLState::SetUniform(m_pShaderManager, "spotLights[0].ambient", m_spotLight.ambient);
+	GLState::SetUniform(m_pShaderManager, "spotLights[0].diffuse", m_spotLight.diffuse);
+	GLState::SetUniform(m_pShaderManager, "spotLights[0].specular", m_spotLight.specular);
+	GLState::SetUniform(m_pShaderManager, "spotLights[0].bActive", m_spotLight.bActive);
+
+	// Pass the shadow maps to the shader
+	m_pShadowManager->BindShadowMaps(m_pShaderManager, m_dynamicObjectCount > 0);
+
+	// cull the objects once for all of the views, then draw
+	// the ones that are left into each view they are seen in
+	CollectDraws();
+	SubmitDraws();
+
+	// load the texture levels the drawn objects asked for
+	m_pTextureStreamer->Update();
+	m_pTextureStreamer->UpdateFrameStats();
+
+	m_pObjectDataBuffer->EndFrame();
+	m_pObjectDataBuffer->UpdateFrameStats();
+	m_pFrameArena->UpdateFrameStats();
+
+	// test the bounds against this frame's depth for the next
+	// frame, when a single view is drawn
+	if (m_viewCount == 1)
+	{
+		TestOcclusion();
+	}
+}
+
+/***********************************************************
+ *  RenderSceneSoftware()
+ *
+ *  This method is used for drawing the first view of the
+ *  scene with the CPU rasterizer, for machines without a
+ *  GPU and for checking the frames drawn by OpenGL.  The
+ *  objects are culled against the view like RenderScene()
+ *  does, and lit live by the same lights and materials.
+ *  Each object is drawn with the mesh GetObjectShape()
+ *  returns for it, the library or imported mesh when it
+ *  has one.  The textures are read from the asset pack or
+ *  the image files the texture streamer loads them from,
+ *  when they are first drawn.  No OpenGL calls are made,
+ *  and the image is returned.
+ ***********************************************************/
+const SoftwareRasterizer* SceneManager::RenderSceneSoftware(int width, int height)
+{
+	if (NULL == m_pSoftwareRasterizer)
+	{
+		m_pSoftwareRasterizer = new SoftwareRasterizer();
+	}
+
+	// give the rasterizer the textures that were registered
+	// since the last frame, from the same pack or image file
+	// the texture streamer loads their levels from
+	std::vector<unsigned char> texels;
+	for (; m_softwareTextureCount < m_loadedTextures; m_softwareTextureCount++)
+	{
+		const TEXTURE_INFO& registered = m_textureIDs[m_softwareTextureCount];
+		int textureWidth = 0;
+		int textureHeight = 0;
+		int channels = 0;
+		if (m_pTextureStreamer->ReadTexels(static_cast<int>(registered.ID), texels,
+			textureWidth, textureHeight, channels) == false)
+		{
+			LOG_ERROR("Failed to read the " << registered.tag << " texture for the software renderer!");
+			continue;
+		}
+
+		TEXTURE_INFO texture;
+		texture.tag = registered.tag;
+		texture.ID = static_cast<uint32_t>(
+			m_pSoftwareRasterizer->AddTexture(texels.data(), textureWidth, textureHeight, channels));
+		m_softwareTextures.push_back(texture);
+	}
+
+	SoftwareRasterizer& rasterizer = *m_pSoftwareRasterizer;
+	if ((rasterizer.GetWidth() != width) || (rasterizer.GetHeight() != height))
+	{
+		rasterizer.SetSize(width, height);
+	}
+
+	rasterizer.BeginFrame(m_views[0].view, m_views[0].projection, m_views[0].position, glm::vec3(0.0f));
+
+	SoftwareRasterizer::RASTER_LIGHT light = SoftwareRasterizer::RASTER_LIGHT();
+	light.type = SoftwareRasterizer::LIGHT_DIRECTIONAL;
+	light.direction = m_directionalLight1.direction;
+	light.ambient = m_directionalLight1.ambient;
+	light.diffuse = m_directionalLight1.diffuse;
+	light.specular = m_directionalLight1.specular;
+	if (m_directionalLight1.bActive == true)
+	{
+		rasterizer.AddLight(light);
+	}
+	light.direction = m_directionalLight2.direction;
+	light.ambient = m_directionalLight2.ambient;
+	light.diffuse = m_directionalLight2.diffuse;
+	light.specular = m_directionalLight2.specular;
+	if (m_directionalLight2.bActive == true)
+	{
+		rasterizer.AddLight(light);
+	}
+
+	light.type = SoftwareRasterizer::LIGHT_POINT;
+	light.position = m_pointLight1.position;
+	light.ambient = m_pointLight1.ambient;
+	light.diffuse = m_pointLight1.diffuse;
+	light.specular = m_pointLight1.specular;
+	if (m_pointLight1.bActive == true)
+	{
+		rasterizer.AddLight(light);
+	}
+	light.position = m_pointLight2.position;
+	light.ambient = m_pointLight2.ambient;
+	light.diffuse = m_pointLight2.diffuse;
+	light.specular = m_pointLight2.specular;
+	if (m_pointLight2.bActive == true)
+	{
+		rasterizer.AddLight(light);
+	}
+
+	light.type = SoftwareRasterizer::LIGHT_SPOT;
+	light.position = m_spotLight.position;
+	light.direction = m_spotLight.direction;
+	light.ambient = m_spotLight.ambient;
+	light.diffuse = m_spotLight.diffuse;
+	light.specular = m_spotLight.specular;
+	light.cutOff = m_spotLight.cutOff;
+	light.outerCutOff = m_spotLight.outerCutOff;
+	light.constant = m_spotLight.constant;
+	light.linear = m_spotLight.linear;
+	light.quadratic = m_spotLight.quadratic;
+	if (m_spotLight.bActive == true)
+	{
+		rasterizer.AddLight(light);
+	}
+
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		if ((CalculateViewMask(object) & 1u) == 0)
+		{
+			continue;
+		}
+
+		SoftwareRasterizer::RASTER_MATERIAL material = { glm::vec3(1.0f), glm::vec3(0.0f), 1.0f };
+		int materialIndex = std::max(FindMaterialIndex(object.materialTag), 0);
+		if (materialIndex < static_cast<int>(m_objectMaterials.size()))
+		{
+			material.diffuseColor = m_objectMaterials[materialIndex].diffuseColor;
+			material.specularColor = m_objectMaterials[materialIndex].specularColor;
+			material.shininess = m_objectMaterials[materialIndex].shininess;
+		}
 
-	// Pass the non-reflective material to the shader
-	m_pShaderManager->setVec3Value("material.diffuseColor", nonReflectiveMaterial.diffuseColor);
-	m_pShaderManager->setVec3Value("material.specularColor", nonReflectiveMaterial.specularColor);
-	m_pShaderManager->setFloatValue("material.shininess", nonReflectiveMaterial.shininess);
-
-
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-	//Lower box for desk
-	scaleXYZ = glm::vec3(25.0f, 2.0f, 15.0f);
-	positionXYZ = glm::vec3(0.0f, 10.0f, 0.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.65f, 0.16f, 0.16f, 1);  // Brown color
-	SetTextureUVScale(1.0f, 1.0f);  // Apply tiling to deskRod texture (adjust tiling as needed)
-	SetShaderTexture("deskRim");
-	m_basicMeshes->DrawBoxMesh();
-
-	//Top box for desk
-	scaleXYZ = glm::vec3(25.5f, 0.5f, 15.5f);
-	positionXYZ = glm::vec3(0.0f, 11.0f, 0.0f); 
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.65f, 0.16f, 0.16f, 1);  // Brown color
-	SetShaderTexture("deskTop");
-	m_basicMeshes->DrawBoxMesh();
-
-
-	//Seting the reflective materials again
-	m_pShaderManager->setVec3Value("material.diffuseColor", shinyMaterial.diffuseColor);
-	m_pShaderManager->setVec3Value("material.specularColor", shinyMaterial.specularColor);
-	m_pShaderManager->setFloatValue("material.shininess", shinyMaterial.shininess);
-
-	//Right leg backward
-	scaleXYZ = glm::vec3(1.0f, 10.0f, 1.0f);
-	positionXYZ = glm::vec3(10.0f, 0.0f, -5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("deskRod");
-	SetTextureUVScale(2.0f, 2.0f);  // Apply tiling to deskRod texture (adjust tiling as needed)
-	m_basicMeshes->DrawCylinderMesh();
-
-	//Right leg forward
-	scaleXYZ = glm::vec3(1.0f, 10.0f, 1.0f);
-	positionXYZ = glm::vec3(10.0f, 0.0f, 5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("deskRod");
-	SetTextureUVScale(2.0f, 2.0f);  // Apply tiling to deskRod texture
-	m_basicMeshes->DrawCylinderMesh();
-
-	//Left leg backward
-	scaleXYZ = glm::vec3(1.0f, 10.0f, 1.0f);
-	positionXYZ = glm::vec3(-10.0f, 0.0f, -5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("deskRod");
-	SetTextureUVScale(2.0f, 2.0f);  // Apply tiling to deskRod texture
-	m_basicMeshes->DrawCylinderMesh();
-
-	//Left leg forward
-	scaleXYZ = glm::vec3(1.0f, 10.0f, 1.0f);
-	positionXYZ = glm::vec3(-10.0f, 0.0f, 5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("deskRod");
-	SetTextureUVScale(2.0f, 2.0f);  // Apply tiling to deskRod texture
-	m_basicMeshes->DrawCylinderMesh();
-
-	//Left leg bracer
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(1.0f, 10.0f, 1.0f);
-	positionXYZ = glm::vec3(-10.0f, 5.0f, -5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("deskRod");
-	SetTextureUVScale(2.0f, 2.0f);  // Apply tiling to deskRod texture
-	m_basicMeshes->DrawCylinderMesh();
-
-	//Right leg bracer
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(1.0f, 10.0f, 1.0f);
-	positionXYZ = glm::vec3(10.0f, 5.0f, -5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("deskRod");
-	SetTextureUVScale(2.0f, 2.0f);  // Apply tiling to deskRod texture
-	m_basicMeshes->DrawCylinderMesh();
-
-	//Lamp base
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(2.0f, 1.0f, 2.0f);
-	positionXYZ = glm::vec3(8.0f, 11.0f, -5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("copper");
-	SetTextureUVScale(1, 1); 
-	m_basicMeshes->DrawCylinderMesh();
-
-	//Lamp base top
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(2.0f, 1.0f, 2.0f);
-	positionXYZ = glm::vec3(8.0f, 12.0f, -5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("copper");
-	SetTextureUVScale(1, 1);	
-	m_basicMeshes->DrawSphereMesh();
-
-	// Lamp bottom pipe connect bottom
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(0.5f, 1.0f, 0.5f);
-	positionXYZ = glm::vec3(8.0f, 12.5f, -5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("copper");
-	SetTextureUVScale(1, 1);
-	m_basicMeshes->DrawCylinderMesh();
-
-	// Lamp bottom pipe
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = -15.0f;
-
-	scaleXYZ = glm::vec3(0.25f, 7.5f, 0.25f);
-	positionXYZ = glm::vec3(7.75f, 12.5f, -5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("copper");
-	SetTextureUVScale(1, 1);
-	m_basicMeshes->DrawCylinderMesh();
-
-	//Lamp bottom pipe connect top
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = -15.0f;
-
-	scaleXYZ = glm::vec3(0.5f, 0.5f, 0.5f);
-	positionXYZ = glm::vec3(9.65f, 19.5f, -5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("copper");
-	SetTextureUVScale(1, 1);
-	m_basicMeshes->DrawCylinderMesh();
-
-	// Lamp joint
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(0.65f, 0.65f, 0.65f);
-	positionXYZ = glm::vec3(9.80f, 20.25f, -5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("copper");
-	SetTextureUVScale(1, 1);
-	m_basicMeshes->DrawSphereMesh();
-
-	// Top Rod
-	XrotationDegrees = 45.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 90.0f;
-
-	scaleXYZ = glm::vec3(0.25f, 7.5f, 0.25f);
-	positionXYZ = glm::vec3(9.80f, 20.25f, -5.0f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("copper");
-	SetTextureUVScale(1, 1);
-	m_basicMeshes->DrawCylinderMesh();
-
-	// Base Shell
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(1.0f, 1.5f, 1.0f);
-	positionXYZ = glm::vec3(4.0f, 19.5f, 0.5f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("copper");
-	SetTextureUVScale(1, 1);
-	m_basicMeshes->DrawCylinderMesh();
-
-	//Light Base Shell
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(1.5f, 1.0f, 1.5f);
-	positionXYZ = glm::vec3(4.0f, 19.0f, 0.5f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.5f, 0.5f, 0.5f, 1);  // Grey color
-	SetShaderTexture("copper");
-	SetTextureUVScale(1, 1);
-	m_basicMeshes->DrawTaperedCylinderMesh();
-
-	// Pass the non-reflective material to the shader again
-	m_pShaderManager->setVec3Value("material.diffuseColor", nonReflectiveMaterial.diffuseColor);
-	m_pShaderManager->setVec3Value("material.specularColor", nonReflectiveMaterial.specularColor);
-	m_pShaderManager->setFloatValue("material.shininess", nonReflectiveMaterial.shininess);
-
-	//Paper
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(5.0f, 0.05f, 5.0f);
-	positionXYZ = glm::vec3(0.0f, 11.25f, 2.5f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(1.0f, 1.0f, 1.0f, 1);  // Brown color
-	//SetShaderTexture("deskTop");
-	m_basicMeshes->DrawBoxMesh();
-
-	//pencil rod
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(0.10f, 2.0f, 0.10f);
-	positionXYZ = glm::vec3(5.0f, 11.35f, 2.5f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(1.0f, 0.6f, 0.2f, 1);  // Yellow-orange pencil color
-	m_basicMeshes->DrawCylinderMesh();
-
-	//Pencil wood before tip
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(0.10f, 0.08f, 0.10f);
-	positionXYZ = glm::vec3(5.0f, 11.35f, 4.5f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.55f, 0.27f, 0.07f, 1);  // Brown wood color before the pencil tip	
-	m_basicMeshes->DrawTaperedCylinderMesh();
-
-	//Pencil tip
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(0.06f, 0.2f, 0.05f);
-	positionXYZ = glm::vec3(5.0f, 11.35f, 4.58f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(0.0f, 0.0f, 0.0f, 1);  // Black
-	//SetShaderTexture("deskTop");
-	m_basicMeshes->DrawConeMesh();
-
-	//Pencil eraser
-	XrotationDegrees = 90.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	scaleXYZ = glm::vec3(0.10f, 0.25f, 0.10f);
-	positionXYZ = glm::vec3(5.0f, 11.35f, 2.25f);
-	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
-	SetShaderColor(1.0f, 1.0f, 1.0f, 1);  // Yellow-orange pencil color
-	SetShaderTexture("erase");
-	SetTextureUVScale(1, 1);
-	m_basicMeshes->DrawCylinderMesh();
+		int texture = -1;
+		for (size_t t = 0; t < m_softwareTextures.size(); t++)
+		{
+			if (m_softwareTextures[t].tag == object.textureTag)
+			{
+				texture = static_cast<int>(m_softwareTextures[t].ID);
+				break;
+			}
+		}
+
+		rasterizer.DrawMesh(&GetObjectShape(object), object.model, object.color,
+			texture, object.UVscale, material);
+	}
 
+	rasterizer.EndFrame();
+	return(m_pSoftwareRasterizer);
 }
@@ -11,7 +11,21 @@
 
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "ShadowManager.h"
+#include "OcclusionCuller.h"
+#include "MeshLibrary.h"
+#include "DynamicUploadBuffer.h"
+#include "SceneView.h"
+#include "BoundsBVH.h"
+#include "AssetPack.h"
+#include "TextureStreamer.h"
+#include "TaskGraph.h"
+#include "LightBaker.h"
+#include "FrameArena.h"
+#include "StaticScene.h"
+#include "SoftwareRasterizer.h"
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -24,7 +38,8 @@
 class SceneManager
 {
 public:
-    // constructor
+    // constructor - without a shader manager no OpenGL calls
+    // are made, and the scene is only drawn on the CPU
     SceneManager(ShaderManager* pShaderManager);
     // destructor
     ~SceneManager();
@@ -32,6 +47,7 @@ public:
     struct TEXTURE_INFO
     {
         std::string tag;
+        // number of the texture in the texture streamer
         uint32_t ID;
     };
 
@@ -91,15 +107,105 @@ public:
         bool bActive;
     };
 
+    // basic mesh shapes that scene objects are drawn with
+    enum MESH_TYPE
+    {
+        PLANE_MESH,
+        BOX_MESH,
+        CYLINDER_MESH,
+        SPHERE_MESH,
+        CONE_MESH,
+        TAPERED_CYLINDER_MESH
+    };
+
+    // an object placed in the 3D scene
+    struct SCENE_OBJECT
+    {
+        std::string tag;
+        MESH_TYPE mesh;
+        glm::vec3 scaleXYZ;
+        float XrotationDegrees;
+        float YrotationDegrees;
+        float ZrotationDegrees;
+        glm::vec3 positionXYZ;
+        // model matrix of the transformations above, worked
+        // out when they are set instead of every frame
+        glm::mat4 model;
+        glm::vec4 color;
+        // empty when the object is drawn with its color only
+        std::string textureTag;
+        glm::vec2 UVscale;
+        std::string materialTag;
+        // static objects are cached in the shadow maps
+        bool bStatic;
+        // world space bounding box
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+        // mesh library index used instead of the basic mesh,
+        // -1 when the basic mesh is drawn
+        int libraryMesh;
+        // mesh library index of the mesh with the baked
+        // lighting, -1 when the object is lit live
+        int bakedMesh;
+        // texture slot of a static object and the offset of its
+        // values in the static object buffer, found once when
+        // the buffer is written - the offset is -1 until then
+        int textureSlot;
+        GLintptr staticDataOffset;
+    };
+
+    // per-object values in the std140 layout of the shader
+    // ObjectData uniform block
+    struct OBJECT_DATA
+    {
+        glm::mat4 model;
+        glm::vec4 color;
+        glm::vec2 UVscale;
+        int materialIndex;
+        int bUseTexture;
+        // layer of the texture in its texture array
+        int textureLayer;
+        // the lighting comes from the vertices of the baked mesh
+        int bBakedLighting;
+        int padding[2];
+    };
+
+    // the nearest scene object hit by a picking ray
+    struct PICK_RESULT
+    {
+        int objectIndex;
+        std::string tag;
+        // world space hit point and its distance along the ray
+        glm::vec3 position;
+        float distance;
+    };
+
+    // a scene object that passed culling, with its values
+    // already written for drawing it into the views
+    struct DRAW_RECORD
+    {
+        int objectIndex;
+        // offset of the per-object values in the upload buffer,
+        // or in the static object buffer for a static object
+        GLintptr dataOffset;
+        bool bStaticData;
+        // texture of the object, -1 when not textured
+        int textureSlot;
+        // bit for every view the object is drawn into
+        unsigned int viewMask;
+        OcclusionCuller::VISIBILITY visibility;
+    };
+
 private:
     // pointer to shader manager object
     ShaderManager* m_pShaderManager;
-    // pointer to basic shapes object
+    // pointer to basic shapes object - only its box is loaded,
+    // for the occlusion tests
     ShapeMeshes* m_basicMeshes;
     // total number of loaded textures
     int m_loadedTextures;
     // loaded textures info
-    TEXTURE_INFO m_textureIDs[16];
+    std::vector<TEXTURE_INFO> m_textureIDs;
     // defined object materials
     std::vector<OBJECT_MATERIAL> m_objectMaterials;
 
@@ -109,19 +215,127 @@ private:
     PointLight m_pointLight2;              // Second point light (red)
     SpotLight m_spotLight;                 // Spotlight
 
+    // objects placed in the 3D scene
+    std::vector<SCENE_OBJECT> m_sceneObjects;
+    // number of scene objects that are not static
+    int m_dynamicObjectCount;
+    // pointer to the shadow map manager
+    ShadowManager* m_pShadowManager;
+    // pointer to the occlusion culler
+    OcclusionCuller* m_pOcclusionCuller;
+    // pointer to the meshes built by the project
+    MeshLibrary* m_pMeshLibrary;
+    // library mesh of each basic shape, -1 when not loaded
+    int m_basicLibraryMeshes[TAPERED_CYLINDER_MESH + 1];
+    // the generated basic shapes, kept for the light baker
+    MESH_DATA m_basicShapes[TAPERED_CYLINDER_MESH + 1];
+    // the library meshes the objects are drawn with, by
+    // library index, kept for the light baker like the basic
+    // shapes - empty for the baked meshes
+    std::vector<MESH_DATA> m_libraryShapes;
+    // a library mesh that was generated and is not loaded yet
+    struct PENDING_MESH
+    {
+        std::string tag;
+        MESH_DATA data;
+        MeshLibrary::VERTEX_FORMAT format;
+    };
+    std::vector<PENDING_MESH> m_pendingMeshes;
+    // the mesh file placed on the desk, and its mesh until it
+    // is loaded into the library
+    std::string m_importMeshFilename;
+    PENDING_MESH m_importedMesh;
+    // ring buffer the per-object values are written into
+    DynamicUploadBuffer* m_pObjectDataBuffer;
+    // whether a full upload buffer was reported
+    bool m_bObjectDataOverflow;
+    // the per-object values of the static objects, written
+    // once and again only when the static scene changes
+    GLuint m_staticObjectBuffer;
+    bool m_bStaticObjectDataDirty;
+    // per-object values for the next draw command
+    OBJECT_DATA m_objectData;
+    // texture for the next draw command
+    int m_textureSlot;
+    // camera view and projection for the current frame, the
+    // shadows and the occlusion tests follow this view
+    glm::mat4 m_viewMatrix;
+    glm::mat4 m_projectionMatrix;
+    // all of the views drawn in the current frame, with the
+    // planes of their view frustums
+    SCENE_VIEW m_views[SCENE_VIEW::MAX_VIEWS];
+    glm::vec4 m_viewPlanes[SCENE_VIEW::MAX_VIEWS][6];
+    int m_viewCount;
+    // whether the views can be drawn with indexed viewports
+    bool m_bViewportArrays;
+    // memory for the transient data of the current frame,
+    // taken back when the next frame starts
+    FrameArena* m_pFrameArena;
+    // objects collected for drawing in the current frame, in
+    // the frame arena
+    DRAW_RECORD* m_drawList;
+    int m_drawCount;
+    // hierarchy over the object bounds for picking, rebuilt
+    // when objects are added and refitted when they move
+    BoundsBVH* m_pObjectBVH;
+    bool m_bObjectBVHDirty;
+    bool m_bObjectBVHMoved;
+    // whether the scene was loaded from an asset pack
+    bool m_bLoadedFromPack;
+    // the asset pack the scene was loaded from - it stays
+    // mapped for streaming the texture levels
+    AssetPack* m_pAssetPack;
+    // owner of the scene textures, streams their mip levels
+    TextureStreamer* m_pTextureStreamer;
+    // whether the static lighting is baked when the scene is
+    // prepared, and whether the baked lighting is still valid
+    bool m_bLightBaking;
+    bool m_bBakedLighting;
+    // the bake that is running, and the object each of its
+    // meshes belongs to
+    LightBaker* m_pLightBaker;
+    std::vector<int> m_bakedObjects;
+    // counts the changes of the static objects, and the count
+    // the running bake was started at - the lighting of a bake
+    // of an older static scene is not loaded
+    std::atomic<unsigned int> m_staticGeneration;
+    unsigned int m_bakeGeneration;
+    // the CPU renderer, created when the scene is first drawn
+    // with it, the scene textures it was given and the number
+    // of registered textures it was offered
+    SoftwareRasterizer* m_pSoftwareRasterizer;
+    std::vector<TEXTURE_INFO> m_softwareTextures;
+    int m_softwareTextureCount;
+
     // load texture images and convert to OpenGL texture data
     bool CreateGLTexture(const char* filename, std::string tag);
-    // bind loaded OpenGL textures to slots in memory
+    // put the loaded textures into texture arrays and bind
+    // them to their texture units
     void BindGLTextures();
     // free the loaded OpenGL textures
     void DestroyGLTextures();
     // find a loaded texture by tag
-    int FindTextureID(std::string tag);
-    int FindTextureSlot(std::string tag);
+    int FindTextureSlot(const std::string& tag);
     // find a defined material by tag
-    bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+    bool FindMaterial(const std::string& tag, OBJECT_MATERIAL& material);
+    int FindMaterialIndex(const std::string& tag);
 
     void LoadSceneTextures();
+    // register the reserved scene textures that were decoded
+    // and put them into texture arrays
+    void LoadDecodedTextures(const std::vector<int>& textureIndices);
+    // connect the per-object uniform block of the compiled
+    // scene shader to its binding
+    void ConnectShader();
+
+    // calculate the model matrix from the
+    // transformation values
+    glm::mat4 CalculateModelMatrix(
+        glm::vec3 scaleXYZ,
+        float XrotationDegrees,
+        float YrotationDegrees,
+        float ZrotationDegrees,
+        glm::vec3 positionXYZ);
 
     // set the transformation values 
     // into the transform buffer
@@ -141,7 +355,7 @@ private:
 
     // set the texture data into the shader
     void SetShaderTexture(
-        std::string textureTag);
+        const std::string& textureTag);
 
     // set the UV scale for the texture mapping
     void SetTextureUVScale(
@@ -149,11 +363,186 @@ private:
 
     // set the object material into the shader
     void SetShaderMaterial(
-        std::string materialTag);
+        const std::string& materialTag);
+
+    // define the materials used by the scene objects
+    void DefineObjectMaterials();
+    // pass the defined materials into the shader
+    void UploadObjectMaterials();
+    // open an asset pack and check all of its records, without
+    // any OpenGL calls
+    bool OpenAssetPack(const char* filename);
+    // load the textures, library meshes, materials and objects
+    // from the opened asset pack, or from the loose files when
+    // it could not be opened
+    void LoadAssetPack();
+    // create a texture from its cooked mip chain
+    bool CreatePackedTexture(const AssetPack& pack, const AssetPack::PACK_TEXTURE& texture);
+    // define the objects placed in the 3D scene
+    void DefineSceneObjects();
+    // build the meshes that are not covered by the basic
+    // shapes, without any OpenGL calls
+    void GenerateLibraryMeshes();
+    // load the generated meshes into the library
+    void LoadLibraryMeshes();
+    // generate the basic shapes
+    void GenerateBasicMeshes();
+    // load the generated basic shapes into the library, so
+    // every mesh is drawn from the mesh arena
+    void LoadBasicMeshes();
+    // generate a basic shape with the tessellation it is
+    // drawn and baked with
+    static void GenerateBasicMesh(MESH_TYPE mesh, MESH_DATA& data);
+    // write the per-object values into the upload buffer and
+    // return their offset, -1 when the buffer is full
+    GLintptr WriteObjectData();
+    // grow the upload buffer when the values of the dynamic
+    // objects no longer fit into a frame of it
+    void ReserveObjectData();
+    // set the per-object values and the texture of a scene
+    // object for the next draw command
+    void SetObjectValues(const SCENE_OBJECT& object);
+    // write the values of every static object into the static
+    // object buffer
+    void WriteStaticObjectData();
+    // draw the mesh of a scene object with the passed in shader
+    void DrawMesh(const SCENE_OBJECT& object, ShaderManager* pShader, int instanceCount = 1);
+    // get the library mesh a scene object is drawn with by
+    // the passed in shader, -1 when it is not loaded
+    int GetObjectMesh(const SCENE_OBJECT& object, ShaderManager* pShader) const;
+    // keep the mesh data of a library mesh for the work done
+    // on the CPU
+    void KeepLibraryShape(int meshIndex, const MESH_DATA& data);
+    // get the mesh data of the mesh a scene object is drawn
+    // with, the basic shape when its library mesh is not kept
+    const MESH_DATA& GetObjectShape(const SCENE_OBJECT& object) const;
+    // calculate the world space bounds of a scene object
+    void CalculateObjectBounds(SCENE_OBJECT& object);
+    // put a scene object into the scene, once its model matrix
+    // and bounds are set, and return its index
+    int InsertSceneObject(const SCENE_OBJECT& object);
+    // find the views the bounds of an object can be seen in
+    unsigned int CalculateViewMask(const SCENE_OBJECT& object);
+    // find the finest texture level an object needs in the
+    // views it is drawn into
+    int CalculateTextureLevel(
+        const SCENE_OBJECT& object,
+        unsigned int viewMask,
+        int textureSize,
+        int frameHeight);
+    // cull the scene objects once for all of the views and
+    // write the values of the objects that are drawn
+    void CollectDraws();
+    // draw the collected objects into every view
+    void SubmitDraws();
+    // bind the values of a collected object
+    void BindDrawRecord(const DRAW_RECORD& record);
+    // test the object bounds for culling in the next frame
+    void TestOcclusion();
+    // bring the picking hierarchy up to date with the objects
+    void UpdateObjectBVH();
+    // intersect a ray with the exact shape of a scene object
+    static bool IntersectObject(
+        void* pContext,
+        int objectIndex,
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float& distance);
+    // intersect a ray with a static scene object, the dynamic
+    // objects are never hit
+    static bool IntersectStaticObject(
+        void* pContext,
+        int objectIndex,
+        const glm::vec3& origin,
+        const glm::vec3& direction,
+        float& distance);
+    // bake the lighting of the static objects into copies of
+    // their meshes, without any OpenGL calls
+    void BakeStaticLighting();
+    // import the mesh file on a worker, and load and place it
+    // on the context thread
+    void ImportMesh();
+    void PlaceImportedMesh();
+    // load the baked meshes and draw the static objects with
+    // them
+    void LoadBakedMeshes();
+    // whether an object is drawn with its baked lighting
+    bool UsesBakedLighting(const SCENE_OBJECT& object) const;
+    // unload the baked meshes, every object is lit live
+    // from then on
+    void ReleaseBakedMeshes();
+    // draw the static or dynamic objects into a shadow view
+    void DrawShadowCasters(bool bStatic);
+    // render the shadow maps that are out of date
+    void RenderShadowMaps();
 
 public:
+    // add an object to the 3D scene
+    int AddSceneObject(
+        std::string tag,
+        MESH_TYPE mesh,
+        glm::vec3 scaleXYZ,
+        float XrotationDegrees,
+        float YrotationDegrees,
+        float ZrotationDegrees,
+        glm::vec3 positionXYZ,
+        glm::vec4 color,
+        std::string textureTag,
+        glm::vec2 UVscale,
+        std::string materialTag,
+        bool bStatic = true);
+
+    // add the objects of a scene compiled at build time, with
+    // the model matrices and bounds of the table
+    void AddStaticScene(const StaticScene::COMPILED_OBJECT* objects, size_t count);
+
+    // move an object that is already in the 3D scene
+    void SetObjectTransformations(
+        int index,
+        glm::vec3 scaleXYZ,
+        float XrotationDegrees,
+        float YrotationDegrees,
+        float ZrotationDegrees,
+        glm::vec3 positionXYZ);
+
+    // draw an object with a mesh from the mesh library
+    // instead of its basic mesh
+    void SetObjectMesh(int index, std::string meshTag);
+
+    // set the views the frame is drawn with - the first view
+    // is the camera the shadows and culling follow
+    void SetViews(const SCENE_VIEW* views, int count);
+
+    // find the nearest scene object hit by a world space ray
+    bool PickObject(glm::vec3 origin, glm::vec3 direction, PICK_RESULT& result);
+
     // The following methods are for the students to 
-    // customize for their own 3D scene
-    void PrepareScene();
+    // customize for their own 3D scene - the scene is prepared
+    // by the startup tasks added to the graph, and the id of
+    // the task after which a frame can be drawn is returned
+    int PrepareScene(TaskGraph& startup, int shaderTask, const char* assetPackFilename = NULL);
+    // prepare the scene for the CPU renderer on this thread,
+    // for a scene manager without a shader manager
+    void PrepareSceneSoftware(const char* assetPackFilename = NULL);
     void RenderScene();
+    // draw the first view of the scene on the CPU into an
+    // image of the passed in size, without OpenGL
+    const SoftwareRasterizer* RenderSceneSoftware(int width, int height);
+
+    // write the scene loaded from the loose files into an
+    // asset pack that can be loaded instead
+    bool CookAssetPack(const char* filename);
+    // whether the scene was loaded from an asset pack
+    bool IsLoadedFromPack() const { return(m_bLoadedFromPack); }
+    // set the memory budget of the streamed texture levels,
+    // 0 for no budget
+    void SetTextureBudget(size_t bytes) { m_pTextureStreamer->SetBudget(bytes); }
+    // whether texture levels are still being streamed in
+    bool IsStreamingTextures() const { return(m_pTextureStreamer->IsLoading()); }
+    // turn baking the static lighting on or off, before the
+    // scene is prepared
+    void SetLightBaking(bool bBake) { m_bLightBaking = bBake; }
+    // import an .obj, .gltf or .glb file and place it on the
+    // desk when the scene is prepared
+    void SetImportMesh(const char* filename) { m_importMeshFilename = filename; }
 };
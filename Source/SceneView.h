@@ -0,0 +1,29 @@
+///////////////////////////////////////////////////////////////////////////////
+// sceneview.h
+// ============
+// a camera view drawn into part of the window
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  SCENE_VIEW
+ *
+ *  The camera matrices of one view and the part of the
+ *  render target it is drawn into.  The viewport is given
+ *  as fractions of the render target - x, y, width and
+ *  height - so it stays valid when the target is resized
+ *  or scaled.
+ ***********************************************************/
+struct SCENE_VIEW
+{
+	// largest number of views drawn in one frame
+	static const int MAX_VIEWS = 4;
+
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 position;
+	glm::vec4 viewport;
+};
@@ -0,0 +1,417 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderbenchmark.cpp
+// ============
+// measure the cost of the scene fragment shader per light configuration
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderBenchmark.h"
+#include "SceneManager.h"
+#include "GLState.h"
+#include "Logger.h"
+#include "ResourceTracker.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// declaration of the global variables and defines
+namespace
+{
+	// the light configurations that are timed - the shader
+	// holds two directional lights, four point lights and five
+	// spotlights
+	struct CONFIGURATION_ENTRY
+	{
+		const char* name;
+		int directionalLights;
+		int pointLights;
+		int spotLights;
+		bool bTextured;
+		float UVscale;
+	};
+
+	const CONFIGURATION_ENTRY g_Configurations[] =
+	{
+		{ "no lights", 0, 0, 0, true, 1.0f },
+		{ "1 directional", 1, 0, 0, true, 1.0f },
+		{ "2 directional", 2, 0, 0, true, 1.0f },
+		{ "2 directional, untextured", 2, 0, 0, false, 1.0f },
+		{ "2 directional, UV scale 2", 2, 0, 0, true, 2.0f },
+		{ "2 directional, 1 spot (desk scene)", 2, 0, 1, true, 2.0f },
+		{ "2 directional, 4 point", 2, 4, 0, true, 1.0f },
+		{ "2 directional, 5 spot", 2, 0, 5, true, 1.0f },
+		{ "all 11 lights", 2, 4, 5, true, 2.0f }
+	};
+	const int g_ConfigurationCount = sizeof(g_Configurations) / sizeof(g_Configurations[0]);
+
+	// number of lights of each kind in the shader
+	const int SHADER_POINT_LIGHTS = 4;
+	const int SHADER_SPOT_LIGHTS = 5;
+
+	// size of the checker texture the quads are textured with
+	const int BENCHMARK_TEXTURE_SIZE = 256;
+	// interleaved position, normal and texture coordinate
+	const int QUAD_FLOATS_PER_VERTEX = 8;
+}
+
+/***********************************************************
+ *  ShaderBenchmark()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderBenchmark::ShaderBenchmark(ShaderManager* pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_vertexArray = 0;
+	m_vertexBuffer = 0;
+	m_objectBuffer = 0;
+	m_texture = 0;
+	m_timerQuery = 0;
+	m_objectBinding = 0;
+}
+
+/***********************************************************
+ *  ~ShaderBenchmark()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderBenchmark::~ShaderBenchmark()
+{
+	if (0 != m_timerQuery)
+	{
+		glDeleteQueries(1, &m_timerQuery);
+		m_timerQuery = 0;
+	}
+	if (0 != m_texture)
+	{
+		ResourceTracker::Release(ResourceTracker::RESOURCE_TEXTURE, m_texture);
+		glDeleteTextures(1, &m_texture);
+		m_texture = 0;
+	}
+	if (0 != m_objectBuffer)
+	{
+		ResourceTracker::Release(ResourceTracker::RESOURCE_BUFFER, m_objectBuffer);
+		GLState::DeleteBuffer(m_objectBuffer);
+		m_objectBuffer = 0;
+	}
+	if (0 != m_vertexBuffer)
+	{
+		ResourceTracker::Release(ResourceTracker::RESOURCE_BUFFER, m_vertexBuffer);
+		GLState::DeleteBuffer(m_vertexBuffer);
+		m_vertexBuffer = 0;
+	}
+	if (0 != m_vertexArray)
+	{
+		GLState::BindVertexArray(0);
+		glDeleteVertexArrays(1, &m_vertexArray);
+		m_vertexArray = 0;
+	}
+
+	// the bindings were changed directly
+	GLState::Invalidate();
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for timing every light configuration
+ *  at the passed in size.  The results are printed, and
+ *  written into the file as comma separated values when a
+ *  file is passed in.
+ ***********************************************************/
+bool ShaderBenchmark::Run(int width, int height, const char* filename)
+{
+	if ((NULL == m_pShaderManager) || (width <= 0) || (height <= 0))
+	{
+		return(false);
+	}
+
+	CreateResources();
+	if (PrepareShader() == false)
+	{
+		return(false);
+	}
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::Viewport(0, 0, width, height);
+	GLState::Disable(GL_DEPTH_TEST);
+	GLState::Disable(GL_BLEND);
+
+	double fragmentCount = static_cast<double>(width) * height;
+	LOG_INFO("INFO: Shader benchmark at " << width << "x" << height << ", "
+		<< QUADS_PER_RUN << " full-screen quads per run");
+
+	std::vector<std::string> rows;
+	for (int i = 0; i < g_ConfigurationCount; i++)
+	{
+		const CONFIGURATION_ENTRY& entry = g_Configurations[i];
+		LIGHT_CONFIGURATION configuration = { entry.name, entry.directionalLights,
+			entry.pointLights, entry.spotLights, entry.bTextured, entry.UVscale };
+		SetConfiguration(configuration);
+
+		double quadTime = TimeQuads();
+		double fragmentTime = (quadTime * 1000000.0) / fragmentCount;
+		int lightCount = configuration.directionalLights + configuration.pointLights + configuration.spotLights;
+		LOG_INFO("INFO:   " << configuration.name << ": " << quadTime << " ms per quad, "
+			<< fragmentTime << " ns per fragment");
+
+		rows.push_back(std::string(configuration.name) + "," + std::to_string(lightCount) + "," +
+			((configuration.bTextured == true) ? "1" : "0") + "," + std::to_string(configuration.UVscale) + "," +
+			std::to_string(quadTime) + "," + std::to_string(fragmentTime));
+	}
+
+	if (NULL == filename)
+	{
+		return(true);
+	}
+
+	std::ofstream file(filename, std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		LOG_ERROR("Could not write the shader benchmark results " << filename);
+		return(false);
+	}
+	file << "configuration,lights,textured,uv scale,ms per quad,ns per fragment\n";
+	for (size_t i = 0; i < rows.size(); i++)
+	{
+		file << rows[i] << "\n";
+	}
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  CreateResources()
+ *
+ *  This method is used for creating the full-screen quad,
+ *  the buffer with its per-object values, a checker texture
+ *  with mip levels like the scene textures, and the timer
+ *  query.
+ ***********************************************************/
+void ShaderBenchmark::CreateResources()
+{
+	// the quad covers the clip space, drawn as a strip
+	const float vertices[4 * QUAD_FLOATS_PER_VERTEX] =
+	{
+		-1.0f, -1.0f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f,
+		 1.0f, -1.0f, 0.0f,   0.0f, 0.0f, 1.0f,   1.0f, 0.0f,
+		-1.0f,  1.0f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 1.0f,
+		 1.0f,  1.0f, 0.0f,   0.0f, 0.0f, 1.0f,   1.0f, 1.0f
+	};
+	GLsizei stride = QUAD_FLOATS_PER_VERTEX * sizeof(float);
+
+	glGenVertexArrays(1, &m_vertexArray);
+	GLState::BindVertexArray(m_vertexArray);
+	glGenBuffers(1, &m_vertexBuffer);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(0));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(3 * sizeof(float)));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(6 * sizeof(float)));
+	glEnableVertexAttribArray(2);
+	ResourceTracker::Track(ResourceTracker::RESOURCE_BUFFER, m_vertexBuffer, sizeof(vertices),
+		ResourceTracker::CATEGORY_MESH, "shader benchmark quad");
+
+	glGenBuffers(1, &m_objectBuffer);
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_objectBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(SceneManager::OBJECT_DATA), NULL, GL_DYNAMIC_DRAW);
+	ResourceTracker::Track(ResourceTracker::RESOURCE_BUFFER, m_objectBuffer, sizeof(SceneManager::OBJECT_DATA),
+		ResourceTracker::CATEGORY_UPLOAD_BUFFER, "shader benchmark object data");
+
+	std::vector<unsigned char> texels(BENCHMARK_TEXTURE_SIZE * BENCHMARK_TEXTURE_SIZE * 4);
+	for (int y = 0; y < BENCHMARK_TEXTURE_SIZE; y++)
+	{
+		for (int x = 0; x < BENCHMARK_TEXTURE_SIZE; x++)
+		{
+			unsigned char value = (((x / 16) + (y / 16)) % 2 == 0) ? 224 : 64;
+			unsigned char* pTexel = &texels[(y * BENCHMARK_TEXTURE_SIZE + x) * 4];
+			pTexel[0] = value;
+			pTexel[1] = static_cast<unsigned char>(x);
+			pTexel[2] = static_cast<unsigned char>(y);
+			pTexel[3] = 255;
+		}
+	}
+	glGenTextures(1, &m_texture);
+	GLState::ActiveTexture(GL_TEXTURE0);
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_texture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, BENCHMARK_TEXTURE_SIZE, BENCHMARK_TEXTURE_SIZE, 1,
+		0, GL_RGBA, GL_UNSIGNED_BYTE, &texels[0]);
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	ResourceTracker::Track(ResourceTracker::RESOURCE_TEXTURE, m_texture, (texels.size() * 4) / 3,
+		ResourceTracker::CATEGORY_SCENE_TEXTURE, "shader benchmark texture");
+
+	glGenQueries(1, &m_timerQuery);
+}
+
+/***********************************************************
+ *  PrepareShader()
+ *
+ *  This method is used for setting up the scene shader so
+ *  the quad fills the clip space without any transform,
+ *  seen from in front of it.  The shadows are turned off,
+ *  so only the lighting is measured.  False is returned
+ *  when the scene shader did not compile and link, so no
+ *  timings are taken of a broken program.
+ ***********************************************************/
+bool ShaderBenchmark::PrepareShader()
+{
+	m_pShaderManager->use();
+
+	GLint program = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	GLint linked = GL_FALSE;
+	if (0 != program)
+	{
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	}
+	if (linked != GL_TRUE)
+	{
+		char infoLog[1024] = "";
+		if (0 != program)
+		{
+			glGetProgramInfoLog(program, sizeof(infoLog), NULL, infoLog);
+		}
+		LOG_ERROR("The scene shader did not compile and link, no benchmark is run: " << infoLog);
+		return(false);
+	}
+
+	// draw the per-object values from the binding the scene
+	// connected the block to
+	GLuint blockIndex = glGetUniformBlockIndex(program, "ObjectData");
+	if (blockIndex != GL_INVALID_INDEX)
+	{
+		GLint binding = 0;
+		glGetActiveUniformBlockiv(program, blockIndex, GL_UNIFORM_BLOCK_BINDING, &binding);
+		m_objectBinding = static_cast<GLuint>(binding);
+	}
+	GLState::BindBufferRange(GL_UNIFORM_BUFFER, m_objectBinding, m_objectBuffer, 0, sizeof(SceneManager::OBJECT_DATA));
+
+	m_pShaderManager->setMat4Value("views[0]", glm::mat4(1.0f));
+	m_pShaderManager->setMat4Value("projections[0]", glm::mat4(1.0f));
+	m_pShaderManager->setVec3Value("viewPositions[0]", glm::vec3(0.0f, 0.0f, 2.0f));
+	m_pShaderManager->setIntValue("firstView", 0);
+	m_pShaderManager->setBoolValue("bViewportArray", false);
+	m_pShaderManager->setBoolValue("bPackedVertices", false);
+	m_pShaderManager->setBoolValue("bUseLighting", true);
+	m_pShaderManager->setBoolValue("bUseShadows", false);
+	m_pShaderManager->setSampler2DValue("objectTexture", 0);
+
+	m_pShaderManager->setVec3Value("materials[0].diffuseColor", glm::vec3(0.8f, 0.8f, 0.8f));
+	m_pShaderManager->setVec3Value("materials[0].specularColor", glm::vec3(0.5f, 0.5f, 0.5f));
+	m_pShaderManager->setFloatValue("materials[0].shininess", 32.0f);
+
+	// the lights are placed in front of the quad, so every one
+	// of them reaches it
+	m_pShaderManager->setVec3Value("directionalLight1.direction", glm::normalize(glm::vec3(-0.3f, -0.5f, -1.0f)));
+	m_pShaderManager->setVec3Value("directionalLight2.direction", glm::normalize(glm::vec3(0.4f, -0.2f, -1.0f)));
+	const char* directionalNames[2] = { "directionalLight1.", "directionalLight2." };
+	for (int i = 0; i < 2; i++)
+	{
+		std::string name = directionalNames[i];
+		m_pShaderManager->setVec3Value(name + "ambient", glm::vec3(0.1f, 0.1f, 0.1f));
+		m_pShaderManager->setVec3Value(name + "diffuse", glm::vec3(0.6f, 0.5f, 0.4f));
+		m_pShaderManager->setVec3Value(name + "specular", glm::vec3(0.8f, 0.8f, 0.8f));
+	}
+
+	for (int i = 0; i < SHADER_POINT_LIGHTS; i++)
+	{
+		float angle = glm::radians(90.0f * i);
+		std::string name = "pointLights[" + std::to_string(i) + "].";
+		m_pShaderManager->setVec3Value(name + "position", glm::vec3(std::cos(angle) * 0.8f, std::sin(angle) * 0.8f, 0.5f));
+		m_pShaderManager->setVec3Value(name + "ambient", glm::vec3(0.02f, 0.02f, 0.02f));
+		m_pShaderManager->setVec3Value(name + "diffuse", glm::vec3(0.3f, 0.3f, 0.6f));
+		m_pShaderManager->setVec3Value(name + "specular", glm::vec3(0.4f, 0.4f, 0.8f));
+	}
+
+	for (int i = 0; i < SHADER_SPOT_LIGHTS; i++)
+	{
+		std::string name = "spotLights[" + std::to_string(i) + "].";
+		m_pShaderManager->setVec3Value(name + "position", glm::vec3(-0.8f + (0.4f * i), 0.0f, 1.0f));
+		m_pShaderManager->setVec3Value(name + "direction", glm::vec3(0.0f, 0.0f, -1.0f));
+		m_pShaderManager->setFloatValue(name + "cutOff", std::cos(glm::radians(25.0f)));
+		m_pShaderManager->setFloatValue(name + "outerCutOff", std::cos(glm::radians(35.0f)));
+		m_pShaderManager->setFloatValue(name + "constant", 1.0f);
+		m_pShaderManager->setFloatValue(name + "linear", 0.045f);
+		m_pShaderManager->setFloatValue(name + "quadratic", 0.0075f);
+		m_pShaderManager->setVec3Value(name + "ambient", glm::vec3(0.05f, 0.05f, 0.05f));
+		m_pShaderManager->setVec3Value(name + "diffuse", glm::vec3(1.0f, 0.9f, 0.7f));
+		m_pShaderManager->setVec3Value(name + "specular", glm::vec3(1.0f, 1.0f, 1.0f));
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetConfiguration()
+ *
+ *  This method is used for turning on the lights of a
+ *  configuration, the first ones of each kind, and writing
+ *  the per-object values of the quad.
+ ***********************************************************/
+void ShaderBenchmark::SetConfiguration(const LIGHT_CONFIGURATION& configuration)
+{
+	m_pShaderManager->setBoolValue("directionalLight1.bActive", configuration.directionalLights >= 1);
+	m_pShaderManager->setBoolValue("directionalLight2.bActive", configuration.directionalLights >= 2);
+	for (int i = 0; i < SHADER_POINT_LIGHTS; i++)
+	{
+		m_pShaderManager->setBoolValue("pointLights[" + std::to_string(i) + "].bActive", i < configuration.pointLights);
+	}
+	for (int i = 0; i < SHADER_SPOT_LIGHTS; i++)
+	{
+		m_pShaderManager->setBoolValue("spotLights[" + std::to_string(i) + "].bActive", i < configuration.spotLights);
+	}
+
+	SceneManager::OBJECT_DATA objectData = SceneManager::OBJECT_DATA();
+	objectData.model = glm::mat4(1.0f);
+	objectData.color = glm::vec4(0.7f, 0.6f, 0.5f, 1.0f);
+	objectData.UVscale = glm::vec2(configuration.UVscale, configuration.UVscale);
+	objectData.materialIndex = 0;
+	objectData.bUseTexture = (configuration.bTextured == true) ? 1 : 0;
+	objectData.textureLayer = 0;
+	objectData.bBakedLighting = 0;
+
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_objectBuffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(objectData), &objectData);
+}
+
+/***********************************************************
+ *  TimeQuads()
+ *
+ *  This method is used for timing the full-screen quads.
+ *  One quad is drawn first so the new state is set up, and
+ *  the fastest of the runs is kept, since the slower ones
+ *  were held up by something else.
+ ***********************************************************/
+double ShaderBenchmark::TimeQuads()
+{
+	GLState::BindVertexArray(m_vertexArray);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	glFinish();
+
+	double fastest = 0.0;
+	for (int run = 0; run < RUNS_PER_CONFIGURATION; run++)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, m_timerQuery);
+		for (int i = 0; i < QUADS_PER_RUN; i++)
+		{
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		}
+		glEndQuery(GL_TIME_ELAPSED);
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(m_timerQuery, GL_QUERY_RESULT, &elapsed);
+		double quadTime = (static_cast<double>(elapsed) / 1000000.0) / QUADS_PER_RUN;
+		fastest = (run == 0) ? quadTime : std::min(fastest, quadTime);
+	}
+
+	return(fastest);
+}
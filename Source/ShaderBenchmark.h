@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderbenchmark.h
+// ============
+// measure the cost of the scene fragment shader per light configuration
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  ShaderBenchmark
+ *
+ *  This class times the scene fragment shader on its own.
+ *  Full-screen quads are drawn with the scene shader over
+ *  each other, without the depth test, so every quad
+ *  shades every pixel, and the GPU time of the quads is
+ *  measured with a timer query for a fixed set of light
+ *  configurations.  The time per fragment of each
+ *  configuration is printed and can be written into a CSV
+ *  file, to follow the cost of the lighting across changes.
+ *
+ *  The benchmark sets the lights, the first material and
+ *  the texture of unit 0 of the scene shader to its own
+ *  values, so the scene is not drawn after it.
+ ***********************************************************/
+class ShaderBenchmark
+{
+public:
+	// quads drawn for each timing
+	static const int QUADS_PER_RUN = 16;
+	// timings of each configuration, the fastest one counts
+	static const int RUNS_PER_CONFIGURATION = 5;
+
+	// constructor
+	ShaderBenchmark(ShaderManager* pShaderManager);
+	// destructor
+	~ShaderBenchmark();
+
+	// time every configuration at the passed in size and
+	// write the results into the file, when it is not NULL
+	bool Run(int width, int height, const char* filename);
+
+private:
+	// a set of active lights the shader is timed with
+	struct LIGHT_CONFIGURATION
+	{
+		const char* name;
+		int directionalLights;
+		int pointLights;
+		int spotLights;
+		bool bTextured;
+		// UV scale of the quad, a scale other than 1 makes the
+		// shader sample the texture a second time
+		float UVscale;
+	};
+
+	// create the quad, the per-object buffer and the texture
+	void CreateResources();
+	// set the scene shader up for drawing the quads, false
+	// when it did not compile and link
+	bool PrepareShader();
+	// turn on the lights of a configuration and write the
+	// per-object values of the quad
+	void SetConfiguration(const LIGHT_CONFIGURATION& configuration);
+	// time the quads, in milliseconds for one quad
+	double TimeQuads();
+
+	ShaderManager* m_pShaderManager;
+	GLuint m_vertexArray;
+	GLuint m_vertexBuffer;
+	GLuint m_objectBuffer;
+	GLuint m_texture;
+	GLuint m_timerQuery;
+	// binding of the per-object uniform block of the shader
+	GLuint m_objectBinding;
+};
@@ -0,0 +1,641 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowmanager.cpp
+// ============
+// manage the cached shadow maps for the directional lights and the spotlight
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShadowManager.h"
+#include "FrameStats.h"
+#include "GLState.h"
+#include "ResourceTracker.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of the global variables and defines
+namespace
+{
+	// resolution of each directional cascade and the spotlight map
+	const int CASCADE_MAP_SIZE = 2048;
+	const int SPOT_MAP_SIZE = 1024;
+	// bytes used by each shadow map texel - 32 bit float depth
+	const size_t SHADOW_TEXEL_BYTES = 4;
+
+	// view distance covered by the directional cascades
+	const float SHADOW_DISTANCE = 60.0f;
+	// blend between logarithmic and uniform cascade splits
+	const float CASCADE_SPLIT_LAMBDA = 0.75f;
+	// the cascade centers are snapped to a grid of this fraction
+	// of the cascade radius, so that the cached maps stay valid
+	// while the camera only moves a little
+	const float CASCADE_SNAP_FRACTION = 0.25f;
+	// distance behind the cascade center that shadow casters
+	// are still rendered from
+	const float SHADOW_CASTER_DISTANCE = 100.0f;
+	// far plane of the spotlight shadow view
+	const float SPOT_SHADOW_FAR = 100.0f;
+
+	const char* g_LightSpaceName = "lightSpace";
+	const char* g_DirectionalShadowMapsName = "directionalShadowMaps";
+	const char* g_SpotShadowMapName = "spotShadowMap";
+}
+
+/***********************************************************
+ *  ShadowManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShadowManager::ShadowManager()
+{
+	// load the shader used for rendering the shadow depth
+	m_pDepthShader = new ShaderManager();
+	m_pDepthShader->LoadShaders(
+		"shaders/shadowVertexShader.glsl",
+		"shaders/shadowFragmentShader.glsl");
+
+	glGenFramebuffers(1, &m_shadowFramebuffer);
+	glGenFramebuffers(1, &m_copyFramebuffer);
+
+	// the shadow framebuffers only have a depth attachment
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, m_shadowFramebuffer);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, m_copyFramebuffer);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	m_staticCascadeArray = CreateDepthTexture(
+		GL_TEXTURE_2D_ARRAY, CASCADE_MAP_SIZE, SPOT_SHADOW_VIEW);
+	m_staticSpotMap = CreateDepthTexture(
+		GL_TEXTURE_2D, SPOT_MAP_SIZE, 1);
+
+	// the composited maps are only created once dynamic
+	// objects are added to the scene
+	m_dynamicCascadeArray = 0;
+	m_dynamicSpotMap = 0;
+
+	for (int i = 0; i < NUM_SHADOW_VIEWS; i++)
+	{
+		m_views[i].lightSpace = glm::mat4(1.0f);
+		m_views[i].cachedCenter = glm::vec3(0.0f);
+		m_views[i].cachedRadius = 0.0f;
+		m_views[i].bDirty = true;
+		m_views[i].bActive = false;
+		m_views[i].bQueryPending = false;
+		m_views[i].lastRenderMilliseconds = 0.0;
+		glGenQueries(1, &m_views[i].timerQuery);
+
+		if (i < SPOT_SHADOW_VIEW)
+		{
+			std::string viewName =
+				"shadow light" + std::to_string((i / NUM_CASCADES) + 1) +
+				" cascade" + std::to_string(i % NUM_CASCADES);
+			m_views[i].uniformName = "directionalLightSpace[" + std::to_string(i) + "]";
+			m_views[i].timeStatName = viewName + " time";
+			m_views[i].memoryStatName = viewName + " memory";
+			m_views[i].bytes = CASCADE_MAP_SIZE * CASCADE_MAP_SIZE * SHADOW_TEXEL_BYTES;
+		}
+		else
+		{
+			m_views[i].uniformName = "spotLightSpace";
+			m_views[i].timeStatName = "shadow spotlight time";
+			m_views[i].memoryStatName = "shadow spotlight memory";
+			m_views[i].bytes = SPOT_MAP_SIZE * SPOT_MAP_SIZE * SHADOW_TEXEL_BYTES;
+		}
+	}
+
+	for (int i = 0; i < NUM_CASCADES; i++)
+	{
+		m_cascadeSplits[i] = 0.0f;
+		m_cascadeSplitNames[i] = "cascadeSplits[" + std::to_string(i) + "]";
+	}
+	for (int i = 0; i < NUM_DIRECTIONAL_LIGHTS; i++)
+	{
+		m_directionalDirections[i] = glm::vec3(0.0f, -1.0f, 0.0f);
+		m_directionalActive[i] = false;
+	}
+	m_spotPosition = glm::vec3(0.0f);
+	m_spotDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_spotOuterCutOff = 0.0f;
+	m_spotActive = false;
+
+	m_renderedViews = 0;
+	m_savedFramebuffer = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_savedViewport[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~ShadowManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShadowManager::~ShadowManager()
+{
+	for (int i = 0; i < NUM_SHADOW_VIEWS; i++)
+	{
+		glDeleteQueries(1, &m_views[i].timerQuery);
+	}
+
+	ResourceTracker::Release(ResourceTracker::RESOURCE_TEXTURE, m_staticCascadeArray);
+	ResourceTracker::Release(ResourceTracker::RESOURCE_TEXTURE, m_staticSpotMap);
+	glDeleteTextures(1, &m_staticCascadeArray);
+	glDeleteTextures(1, &m_staticSpotMap);
+	if (m_dynamicCascadeArray != 0)
+	{
+		ResourceTracker::Release(ResourceTracker::RESOURCE_TEXTURE, m_dynamicCascadeArray);
+		ResourceTracker::Release(ResourceTracker::RESOURCE_TEXTURE, m_dynamicSpotMap);
+		glDeleteTextures(1, &m_dynamicCascadeArray);
+		glDeleteTextures(1, &m_dynamicSpotMap);
+	}
+	glDeleteFramebuffers(1, &m_shadowFramebuffer);
+	glDeleteFramebuffers(1, &m_copyFramebuffer);
+
+	if (NULL != m_pDepthShader)
+	{
+		delete m_pDepthShader;
+		m_pDepthShader = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateDepthTexture()
+ *
+ *  This method is used for creating a depth texture that
+ *  can be sampled with hardware depth comparison.
+ ***********************************************************/
+GLuint ShadowManager::CreateDepthTexture(GLenum target, int size, int layers)
+{
+	GLuint textureID = 0;
+	const float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	glGenTextures(1, &textureID);
+	GLState::BindTexture(target, textureID);
+
+	if (target == GL_TEXTURE_2D_ARRAY)
+	{
+		glTexImage3D(target, 0, GL_DEPTH_COMPONENT32F, size, size, layers,
+			0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	}
+	else
+	{
+		glTexImage2D(target, 0, GL_DEPTH_COMPONENT32F, size, size,
+			0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+	}
+
+	// everything outside of the shadow map is lit
+	glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glTexParameterfv(target, GL_TEXTURE_BORDER_COLOR, borderColor);
+	// linear filtering with depth comparison gives hardware PCF
+	glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(target, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+	GLState::BindTexture(target, 0);
+
+	ResourceTracker::Track(ResourceTracker::RESOURCE_TEXTURE, textureID,
+		ResourceTracker::GetTextureBytes(size, size, layers, static_cast<int>(SHADOW_TEXEL_BYTES), false),
+		ResourceTracker::CATEGORY_SHADOW_MAP, "shadow map");
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  CreateDynamicShadowMaps()
+ *
+ *  This method is used for creating the maps that the
+ *  dynamic objects are composited into.
+ ***********************************************************/
+void ShadowManager::CreateDynamicShadowMaps()
+{
+	if (m_dynamicCascadeArray != 0)
+	{
+		return;
+	}
+
+	m_dynamicCascadeArray = CreateDepthTexture(
+		GL_TEXTURE_2D_ARRAY, CASCADE_MAP_SIZE, SPOT_SHADOW_VIEW);
+	m_dynamicSpotMap = CreateDepthTexture(
+		GL_TEXTURE_2D, SPOT_MAP_SIZE, 1);
+
+	for (int i = 0; i < NUM_SHADOW_VIEWS; i++)
+	{
+		m_views[i].bytes *= 2;
+	}
+}
+
+/***********************************************************
+ *  SetDirectionalLight()
+ *
+ *  This method is used for updating a directional light
+ *  and invalidating its cascades when it has changed.
+ ***********************************************************/
+void ShadowManager::SetDirectionalLight(int index, glm::vec3 direction, bool bActive)
+{
+	if ((index < 0) || (index >= NUM_DIRECTIONAL_LIGHTS))
+	{
+		return;
+	}
+
+	if ((m_directionalDirections[index] != direction) ||
+		(m_directionalActive[index] != bActive))
+	{
+		m_directionalDirections[index] = direction;
+		m_directionalActive[index] = bActive;
+		for (int i = 0; i < NUM_CASCADES; i++)
+		{
+			m_views[(index * NUM_CASCADES) + i].bDirty = true;
+		}
+	}
+}
+
+/***********************************************************
+ *  SetSpotLight()
+ *
+ *  This method is used for updating the spotlight and
+ *  invalidating its shadow map when it has changed.
+ ***********************************************************/
+void ShadowManager::SetSpotLight(glm::vec3 position, glm::vec3 direction, float outerCutOff, bool bActive)
+{
+	if ((m_spotPosition != position) ||
+		(m_spotDirection != direction) ||
+		(m_spotOuterCutOff != outerCutOff) ||
+		(m_spotActive != bActive))
+	{
+		m_spotPosition = position;
+		m_spotDirection = direction;
+		m_spotOuterCutOff = outerCutOff;
+		m_spotActive = bActive;
+		m_views[SPOT_SHADOW_VIEW].bDirty = true;
+	}
+}
+
+/***********************************************************
+ *  MarkStaticGeometryDirty()
+ *
+ *  This method is used for invalidating every cached shadow
+ *  map after a static object has changed.
+ ***********************************************************/
+void ShadowManager::MarkStaticGeometryDirty()
+{
+	for (int i = 0; i < NUM_SHADOW_VIEWS; i++)
+	{
+		m_views[i].bDirty = true;
+	}
+}
+
+/***********************************************************
+ *  PrepareShadowViews()
+ *
+ *  This method is used for splitting the camera frustum into
+ *  cascades and calculating the light view of each cascade.
+ *  A cascade is only marked for re-rendering when its
+ *  snapped region has moved.
+ ***********************************************************/
+void ShadowManager::PrepareShadowViews(glm::mat4 view, glm::mat4 projection)
+{
+	glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+	glm::vec3 nearCorners[4];
+	glm::vec3 farCorners[4];
+
+	m_renderedViews = 0;
+	CollectTimerQueries();
+
+	// save the scene framebuffer and viewport so they can be
+	// restored afterwards
+	m_savedFramebuffer = GLState::GetDrawFramebuffer();
+	GLState::GetViewport(m_savedViewport);
+
+	// get the world space corners of the camera frustum
+	for (int i = 0; i < 4; i++)
+	{
+		float x = (i & 1) ? 1.0f : -1.0f;
+		float y = (i & 2) ? 1.0f : -1.0f;
+		glm::vec4 nearCorner = inverseViewProjection * glm::vec4(x, y, -1.0f, 1.0f);
+		glm::vec4 farCorner = inverseViewProjection * glm::vec4(x, y, 1.0f, 1.0f);
+		nearCorners[i] = glm::vec3(nearCorner) / nearCorner.w;
+		farCorners[i] = glm::vec3(farCorner) / farCorner.w;
+	}
+
+	float nearDepth = -(view * glm::vec4(nearCorners[0], 1.0f)).z;
+	float farDepth = -(view * glm::vec4(farCorners[0], 1.0f)).z;
+	float shadowFar = std::min(farDepth, SHADOW_DISTANCE);
+	float cascadeStart = nearDepth;
+
+	for (int c = 0; c < NUM_CASCADES; c++)
+	{
+		// blend the logarithmic and uniform split schemes
+		float fraction = static_cast<float>(c + 1) / NUM_CASCADES;
+		float logSplit = nearDepth * std::pow(shadowFar / nearDepth, fraction);
+		float uniformSplit = nearDepth + ((shadowFar - nearDepth) * fraction);
+		m_cascadeSplits[c] = (CASCADE_SPLIT_LAMBDA * logSplit) +
+			((1.0f - CASCADE_SPLIT_LAMBDA) * uniformSplit);
+
+		// get the corners of the frustum slice for this cascade
+		float startFraction = (cascadeStart - nearDepth) / (farDepth - nearDepth);
+		float endFraction = (m_cascadeSplits[c] - nearDepth) / (farDepth - nearDepth);
+		glm::vec3 sliceCorners[8];
+		glm::vec3 center = glm::vec3(0.0f);
+		for (int i = 0; i < 4; i++)
+		{
+			sliceCorners[i] = glm::mix(nearCorners[i], farCorners[i], startFraction);
+			sliceCorners[i + 4] = glm::mix(nearCorners[i], farCorners[i], endFraction);
+			center += sliceCorners[i] + sliceCorners[i + 4];
+		}
+		center /= 8.0f;
+		cascadeStart = m_cascadeSplits[c];
+
+		// the bounding sphere does not change when the camera
+		// rotates, which keeps the cascade size stable
+		float radius = 0.0f;
+		for (int i = 0; i < 8; i++)
+		{
+			radius = std::max(radius, glm::length(sliceCorners[i] - center));
+		}
+		radius = std::ceil(radius * 16.0f) / 16.0f;
+
+		for (int l = 0; l < NUM_DIRECTIONAL_LIGHTS; l++)
+		{
+			SHADOW_VIEW& shadowView = m_views[(l * NUM_CASCADES) + c];
+			shadowView.bActive = m_directionalActive[l];
+			if (shadowView.bActive == false)
+			{
+				continue;
+			}
+
+			glm::vec3 direction = glm::normalize(m_directionalDirections[l]);
+			glm::vec3 up = (std::abs(direction.y) > 0.99f) ?
+				glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+			// snap the cascade center to a grid in light space
+			glm::mat4 lightRotation = glm::lookAt(glm::vec3(0.0f), direction, up);
+			float snapStep = radius * CASCADE_SNAP_FRACTION;
+			glm::vec4 lightCenter = lightRotation * glm::vec4(center, 1.0f);
+			lightCenter.x = std::floor(lightCenter.x / snapStep) * snapStep;
+			lightCenter.y = std::floor(lightCenter.y / snapStep) * snapStep;
+			lightCenter.z = std::floor(lightCenter.z / snapStep) * snapStep;
+			glm::vec3 snappedCenter = glm::vec3(glm::inverse(lightRotation) * lightCenter);
+
+			if ((shadowView.cachedCenter != snappedCenter) ||
+				(shadowView.cachedRadius != radius))
+			{
+				shadowView.cachedCenter = snappedCenter;
+				shadowView.cachedRadius = radius;
+				shadowView.bDirty = true;
+			}
+
+			// widen the view by one snap step so the slice is
+			// still covered wherever it sits inside the cell
+			float extent = radius + snapStep;
+			glm::mat4 lightView = glm::lookAt(
+				snappedCenter - (direction * SHADOW_CASTER_DISTANCE),
+				snappedCenter,
+				up);
+			glm::mat4 lightProjection = glm::ortho(
+				-extent, extent, -extent, extent,
+				0.1f, SHADOW_CASTER_DISTANCE + extent + snapStep);
+			shadowView.lightSpace = lightProjection * lightView;
+		}
+	}
+
+	// the spotlight view only depends on the spotlight
+	SHADOW_VIEW& spotView = m_views[SPOT_SHADOW_VIEW];
+	spotView.bActive = m_spotActive;
+	if (spotView.bActive == true)
+	{
+		glm::vec3 direction = glm::normalize(m_spotDirection);
+		glm::vec3 up = (std::abs(direction.y) > 0.99f) ?
+			glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		float fieldOfView = 2.0f * std::acos(glm::clamp(m_spotOuterCutOff, 0.0f, 1.0f));
+
+		spotView.lightSpace =
+			glm::perspective(fieldOfView, 1.0f, 0.1f, SPOT_SHADOW_FAR) *
+			glm::lookAt(m_spotPosition, m_spotPosition + direction, up);
+	}
+}
+
+/***********************************************************
+ *  AttachShadowView()
+ *
+ *  This method is used for attaching the shadow map layer
+ *  of a view to the framebuffer bound to the passed target.
+ ***********************************************************/
+void ShadowManager::AttachShadowView(GLenum target, int index, bool bDynamic)
+{
+	if (index == SPOT_SHADOW_VIEW)
+	{
+		glFramebufferTexture2D(target, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
+			bDynamic ? m_dynamicSpotMap : m_staticSpotMap, 0);
+	}
+	else
+	{
+		glFramebufferTextureLayer(target, GL_DEPTH_ATTACHMENT,
+			bDynamic ? m_dynamicCascadeArray : m_staticCascadeArray, 0, index);
+	}
+}
+
+/***********************************************************
+ *  StartShadowView()
+ *
+ *  This method is used for setting up the depth shader and
+ *  the GPU timer for rendering into a shadow view.
+ ***********************************************************/
+void ShadowManager::StartShadowView(int index)
+{
+	int size = (index == SPOT_SHADOW_VIEW) ? SPOT_MAP_SIZE : CASCADE_MAP_SIZE;
+
+	GLState::Viewport(0, 0, size, size);
+
+	// offset the depth to reduce shadow acne
+	GLState::Enable(GL_POLYGON_OFFSET_FILL);
+	GLState::PolygonOffset(2.0f, 4.0f);
+
+	GLState::UseShader(m_pDepthShader);
+	GLState::SetUniform(m_pDepthShader, g_LightSpaceName, m_views[index].lightSpace);
+
+	// only one timer query per view is in flight, so the
+	// result is never waited on
+	if (m_views[index].bQueryPending == false)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, m_views[index].timerQuery);
+	}
+}
+
+/***********************************************************
+ *  BeginStaticShadowView()
+ *
+ *  This method is used for starting to render the static
+ *  objects into a cached shadow view.  False is returned
+ *  when the cached shadow view is still valid.
+ ***********************************************************/
+bool ShadowManager::BeginStaticShadowView(int index)
+{
+	if ((m_views[index].bActive == false) || (m_views[index].bDirty == false))
+	{
+		return(false);
+	}
+
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, m_shadowFramebuffer);
+	AttachShadowView(GL_FRAMEBUFFER, index, false);
+	glClear(GL_DEPTH_BUFFER_BIT);
+
+	StartShadowView(index);
+	m_views[index].bDirty = false;
+
+	return(true);
+}
+
+/***********************************************************
+ *  BeginDynamicShadowView()
+ *
+ *  This method is used for copying a cached static shadow
+ *  view and starting to render the dynamic objects on top.
+ ***********************************************************/
+bool ShadowManager::BeginDynamicShadowView(int index)
+{
+	if (m_views[index].bActive == false)
+	{
+		return(false);
+	}
+
+	CreateDynamicShadowMaps();
+
+	int size = (index == SPOT_SHADOW_VIEW) ? SPOT_MAP_SIZE : CASCADE_MAP_SIZE;
+
+	// copy the cached static depth into the composited map
+	GLState::BindFramebuffer(GL_READ_FRAMEBUFFER, m_copyFramebuffer);
+	AttachShadowView(GL_READ_FRAMEBUFFER, index, false);
+	GLState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, m_shadowFramebuffer);
+	AttachShadowView(GL_DRAW_FRAMEBUFFER, index, true);
+	glBlitFramebuffer(0, 0, size, size, 0, 0, size, size,
+		GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, m_shadowFramebuffer);
+	StartShadowView(index);
+
+	return(true);
+}
+
+/***********************************************************
+ *  EndShadowView()
+ *
+ *  This method is used for finishing the rendering of a
+ *  shadow view.
+ ***********************************************************/
+void ShadowManager::EndShadowView(int index)
+{
+	if (m_views[index].bQueryPending == false)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		m_views[index].bQueryPending = true;
+	}
+
+	m_renderedViews++;
+}
+
+/***********************************************************
+ *  EndShadowPasses()
+ *
+ *  This method is used for restoring the scene framebuffer
+ *  and viewport after all the shadow views are rendered.
+ ***********************************************************/
+void ShadowManager::EndShadowPasses()
+{
+	GLState::Disable(GL_POLYGON_OFFSET_FILL);
+	GLState::BindFramebuffer(GL_FRAMEBUFFER, m_savedFramebuffer);
+	GLState::Viewport(m_savedViewport[0], m_savedViewport[1],
+		m_savedViewport[2], m_savedViewport[3]);
+}
+
+/***********************************************************
+ *  CollectTimerQueries()
+ *
+ *  This method is used for reading back the GPU timer
+ *  queries that have finished, without waiting on the ones
+ *  that have not.
+ ***********************************************************/
+void ShadowManager::CollectTimerQueries()
+{
+	for (int i = 0; i < NUM_SHADOW_VIEWS; i++)
+	{
+		if (m_views[i].bQueryPending == false)
+		{
+			continue;
+		}
+
+		GLint available = 0;
+		glGetQueryObjectiv(m_views[i].timerQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available != 0)
+		{
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(m_views[i].timerQuery, GL_QUERY_RESULT, &elapsed);
+			m_views[i].lastRenderMilliseconds = static_cast<double>(elapsed) / 1000000.0;
+			m_views[i].bQueryPending = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  BindShadowMaps()
+ *
+ *  This method is used for binding the shadow maps to their
+ *  texture units and passing the light views and cascade
+ *  splits into the scene shader.
+ ***********************************************************/
+void ShadowManager::BindShadowMaps(ShaderManager* pShaderManager, bool bDynamicObjects)
+{
+	if (NULL == pShaderManager)
+	{
+		return;
+	}
+
+	bool bUseDynamic = (bDynamicObjects == true) && (m_dynamicCascadeArray != 0);
+
+	GLState::ActiveTexture(GL_TEXTURE0 + DIRECTIONAL_SHADOW_TEXTURE_UNIT);
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY,
+		bUseDynamic ? m_dynamicCascadeArray : m_staticCascadeArray);
+	GLState::ActiveTexture(GL_TEXTURE0 + SPOT_SHADOW_TEXTURE_UNIT);
+	GLState::BindTexture(GL_TEXTURE_2D,
+		bUseDynamic ? m_dynamicSpotMap : m_staticSpotMap);
+	GLState::ActiveTexture(GL_TEXTURE0);
+
+	GLState::SetUniform(pShaderManager, "bUseShadows", true);
+	GLState::SetSampler(pShaderManager, g_DirectionalShadowMapsName, DIRECTIONAL_SHADOW_TEXTURE_UNIT);
+	GLState::SetSampler(pShaderManager, g_SpotShadowMapName, SPOT_SHADOW_TEXTURE_UNIT);
+
+	for (int i = 0; i < NUM_SHADOW_VIEWS; i++)
+	{
+		GLState::SetUniform(pShaderManager, m_views[i].uniformName.c_str(), m_views[i].lightSpace);
+	}
+	for (int c = 0; c < NUM_CASCADES; c++)
+	{
+		GLState::SetUniform(pShaderManager, m_cascadeSplitNames[c].c_str(), m_cascadeSplits[c]);
+	}
+}
+
+/***********************************************************
+ *  UpdateFrameStats()
+ *
+ *  This method is used for publishing the GPU time and the
+ *  memory of each shadow view to the frame stats.
+ ***********************************************************/
+void ShadowManager::UpdateFrameStats()
+{
+	for (int i = 0; i < NUM_SHADOW_VIEWS; i++)
+	{
+		FrameStats::SetMilliseconds(
+			m_views[i].timeStatName.c_str(),
+			m_views[i].lastRenderMilliseconds);
+		FrameStats::SetBytes(
+			m_views[i].memoryStatName.c_str(),
+			m_views[i].bytes);
+	}
+	FrameStats::AddCounter("shadow views rendered", m_renderedViews);
+}
@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadowmanager.h
+// ============
+// manage the cached shadow maps for the directional lights and the spotlight
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <string>
+
+/***********************************************************
+ *  ShadowManager
+ *
+ *  This class owns the shadow map textures and the depth
+ *  shader.  Shadows from static objects are rendered into
+ *  cached maps that are only re-rendered when a light, the
+ *  static geometry or a cascade region changes.  Dynamic
+ *  objects are drawn on top of a copy of the cached maps
+ *  every frame.
+ ***********************************************************/
+class ShadowManager
+{
+public:
+	// number of cascades for each directional light
+	static const int NUM_CASCADES = 3;
+	// number of directional lights that cast shadows
+	static const int NUM_DIRECTIONAL_LIGHTS = 2;
+	// the spotlight view comes after all the cascade views
+	static const int SPOT_SHADOW_VIEW = NUM_CASCADES * NUM_DIRECTIONAL_LIGHTS;
+	// total number of rendered shadow views
+	static const int NUM_SHADOW_VIEWS = SPOT_SHADOW_VIEW + 1;
+
+	// texture units reserved for the shadow maps - the scene
+	// textures use the units below these
+	static const int DIRECTIONAL_SHADOW_TEXTURE_UNIT = 14;
+	static const int SPOT_SHADOW_TEXTURE_UNIT = 15;
+
+	// constructor
+	ShadowManager();
+	// destructor
+	~ShadowManager();
+
+	// set the light values - the cached shadows are invalidated
+	// when any of the values differ from the previous ones
+	void SetDirectionalLight(int index, glm::vec3 direction, bool bActive);
+	void SetSpotLight(glm::vec3 position, glm::vec3 direction, float outerCutOff, bool bActive);
+
+	// mark the cached shadows from static objects as out of date
+	void MarkStaticGeometryDirty();
+
+	// calculate the shadow view for every cascade and light
+	void PrepareShadowViews(glm::mat4 view, glm::mat4 projection);
+
+	// begin rendering the static objects into a shadow view,
+	// returns false when the cached map is still valid
+	bool BeginStaticShadowView(int index);
+	// begin rendering the dynamic objects on top of a copy
+	// of the cached static shadow view
+	bool BeginDynamicShadowView(int index);
+	// finish rendering a shadow view
+	void EndShadowView(int index);
+	// restore the scene framebuffer after the shadow views
+	void EndShadowPasses();
+
+	// get the shader used for drawing objects into a shadow view
+	ShaderManager* GetDepthShader() { return(m_pDepthShader); }
+
+	// bind the shadow maps and pass the shadow values into
+	// the scene shader
+	void BindShadowMaps(ShaderManager* pShaderManager, bool bDynamicObjects);
+
+	// publish the shadow timings and memory to the frame stats
+	void UpdateFrameStats();
+
+private:
+	struct SHADOW_VIEW
+	{
+		// combined light projection and view matrix
+		glm::mat4 lightSpace;
+		// snapped center and radius the cached map was rendered with
+		glm::vec3 cachedCenter;
+		float cachedRadius;
+		// the cached map must be re-rendered
+		bool bDirty;
+		// the view belongs to an inactive light
+		bool bActive;
+		// GPU timer query for the last rendering of the view
+		GLuint timerQuery;
+		bool bQueryPending;
+		double lastRenderMilliseconds;
+		// texture memory used by the view
+		size_t bytes;
+		// name of the light space matrix in the scene shader
+		std::string uniformName;
+		// names published to the frame stats
+		std::string timeStatName;
+		std::string memoryStatName;
+	};
+
+	// shader for rendering the shadow depth
+	ShaderManager* m_pDepthShader;
+	// framebuffers for rendering and copying the shadow maps
+	GLuint m_shadowFramebuffer;
+	GLuint m_copyFramebuffer;
+	// cached static and composited directional cascades
+	GLuint m_staticCascadeArray;
+	GLuint m_dynamicCascadeArray;
+	// cached static and composited spotlight maps
+	GLuint m_staticSpotMap;
+	GLuint m_dynamicSpotMap;
+	// framebuffer and viewport saved before the shadow passes
+	GLuint m_savedFramebuffer;
+	GLint m_savedViewport[4];
+
+	SHADOW_VIEW m_views[NUM_SHADOW_VIEWS];
+	// view depth at the far end of each cascade
+	float m_cascadeSplits[NUM_CASCADES];
+	std::string m_cascadeSplitNames[NUM_CASCADES];
+
+	glm::vec3 m_directionalDirections[NUM_DIRECTIONAL_LIGHTS];
+	bool m_directionalActive[NUM_DIRECTIONAL_LIGHTS];
+	glm::vec3 m_spotPosition;
+	glm::vec3 m_spotDirection;
+	float m_spotOuterCutOff;
+	bool m_spotActive;
+
+	// number of views re-rendered in the current frame
+	int m_renderedViews;
+
+	// create the depth textures used for the shadow maps
+	GLuint CreateDepthTexture(GLenum target, int size, int layers);
+	// allocate the composited maps once dynamic objects appear
+	void CreateDynamicShadowMaps();
+	// attach the shadow map layer for a view to a framebuffer
+	void AttachShadowView(GLenum target, int index, bool bDynamic);
+	// set up the depth shader and timing for a shadow view
+	void StartShadowView(int index);
+	// collect finished GPU timer query results
+	void CollectTimerQueries();
+};
@@ -0,0 +1,860 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwarerasterizer.cpp
+// ============
+// draw the scene on the CPU in tiles spread over all cores, without OpenGL
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include <emmintrin.h>
+
+// declaration of the global variables and defines
+namespace
+{
+	// triangles thinner than this in pixels are not drawn
+	const float MIN_TRIANGLE_AREA = 1.0e-8f;
+
+	/***********************************************************
+	 *  PackColor()
+	 *
+	 *  Pack a color into red, green, blue and alpha bytes, the
+	 *  way it is written into an 8 bit render target.
+	 ***********************************************************/
+	uint32_t PackColor(const glm::vec3& color)
+	{
+		uint32_t red = static_cast<uint32_t>(std::min(std::max(color.r, 0.0f), 1.0f) * 255.0f + 0.5f);
+		uint32_t green = static_cast<uint32_t>(std::min(std::max(color.g, 0.0f), 1.0f) * 255.0f + 0.5f);
+		uint32_t blue = static_cast<uint32_t>(std::min(std::max(color.b, 0.0f), 1.0f) * 255.0f + 0.5f);
+		return(red | (green << 8) | (blue << 16) | 0xFF000000u);
+	}
+
+	/***********************************************************
+	 *  WrapCoordinate()
+	 *
+	 *  Wrap a texel coordinate into the texture, like the
+	 *  repeat wrapping of the scene textures.
+	 ***********************************************************/
+	int WrapCoordinate(int coordinate, int size)
+	{
+		coordinate %= size;
+		return((coordinate < 0) ? (coordinate + size) : coordinate);
+	}
+
+	/***********************************************************
+	 *  InsideEdge()
+	 *
+	 *  Test four edge function values - a pixel right on the
+	 *  edge is only inside when the triangle owns the edge.
+	 ***********************************************************/
+	__m128 InsideEdge(__m128 edge, bool bOwnsEdge)
+	{
+		return((bOwnsEdge == true) ?
+			_mm_cmpge_ps(edge, _mm_setzero_ps()) :
+			_mm_cmpgt_ps(edge, _mm_setzero_ps()));
+	}
+}
+
+/***********************************************************
+ *  SoftwareRasterizer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SoftwareRasterizer::SoftwareRasterizer()
+{
+	m_width = 0;
+	m_height = 0;
+	m_stride = 0;
+	m_tilesX = 0;
+	m_tilesY = 0;
+	m_viewProjection = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
+	m_clearColor = PackColor(glm::vec3(0.0f));
+	m_nextWork = 0;
+	m_pStage = NULL;
+	m_stage = 0;
+	m_stageWorkers = 0;
+	m_busyWorkers = 0;
+	m_bStopWorkers = false;
+}
+
+/***********************************************************
+ *  ~SoftwareRasterizer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopWorkers = true;
+	}
+	m_stageReady.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+}
+
+/***********************************************************
+ *  SetSize()
+ *
+ *  This method is used for setting the size of the image.
+ *  The rows are padded to whole tiles, so the four pixels
+ *  drawn at once always stay inside the tile they belong
+ *  to.
+ ***********************************************************/
+void SoftwareRasterizer::SetSize(int width, int height)
+{
+	m_width = std::max(width, 1);
+	m_height = std::max(height, 1);
+	m_tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+	m_tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+	m_stride = m_tilesX * TILE_SIZE;
+
+	m_color.assign(static_cast<size_t>(m_stride) * m_height, m_clearColor);
+	m_depth.assign(static_cast<size_t>(m_stride) * m_height, 1.0f);
+	m_tileBins.resize(static_cast<size_t>(m_tilesX) * m_tilesY);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for adding a texture from 8 bit
+ *  pixels.  Only the color is kept, images with less than
+ *  three channels are gray.
+ ***********************************************************/
+int SoftwareRasterizer::AddTexture(const unsigned char* pixels, int width, int height, int channels)
+{
+	TEXTURE texture;
+	texture.width = width;
+	texture.height = height;
+	texture.texels.resize(static_cast<size_t>(width) * height * 3);
+
+	for (size_t i = 0; i < static_cast<size_t>(width) * height; i++)
+	{
+		const unsigned char* pPixel = pixels + (i * channels);
+		for (int c = 0; c < 3; c++)
+		{
+			texture.texels[i * 3 + c] = (channels >= 3) ? pPixel[c] : pPixel[0];
+		}
+	}
+
+	m_textures.push_back(texture);
+	return(static_cast<int>(m_textures.size()) - 1);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a frame seen from the
+ *  passed in camera.  The draws and lights of the last
+ *  frame are dropped.
+ ***********************************************************/
+void SoftwareRasterizer::BeginFrame(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& viewPosition,
+	const glm::vec3& clearColor)
+{
+	m_viewProjection = projection * view;
+	m_viewPosition = viewPosition;
+	m_clearColor = PackColor(clearColor);
+	m_lights.clear();
+	m_draws.clear();
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a light to the frame.
+ ***********************************************************/
+void SoftwareRasterizer::AddLight(const RASTER_LIGHT& light)
+{
+	m_lights.push_back(light);
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for adding a mesh to the draws of
+ *  the frame.  Nothing is drawn until the frame ends.
+ ***********************************************************/
+void SoftwareRasterizer::DrawMesh(
+	const MESH_DATA* pMesh,
+	const glm::mat4& model,
+	const glm::vec4& color,
+	int texture,
+	const glm::vec2& UVscale,
+	const RASTER_MATERIAL& material)
+{
+	if ((NULL == pMesh) || (pMesh->indices.empty() == true))
+	{
+		return;
+	}
+
+	DRAW_COMMAND draw;
+	draw.pMesh = pMesh;
+	draw.model = model;
+	draw.color = color;
+	draw.texture = ((texture >= 0) && (texture < static_cast<int>(m_textures.size()))) ? texture : -1;
+	draw.UVscale = UVscale;
+	draw.material = material;
+	m_draws.push_back(draw);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for drawing the frame.  The draws
+ *  are set up on all threads, the triangles are put into
+ *  the bins of their tiles in the order of the draws, and
+ *  the tiles are drawn on all threads.  Binning in order
+ *  keeps the image the same however the work is spread.
+ ***********************************************************/
+void SoftwareRasterizer::EndFrame(int threadCount)
+{
+	if (m_tileBins.empty() == true)
+	{
+		return;
+	}
+
+	if (threadCount <= 0)
+	{
+		threadCount = static_cast<int>(std::thread::hardware_concurrency());
+	}
+	threadCount = std::max(threadCount, 1);
+
+	if (m_drawVertices.size() < m_draws.size())
+	{
+		m_drawVertices.resize(m_draws.size());
+		m_drawTriangles.resize(m_draws.size());
+	}
+	RunStage(&SoftwareRasterizer::SetupDraws, std::min(threadCount, static_cast<int>(m_draws.size())));
+
+	for (size_t i = 0; i < m_tileBins.size(); i++)
+	{
+		m_tileBins[i].clear();
+	}
+	for (size_t d = 0; d < m_draws.size(); d++)
+	{
+		const std::vector<TRIANGLE>& triangles = m_drawTriangles[d];
+		for (size_t t = 0; t < triangles.size(); t++)
+		{
+			const TRIANGLE& triangle = triangles[t];
+			for (int tileY = triangle.minY / TILE_SIZE; tileY <= triangle.maxY / TILE_SIZE; tileY++)
+			{
+				for (int tileX = triangle.minX / TILE_SIZE; tileX <= triangle.maxX / TILE_SIZE; tileX++)
+				{
+					m_tileBins[tileY * m_tilesX + tileX].push_back(&triangle);
+				}
+			}
+		}
+	}
+
+	RunStage(&SoftwareRasterizer::DrawTiles, std::min(threadCount, static_cast<int>(m_tileBins.size())));
+}
+
+/***********************************************************
+ *  RunStage()
+ *
+ *  This method is used for running a stage of the frame on
+ *  several threads.  The threads take their work from the
+ *  shared counter, and the calling thread works as well.
+ *  The workers are only started when a stage needs more of
+ *  them than ran before, so a frame does not start any.
+ ***********************************************************/
+void SoftwareRasterizer::RunStage(void (SoftwareRasterizer::*pStage)(), int threadCount)
+{
+	m_nextWork = 0;
+
+	int workerCount = std::max(threadCount - 1, 0);
+	if (workerCount > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			// a new worker waits for the stages after the
+			// current one
+			while (static_cast<int>(m_workers.size()) < workerCount)
+			{
+				m_workers.push_back(std::thread(&SoftwareRasterizer::WorkerMain, this,
+					static_cast<int>(m_workers.size()), m_stage));
+			}
+			m_pStage = pStage;
+			m_stageWorkers = workerCount;
+			m_busyWorkers = workerCount;
+			m_stage++;
+		}
+		m_stageReady.notify_all();
+	}
+
+	(this->*pStage)();
+
+	if (workerCount > 0)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (m_busyWorkers > 0)
+		{
+			m_stageDone.wait(lock);
+		}
+	}
+}
+
+/***********************************************************
+ *  WorkerMain()
+ *
+ *  This method is the loop of a worker thread.  It waits
+ *  for the next stage and runs it when the worker takes
+ *  part in it, until the rasterizer is destroyed.
+ ***********************************************************/
+void SoftwareRasterizer::WorkerMain(int worker, unsigned int stage)
+{
+	while (true)
+	{
+		void (SoftwareRasterizer::*pStage)() = NULL;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while ((m_bStopWorkers == false) && (m_stage == stage))
+			{
+				m_stageReady.wait(lock);
+			}
+			if (m_bStopWorkers == true)
+			{
+				return;
+			}
+			stage = m_stage;
+			// the stage has less work than there are workers
+			if (worker >= m_stageWorkers)
+			{
+				continue;
+			}
+			pStage = m_pStage;
+		}
+
+		(this->*pStage)();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_busyWorkers--;
+		}
+		m_stageDone.notify_all();
+	}
+}
+
+/***********************************************************
+ *  SetupDraws()
+ *
+ *  This method is used for transforming the vertices of
+ *  the draws taken from the shared counter, the way the
+ *  vertex shader does, and setting up their triangles.
+ *  The normals are passed on as they are, like the shader
+ *  passes them.
+ ***********************************************************/
+void SoftwareRasterizer::SetupDraws()
+{
+	for (;;)
+	{
+		size_t drawIndex = m_nextWork.fetch_add(1);
+		if (drawIndex >= m_draws.size())
+		{
+			return;
+		}
+
+		const DRAW_COMMAND& draw = m_draws[drawIndex];
+		const MESH_DATA& mesh = *draw.pMesh;
+		std::vector<CLIP_VERTEX>& vertices = m_drawVertices[drawIndex];
+		std::vector<TRIANGLE>& triangles = m_drawTriangles[drawIndex];
+		triangles.clear();
+
+		unsigned int vertexCount = mesh.GetVertexCount();
+		vertices.resize(vertexCount);
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			const float* pVertex = &mesh.vertices[i * MESH_DATA::FLOATS_PER_VERTEX];
+			glm::vec4 world = draw.model * glm::vec4(
+				pVertex[MESH_DATA::POSITION_OFFSET],
+				pVertex[MESH_DATA::POSITION_OFFSET + 1],
+				pVertex[MESH_DATA::POSITION_OFFSET + 2],
+				1.0f);
+
+			CLIP_VERTEX& vertex = vertices[i];
+			vertex.clip = m_viewProjection * world;
+			vertex.world = glm::vec3(world);
+			vertex.normal = glm::vec3(
+				pVertex[MESH_DATA::NORMAL_OFFSET],
+				pVertex[MESH_DATA::NORMAL_OFFSET + 1],
+				pVertex[MESH_DATA::NORMAL_OFFSET + 2]);
+			vertex.uv = glm::vec2(pVertex[MESH_DATA::UV_OFFSET], pVertex[MESH_DATA::UV_OFFSET + 1]);
+		}
+
+		for (size_t i = 0; (i + 2) < mesh.indices.size(); i += 3)
+		{
+			CLIP_VERTEX corners[3] = {
+				vertices[mesh.indices[i]],
+				vertices[mesh.indices[i + 1]],
+				vertices[mesh.indices[i + 2]] };
+			ClipTriangle(corners, static_cast<int>(drawIndex), triangles);
+		}
+	}
+}
+
+/***********************************************************
+ *  ClipTriangle()
+ *
+ *  This method is used for dropping a triangle that is
+ *  outside one of the frustum planes and clipping the
+ *  others against the near plane, so every vertex that is
+ *  set up is in front of the camera.  The other planes are
+ *  left to the pixel bounds and the depth test.
+ ***********************************************************/
+void SoftwareRasterizer::ClipTriangle(const CLIP_VERTEX* vertices, int draw, std::vector<TRIANGLE>& triangles)
+{
+	int outside[5] = { 0, 0, 0, 0, 0 };
+	int behind = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec4& clip = vertices[i].clip;
+		outside[0] += (clip.x < -clip.w) ? 1 : 0;
+		outside[1] += (clip.x > clip.w) ? 1 : 0;
+		outside[2] += (clip.y < -clip.w) ? 1 : 0;
+		outside[3] += (clip.y > clip.w) ? 1 : 0;
+		outside[4] += (clip.z > clip.w) ? 1 : 0;
+		behind += ((clip.z + clip.w) < 0.0f) ? 1 : 0;
+	}
+	for (int plane = 0; plane < 5; plane++)
+	{
+		if (outside[plane] == 3)
+		{
+			return;
+		}
+	}
+
+	if (behind == 0)
+	{
+		SetupTriangle(vertices[0], vertices[1], vertices[2], draw, triangles);
+		return;
+	}
+	if (behind == 3)
+	{
+		return;
+	}
+
+	// cut the triangle at the near plane, which leaves a
+	// triangle or a quad
+	CLIP_VERTEX polygon[4];
+	int count = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		const CLIP_VERTEX& current = vertices[i];
+		const CLIP_VERTEX& next = vertices[(i + 1) % 3];
+		float currentDistance = current.clip.z + current.clip.w;
+		float nextDistance = next.clip.z + next.clip.w;
+
+		if (currentDistance >= 0.0f)
+		{
+			polygon[count++] = current;
+		}
+		if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+		{
+			float t = currentDistance / (currentDistance - nextDistance);
+			CLIP_VERTEX& cut = polygon[count++];
+			cut.clip = glm::mix(current.clip, next.clip, t);
+			cut.world = glm::mix(current.world, next.world, t);
+			cut.normal = glm::mix(current.normal, next.normal, t);
+			cut.uv = glm::mix(current.uv, next.uv, t);
+		}
+	}
+
+	for (int i = 2; i < count; i++)
+	{
+		SetupTriangle(polygon[0], polygon[i - 1], polygon[i], draw, triangles);
+	}
+}
+
+/***********************************************************
+ *  SetupTriangle()
+ *
+ *  This method is used for moving a triangle into pixels
+ *  and working out its edge functions.  The edges are
+ *  turned so the inside is positive whichever way the
+ *  triangle faces, since the scene is drawn without face
+ *  culling.  Of the two triangles sharing an edge exactly
+ *  one owns it, so its pixels are drawn once.
+ ***********************************************************/
+void SoftwareRasterizer::SetupTriangle(
+	const CLIP_VERTEX& a,
+	const CLIP_VERTEX& b,
+	const CLIP_VERTEX& c,
+	int draw,
+	std::vector<TRIANGLE>& triangles)
+{
+	const CLIP_VERTEX* corners[3] = { &a, &b, &c };
+
+	TRIANGLE triangle;
+	float x[3];
+	float y[3];
+	for (int i = 0; i < 3; i++)
+	{
+		const CLIP_VERTEX& vertex = *corners[i];
+		float invW = 1.0f / vertex.clip.w;
+		x[i] = (vertex.clip.x * invW * 0.5f + 0.5f) * static_cast<float>(m_width);
+		y[i] = (0.5f - vertex.clip.y * invW * 0.5f) * static_cast<float>(m_height);
+		triangle.depth[i] = vertex.clip.z * invW * 0.5f + 0.5f;
+		triangle.invW[i] = invW;
+		triangle.world[i] = vertex.world * invW;
+		triangle.normal[i] = vertex.normal * invW;
+		triangle.uv[i] = vertex.uv * invW;
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		int j = (i + 1) % 3;
+		int k = (i + 2) % 3;
+		triangle.edgeA[i] = y[j] - y[k];
+		triangle.edgeB[i] = x[k] - x[j];
+		triangle.edgeC[i] = -((triangle.edgeA[i] * x[j]) + (triangle.edgeB[i] * y[j]));
+	}
+
+	float area = (triangle.edgeA[0] * x[0]) + (triangle.edgeB[0] * y[0]) + triangle.edgeC[0];
+	if (std::fabs(area) < MIN_TRIANGLE_AREA)
+	{
+		return;
+	}
+	if (area < 0.0f)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			triangle.edgeA[i] = -triangle.edgeA[i];
+			triangle.edgeB[i] = -triangle.edgeB[i];
+			triangle.edgeC[i] = -triangle.edgeC[i];
+		}
+		area = -area;
+	}
+	triangle.invArea = 1.0f / area;
+
+	for (int i = 0; i < 3; i++)
+	{
+		triangle.bOwnsEdge[i] = (triangle.edgeA[i] > 0.0f) ||
+			((triangle.edgeA[i] == 0.0f) && (triangle.edgeB[i] > 0.0f));
+	}
+
+	float minX = std::min(std::min(x[0], x[1]), x[2]);
+	float maxX = std::max(std::max(x[0], x[1]), x[2]);
+	float minY = std::min(std::min(y[0], y[1]), y[2]);
+	float maxY = std::max(std::max(y[0], y[1]), y[2]);
+	triangle.minX = std::max(static_cast<int>(std::floor(minX)), 0);
+	triangle.minY = std::max(static_cast<int>(std::floor(minY)), 0);
+	triangle.maxX = std::min(static_cast<int>(std::ceil(maxX)), m_width - 1);
+	triangle.maxY = std::min(static_cast<int>(std::ceil(maxY)), m_height - 1);
+	if ((triangle.minX > triangle.maxX) || (triangle.minY > triangle.maxY))
+	{
+		return;
+	}
+
+	triangle.draw = draw;
+	triangles.push_back(triangle);
+}
+
+/***********************************************************
+ *  DrawTiles()
+ *
+ *  This method is used for drawing the tiles taken from the
+ *  shared counter.  A tile is cleared and its triangles
+ *  are drawn in the order they were binned.
+ ***********************************************************/
+void SoftwareRasterizer::DrawTiles()
+{
+	for (;;)
+	{
+		size_t tile = m_nextWork.fetch_add(1);
+		if (tile >= m_tileBins.size())
+		{
+			return;
+		}
+
+		int tileMinX = static_cast<int>(tile % m_tilesX) * TILE_SIZE;
+		int tileMinY = static_cast<int>(tile / m_tilesX) * TILE_SIZE;
+		int tileMaxX = std::min(tileMinX + TILE_SIZE, m_width) - 1;
+		int tileMaxY = std::min(tileMinY + TILE_SIZE, m_height) - 1;
+
+		for (int y = tileMinY; y <= tileMaxY; y++)
+		{
+			size_t rowStart = static_cast<size_t>(y) * m_stride + tileMinX;
+			std::fill(m_color.begin() + rowStart, m_color.begin() + rowStart + TILE_SIZE, m_clearColor);
+			std::fill(m_depth.begin() + rowStart, m_depth.begin() + rowStart + TILE_SIZE, 1.0f);
+		}
+
+		const std::vector<const TRIANGLE*>& bin = m_tileBins[tile];
+		for (size_t i = 0; i < bin.size(); i++)
+		{
+			DrawTriangle(*bin[i], tileMinX, tileMinY, tileMaxX, tileMaxY);
+		}
+	}
+}
+
+/***********************************************************
+ *  DrawTriangle()
+ *
+ *  This method is used for drawing the part of a triangle
+ *  that is inside a tile.  Four pixels of a row are tested
+ *  against the edges and the depth buffer at once, starting
+ *  on a multiple of four from the tile's left side.  The
+ *  pixels that pass are lit one by one with their values
+ *  corrected for perspective.
+ ***********************************************************/
+void SoftwareRasterizer::DrawTriangle(const TRIANGLE& triangle, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY)
+{
+	int minX = std::max(triangle.minX, tileMinX);
+	int minY = std::max(triangle.minY, tileMinY);
+	int maxX = std::min(triangle.maxX, tileMaxX);
+	int maxY = std::min(triangle.maxY, tileMaxY);
+	if ((minX > maxX) || (minY > maxY))
+	{
+		return;
+	}
+
+	const DRAW_COMMAND& draw = m_draws[triangle.draw];
+	int startX = tileMinX + ((minX - tileMinX) & ~3);
+
+	const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 columnMin = _mm_set1_ps(static_cast<float>(minX));
+	const __m128 columnEnd = _mm_set1_ps(static_cast<float>(maxX + 1));
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 invArea = _mm_set1_ps(triangle.invArea);
+	__m128 edgeA[3];
+	__m128 depth[3];
+	__m128 invW[3];
+	for (int i = 0; i < 3; i++)
+	{
+		edgeA[i] = _mm_set1_ps(triangle.edgeA[i]);
+		depth[i] = _mm_set1_ps(triangle.depth[i]);
+		invW[i] = _mm_set1_ps(triangle.invW[i]);
+	}
+
+	for (int y = minY; y <= maxY; y++)
+	{
+		float centerY = static_cast<float>(y) + 0.5f;
+		__m128 rowBase[3];
+		for (int i = 0; i < 3; i++)
+		{
+			rowBase[i] = _mm_set1_ps((triangle.edgeB[i] * centerY) + triangle.edgeC[i]);
+		}
+
+		float* pDepthRow = &m_depth[static_cast<size_t>(y) * m_stride];
+		uint32_t* pColorRow = &m_color[static_cast<size_t>(y) * m_stride];
+
+		for (int x = startX; x <= maxX; x += 4)
+		{
+			__m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+			__m128 edge0 = _mm_add_ps(_mm_mul_ps(edgeA[0], centerX), rowBase[0]);
+			__m128 edge1 = _mm_add_ps(_mm_mul_ps(edgeA[1], centerX), rowBase[1]);
+			__m128 edge2 = _mm_add_ps(_mm_mul_ps(edgeA[2], centerX), rowBase[2]);
+
+			__m128 inside = _mm_and_ps(
+				_mm_and_ps(InsideEdge(edge0, triangle.bOwnsEdge[0]), InsideEdge(edge1, triangle.bOwnsEdge[1])),
+				InsideEdge(edge2, triangle.bOwnsEdge[2]));
+			inside = _mm_and_ps(inside, _mm_and_ps(
+				_mm_cmpge_ps(centerX, columnMin),
+				_mm_cmplt_ps(centerX, columnEnd)));
+			if (_mm_movemask_ps(inside) == 0)
+			{
+				continue;
+			}
+
+			__m128 weight0 = _mm_mul_ps(edge0, invArea);
+			__m128 weight1 = _mm_mul_ps(edge1, invArea);
+			__m128 weight2 = _mm_mul_ps(edge2, invArea);
+			__m128 z = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(weight0, depth[0]),
+				_mm_mul_ps(weight1, depth[1])),
+				_mm_mul_ps(weight2, depth[2]));
+
+			// the depth test of the scene is less than, and
+			// nothing beyond the far plane is drawn
+			__m128 storedDepth = _mm_loadu_ps(pDepthRow + x);
+			__m128 pass = _mm_and_ps(inside, _mm_cmplt_ps(z, storedDepth));
+			pass = _mm_and_ps(pass, _mm_and_ps(_mm_cmpge_ps(z, zero), _mm_cmple_ps(z, one)));
+			int passMask = _mm_movemask_ps(pass);
+			if (passMask == 0)
+			{
+				continue;
+			}
+			_mm_storeu_ps(pDepthRow + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, storedDepth)));
+
+			__m128 w = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(weight0, invW[0]),
+				_mm_mul_ps(weight1, invW[1])),
+				_mm_mul_ps(weight2, invW[2]));
+			float weights[3][4];
+			float perspective[4];
+			_mm_storeu_ps(weights[0], weight0);
+			_mm_storeu_ps(weights[1], weight1);
+			_mm_storeu_ps(weights[2], weight2);
+			_mm_storeu_ps(perspective, _mm_div_ps(one, w));
+
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if ((passMask & (1 << lane)) == 0)
+				{
+					continue;
+				}
+
+				float b0 = weights[0][lane] * perspective[lane];
+				float b1 = weights[1][lane] * perspective[lane];
+				float b2 = weights[2][lane] * perspective[lane];
+				glm::vec3 world = (triangle.world[0] * b0) + (triangle.world[1] * b1) + (triangle.world[2] * b2);
+				glm::vec3 normal = (triangle.normal[0] * b0) + (triangle.normal[1] * b1) + (triangle.normal[2] * b2);
+				glm::vec2 uv = (triangle.uv[0] * b0) + (triangle.uv[1] * b1) + (triangle.uv[2] * b2);
+
+				pColorRow[x + lane] = PackColor(ShadePixel(draw, world, normal, uv));
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ShadePixel()
+ *
+ *  This method is used for lighting a pixel with the Phong
+ *  model of the scene fragment shader.  Like the shader,
+ *  the ambient light takes the texture without the UV
+ *  scale, and the lit color is multiplied by the texture
+ *  with the UV scale.
+ ***********************************************************/
+glm::vec3 SoftwareRasterizer::ShadePixel(
+	const DRAW_COMMAND& draw,
+	const glm::vec3& world,
+	const glm::vec3& normal,
+	const glm::vec2& uv) const
+{
+	const RASTER_MATERIAL& material = draw.material;
+	glm::vec3 norm = glm::normalize(normal);
+	glm::vec3 viewDir = glm::normalize(m_viewPosition - world);
+
+	bool bTextured = (draw.texture >= 0);
+	glm::vec3 ambientColor = (bTextured == true) ? SampleTexture(draw.texture, uv) : glm::vec3(draw.color);
+
+	glm::vec3 lighting(0.0f);
+	for (size_t i = 0; i < m_lights.size(); i++)
+	{
+		const RASTER_LIGHT& light = m_lights[i];
+		glm::vec3 lightDir = (light.type == LIGHT_DIRECTIONAL) ?
+			glm::normalize(-light.direction) :
+			glm::normalize(light.position - world);
+
+		glm::vec3 ambient = light.ambient * ambientColor;
+
+		float diff = std::max(glm::dot(norm, lightDir), 0.0f);
+		glm::vec3 diffuse = light.diffuse * diff * material.diffuseColor;
+
+		glm::vec3 reflectDir = glm::reflect(-lightDir, norm);
+		float spec = std::pow(std::max(glm::dot(viewDir, reflectDir), 0.0f), material.shininess);
+		glm::vec3 specular = light.specular * spec * material.specularColor;
+
+		if (light.type != LIGHT_SPOT)
+		{
+			lighting += ambient + diffuse + specular;
+			continue;
+		}
+
+		float distance = glm::length(light.position - world);
+		float attenuation = 1.0f / (light.constant + (light.linear * distance) + (light.quadratic * (distance * distance)));
+		float theta = glm::dot(lightDir, glm::normalize(-light.direction));
+		float epsilon = light.cutOff - light.outerCutOff;
+		float intensity = std::min(std::max((theta - light.outerCutOff) / epsilon, 0.0f), 1.0f);
+		lighting += (ambient + (diffuse * intensity) + (specular * intensity)) * attenuation;
+	}
+
+	glm::vec3 baseColor = (bTextured == true) ?
+		SampleTexture(draw.texture, uv * draw.UVscale) :
+		glm::vec3(draw.color);
+
+	return(lighting * baseColor);
+}
+
+/***********************************************************
+ *  SampleTexture()
+ *
+ *  This method is used for reading a texture between its
+ *  four nearest texels, wrapping around its sides.
+ ***********************************************************/
+glm::vec3 SoftwareRasterizer::SampleTexture(int texture, glm::vec2 uv) const
+{
+	const TEXTURE& image = m_textures[texture];
+
+	float x = (uv.x * static_cast<float>(image.width)) - 0.5f;
+	float y = (uv.y * static_cast<float>(image.height)) - 0.5f;
+	float left = std::floor(x);
+	float bottom = std::floor(y);
+	float fractionX = x - left;
+	float fractionY = y - bottom;
+
+	int x0 = WrapCoordinate(static_cast<int>(left), image.width);
+	int x1 = WrapCoordinate(x0 + 1, image.width);
+	int y0 = WrapCoordinate(static_cast<int>(bottom), image.height);
+	int y1 = WrapCoordinate(y0 + 1, image.height);
+
+	const unsigned char* pTexels = &image.texels[0];
+	const unsigned char* pCorners[4] = {
+		pTexels + ((static_cast<size_t>(y0) * image.width + x0) * 3),
+		pTexels + ((static_cast<size_t>(y0) * image.width + x1) * 3),
+		pTexels + ((static_cast<size_t>(y1) * image.width + x0) * 3),
+		pTexels + ((static_cast<size_t>(y1) * image.width + x1) * 3) };
+
+	glm::vec3 color(0.0f);
+	for (int c = 0; c < 3; c++)
+	{
+		float bottomRow = pCorners[0][c] + ((pCorners[1][c] - pCorners[0][c]) * fractionX);
+		float topRow = pCorners[2][c] + ((pCorners[3][c] - pCorners[2][c]) * fractionX);
+		color[c] = (bottomRow + ((topRow - bottomRow) * fractionY)) / 255.0f;
+	}
+
+	return(color);
+}
+
+/***********************************************************
+ *  GetPixel()
+ *
+ *  This method is used for getting the bytes of a pixel,
+ *  with the first row at the top of the image.
+ ***********************************************************/
+const unsigned char* SoftwareRasterizer::GetPixel(int x, int y) const
+{
+	return(reinterpret_cast<const unsigned char*>(&m_color[static_cast<size_t>(y) * m_stride + x]));
+}
+
+/***********************************************************
+ *  SaveImage()
+ *
+ *  This method is used for writing the image into a binary
+ *  PPM file, top row first.
+ ***********************************************************/
+bool SoftwareRasterizer::SaveImage(const char* filename) const
+{
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		return(false);
+	}
+
+	file << "P6\n" << m_width << " " << m_height << "\n255\n";
+	std::vector<unsigned char> row(static_cast<size_t>(m_width) * 3);
+	for (int y = 0; y < m_height; y++)
+	{
+		for (int x = 0; x < m_width; x++)
+		{
+			const unsigned char* pPixel = GetPixel(x, y);
+			row[x * 3] = pPixel[0];
+			row[x * 3 + 1] = pPixel[1];
+			row[x * 3 + 2] = pPixel[2];
+		}
+		file.write(reinterpret_cast<const char*>(&row[0]), row.size());
+	}
+
+	return(file.good());
+}
@@ -0,0 +1,244 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwarerasterizer.h
+// ============
+// draw the scene on the CPU in tiles spread over all cores, without OpenGL
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshData.h"
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  SoftwareRasterizer
+ *
+ *  This class draws meshes into an image on the CPU, for
+ *  machines without a GPU and for checking the frames
+ *  drawn by OpenGL.  It makes no OpenGL calls.
+ *
+ *  The draws of a frame are collected first.  When the
+ *  frame ends, the vertices of every draw are transformed
+ *  and its triangles clipped and set up on all cores, the
+ *  triangles are sorted into bins of the screen tiles they
+ *  touch, and then the tiles are drawn on all cores.  Every
+ *  tile is drawn by one thread, so no pixel is shared.
+ *  The worker threads are started by the first frame that
+ *  needs them and wait for the next stage between frames,
+ *  until the rasterizer is destroyed.
+ *
+ *  The edge functions, depth test and perspective values
+ *  are evaluated for four pixels of a row at once with SSE.
+ *  The covered pixels are lit with the formulas of the
+ *  scene fragment shader - the directional, point and spot
+ *  lights with the Phong model, and bilinear sampling of
+ *  the textures with repeat wrapping.  The shadow maps and
+ *  the baked lighting are not drawn.
+ ***********************************************************/
+class SoftwareRasterizer
+{
+public:
+	// width and height of the tiles in pixels - a multiple of
+	// the four pixels drawn at once
+	static const int TILE_SIZE = 64;
+
+	enum LIGHT_TYPE
+	{
+		LIGHT_DIRECTIONAL,
+		LIGHT_POINT,
+		LIGHT_SPOT
+	};
+
+	// a light with the values of the shader's light structs,
+	// the spot values are only used by spot lights
+	struct RASTER_LIGHT
+	{
+		LIGHT_TYPE type;
+		glm::vec3 position;
+		glm::vec3 direction;
+		glm::vec3 ambient;
+		glm::vec3 diffuse;
+		glm::vec3 specular;
+		float cutOff;
+		float outerCutOff;
+		float constant;
+		float linear;
+		float quadratic;
+	};
+
+	// the shader's material struct
+	struct RASTER_MATERIAL
+	{
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+	};
+
+	// constructor
+	SoftwareRasterizer();
+	// destructor
+	~SoftwareRasterizer();
+
+	// set the size of the image, the image is cleared
+	void SetSize(int width, int height);
+	// add a texture from 8 bit pixels with the first row at
+	// the bottom, returns its number
+	int AddTexture(const unsigned char* pixels, int width, int height, int channels);
+
+	// start a frame seen from the passed in camera
+	void BeginFrame(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& viewPosition,
+		const glm::vec3& clearColor);
+	// add a light to the frame
+	void AddLight(const RASTER_LIGHT& light);
+	// draw a mesh - the mesh has to stay alive until the
+	// frame ends, and the texture is -1 to use the color
+	void DrawMesh(
+		const MESH_DATA* pMesh,
+		const glm::mat4& model,
+		const glm::vec4& color,
+		int texture,
+		const glm::vec2& UVscale,
+		const RASTER_MATERIAL& material);
+	// draw the frame, using one thread per core when the
+	// thread count is 0
+	void EndFrame(int threadCount = 0);
+
+	int GetWidth() const { return(m_width); }
+	int GetHeight() const { return(m_height); }
+	// the pixel at a column and row, with the first row at
+	// the top, as red, green, blue and alpha bytes
+	const unsigned char* GetPixel(int x, int y) const;
+	// write the image into a binary PPM file
+	bool SaveImage(const char* filename) const;
+
+private:
+	struct DRAW_COMMAND
+	{
+		const MESH_DATA* pMesh;
+		glm::mat4 model;
+		glm::vec4 color;
+		int texture;
+		glm::vec2 UVscale;
+		RASTER_MATERIAL material;
+	};
+
+	// a vertex after the vertex stage, as the vertex shader
+	// writes it
+	struct CLIP_VERTEX
+	{
+		glm::vec4 clip;
+		glm::vec3 world;
+		glm::vec3 normal;
+		glm::vec2 uv;
+	};
+
+	// a triangle ready for drawing - the edge functions are
+	// positive inside, and the values drawn across the
+	// triangle are divided by w for perspective
+	struct TRIANGLE
+	{
+		float edgeA[3];
+		float edgeB[3];
+		float edgeC[3];
+		// whether the pixels right on an edge belong to the
+		// triangle, so a shared edge is drawn once
+		bool bOwnsEdge[3];
+		float invArea;
+		float depth[3];
+		float invW[3];
+		glm::vec3 world[3];
+		glm::vec3 normal[3];
+		glm::vec2 uv[3];
+		// pixel bounds, the maximum is inclusive
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+		int draw;
+	};
+
+	struct TEXTURE
+	{
+		int width;
+		int height;
+		// red, green and blue bytes, first row at the bottom
+		std::vector<unsigned char> texels;
+	};
+
+	// run a stage on the passed in number of threads, the
+	// calling thread included
+	void RunStage(void (SoftwareRasterizer::*pStage)(), int threadCount);
+	// the loop of a worker thread, which runs its part of
+	// every stage after the passed in one
+	void WorkerMain(int worker, unsigned int stage);
+	// transform and set up the draws taken from the shared
+	// counter
+	void SetupDraws();
+	// draw the tiles taken from the shared counter
+	void DrawTiles();
+	// clip a triangle against the near plane and set up the
+	// pieces that are left
+	void ClipTriangle(const CLIP_VERTEX* vertices, int draw, std::vector<TRIANGLE>& triangles);
+	// set up a triangle from clip space vertices
+	void SetupTriangle(const CLIP_VERTEX& a, const CLIP_VERTEX& b, const CLIP_VERTEX& c, int draw, std::vector<TRIANGLE>& triangles);
+	// draw the part of a triangle inside a tile
+	void DrawTriangle(const TRIANGLE& triangle, int tileMinX, int tileMinY, int tileMaxX, int tileMaxY);
+	// light a pixel the way the fragment shader does
+	glm::vec3 ShadePixel(const DRAW_COMMAND& draw, const glm::vec3& world, const glm::vec3& normal, const glm::vec2& uv) const;
+	// sample a texture with bilinear filtering
+	glm::vec3 SampleTexture(int texture, glm::vec2 uv) const;
+
+	int m_width;
+	int m_height;
+	// pixels between the starts of two rows, the width rounded
+	// up to whole tiles so four pixels never reach past a row
+	int m_stride;
+	int m_tilesX;
+	int m_tilesY;
+	std::vector<uint32_t> m_color;
+	std::vector<float> m_depth;
+
+	glm::mat4 m_viewProjection;
+	glm::vec3 m_viewPosition;
+	uint32_t m_clearColor;
+	std::vector<RASTER_LIGHT> m_lights;
+	std::vector<DRAW_COMMAND> m_draws;
+	std::vector<TEXTURE> m_textures;
+
+	// the transformed vertices and the triangles of every draw,
+	// kept between the frames so they keep their memory
+	std::vector<std::vector<CLIP_VERTEX> > m_drawVertices;
+	std::vector<std::vector<TRIANGLE> > m_drawTriangles;
+	// the triangles touching each tile, in the order they are
+	// drawn
+	std::vector<std::vector<const TRIANGLE*> > m_tileBins;
+
+	// next draw or tile to work on, shared by the threads
+	std::atomic<size_t> m_nextWork;
+
+	// the worker threads, kept for the rasterizer's lifetime
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	// signaled when a stage is started or the workers stop
+	std::condition_variable m_stageReady;
+	// signaled when a worker finished its part of a stage
+	std::condition_variable m_stageDone;
+	// the running stage, counted up for every stage, the
+	// number of workers taking part in it and the ones that
+	// have not finished yet
+	void (SoftwareRasterizer::*m_pStage)();
+	unsigned int m_stage;
+	int m_stageWorkers;
+	int m_busyWorkers;
+	bool m_bStopWorkers;
+};
@@ -0,0 +1,334 @@
+///////////////////////////////////////////////////////////////////////////////
+// staticscene.h
+// ============
+// compile a scene that never changes into read-only tables at build time
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  StaticScene
+ *
+ *  A scene whose objects are known when the project is
+ *  built is declared as a constexpr array of objects, and
+ *  CompileScene() turns it into a table the compiler fills
+ *  in - the model matrix and world bounds of every object,
+ *  in an order that keeps objects with the same mesh,
+ *  texture and material together.  Loading the scene then
+ *  only copies the table, and no object has its matrix
+ *  built from degrees while the frames are drawn.
+ *
+ *  Everything here is constexpr, so the trigonometry is
+ *  done with series instead of the math library, and the
+ *  matrices are plain column-major float arrays in the
+ *  layout of glm::mat4.
+ ***********************************************************/
+namespace StaticScene
+{
+	// an object as it is declared - the mesh is the number
+	// of the basic mesh, and the library mesh is drawn in
+	// its place when it is not NULL
+	struct OBJECT
+	{
+		const char* tag;
+		int mesh;
+		float scale[3];
+		float rotationDegrees[3];
+		float position[3];
+		float color[4];
+		// empty when the object is drawn with its color only
+		const char* textureTag;
+		float UVscale[2];
+		const char* materialTag;
+		const char* libraryMesh;
+	};
+
+	// bounding box of a basic mesh in its own space
+	struct LOCAL_BOUNDS
+	{
+		float min[3];
+		float max[3];
+	};
+
+	// column-major 4x4 matrix, element [column * 4 + row]
+	struct MATRIX
+	{
+		float m[16];
+	};
+
+	// an object with what the compiler worked out for it
+	struct COMPILED_OBJECT
+	{
+		OBJECT object;
+		MATRIX model;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	// the compiled objects in their draw order
+	template <size_t COUNT>
+	struct TABLE
+	{
+		COMPILED_OBJECT objects[COUNT];
+
+		static constexpr size_t GetCount() { return(COUNT); }
+	};
+
+	/***********************************************************
+	 *  SineDegrees()
+	 *
+	 *  Sine of an angle in degrees.  The angle is folded into
+	 *  -90 to 90 degrees first, so the series is exact for the
+	 *  right angles the scenes are usually built from.
+	 ***********************************************************/
+	constexpr float SineDegrees(float degrees)
+	{
+		double angle = static_cast<double>(degrees);
+		double turns = (angle + 180.0) / 360.0;
+		long long whole = static_cast<long long>(turns);
+		if (static_cast<double>(whole) > turns)
+		{
+			whole--;
+		}
+		angle -= 360.0 * static_cast<double>(whole);
+
+		if (angle > 90.0)
+		{
+			angle = 180.0 - angle;
+		}
+		else if (angle < -90.0)
+		{
+			angle = -180.0 - angle;
+		}
+
+		double x = angle * 3.14159265358979323846 / 180.0;
+		double term = x;
+		double sum = x;
+		for (int n = 1; n < 10; n++)
+		{
+			term *= -(x * x) / static_cast<double>((2 * n) * (2 * n + 1));
+			sum += term;
+		}
+
+		return(static_cast<float>(sum));
+	}
+
+	/***********************************************************
+	 *  CosineDegrees()
+	 *
+	 *  Cosine of an angle in degrees.
+	 ***********************************************************/
+	constexpr float CosineDegrees(float degrees)
+	{
+		return(SineDegrees(degrees + 90.0f));
+	}
+
+	/***********************************************************
+	 *  Identity()
+	 *
+	 *  The identity matrix.
+	 ***********************************************************/
+	constexpr MATRIX Identity()
+	{
+		MATRIX result = {};
+		result.m[0] = 1.0f;
+		result.m[5] = 1.0f;
+		result.m[10] = 1.0f;
+		result.m[15] = 1.0f;
+		return(result);
+	}
+
+	/***********************************************************
+	 *  Multiply()
+	 *
+	 *  The product of two matrices, applying b first.
+	 ***********************************************************/
+	constexpr MATRIX Multiply(const MATRIX& a, const MATRIX& b)
+	{
+		MATRIX result = {};
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				float sum = 0.0f;
+				for (int k = 0; k < 4; k++)
+				{
+					sum += a.m[k * 4 + row] * b.m[column * 4 + k];
+				}
+				result.m[column * 4 + row] = sum;
+			}
+		}
+		return(result);
+	}
+
+	/***********************************************************
+	 *  Rotation()
+	 *
+	 *  A rotation around the x (0), y (1) or z (2) axis, the
+	 *  same as glm::rotate() around that axis.
+	 ***********************************************************/
+	constexpr MATRIX Rotation(int axis, float degrees)
+	{
+		float s = SineDegrees(degrees);
+		float c = CosineDegrees(degrees);
+
+		// the two axes the rotation turns into each other
+		int first = (axis + 1) % 3;
+		int second = (axis + 2) % 3;
+
+		MATRIX result = Identity();
+		result.m[first * 4 + first] = c;
+		result.m[first * 4 + second] = s;
+		result.m[second * 4 + first] = -s;
+		result.m[second * 4 + second] = c;
+		return(result);
+	}
+
+	/***********************************************************
+	 *  ModelMatrix()
+	 *
+	 *  The model matrix of an object - scaled, rotated around
+	 *  x, y and then z, and moved to its position, in the same
+	 *  order as SceneManager::CalculateModelMatrix().
+	 ***********************************************************/
+	constexpr MATRIX ModelMatrix(const OBJECT& object)
+	{
+		MATRIX scale = Identity();
+		scale.m[0] = object.scale[0];
+		scale.m[5] = object.scale[1];
+		scale.m[10] = object.scale[2];
+
+		MATRIX translation = Identity();
+		translation.m[12] = object.position[0];
+		translation.m[13] = object.position[1];
+		translation.m[14] = object.position[2];
+
+		MATRIX rotation = Multiply(
+			Rotation(2, object.rotationDegrees[2]),
+			Multiply(Rotation(1, object.rotationDegrees[1]), Rotation(0, object.rotationDegrees[0])));
+
+		return(Multiply(translation, Multiply(rotation, scale)));
+	}
+
+	/***********************************************************
+	 *  TransformBounds()
+	 *
+	 *  This function is used for finding the world bounds of
+	 *  a compiled object from the eight corners of the local
+	 *  bounds of its mesh.
+	 ***********************************************************/
+	constexpr void TransformBounds(const LOCAL_BOUNDS& local, COMPILED_OBJECT& compiled)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			float corner[3] = {
+				(i & 1) ? local.max[0] : local.min[0],
+				(i & 2) ? local.max[1] : local.min[1],
+				(i & 4) ? local.max[2] : local.min[2] };
+
+			for (int row = 0; row < 3; row++)
+			{
+				float world = compiled.model.m[12 + row];
+				for (int k = 0; k < 3; k++)
+				{
+					world += compiled.model.m[k * 4 + row] * corner[k];
+				}
+
+				if ((i == 0) || (world < compiled.boundsMin[row]))
+				{
+					compiled.boundsMin[row] = world;
+				}
+				if ((i == 0) || (world > compiled.boundsMax[row]))
+				{
+					compiled.boundsMax[row] = world;
+				}
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  CompareNames()
+	 *
+	 *  Compare two names like strcmp(), with NULL before any
+	 *  name.
+	 ***********************************************************/
+	constexpr int CompareNames(const char* a, const char* b)
+	{
+		if ((NULL == a) || (NULL == b))
+		{
+			return(((NULL == a) ? 0 : 1) - ((NULL == b) ? 0 : 1));
+		}
+
+		while ((*a != '\0') && (*a == *b))
+		{
+			a++;
+			b++;
+		}
+		return(static_cast<int>(static_cast<unsigned char>(*a)) - static_cast<int>(static_cast<unsigned char>(*b)));
+	}
+
+	/***********************************************************
+	 *  DrawsBefore()
+	 *
+	 *  Whether an object is drawn before another - objects are
+	 *  grouped by their mesh, then their texture and then their
+	 *  material, so the draws in a row share their bindings.
+	 ***********************************************************/
+	constexpr bool DrawsBefore(const OBJECT& a, const OBJECT& b)
+	{
+		if (a.mesh != b.mesh)
+		{
+			return(a.mesh < b.mesh);
+		}
+
+		int order = CompareNames(a.libraryMesh, b.libraryMesh);
+		if (order == 0)
+		{
+			order = CompareNames(a.textureTag, b.textureTag);
+		}
+		if (order == 0)
+		{
+			order = CompareNames(a.materialTag, b.materialTag);
+		}
+		return(order < 0);
+	}
+
+	/***********************************************************
+	 *  CompileScene()
+	 *
+	 *  This function is used for compiling the declared
+	 *  objects into a table.  The local bounds are indexed by
+	 *  the mesh number.  The objects are sorted into their
+	 *  draw order with an insertion sort, which keeps objects
+	 *  that draw the same in the order they were declared.
+	 ***********************************************************/
+	template <size_t COUNT, size_t MESH_COUNT>
+	constexpr TABLE<COUNT> CompileScene(
+		const OBJECT (&objects)[COUNT],
+		const LOCAL_BOUNDS (&meshBounds)[MESH_COUNT])
+	{
+		TABLE<COUNT> table = {};
+		for (size_t i = 0; i < COUNT; i++)
+		{
+			COMPILED_OBJECT compiled = {};
+			compiled.object = objects[i];
+			compiled.model = ModelMatrix(objects[i]);
+			if ((objects[i].mesh >= 0) && (static_cast<size_t>(objects[i].mesh) < MESH_COUNT))
+			{
+				TransformBounds(meshBounds[objects[i].mesh], compiled);
+			}
+
+			size_t slot = i;
+			while ((slot > 0) && (DrawsBefore(compiled.object, table.objects[slot - 1].object) == true))
+			{
+				table.objects[slot] = table.objects[slot - 1];
+				slot--;
+			}
+			table.objects[slot] = compiled;
+		}
+
+		return(table);
+	}
+}
@@ -0,0 +1,450 @@
+///////////////////////////////////////////////////////////////////////////////
+// taskgraph.cpp
+// ============
+// run the startup work as a graph of tasks on worker threads and the context
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TaskGraph.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstdio>
+
+/***********************************************************
+ *  TaskGraph()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TaskGraph::TaskGraph()
+{
+	m_finishedCount = 0;
+	m_bStarted = false;
+	m_bStopWorkers = false;
+	m_pWake = NULL;
+}
+
+/***********************************************************
+ *  ~TaskGraph()
+ *
+ *  The destructor for the class - the queued worker tasks
+ *  are dropped and the running ones are waited for.
+ ***********************************************************/
+TaskGraph::~TaskGraph()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopWorkers = true;
+		m_workerTasks.clear();
+	}
+	m_workerReady.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+}
+
+/***********************************************************
+ *  AddTask()
+ *
+ *  This method is used for adding a task to the graph.
+ *  The dependencies are tasks that were added before, so
+ *  the graph can not have cycles.
+ ***********************************************************/
+int TaskGraph::AddTask(
+	const std::string& name,
+	TASK_THREAD thread,
+	TASK_FUNCTION function,
+	const std::vector<int>& dependencies)
+{
+	if (m_bStarted == true)
+	{
+		LOG_ERROR("Task added after the task graph was started:" << name);
+		return(-1);
+	}
+
+	int index = static_cast<int>(m_tasks.size());
+
+	TASK task;
+	task.name = name;
+	task.thread = thread;
+	task.function = function;
+	task.waitingFor = 0;
+	task.bFinished = false;
+	task.startTime = 0.0;
+	task.endTime = 0.0;
+	task.worker = -1;
+	for (size_t i = 0; i < dependencies.size(); i++)
+	{
+		int dependency = dependencies[i];
+		if ((dependency >= 0) && (dependency < index))
+		{
+			task.dependencies.push_back(dependency);
+			m_tasks[dependency].dependents.push_back(index);
+			task.waitingFor++;
+		}
+	}
+	m_tasks.push_back(task);
+
+	return(index);
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for queueing the tasks without
+ *  dependencies and starting the worker threads.
+ ***********************************************************/
+void TaskGraph::Start(int workerCount)
+{
+	if (m_bStarted == true)
+	{
+		return;
+	}
+
+	if (workerCount <= 0)
+	{
+		workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStarted = true;
+		m_startTime = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < m_tasks.size(); i++)
+		{
+			if (m_tasks[i].waitingFor == 0)
+			{
+				QueueTask(static_cast<int>(i));
+			}
+		}
+	}
+
+	for (int i = 0; i < workerCount; i++)
+	{
+		m_workers.push_back(std::thread(&TaskGraph::WorkerMain, this, i));
+	}
+}
+
+/***********************************************************
+ *  RunContextTasks()
+ *
+ *  This method is used for running the context tasks that
+ *  are ready, including the ones they make ready.  It must
+ *  be called on the context thread.
+ ***********************************************************/
+bool TaskGraph::RunContextTasks()
+{
+	bool bRan = false;
+
+	while (true)
+	{
+		int task = -1;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_contextTasks.empty() == true)
+			{
+				return(bRan);
+			}
+			task = m_contextTasks.front();
+			m_contextTasks.pop_front();
+		}
+
+		RunTask(task, -1);
+		bRan = true;
+	}
+}
+
+/***********************************************************
+ *  WaitForTask()
+ *
+ *  This method is used for blocking the context thread
+ *  until a task has finished, running the context tasks
+ *  as they become ready.
+ ***********************************************************/
+void TaskGraph::WaitForTask(int task)
+{
+	if ((task < 0) || (task >= static_cast<int>(m_tasks.size())))
+	{
+		return;
+	}
+
+	Start();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_tasks[task].bFinished == false)
+	{
+		if (m_contextTasks.empty() == false)
+		{
+			int next = m_contextTasks.front();
+			m_contextTasks.pop_front();
+			lock.unlock();
+			RunTask(next, -1);
+			lock.lock();
+		}
+		else
+		{
+			m_taskDone.wait(lock);
+		}
+	}
+}
+
+/***********************************************************
+ *  WaitForAll()
+ *
+ *  This method is used for blocking the context thread
+ *  until every task has finished, running the context
+ *  tasks as they become ready.
+ ***********************************************************/
+void TaskGraph::WaitForAll()
+{
+	Start();
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (m_finishedCount < static_cast<int>(m_tasks.size()))
+	{
+		if (m_contextTasks.empty() == false)
+		{
+			int next = m_contextTasks.front();
+			m_contextTasks.pop_front();
+			lock.unlock();
+			RunTask(next, -1);
+			lock.lock();
+		}
+		else
+		{
+			m_taskDone.wait(lock);
+		}
+	}
+}
+
+/***********************************************************
+ *  IsFinished()
+ *
+ *  This method is used for checking whether every task has
+ *  finished.
+ ***********************************************************/
+bool TaskGraph::IsFinished()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return(m_finishedCount == static_cast<int>(m_tasks.size()));
+}
+
+/***********************************************************
+ *  IsTaskFinished()
+ *
+ *  This method is used for checking whether a task has
+ *  finished.
+ ***********************************************************/
+bool TaskGraph::IsTaskFinished(int task)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if ((task < 0) || (task >= static_cast<int>(m_tasks.size())))
+	{
+		return(false);
+	}
+
+	return(m_tasks[task].bFinished);
+}
+
+/***********************************************************
+ *  QueueTask()
+ *
+ *  This method is used for putting a task that is ready
+ *  into the queue of the thread it runs on.  The lock must
+ *  be held.
+ ***********************************************************/
+void TaskGraph::QueueTask(int task)
+{
+	if (m_tasks[task].thread == THREAD_CONTEXT)
+	{
+		m_contextTasks.push_back(task);
+	}
+	else
+	{
+		m_workerTasks.push_back(task);
+	}
+}
+
+/***********************************************************
+ *  RunTask()
+ *
+ *  This method is used for running a task and queueing the
+ *  tasks that were only waiting for it.  The context thread
+ *  is woken up when a worker makes a context task ready or
+ *  finishes the last task.
+ ***********************************************************/
+void TaskGraph::RunTask(int task, int worker)
+{
+	TASK_FUNCTION function;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks[task].startTime = GetTime();
+		m_tasks[task].worker = worker;
+		function.swap(m_tasks[task].function);
+	}
+
+	if (function)
+	{
+		function();
+	}
+
+	bool bWake = false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		TASK& finished = m_tasks[task];
+		finished.endTime = GetTime();
+		finished.bFinished = true;
+		m_finishedCount++;
+
+		for (size_t i = 0; i < finished.dependents.size(); i++)
+		{
+			int dependent = finished.dependents[i];
+			m_tasks[dependent].waitingFor--;
+			if (m_tasks[dependent].waitingFor == 0)
+			{
+				QueueTask(dependent);
+				bWake = bWake || (m_tasks[dependent].thread == THREAD_CONTEXT);
+			}
+		}
+		bWake = bWake || (m_finishedCount == static_cast<int>(m_tasks.size()));
+	}
+	m_workerReady.notify_all();
+	m_taskDone.notify_all();
+
+	if ((bWake == true) && (worker >= 0) && (NULL != m_pWake))
+	{
+		m_pWake();
+	}
+}
+
+/***********************************************************
+ *  WorkerMain()
+ *
+ *  This method is the loop of a worker thread.  It runs the
+ *  queued worker tasks until every task has finished or
+ *  the graph is destroyed.
+ ***********************************************************/
+void TaskGraph::WorkerMain(int worker)
+{
+	while (true)
+	{
+		int task = -1;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while ((m_bStopWorkers == false) &&
+				(m_workerTasks.empty() == true) &&
+				(m_finishedCount < static_cast<int>(m_tasks.size())))
+			{
+				m_workerReady.wait(lock);
+			}
+			if (m_workerTasks.empty() == true)
+			{
+				return;
+			}
+			task = m_workerTasks.front();
+			m_workerTasks.pop_front();
+		}
+
+		RunTask(task, worker);
+	}
+}
+
+/***********************************************************
+ *  GetTime()
+ *
+ *  This method is used for getting the milliseconds since
+ *  the graph was started.
+ ***********************************************************/
+double TaskGraph::GetTime() const
+{
+	return(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count());
+}
+
+/***********************************************************
+ *  ReportTimeline()
+ *
+ *  This method is used for writing when each task ran and
+ *  on which thread, in the order they started, followed by
+ *  the critical path.  The path is found backwards from
+ *  the task that finished last, always following the
+ *  dependency that finished last, and shows for every
+ *  task how long it ran and how long it waited for a
+ *  thread after it was ready.
+ ***********************************************************/
+void TaskGraph::ReportTimeline()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if ((m_tasks.empty() == true) || (m_finishedCount < static_cast<int>(m_tasks.size())))
+	{
+		return;
+	}
+
+	std::vector<int> order(m_tasks.size());
+	int lastTask = 0;
+	for (size_t i = 0; i < m_tasks.size(); i++)
+	{
+		order[i] = static_cast<int>(i);
+		if (m_tasks[i].endTime > m_tasks[lastTask].endTime)
+		{
+			lastTask = static_cast<int>(i);
+		}
+	}
+	std::stable_sort(order.begin(), order.end(),
+		[this](int a, int b)
+		{
+			return(m_tasks[a].startTime < m_tasks[b].startTime);
+		});
+
+	char line[Logger::MAX_MESSAGE_LENGTH];
+	LOG_INFO("INFO: Startup took " << m_tasks[lastTask].endTime << " ms with "
+		<< static_cast<int>(m_workers.size()) << " workers");
+	LOG_INFO("   start ms     end ms  thread     task");
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		const TASK& task = m_tasks[order[i]];
+		char thread[16];
+		if (task.worker < 0)
+		{
+			snprintf(thread, sizeof(thread), "context");
+		}
+		else
+		{
+			snprintf(thread, sizeof(thread), "worker %d", task.worker);
+		}
+		snprintf(line, sizeof(line), "%11.1f %10.1f  %-10s %s",
+			task.startTime, task.endTime, thread, task.name.c_str());
+		LOG_INFO(line);
+	}
+
+	std::vector<int> path;
+	int task = lastTask;
+	while (task >= 0)
+	{
+		path.push_back(task);
+		int latest = -1;
+		for (size_t i = 0; i < m_tasks[task].dependencies.size(); i++)
+		{
+			int dependency = m_tasks[task].dependencies[i];
+			if ((latest < 0) || (m_tasks[dependency].endTime > m_tasks[latest].endTime))
+			{
+				latest = dependency;
+			}
+		}
+		task = latest;
+	}
+
+	LOG_INFO("INFO: Startup critical path:");
+	for (size_t i = path.size(); i > 0; i--)
+	{
+		const TASK& step = m_tasks[path[i - 1]];
+		double readyTime = 0.0;
+		for (size_t j = 0; j < step.dependencies.size(); j++)
+		{
+			readyTime = std::max(readyTime, m_tasks[step.dependencies[j]].endTime);
+		}
+		snprintf(line, sizeof(line), "  %-32s ran %8.1f ms, waited %6.1f ms for a thread",
+			step.name.c_str(), step.endTime - step.startTime, step.startTime - readyTime);
+		LOG_INFO(line);
+	}
+}
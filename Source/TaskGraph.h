@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// taskgraph.h
+// ============
+// run the startup work as a graph of tasks on worker threads and the context
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  TaskGraph
+ *
+ *  This class runs a set of tasks in the order their
+ *  dependencies allow.  A task starts once every task it
+ *  depends on has finished, so independent work like
+ *  decoding images and generating meshes runs at the same
+ *  time on the worker threads.
+ *
+ *  Tasks that call OpenGL are marked to run on the context
+ *  thread, the thread the window and the OpenGL context
+ *  belong to.  They are queued until that thread pumps
+ *  them, between frames or while it waits for a task, so
+ *  the frames can start before all of the tasks are done.
+ *
+ *  All of the tasks are added before the graph is started.
+ *  The start and end of each task is recorded, and the
+ *  timeline report lists them with the critical path, the
+ *  chain of tasks the whole graph had to wait for.
+ ***********************************************************/
+class TaskGraph
+{
+public:
+	// thread a task has to run on
+	enum TASK_THREAD
+	{
+		THREAD_WORKER,
+		THREAD_CONTEXT
+	};
+
+	typedef std::function<void()> TASK_FUNCTION;
+
+	// constructor
+	TaskGraph();
+	// destructor
+	~TaskGraph();
+
+	// add a task that runs after the passed in tasks, returns
+	// its number
+	int AddTask(
+		const std::string& name,
+		TASK_THREAD thread,
+		TASK_FUNCTION function,
+		const std::vector<int>& dependencies = std::vector<int>());
+	// set the function called from a worker when a context
+	// task is ready, to wake up the context thread
+	void SetWakeFunction(void (*pWake)()) { m_pWake = pWake; }
+
+	// start running the tasks, with one worker less than the
+	// number of cores when 0 workers are passed in
+	void Start(int workerCount = 0);
+	// run the context tasks that are ready, on the context
+	// thread, returns whether any task was run
+	bool RunContextTasks();
+	// run the context tasks until a task has finished
+	void WaitForTask(int task);
+	// run the context tasks until all tasks have finished
+	void WaitForAll();
+
+	// whether all of the tasks have finished
+	bool IsFinished();
+	// whether a task has finished
+	bool IsTaskFinished(int task);
+
+	// write the start and end of every task and the critical
+	// path, once all of the tasks have finished
+	void ReportTimeline();
+
+private:
+	struct TASK
+	{
+		std::string name;
+		TASK_THREAD thread;
+		TASK_FUNCTION function;
+		std::vector<int> dependencies;
+		std::vector<int> dependents;
+		// dependencies that have not finished yet
+		int waitingFor;
+		bool bFinished;
+		// milliseconds since the start of the graph, and the
+		// worker the task ran on, -1 for the context thread
+		double startTime;
+		double endTime;
+		int worker;
+	};
+
+	// queue a task that has no unfinished dependencies, with
+	// the lock held
+	void QueueTask(int task);
+	// run a task and start the tasks waiting for it
+	void RunTask(int task, int worker);
+	// loop of a worker thread
+	void WorkerMain(int worker);
+	// milliseconds since the graph was started
+	double GetTime() const;
+
+	std::vector<TASK> m_tasks;
+	std::deque<int> m_workerTasks;
+	std::deque<int> m_contextTasks;
+	int m_finishedCount;
+	bool m_bStarted;
+	bool m_bStopWorkers;
+	std::chrono::steady_clock::time_point m_startTime;
+	void (*m_pWake)();
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	// signaled when a worker task is queued
+	std::condition_variable m_workerReady;
+	// signaled when a task finished or a context task is
+	// queued
+	std::condition_variable m_taskDone;
+};
@@ -0,0 +1,1274 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.cpp
+// ============
+// stream the mip levels of the scene textures under a memory budget
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureStreamer.h"
+#include "FramePacer.h"
+#include "FrameStats.h"
+#include "GLState.h"
+#include "Logger.h"
+#include "ResourceTracker.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// declaration of the global variables and defines
+namespace
+{
+	/***********************************************************
+	 *  GetLevelSize()
+	 *
+	 *  Get the width or height of a mip level.
+	 ***********************************************************/
+	int GetLevelSize(int size, int level)
+	{
+		return(std::max(1, size >> level));
+	}
+
+	/***********************************************************
+	 *  GetLevelCount()
+	 *
+	 *  Get the number of mip levels down to 1x1.
+	 ***********************************************************/
+	int GetLevelCount(int width, int height)
+	{
+		int levelCount = 1;
+		while (((width > 1) || (height > 1)) && (levelCount < TextureStreamer::MAX_LEVELS))
+		{
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+			levelCount++;
+		}
+
+		return(levelCount);
+	}
+
+	/***********************************************************
+	 *  GetTailLevel()
+	 *
+	 *  Get the first level that is small enough to always
+	 *  stay resident.
+	 ***********************************************************/
+	int GetTailLevel(int width, int height, int levelCount)
+	{
+		int level = 0;
+		while ((level < (levelCount - 1)) &&
+			(std::max(GetLevelSize(width, level), GetLevelSize(height, level)) > TextureStreamer::RESIDENT_LEVEL_SIZE))
+		{
+			level++;
+		}
+
+		return(level);
+	}
+
+	/***********************************************************
+	 *  Downsample()
+	 *
+	 *  Average each 2x2 block of texels into the next smaller
+	 *  mip level.  The last row or column of an odd sized
+	 *  level is repeated.
+	 ***********************************************************/
+	void Downsample(const unsigned char* pSource, int width, int height, int channels, std::vector<unsigned char>& destination)
+	{
+		int levelWidth = std::max(1, width / 2);
+		int levelHeight = std::max(1, height / 2);
+		destination.resize(static_cast<size_t>(levelWidth) * levelHeight * channels);
+
+		for (int y = 0; y < levelHeight; y++)
+		{
+			const unsigned char* pRow0 = pSource + static_cast<size_t>(std::min(y * 2, height - 1)) * width * channels;
+			const unsigned char* pRow1 = pSource + static_cast<size_t>(std::min(y * 2 + 1, height - 1)) * width * channels;
+			unsigned char* pOut = destination.data() + static_cast<size_t>(y) * levelWidth * channels;
+
+			for (int x = 0; x < levelWidth; x++)
+			{
+				int x0 = std::min(x * 2, width - 1) * channels;
+				int x1 = std::min(x * 2 + 1, width - 1) * channels;
+				for (int c = 0; c < channels; c++)
+				{
+					int sum = pRow0[x0 + c] + pRow0[x1 + c] + pRow1[x0 + c] + pRow1[x1 + c];
+					pOut[x * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  BuildLevels()
+	 *
+	 *  Build the mip levels of a decoded image from the first
+	 *  up to, but not including, the end level.  Only those
+	 *  levels are kept, the larger ones are just passed
+	 *  through on the way down.
+	 ***********************************************************/
+	void BuildLevels(
+		const unsigned char* pImage,
+		int width,
+		int height,
+		int channels,
+		int firstLevel,
+		int endLevel,
+		std::vector<std::vector<unsigned char> >& levels)
+	{
+		std::vector<unsigned char> scratch[2];
+		const unsigned char* pLevel = pImage;
+
+		levels.resize(endLevel - firstLevel);
+		for (int level = 0; level < endLevel; level++)
+		{
+			if (level >= firstLevel)
+			{
+				levels[level - firstLevel].assign(pLevel,
+					pLevel + static_cast<size_t>(width) * height * channels);
+			}
+			if ((level + 1) < endLevel)
+			{
+				Downsample(pLevel, width, height, channels, scratch[level & 1]);
+				pLevel = scratch[level & 1].data();
+				width = std::max(1, width / 2);
+				height = std::max(1, height / 2);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  DecodeColorBlock()
+	 *
+	 *  Decode the colors of a 4x4 S3TC block into RGBA texels.
+	 *  A DXT1 block whose first color is not above the second
+	 *  has three colors and transparent black.
+	 ***********************************************************/
+	void DecodeColorBlock(const unsigned char* pBlock, bool bFourColors, unsigned char texels[16][4])
+	{
+		unsigned int colors[2] =
+		{
+			static_cast<unsigned int>(pBlock[0] | (pBlock[1] << 8)),
+			static_cast<unsigned int>(pBlock[2] | (pBlock[3] << 8))
+		};
+
+		// expand the 5:6:5 end points to 8 bits
+		int palette[4][4];
+		for (int i = 0; i < 2; i++)
+		{
+			palette[i][0] = static_cast<int>((colors[i] >> 11) & 31) * 255 / 31;
+			palette[i][1] = static_cast<int>((colors[i] >> 5) & 63) * 255 / 63;
+			palette[i][2] = static_cast<int>(colors[i] & 31) * 255 / 31;
+			palette[i][3] = 255;
+		}
+		for (int c = 0; c < 4; c++)
+		{
+			if ((bFourColors == true) || (colors[0] > colors[1]))
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+
+		unsigned int bits = pBlock[4] | (pBlock[5] << 8) | (pBlock[6] << 16) | (static_cast<unsigned int>(pBlock[7]) << 24);
+		for (int i = 0; i < 16; i++)
+		{
+			const int* pColor = palette[(bits >> (i * 2)) & 3];
+			for (int c = 0; c < 4; c++)
+			{
+				texels[i][c] = static_cast<unsigned char>(pColor[c]);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  DecodeAlphaBlock()
+	 *
+	 *  Decode the alpha of a 4x4 DXT5 block into the alpha of
+	 *  the texels.
+	 ***********************************************************/
+	void DecodeAlphaBlock(const unsigned char* pBlock, unsigned char texels[16][4])
+	{
+		int alpha[8];
+		alpha[0] = pBlock[0];
+		alpha[1] = pBlock[1];
+		if (alpha[0] > alpha[1])
+		{
+			for (int i = 2; i < 8; i++)
+			{
+				alpha[i] = ((8 - i) * alpha[0] + (i - 1) * alpha[1]) / 7;
+			}
+		}
+		else
+		{
+			for (int i = 2; i < 6; i++)
+			{
+				alpha[i] = ((6 - i) * alpha[0] + (i - 1) * alpha[1]) / 5;
+			}
+			alpha[6] = 0;
+			alpha[7] = 255;
+		}
+
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; i++)
+		{
+			bits |= static_cast<uint64_t>(pBlock[2 + i]) << (i * 8);
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			texels[i][3] = static_cast<unsigned char>(alpha[(bits >> (i * 3)) & 7]);
+		}
+	}
+
+	/***********************************************************
+	 *  DecodeS3TC()
+	 *
+	 *  Decode a DXT1 or DXT5 compressed level into RGBA texels,
+	 *  for the CPU.  Returns false when the data is too small
+	 *  for the level or the format is not one of them.
+	 ***********************************************************/
+	bool DecodeS3TC(
+		const unsigned char* pData,
+		size_t bytes,
+		GLenum internalFormat,
+		int width,
+		int height,
+		std::vector<unsigned char>& texels)
+	{
+		bool bAlpha = (internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+		if ((bAlpha == false) && (internalFormat != GL_COMPRESSED_RGB_S3TC_DXT1_EXT))
+		{
+			return(false);
+		}
+
+		size_t blockBytes = (bAlpha == true) ? 16 : 8;
+		int blocksX = (width + 3) / 4;
+		int blocksY = (height + 3) / 4;
+		if (bytes < static_cast<size_t>(blocksX) * blocksY * blockBytes)
+		{
+			return(false);
+		}
+
+		texels.resize(static_cast<size_t>(width) * height * 4);
+		unsigned char block[16][4];
+		for (int by = 0; by < blocksY; by++)
+		{
+			for (int bx = 0; bx < blocksX; bx++)
+			{
+				const unsigned char* pBlock = pData + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+				if (bAlpha == true)
+				{
+					DecodeColorBlock(pBlock + 8, true, block);
+					DecodeAlphaBlock(pBlock, block);
+				}
+				else
+				{
+					DecodeColorBlock(pBlock, false, block);
+				}
+
+				// the last block of a row or column can be partly
+				// outside of the level
+				for (int y = 0; y < 4; y++)
+				{
+					for (int x = 0; x < 4; x++)
+					{
+						int texelX = bx * 4 + x;
+						int texelY = by * 4 + y;
+						if ((texelX < width) && (texelY < height))
+						{
+							memcpy(&texels[(static_cast<size_t>(texelY) * width + texelX) * 4], block[y * 4 + x], 4);
+						}
+					}
+				}
+			}
+		}
+
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  TextureStreamer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureStreamer::TextureStreamer()
+{
+	m_bArraysCreated = false;
+	m_budget = 0;
+	m_residentBytes = 0;
+	m_pendingBytes = 0;
+	m_pendingLoads = 0;
+	m_frame = 1;
+	m_bStopWorker = false;
+
+	m_worker = std::thread(&TextureStreamer::WorkerMain, this);
+}
+
+/***********************************************************
+ *  ~TextureStreamer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureStreamer::~TextureStreamer()
+{
+	DestroyTextures();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopWorker = true;
+	}
+	m_jobReady.notify_all();
+	m_worker.join();
+}
+
+/***********************************************************
+ *  AddFileTexture()
+ *
+ *  This method is used for adding a texture from an image
+ *  file and decoding it right away.
+ ***********************************************************/
+int TextureStreamer::AddFileTexture(const char* filename)
+{
+	int textureIndex = ReserveFileTexture(filename);
+	if ((textureIndex < 0) || (DecodeFileTexture(textureIndex) == false))
+	{
+		return(-1);
+	}
+
+	return(textureIndex);
+}
+
+/***********************************************************
+ *  ReserveFileTexture()
+ *
+ *  This method is used for adding a texture from an image
+ *  file without decoding it.  The texture has no levels
+ *  until it is decoded, and is left out of the arrays when
+ *  decoding fails.
+ ***********************************************************/
+int TextureStreamer::ReserveFileTexture(const char* filename)
+{
+	// indicate to always flip images vertically when loaded -
+	// this is set before any image is decoded
+	stbi_set_flip_vertically_on_load(true);
+
+	STREAMED_TEXTURE texture;
+	texture.source.source = SOURCE_FILE;
+	texture.source.filename = filename;
+	texture.source.pPack = NULL;
+	texture.source.pPacked = NULL;
+	texture.internalFormat = GL_RGBA8;
+	texture.format = GL_RGBA;
+	texture.channels = 0;
+	texture.width = 0;
+	texture.height = 0;
+	texture.levelCount = 0;
+	texture.tailLevel = 0;
+
+	return(AddTexture(texture));
+}
+
+/***********************************************************
+ *  DecodeFileTexture()
+ *
+ *  This method is used for decoding the image of a
+ *  reserved texture.  The whole image is decoded to build
+ *  the mip chain, but only the levels that always stay
+ *  resident are kept - the larger levels are decoded again
+ *  on the worker when they are needed.  It makes no OpenGL
+ *  calls and only changes its own texture, so textures can
+ *  be decoded on several threads at once.
+ ***********************************************************/
+bool TextureStreamer::DecodeFileTexture(int index)
+{
+	if ((index < 0) || (index >= static_cast<int>(m_textures.size())))
+	{
+		return(false);
+	}
+
+	STREAMED_TEXTURE& texture = m_textures[index];
+	const char* filename = texture.source.filename.c_str();
+
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	unsigned char* image = stbi_load(filename, &width, &height, &colorChannels, 0);
+	if (NULL == image)
+	{
+		LOG_ERROR("Could not load image:" << filename);
+		return(false);
+	}
+
+	LOG_INFO("Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels);
+
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		LOG_ERROR("Not implemented to handle image with " << colorChannels << " channels");
+		stbi_image_free(image);
+		return(false);
+	}
+
+	texture.internalFormat = (colorChannels == 4) ? GL_RGBA8 : GL_RGB8;
+	texture.format = (colorChannels == 4) ? GL_RGBA : GL_RGB;
+	texture.channels = colorChannels;
+	texture.width = width;
+	texture.height = height;
+	int levelCount = GetLevelCount(width, height);
+	texture.tailLevel = GetTailLevel(width, height, levelCount);
+	BuildLevels(image, width, height, colorChannels, texture.tailLevel, levelCount, texture.tailLevels);
+	stbi_image_free(image);
+
+	// the level count marks the texture as loaded
+	texture.levelCount = levelCount;
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsTextureLoaded()
+ *
+ *  This method is used for checking whether a texture has
+ *  its resident levels, which a reserved texture only has
+ *  once it was decoded.
+ ***********************************************************/
+bool TextureStreamer::IsTextureLoaded(int index) const
+{
+	if ((index < 0) || (index >= static_cast<int>(m_textures.size())))
+	{
+		return(false);
+	}
+
+	return(m_textures[index].levelCount > 0);
+}
+
+/***********************************************************
+ *  AddPackedTexture()
+ *
+ *  This method is used for adding a texture from the
+ *  cooked mip chain in an asset pack.  Only the levels
+ *  that always stay resident are read from the mapped file
+ *  now.
+ ***********************************************************/
+int TextureStreamer::AddPackedTexture(const AssetPack* pPack, const AssetPack::PACK_TEXTURE& packed)
+{
+	STREAMED_TEXTURE texture;
+	texture.source.source = SOURCE_PACK;
+	texture.source.filename = pPack->GetString(packed.tagOffset);
+	texture.source.pPack = pPack;
+	texture.source.pPacked = &packed;
+	texture.internalFormat = packed.internalFormat;
+	texture.format = GL_RGBA;
+	texture.channels = 4;
+	texture.width = static_cast<int>(packed.width);
+	texture.height = static_cast<int>(packed.height);
+	texture.levelCount = std::min(static_cast<int>(packed.levelCount), static_cast<int>(MAX_LEVELS));
+	texture.tailLevel = GetTailLevel(texture.width, texture.height, texture.levelCount);
+
+	texture.tailLevels.resize(texture.levelCount - texture.tailLevel);
+	for (int level = texture.tailLevel; level < texture.levelCount; level++)
+	{
+		const unsigned char* pData = static_cast<const unsigned char*>(
+			pPack->GetData(packed.levelOffsets[level], packed.levelBytes[level]));
+		if (NULL == pData)
+		{
+			return(-1);
+		}
+		texture.tailLevels[level - texture.tailLevel].assign(pData, pData + packed.levelBytes[level]);
+	}
+
+	return(AddTexture(texture));
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for keeping a new texture until the
+ *  arrays are created.
+ ***********************************************************/
+int TextureStreamer::AddTexture(STREAMED_TEXTURE& texture)
+{
+	if (m_bArraysCreated == true)
+	{
+		LOG_WARNING("Texture added after the texture arrays were created:" << texture.source.filename);
+		return(-1);
+	}
+
+	texture.arrayIndex = -1;
+	texture.layer = 0;
+	m_textures.push_back(texture);
+
+	return(static_cast<int>(m_textures.size()) - 1);
+}
+
+/***********************************************************
+ *  CreateArrays()
+ *
+ *  This method is used for putting the added textures into
+ *  arrays.  Textures with the same size, format and number
+ *  of levels share an array, in the order they were added.
+ ***********************************************************/
+void TextureStreamer::CreateArrays()
+{
+	m_bArraysCreated = true;
+
+	std::vector<bool> bGrouped(m_textures.size(), false);
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		// reserved textures that failed to decode get no array
+		if ((bGrouped[i] == true) || (m_textures[i].levelCount == 0))
+		{
+			continue;
+		}
+
+		const STREAMED_TEXTURE& first = m_textures[i];
+		std::vector<int> textureIndices;
+		for (size_t j = i; j < m_textures.size(); j++)
+		{
+			const STREAMED_TEXTURE& texture = m_textures[j];
+			if ((bGrouped[j] == false) &&
+				(texture.width == first.width) &&
+				(texture.height == first.height) &&
+				(texture.internalFormat == first.internalFormat) &&
+				(texture.levelCount == first.levelCount))
+			{
+				textureIndices.push_back(static_cast<int>(j));
+				bGrouped[j] = true;
+			}
+		}
+
+		if (static_cast<int>(m_arrays.size()) < MAX_TEXTURE_ARRAYS)
+		{
+			CreateArray(textureIndices);
+		}
+		else
+		{
+			LOG_ERROR("No texture unit left for the texture array of:" << first.source.filename);
+		}
+	}
+
+	// the level data is in the arrays now
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		std::vector<std::vector<unsigned char> >().swap(m_textures[i].tailLevels);
+	}
+
+	FrameStats::SetValue("texture arrays", static_cast<double>(m_arrays.size()));
+}
+
+/***********************************************************
+ *  CreateArray()
+ *
+ *  This method is used for creating the OpenGL texture
+ *  array of a group of textures and uploading their
+ *  resident levels.  The array is bound on the unit it is
+ *  numbered with and stays bound there.  An array that does
+ *  not fit into the memory budget is not created.
+ ***********************************************************/
+void TextureStreamer::CreateArray(const std::vector<int>& textureIndices)
+{
+	const STREAMED_TEXTURE& first = m_textures[textureIndices[0]];
+	int layerCount = static_cast<int>(textureIndices.size());
+
+	TEXTURE_ARRAY textureArray;
+	textureArray.textureID = 0;
+	textureArray.internalFormat = first.internalFormat;
+	textureArray.format = first.format;
+	textureArray.channels = first.channels;
+	textureArray.width = first.width;
+	textureArray.height = first.height;
+	textureArray.levelCount = first.levelCount;
+	textureArray.residentLevel = first.tailLevel;
+	textureArray.tailLevel = first.tailLevel;
+	textureArray.minLevel = 0;
+	textureArray.wantedLevel = first.levelCount;
+	textureArray.bLoading = false;
+	for (int level = 0; level < MAX_LEVELS; level++)
+	{
+		textureArray.levelBytes[level] = 0;
+		textureArray.levelLastUsed[level] = 0;
+	}
+	for (int level = 0; level < textureArray.levelCount; level++)
+	{
+		if (first.source.source == SOURCE_PACK)
+		{
+			textureArray.levelBytes[level] = first.source.pPacked->levelBytes[level] * static_cast<size_t>(layerCount);
+		}
+		else
+		{
+			// RGB textures are stored with 4 bytes per texel by
+			// most drivers, so the levels are counted that way
+			textureArray.levelBytes[level] = static_cast<size_t>(GetLevelSize(first.width, level)) *
+				GetLevelSize(first.height, level) * 4 * layerCount;
+		}
+	}
+
+	size_t tailBytes = GetLevelBytes(textureArray, textureArray.tailLevel, textureArray.levelCount);
+	if (ResourceTracker::FitsBudget(ResourceTracker::RESOURCE_TEXTURE, tailBytes) == false)
+	{
+		LOG_ERROR("Texture array does not fit into the GPU memory budget:" << first.source.filename);
+		return;
+	}
+
+	int arrayIndex = static_cast<int>(m_arrays.size());
+	for (int layer = 0; layer < layerCount; layer++)
+	{
+		STREAMED_TEXTURE& texture = m_textures[textureIndices[layer]];
+		texture.arrayIndex = arrayIndex;
+		texture.layer = layer;
+		textureArray.layers.push_back(texture.source);
+	}
+
+	glGenTextures(1, &textureArray.textureID);
+	GLState::ActiveTexture(GL_TEXTURE0 + arrayIndex);
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, textureArray.textureID);
+
+	// set the texture wrapping and filtering parameters
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// only the levels from the base level on need to exist
+	// for the array to be complete
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, textureArray.residentLevel);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, textureArray.levelCount - 1);
+
+	std::vector<unsigned char> levelData;
+	for (int level = textureArray.tailLevel; level < textureArray.levelCount; level++)
+	{
+		levelData.clear();
+		for (int layer = 0; layer < layerCount; layer++)
+		{
+			const std::vector<unsigned char>& layerData =
+				m_textures[textureIndices[layer]].tailLevels[level - textureArray.tailLevel];
+			levelData.insert(levelData.end(), layerData.begin(), layerData.end());
+		}
+		UploadLevel(textureArray, level, levelData);
+	}
+	GLState::ActiveTexture(GL_TEXTURE0);
+
+	m_residentBytes += tailBytes;
+	m_arrays.push_back(textureArray);
+	TrackArray(textureArray);
+}
+
+/***********************************************************
+ *  UploadLevel()
+ *
+ *  This method is used for uploading the data of one level
+ *  with all of its layers into the bound array.
+ ***********************************************************/
+void TextureStreamer::UploadLevel(const TEXTURE_ARRAY& textureArray, int level, const std::vector<unsigned char>& data)
+{
+	GLsizei width = GetLevelSize(textureArray.width, level);
+	GLsizei height = GetLevelSize(textureArray.height, level);
+	GLsizei layerCount = static_cast<GLsizei>(textureArray.layers.size());
+
+	if ((textureArray.internalFormat == GL_RGB8) || (textureArray.internalFormat == GL_RGBA8))
+	{
+		// the rows of the small RGB levels are not 4 byte aligned
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, textureArray.internalFormat, width, height, layerCount, 0,
+			textureArray.format, GL_UNSIGNED_BYTE, data.data());
+	}
+	else
+	{
+		glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, textureArray.internalFormat, width, height, layerCount, 0,
+			static_cast<GLsizei>(data.size()), data.data());
+	}
+}
+
+/***********************************************************
+ *  DestroyTextures()
+ *
+ *  This method is used for freeing all of the textures.
+ *  Loads that have not started are dropped, and the ones
+ *  running on the worker are waited for.
+ ***********************************************************/
+void TextureStreamer::DestroyTextures()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_pendingLoads -= static_cast<int>(m_jobs.size());
+		m_jobs.clear();
+		while (static_cast<int>(m_results.size()) < m_pendingLoads)
+		{
+			m_resultReady.wait(lock);
+		}
+		m_results.clear();
+	}
+	m_pendingLoads = 0;
+	m_pendingBytes = 0;
+
+	for (size_t i = 0; i < m_arrays.size(); i++)
+	{
+		ResourceTracker::Release(ResourceTracker::RESOURCE_TEXTURE, m_arrays[i].textureID);
+		glDeleteTextures(1, &m_arrays[i].textureID);
+	}
+	m_arrays.clear();
+	m_textures.clear();
+	m_bArraysCreated = false;
+	m_residentBytes = 0;
+}
+
+/***********************************************************
+ *  GetTextureUnit()
+ *
+ *  This method is used for getting the texture unit of the
+ *  array a texture is stored in.
+ ***********************************************************/
+int TextureStreamer::GetTextureUnit(int index) const
+{
+	if ((index < 0) || (index >= static_cast<int>(m_textures.size())))
+	{
+		return(-1);
+	}
+
+	return(m_textures[index].arrayIndex);
+}
+
+/***********************************************************
+ *  GetTextureLayer()
+ *
+ *  This method is used for getting the layer of a texture
+ *  in its array.
+ ***********************************************************/
+int TextureStreamer::GetTextureLayer(int index) const
+{
+	if ((index < 0) || (index >= static_cast<int>(m_textures.size())))
+	{
+		return(0);
+	}
+
+	return(m_textures[index].layer);
+}
+
+/***********************************************************
+ *  GetArrayTexture()
+ *
+ *  This method is used for getting the name of the array a
+ *  texture is stored in, 0 when it has no array.
+ ***********************************************************/
+GLuint TextureStreamer::GetArrayTexture(int index) const
+{
+	int arrayIndex = GetTextureUnit(index);
+	if (arrayIndex < 0)
+	{
+		return(0);
+	}
+
+	return(m_arrays[arrayIndex].textureID);
+}
+
+/***********************************************************
+ *  GetTextureSize()
+ *
+ *  This method is used for getting the number of texels
+ *  across the largest level of a texture.
+ ***********************************************************/
+int TextureStreamer::GetTextureSize(int index) const
+{
+	if ((index < 0) || (index >= static_cast<int>(m_textures.size())))
+	{
+		return(0);
+	}
+
+	return(std::max(m_textures[index].width, m_textures[index].height));
+}
+
+/***********************************************************
+ *  ReadTexels()
+ *
+ *  This method is used for reading the largest level of a
+ *  texture for the CPU renderer.  Packed levels are copied
+ *  from the mapped file and decompressed, and image files
+ *  are decoded again, like the loads on the worker.  It
+ *  makes no OpenGL calls, so it also works for textures
+ *  that never got an array.
+ ***********************************************************/
+bool TextureStreamer::ReadTexels(int index, std::vector<unsigned char>& texels, int& width, int& height, int& channels) const
+{
+	if (IsTextureLoaded(index) == false)
+	{
+		return(false);
+	}
+
+	const STREAMED_TEXTURE& texture = m_textures[index];
+	width = texture.width;
+	height = texture.height;
+	channels = texture.channels;
+
+	if (texture.source.source == SOURCE_PACK)
+	{
+		const AssetPack::PACK_TEXTURE& packed = *texture.source.pPacked;
+		const unsigned char* pData = static_cast<const unsigned char*>(
+			texture.source.pPack->GetData(packed.levelOffsets[0], packed.levelBytes[0]));
+		if (NULL == pData)
+		{
+			return(false);
+		}
+
+		if (texture.internalFormat == GL_RGBA8)
+		{
+			size_t levelBytes = static_cast<size_t>(width) * height * 4;
+			if (packed.levelBytes[0] < levelBytes)
+			{
+				return(false);
+			}
+			texels.assign(pData, pData + levelBytes);
+			return(true);
+		}
+
+		return(DecodeS3TC(pData, packed.levelBytes[0], texture.internalFormat, width, height, texels));
+	}
+
+	int imageWidth = 0;
+	int imageHeight = 0;
+	int colorChannels = 0;
+	unsigned char* image = stbi_load(texture.source.filename.c_str(), &imageWidth, &imageHeight, &colorChannels, channels);
+	if (NULL == image)
+	{
+		return(false);
+	}
+
+	// the file may have changed since the texture was added
+	if ((imageWidth != width) || (imageHeight != height))
+	{
+		stbi_image_free(image);
+		return(false);
+	}
+
+	texels.assign(image, image + static_cast<size_t>(width) * height * channels);
+	stbi_image_free(image);
+
+	return(true);
+}
+
+/***********************************************************
+ *  RequestLevel()
+ *
+ *  This method is used for asking for the finest level an
+ *  object needs from a texture in this frame.  The level
+ *  and all of the smaller ones of its array are marked as
+ *  used.
+ ***********************************************************/
+void TextureStreamer::RequestLevel(int index, int level)
+{
+	int arrayIndex = GetTextureUnit(index);
+	if (arrayIndex < 0)
+	{
+		return;
+	}
+
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+	level = std::min(std::max(level, textureArray.minLevel), textureArray.levelCount - 1);
+	textureArray.wantedLevel = std::min(textureArray.wantedLevel, level);
+	for (int i = level; i < textureArray.levelCount; i++)
+	{
+		textureArray.levelLastUsed[i] = m_frame;
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for committing a finished load and
+ *  starting the loads for this frame's requests.  Only one
+ *  load is committed per frame, so no frame uploads the
+ *  levels of more than one array.
+ ***********************************************************/
+void TextureStreamer::Update()
+{
+	LOAD_RESULT result;
+	bool bFinished = false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_results.empty() == false)
+		{
+			result = std::move(m_results.front());
+			m_results.pop_front();
+			bFinished = true;
+		}
+	}
+	if (bFinished == true)
+	{
+		CommitLoad(result);
+	}
+
+	for (int i = 0; i < static_cast<int>(m_arrays.size()); i++)
+	{
+		TEXTURE_ARRAY& textureArray = m_arrays[i];
+		if ((textureArray.wantedLevel < textureArray.residentLevel) && (textureArray.bLoading == false))
+		{
+			StartLoad(i);
+		}
+		textureArray.wantedLevel = textureArray.levelCount;
+	}
+
+	// a lowered budget is applied even without new loads
+	MakeRoom(0);
+
+	// keep drawing while loads are running, so their levels
+	// are committed when the scene is rendered on demand
+	if (m_pendingLoads > 0)
+	{
+		FramePacer::RequestRedraw();
+	}
+
+	m_frame++;
+}
+
+/***********************************************************
+ *  StartLoad()
+ *
+ *  This method is used for queueing the load of the levels
+ *  an array asked for.  When they do not all fit into the
+ *  budget, the finest levels are left out.
+ ***********************************************************/
+void TextureStreamer::StartLoad(int arrayIndex)
+{
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+
+	int firstLevel = textureArray.wantedLevel;
+	while (firstLevel < textureArray.residentLevel)
+	{
+		size_t bytes = GetLevelBytes(textureArray, firstLevel, textureArray.residentLevel);
+		if ((MakeRoom(bytes) == true) &&
+			(ResourceTracker::FitsBudget(ResourceTracker::RESOURCE_TEXTURE, bytes) == true))
+		{
+			break;
+		}
+		firstLevel++;
+	}
+	if (firstLevel == textureArray.residentLevel)
+	{
+		return;
+	}
+
+	LOAD_JOB job;
+	PrepareLoad(arrayIndex, firstLevel, job);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(job);
+	}
+	m_jobReady.notify_one();
+}
+
+/***********************************************************
+ *  PrepareLoad()
+ *
+ *  This method is used for filling in the job that loads
+ *  the levels of an array from the passed in level up to
+ *  its resident levels, and counting it as running.
+ ***********************************************************/
+void TextureStreamer::PrepareLoad(int arrayIndex, int firstLevel, LOAD_JOB& job)
+{
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+
+	job.arrayIndex = arrayIndex;
+	job.firstLevel = firstLevel;
+	job.endLevel = textureArray.residentLevel;
+	job.layers = textureArray.layers;
+	job.channels = textureArray.channels;
+	job.width = textureArray.width;
+	job.height = textureArray.height;
+
+	textureArray.bLoading = true;
+	m_pendingBytes += GetLevelBytes(textureArray, firstLevel, textureArray.residentLevel);
+	m_pendingLoads++;
+}
+
+/***********************************************************
+ *  CommitLoad()
+ *
+ *  This method is used for uploading the levels of a
+ *  finished load and making them visible by lowering the
+ *  base level of the array.
+ ***********************************************************/
+void TextureStreamer::CommitLoad(LOAD_RESULT& result)
+{
+	TEXTURE_ARRAY& textureArray = m_arrays[result.arrayIndex];
+	int endLevel = result.firstLevel + static_cast<int>(result.levels.size());
+
+	textureArray.bLoading = false;
+	m_pendingBytes -= GetLevelBytes(textureArray, result.firstLevel, endLevel);
+	m_pendingLoads--;
+
+	if ((result.bSuccess == false) || (endLevel != textureArray.residentLevel))
+	{
+		// do not try the levels that failed again
+		LOG_ERROR("Could not stream the texture levels of:" << textureArray.layers[0].filename);
+		textureArray.minLevel = textureArray.residentLevel;
+		return;
+	}
+
+	GLState::ActiveTexture(GL_TEXTURE0 + result.arrayIndex);
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, textureArray.textureID);
+	for (int level = result.firstLevel; level < endLevel; level++)
+	{
+		UploadLevel(textureArray, level, result.levels[level - result.firstLevel]);
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, result.firstLevel);
+	GLState::ActiveTexture(GL_TEXTURE0);
+
+	textureArray.residentLevel = result.firstLevel;
+	m_residentBytes += GetLevelBytes(textureArray, result.firstLevel, endLevel);
+	TrackArray(textureArray);
+	FrameStats::AddCounter("texture levels streamed", endLevel - result.firstLevel);
+}
+
+/***********************************************************
+ *  MakeRoom()
+ *
+ *  This method is used for freeing the least recently used
+ *  levels until the passed in bytes fit into the budget.
+ *  Levels used in this frame, the resident tails and the
+ *  arrays that are loading are never freed, so it returns
+ *  false when the bytes cannot be made to fit.
+ ***********************************************************/
+bool TextureStreamer::MakeRoom(size_t bytes)
+{
+	if (m_budget == 0)
+	{
+		return(true);
+	}
+
+	while ((m_residentBytes + m_pendingBytes + bytes) > m_budget)
+	{
+		int oldest = -1;
+		unsigned int oldestFrame = m_frame;
+		for (int i = 0; i < static_cast<int>(m_arrays.size()); i++)
+		{
+			const TEXTURE_ARRAY& textureArray = m_arrays[i];
+			if ((textureArray.bLoading == false) &&
+				(textureArray.residentLevel < textureArray.tailLevel) &&
+				(textureArray.levelLastUsed[textureArray.residentLevel] < oldestFrame))
+			{
+				oldest = i;
+				oldestFrame = textureArray.levelLastUsed[textureArray.residentLevel];
+			}
+		}
+
+		if (oldest < 0)
+		{
+			return(false);
+		}
+		EvictLevel(oldest);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  EvictLevel()
+ *
+ *  This method is used for freeing the largest resident
+ *  level of an array.  The base level is raised first, so
+ *  the array stays complete, and the level is then
+ *  redefined with no texels to free its memory.
+ ***********************************************************/
+void TextureStreamer::EvictLevel(int arrayIndex)
+{
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+	int level = textureArray.residentLevel;
+
+	GLState::ActiveTexture(GL_TEXTURE0 + arrayIndex);
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, textureArray.textureID);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, level + 1);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, level, textureArray.internalFormat, 0, 0, 0, 0,
+		textureArray.format, GL_UNSIGNED_BYTE, NULL);
+	GLState::ActiveTexture(GL_TEXTURE0);
+
+	textureArray.residentLevel = level + 1;
+	m_residentBytes -= textureArray.levelBytes[level];
+	TrackArray(textureArray);
+	FrameStats::AddCounter("texture levels evicted", 1);
+}
+
+/***********************************************************
+ *  LoadAllLevels()
+ *
+ *  This method is used for making every level of every
+ *  array resident before the textures are read back.  The
+ *  levels are loaded on the calling thread, and the budget
+ *  is ignored.
+ ***********************************************************/
+void TextureStreamer::LoadAllLevels()
+{
+	// commit the loads that are already running first
+	while (m_pendingLoads > 0)
+	{
+		LOAD_RESULT result;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (m_results.empty() == true)
+			{
+				m_resultReady.wait(lock);
+			}
+			result = std::move(m_results.front());
+			m_results.pop_front();
+		}
+		CommitLoad(result);
+	}
+
+	for (int i = 0; i < static_cast<int>(m_arrays.size()); i++)
+	{
+		if (m_arrays[i].residentLevel > m_arrays[i].minLevel)
+		{
+			LOAD_JOB job;
+			LOAD_RESULT result;
+			PrepareLoad(i, m_arrays[i].minLevel, job);
+			LoadLevels(job, result);
+			CommitLoad(result);
+		}
+	}
+}
+
+/***********************************************************
+ *  GetLevelBytes()
+ *
+ *  This method is used for adding up the memory of a range
+ *  of levels of an array.
+ ***********************************************************/
+size_t TextureStreamer::GetLevelBytes(const TEXTURE_ARRAY& textureArray, int firstLevel, int endLevel)
+{
+	size_t bytes = 0;
+	for (int level = firstLevel; level < endLevel; level++)
+	{
+		bytes += textureArray.levelBytes[level];
+	}
+
+	return(bytes);
+}
+
+/***********************************************************
+ *  TrackArray()
+ *
+ *  This method is used for recording the memory of the
+ *  resident levels of an array with the resource tracker.
+ ***********************************************************/
+void TextureStreamer::TrackArray(const TEXTURE_ARRAY& textureArray)
+{
+	ResourceTracker::Track(ResourceTracker::RESOURCE_TEXTURE, textureArray.textureID,
+		GetLevelBytes(textureArray, textureArray.residentLevel, textureArray.levelCount),
+		ResourceTracker::CATEGORY_SCENE_TEXTURE, "scene texture array");
+}
+
+/***********************************************************
+ *  UpdateFrameStats()
+ *
+ *  This method is used for publishing the resident memory
+ *  and the running loads to the frame stats.
+ ***********************************************************/
+void TextureStreamer::UpdateFrameStats()
+{
+	FrameStats::SetBytes("texture streaming resident", m_residentBytes);
+	FrameStats::SetBytes("texture streaming pending", m_pendingBytes);
+	FrameStats::SetValue("texture streaming loads", m_pendingLoads);
+}
+
+/***********************************************************
+ *  WorkerMain()
+ *
+ *  This method is the loop of the worker thread.  It loads
+ *  the queued jobs one after the other until the streamer
+ *  is destroyed.
+ ***********************************************************/
+void TextureStreamer::WorkerMain()
+{
+	while (true)
+	{
+		LOAD_JOB job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while ((m_bStopWorker == false) && (m_jobs.empty() == true))
+			{
+				m_jobReady.wait(lock);
+			}
+			if (m_bStopWorker == true)
+			{
+				return;
+			}
+			job = m_jobs.front();
+			m_jobs.pop_front();
+		}
+
+		LOAD_RESULT result;
+		LoadLevels(job, result);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_results.push_back(std::move(result));
+		}
+		m_resultReady.notify_all();
+	}
+}
+
+/***********************************************************
+ *  LoadLevels()
+ *
+ *  This method is used for reading the levels of a job,
+ *  one layer after the other.  Pack levels are copied out
+ *  of the mapped file, and image files are decoded again
+ *  and scaled down to the requested levels.  It makes no
+ *  OpenGL calls, so it can run on the worker thread.
+ ***********************************************************/
+void TextureStreamer::LoadLevels(const LOAD_JOB& job, LOAD_RESULT& result)
+{
+	result.arrayIndex = job.arrayIndex;
+	result.firstLevel = job.firstLevel;
+	result.bSuccess = false;
+	result.levels.assign(job.endLevel - job.firstLevel, std::vector<unsigned char>());
+
+	std::vector<std::vector<unsigned char> > layerLevels;
+	for (size_t layer = 0; layer < job.layers.size(); layer++)
+	{
+		const LAYER_SOURCE& source = job.layers[layer];
+		if (source.source == SOURCE_PACK)
+		{
+			for (int level = job.firstLevel; level < job.endLevel; level++)
+			{
+				const unsigned char* pData = static_cast<const unsigned char*>(
+					source.pPack->GetData(source.pPacked->levelOffsets[level], source.pPacked->levelBytes[level]));
+				if (NULL == pData)
+				{
+					return;
+				}
+				std::vector<unsigned char>& levelData = result.levels[level - job.firstLevel];
+				levelData.insert(levelData.end(), pData, pData + source.pPacked->levelBytes[level]);
+			}
+			continue;
+		}
+
+		int width = 0;
+		int height = 0;
+		int colorChannels = 0;
+		unsigned char* image = stbi_load(source.filename.c_str(), &width, &height, &colorChannels, job.channels);
+		if (NULL == image)
+		{
+			return;
+		}
+
+		// the file may have changed since the texture was added
+		if ((width != job.width) || (height != job.height))
+		{
+			stbi_image_free(image);
+			return;
+		}
+
+		BuildLevels(image, width, height, job.channels, job.firstLevel, job.endLevel, layerLevels);
+		stbi_image_free(image);
+		for (int level = job.firstLevel; level < job.endLevel; level++)
+		{
+			std::vector<unsigned char>& levelData = result.levels[level - job.firstLevel];
+			levelData.insert(levelData.end(), layerLevels[level - job.firstLevel].begin(), layerLevels[level - job.firstLevel].end());
+		}
+	}
+
+	result.bSuccess = true;
+}
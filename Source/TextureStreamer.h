@@ -0,0 +1,257 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.h
+// ============
+// stream the mip levels of the scene textures under a memory budget
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AssetPack.h"
+
+#include <GL/glew.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  TextureStreamer
+ *
+ *  This class owns the scene textures and keeps only the
+ *  mip levels the objects need resident.  Textures of the
+ *  same size and format are stored as the layers of one
+ *  GL_TEXTURE_2D_ARRAY, so each array takes a single
+ *  texture unit and the draws only pass their layer.
+ *
+ *  An array is created with its small levels, and its
+ *  larger levels are loaded on a worker thread when an
+ *  object using any of its layers is close enough to show
+ *  them.  Loaded levels are committed by lowering
+ *  GL_TEXTURE_BASE_LEVEL, so the array stays complete with
+ *  whatever levels are resident.  When the arrays go over
+ *  the budget, the largest level of the array that was
+ *  used least recently is freed again.
+ *
+ *  Textures are numbered in the order they are added, and
+ *  all of them are added before the arrays are created.
+ *  Image files can be reserved first and decoded on other
+ *  threads, each one by a single thread, as long as no
+ *  texture is added while they are decoded.
+ *  Each array stays bound to the texture unit it is
+ *  numbered with.  Levels are loaded from the image file,
+ *  which is decoded again on the worker, or copied from
+ *  the asset pack, which has to stay open while the
+ *  streamer exists.
+ ***********************************************************/
+class TextureStreamer
+{
+public:
+	// levels of this size and smaller are loaded with the
+	// texture and never evicted
+	static const int RESIDENT_LEVEL_SIZE = 128;
+	// largest number of mip levels of a texture
+	static const int MAX_LEVELS = 16;
+	// number of texture units for the arrays - the shadow
+	// maps use the units above these
+	static const int MAX_TEXTURE_ARRAYS = 14;
+
+	// constructor
+	TextureStreamer();
+	// destructor
+	~TextureStreamer();
+
+	// add a texture from an image file, returns its number or
+	// -1 when it could not be loaded
+	int AddFileTexture(const char* filename);
+	// take the number of a texture from an image file that is
+	// decoded later, on any thread
+	int ReserveFileTexture(const char* filename);
+	// decode a reserved texture, returns false when it could
+	// not be loaded
+	bool DecodeFileTexture(int index);
+	// whether a texture has its resident levels
+	bool IsTextureLoaded(int index) const;
+	// add a texture from the cooked mip chain in a pack
+	int AddPackedTexture(const AssetPack* pPack, const AssetPack::PACK_TEXTURE& texture);
+	// put the added textures into arrays, upload their
+	// resident levels and bind the arrays to their units
+	void CreateArrays();
+	// free all of the textures
+	void DestroyTextures();
+
+	// texture unit of the array a texture is stored in, -1
+	// when the texture has no array
+	int GetTextureUnit(int index) const;
+	// layer of a texture in its array
+	int GetTextureLayer(int index) const;
+	// name of the array a texture is stored in
+	GLuint GetArrayTexture(int index) const;
+	// number of texels across the largest level of a texture
+	int GetTextureSize(int index) const;
+	// read the largest level of a texture into 8 bit texels
+	// from its source, without OpenGL
+	bool ReadTexels(int index, std::vector<unsigned char>& texels, int& width, int& height, int& channels) const;
+	int GetArrayCount() const { return(static_cast<int>(m_arrays.size())); }
+
+	// ask for the finest level an object needs in this frame
+	void RequestLevel(int index, int level);
+	// commit a finished load, evict the least recently used
+	// levels and start the loads for this frame's requests
+	void Update();
+	// load every level of every array and wait for it,
+	// ignoring the budget
+	void LoadAllLevels();
+
+	// set the budget of all texture levels in bytes, 0 for no
+	// budget
+	void SetBudget(size_t bytes) { m_budget = bytes; }
+	size_t GetResidentBytes() const { return(m_residentBytes); }
+	// whether texture levels are still being loaded
+	bool IsLoading() const { return(m_pendingLoads > 0); }
+
+	// publish the resident memory and pending loads to the
+	// frame stats
+	void UpdateFrameStats();
+
+private:
+	// where the levels of a texture are loaded from
+	enum SOURCE_TYPE
+	{
+		SOURCE_FILE,
+		SOURCE_PACK
+	};
+
+	// where one layer of an array is loaded from
+	struct LAYER_SOURCE
+	{
+		SOURCE_TYPE source;
+		// image file, or the tag of a packed texture
+		std::string filename;
+		const AssetPack* pPack;
+		const AssetPack::PACK_TEXTURE* pPacked;
+	};
+
+	// a texture that was added, stored as a layer of an array
+	struct STREAMED_TEXTURE
+	{
+		LAYER_SOURCE source;
+		GLenum internalFormat;
+		// pixel format of the uncompressed level data
+		GLenum format;
+		int channels;
+		int width;
+		int height;
+		int levelCount;
+		// first of the levels that always stay resident
+		int tailLevel;
+		// data of the resident levels until the arrays are
+		// created
+		std::vector<std::vector<unsigned char> > tailLevels;
+		// array and layer the texture is stored in, -1 when
+		// it did not get an array
+		int arrayIndex;
+		int layer;
+	};
+
+	struct TEXTURE_ARRAY
+	{
+		GLuint textureID;
+		GLenum internalFormat;
+		GLenum format;
+		int channels;
+		int width;
+		int height;
+		int levelCount;
+		std::vector<LAYER_SOURCE> layers;
+		// finest level that is resident
+		int residentLevel;
+		// first of the levels that always stay resident
+		int tailLevel;
+		// finest level that can be loaded, raised when a load
+		// fails
+		int minLevel;
+		// finest level requested in the current frame
+		int wantedLevel;
+		// set while a load is running, the array is not
+		// evicted until it is committed
+		bool bLoading;
+		// memory of each level with all of its layers
+		size_t levelBytes[MAX_LEVELS];
+		unsigned int levelLastUsed[MAX_LEVELS];
+	};
+
+	// levels to load on the worker - the source values are
+	// copied so the worker never reads the array list
+	struct LOAD_JOB
+	{
+		int arrayIndex;
+		int firstLevel;
+		int endLevel;
+		std::vector<LAYER_SOURCE> layers;
+		int channels;
+		int width;
+		int height;
+	};
+
+	// the loaded levels, with the layers of each level one
+	// after the other
+	struct LOAD_RESULT
+	{
+		int arrayIndex;
+		int firstLevel;
+		bool bSuccess;
+		std::vector<std::vector<unsigned char> > levels;
+	};
+
+	// check a new texture and keep it until the arrays are
+	// created
+	int AddTexture(STREAMED_TEXTURE& texture);
+	// create an array from the textures of the same size and
+	// format
+	void CreateArray(const std::vector<int>& textureIndices);
+	// upload the data of one level with all of its layers
+	void UploadLevel(const TEXTURE_ARRAY& textureArray, int level, const std::vector<unsigned char>& data);
+	// start loading the levels an array asked for
+	void StartLoad(int arrayIndex);
+	// fill in the job for loading levels of an array
+	void PrepareLoad(int arrayIndex, int firstLevel, LOAD_JOB& job);
+	// upload the levels of a finished load
+	void CommitLoad(LOAD_RESULT& result);
+	// free levels that were not used in this frame until the
+	// passed in bytes fit into the budget
+	bool MakeRoom(size_t bytes);
+	// free the largest resident level of an array
+	void EvictLevel(int arrayIndex);
+	// record the current size of an array with the tracker
+	void TrackArray(const TEXTURE_ARRAY& textureArray);
+	// memory of a range of levels of an array
+	static size_t GetLevelBytes(const TEXTURE_ARRAY& textureArray, int firstLevel, int endLevel);
+
+	// loop of the worker thread
+	void WorkerMain();
+	// read the levels of a job from its sources
+	static void LoadLevels(const LOAD_JOB& job, LOAD_RESULT& result);
+
+	std::vector<STREAMED_TEXTURE> m_textures;
+	std::vector<TEXTURE_ARRAY> m_arrays;
+	// set once the arrays were created
+	bool m_bArraysCreated;
+	size_t m_budget;
+	size_t m_residentBytes;
+	// bytes of the loads that are still running
+	size_t m_pendingBytes;
+	int m_pendingLoads;
+	unsigned int m_frame;
+
+	// jobs and results shared with the worker thread
+	std::thread m_worker;
+	std::mutex m_mutex;
+	std::condition_variable m_jobReady;
+	std::condition_variable m_resultReady;
+	std::deque<LOAD_JOB> m_jobs;
+	std::deque<LOAD_RESULT> m_results;
+	bool m_bStopWorker;
+};
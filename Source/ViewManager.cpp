@@ -8,11 +8,19 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "ViewManager.h"
+#include "CameraRecorder.h"
+#include "FramePacer.h"
+#include "GLState.h"
+#include "Logger.h"
+#include "ResourceTracker.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>    
+
+#include <algorithm>
+#include <cmath>
 using namespace std;
 
 // declaration of the global variables and defines
@@ -21,12 +29,26 @@ namespace
 	// Variables for window width and height
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
+	// names of the per-view values in the scene shader
+	const char* g_ViewNames[SCENE_VIEW::MAX_VIEWS] = {
+		"views[0]", "views[1]", "views[2]", "views[3]" };
+	const char* g_ProjectionNames[SCENE_VIEW::MAX_VIEWS] = {
+		"projections[0]", "projections[1]", "projections[2]", "projections[3]" };
+	const char* g_ViewPositionNames[SCENE_VIEW::MAX_VIEWS] = {
+		"viewPositions[0]", "viewPositions[1]", "viewPositions[2]", "viewPositions[3]" };
+
+	// half the height of the orthographic views
+	const float ORTHO_SIZE = 20.0f;
+	// distance of the fixed orthographic views from the
+	// center of the scene
+	const float ORTHO_VIEW_DISTANCE = 40.0f;
 
 	// camera object used for viewing and interacting with
 	// the 3D scene
 	Camera* g_pCamera = nullptr;
+	// records the camera path, or drives the camera from a
+	// recording instead of the input
+	CameraRecorder* g_pCameraRecorder = nullptr;
 
 	// these variables are used for mouse movement processing
 	float gLastX = WINDOW_WIDTH / 2.0f;
@@ -36,6 +58,9 @@ namespace
 	// time between current frame and last frame
 	float gDeltaTime = 0.0f;
 	float gLastFrame = 0.0f;
+	// longest time step applied to the camera, so the first
+	// frame after waiting for events does not jump
+	const float MAX_DELTA_TIME = 0.1f;
 
 	// if orthographic projection is on, this value will be
 	// true
@@ -43,16 +68,28 @@ namespace
 
 	//Camera speed
 	float cameraSpeed = 2.5f;
+
+	// set when the mouse was clicked, until the pick ray
+	// has been taken
+	bool gPickRequested = false;
 }
 
 // Scroll callback function
 void ScrollCallback(GLFWwindow* window, double xOffset, double yOffset)
 {
+	// the camera follows the recording during a replay
+	if ((NULL != g_pCameraRecorder) && (g_pCameraRecorder->IsReplaying() == true))
+	{
+		return;
+	}
+
 	// Adjust camera speed based on scroll direction
 	if (yOffset > 0) // Scroll up to increase speed
 		cameraSpeed += 0.5f;
 	else if (yOffset < 0) // Scroll down to decrease speed
 		cameraSpeed = std::max(cameraSpeed - 0.5f, 0.5f); // Prevent speed from dropping too low
+
+	FramePacer::RequestRedraw();
 }
 
 /***********************************************************
@@ -66,6 +103,17 @@ ViewManager::ViewManager(
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
 	m_pWindow = NULL;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
+	m_viewLayout = VIEW_LAYOUT_SINGLE;
+	m_viewCount = 1;
+	for (int i = 0; i < SCENE_VIEW::MAX_VIEWS; i++)
+	{
+		m_views[i].view = glm::mat4(1.0f);
+		m_views[i].projection = glm::mat4(1.0f);
+		m_views[i].position = glm::vec3(0.0f);
+		m_views[i].viewport = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	}
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(0.5f, 5.5f, 10.0f);
@@ -73,6 +121,7 @@ ViewManager::ViewManager(
 	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
 	g_pCamera->Zoom = 80;
 	g_pCamera->MovementSpeed = 10;
+	g_pCameraRecorder = new CameraRecorder();
 }
 
 /***********************************************************
@@ -90,6 +139,13 @@ ViewManager::~ViewManager()
 		delete g_pCamera;
 		g_pCamera = NULL;
 	}
+	if (NULL != g_pCameraRecorder)
+	{
+		// write the recorded camera path, if there is one
+		g_pCameraRecorder->StopRecording();
+		delete g_pCameraRecorder;
+		g_pCameraRecorder = NULL;
+	}
 }
 
 /***********************************************************
@@ -111,7 +167,7 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 		NULL, NULL);
 	if (window == NULL)
 	{
-		std::cout << "Failed to create GLFW window" << std::endl;
+		LOG_ERROR("Failed to create GLFW window");
 		glfwTerminate();
 		return NULL;
 	}
@@ -120,12 +176,17 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	// this callback is used to receive mouse moving events
 	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
 
+	// these callbacks wake up the render-on-demand loop
+	glfwSetKeyCallback(window, &ViewManager::Key_Callback);
+	glfwSetMouseButtonCallback(window, &ViewManager::Mouse_Button_Callback);
+	glfwSetWindowRefreshCallback(window, &ViewManager::Window_Refresh_Callback);
+
 	// tell GLFW to capture all mouse events
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
 	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLState::Enable(GL_BLEND);
+	GLState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	m_pWindow = window;
 
@@ -150,6 +211,12 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
 		return; // Ignore mouse movement in orthographic mode
 	}
 
+	// the camera follows the recording during a replay
+	if (g_pCameraRecorder->IsReplaying() == true)
+	{
+		return;
+	}
+
 	// Handle mouse movement for perspective mode
 	if (gFirstMouse)
 	{
@@ -167,6 +234,55 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
 
 	// Update the camera based on mouse movement
 	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
+	FramePacer::RequestRedraw();
+}
+
+/***********************************************************
+ *  Key_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  a key is pressed, repeated or released.  The keys are
+ *  handled in ProcessKeyboardEvents(), so the scene only
+ *  needs to be drawn again.  The M key prints the memory
+ *  report once per press.
+ ***********************************************************/
+void ViewManager::Key_Callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if ((key == GLFW_KEY_M) && (action == GLFW_PRESS))
+	{
+		ResourceTracker::PrintReport();
+	}
+
+	FramePacer::RequestRedraw();
+}
+
+/***********************************************************
+ *  Mouse_Button_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  a mouse button is pressed or released.  A left click
+ *  asks for the object under the cursor to be picked in
+ *  the next frame.
+ ***********************************************************/
+void ViewManager::Mouse_Button_Callback(GLFWwindow* window, int button, int action, int mods)
+{
+	if ((button == GLFW_MOUSE_BUTTON_LEFT) && (action == GLFW_PRESS))
+	{
+		gPickRequested = true;
+		FramePacer::RequestRedraw();
+	}
+}
+
+/***********************************************************
+ *  Window_Refresh_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the contents of the window need to be drawn again, for
+ *  example after it was resized or uncovered.
+ ***********************************************************/
+void ViewManager::Window_Refresh_Callback(GLFWwindow* window)
+{
+	FramePacer::RequestRedraw();
 }
 
 
@@ -192,6 +308,22 @@ void ViewManager::ProcessKeyboardEvents()
 		return;
 	}
 
+	// the camera follows the recording during a replay
+	if (g_pCameraRecorder->IsReplaying() == true)
+	{
+		return;
+	}
+
+	// keep drawing while a camera movement key is held down
+	const int movementKeys[] = { GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_Q, GLFW_KEY_E };
+	for (int i = 0; i < 6; i++)
+	{
+		if (glfwGetKey(m_pWindow, movementKeys[i]) == GLFW_PRESS)
+		{
+			FramePacer::RequestRedraw();
+		}
+	}
+
 	// process camera zooming in and out
 	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
 	{
@@ -210,7 +342,7 @@ void ViewManager::ProcessKeyboardEvents()
 	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
 	{
 		g_pCamera->ProcessKeyboard(RIGHT, (cameraSpeed * gDeltaTime));
-		cout << cameraSpeed;
+		LOG_DEBUG("camera speed: " << cameraSpeed);
 	}
 	//DOWN emumator is already defined
 	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
@@ -233,11 +365,223 @@ void ViewManager::ProcessKeyboardEvents()
 		bOrthographicProjection = true;  // Switch to orthographic view
 	}
 
+	// Handle view layout switching
+	if (glfwGetKey(m_pWindow, GLFW_KEY_1) == GLFW_PRESS)
+	{
+		SetViewLayout(VIEW_LAYOUT_SINGLE);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_2) == GLFW_PRESS)
+	{
+		SetViewLayout(VIEW_LAYOUT_SIDE_BY_SIDE);
+	}
+	if (glfwGetKey(m_pWindow, GLFW_KEY_4) == GLFW_PRESS)
+	{
+		SetViewLayout(VIEW_LAYOUT_QUAD);
+	}
+
+
+
+}
+
 
 
+/***********************************************************
+ *  SetViewLayout()
+ *
+ *  This method is used for choosing how many views are
+ *  drawn and how they are arranged in the window.
+ ***********************************************************/
+void ViewManager::SetViewLayout(VIEW_LAYOUT layout)
+{
+	if (layout != m_viewLayout)
+	{
+		m_viewLayout = layout;
+		FramePacer::RequestRedraw();
+	}
 }
 
+/***********************************************************
+ *  ArrangeViews()
+ *
+ *  This method is used for placing the views of the current
+ *  layout in the window.  The camera view always comes
+ *  first, so the shadows and culling follow it.
+ ***********************************************************/
+void ViewManager::ArrangeViews()
+{
+	switch (m_viewLayout)
+	{
+	case VIEW_LAYOUT_SIDE_BY_SIDE:
+		m_viewCount = 2;
+		m_views[0].viewport = glm::vec4(0.0f, 0.0f, 0.5f, 1.0f);
+		m_views[1].viewport = glm::vec4(0.5f, 0.0f, 0.5f, 1.0f);
+		break;
+	case VIEW_LAYOUT_QUAD:
+		m_viewCount = 4;
+		m_views[0].viewport = glm::vec4(0.0f, 0.5f, 0.5f, 0.5f);
+		m_views[1].viewport = glm::vec4(0.5f, 0.5f, 0.5f, 0.5f);
+		m_views[2].viewport = glm::vec4(0.0f, 0.0f, 0.5f, 0.5f);
+		m_views[3].viewport = glm::vec4(0.5f, 0.0f, 0.5f, 0.5f);
+		break;
+	default:
+		m_viewCount = 1;
+		m_views[0].viewport = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		break;
+	}
+}
 
+/***********************************************************
+ *  SetOrthographicView()
+ *
+ *  This method is used for calculating a fixed orthographic
+ *  view that looks at the center of the scene from the
+ *  passed in direction.
+ ***********************************************************/
+void ViewManager::SetOrthographicView(int index, glm::vec3 direction, glm::vec3 up)
+{
+	SCENE_VIEW& sceneView = m_views[index];
+	float aspectRatio = (WINDOW_WIDTH * sceneView.viewport.z) / (WINDOW_HEIGHT * sceneView.viewport.w);
+
+	sceneView.position = direction * ORTHO_VIEW_DISTANCE;
+	sceneView.view = glm::lookAt(sceneView.position, glm::vec3(0.0f), up);
+	sceneView.projection = glm::ortho(
+		-ORTHO_SIZE * aspectRatio, ORTHO_SIZE * aspectRatio,
+		-ORTHO_SIZE, ORTHO_SIZE,
+		0.1f, ORTHO_VIEW_DISTANCE * 2.0f);
+}
+
+/***********************************************************
+ *  GetPickRay()
+ *
+ *  This method is used for getting the world space ray from
+ *  the camera through the cursor, once for every click.
+ *  While the cursor is captured for looking around, the ray
+ *  goes through the center of the camera view.
+ ***********************************************************/
+bool ViewManager::GetPickRay(glm::vec3& origin, glm::vec3& direction)
+{
+	if (gPickRequested == false)
+	{
+		return(false);
+	}
+	gPickRequested = false;
+
+	// position of the cursor inside the camera view, from -1
+	// to 1 on both axes
+	glm::vec2 position(0.0f, 0.0f);
+	if (glfwGetInputMode(m_pWindow, GLFW_CURSOR) != GLFW_CURSOR_DISABLED)
+	{
+		double xCursor = 0.0;
+		double yCursor = 0.0;
+		int width = 1;
+		int height = 1;
+		glfwGetCursorPos(m_pWindow, &xCursor, &yCursor);
+		glfwGetWindowSize(m_pWindow, &width, &height);
+
+		const glm::vec4& viewport = m_views[0].viewport;
+		float x = static_cast<float>(xCursor) / std::max(width, 1);
+		float y = 1.0f - static_cast<float>(yCursor) / std::max(height, 1);
+		position.x = ((x - viewport.x) / viewport.z) * 2.0f - 1.0f;
+		position.y = ((y - viewport.y) / viewport.w) * 2.0f - 1.0f;
+		if ((std::fabs(position.x) > 1.0f) || (std::fabs(position.y) > 1.0f))
+		{
+			return(false);
+		}
+	}
+
+	// unproject the cursor on the near and far planes, which
+	// works for both the perspective and orthographic cameras
+	glm::mat4 inverseViewProjection = glm::inverse(m_projectionMatrix * m_viewMatrix);
+	glm::vec4 nearPoint = inverseViewProjection * glm::vec4(position, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverseViewProjection * glm::vec4(position, 1.0f, 1.0f);
+	origin = glm::vec3(nearPoint) / nearPoint.w;
+	direction = glm::normalize((glm::vec3(farPoint) / farPoint.w) - origin);
+
+	return(true);
+}
+
+/***********************************************************
+ *  StartCameraRecording()
+ *
+ *  This method is used for capturing the camera path at the
+ *  passed in number of ticks per second.  The recording is
+ *  written to the file when the view manager is destroyed.
+ ***********************************************************/
+void ViewManager::StartCameraRecording(const char* filename, int tickRate)
+{
+	g_pCameraRecorder->StartRecording(filename, tickRate);
+}
+
+/***********************************************************
+ *  StartCameraReplay()
+ *
+ *  This method is used for driving the camera from a
+ *  recording, one tick per frame.  The window is closed
+ *  after the last tick.
+ ***********************************************************/
+bool ViewManager::StartCameraReplay(const char* filename)
+{
+	return(g_pCameraRecorder->StartReplay(filename));
+}
+
+/***********************************************************
+ *  SetCameraPose()
+ *
+ *  This method is used for placing the camera for a still,
+ *  with the perspective projection and the camera filling
+ *  the window.  The camera stays upright unless it looks
+ *  straight up or down.
+ ***********************************************************/
+void ViewManager::SetCameraPose(glm::vec3 position, glm::vec3 target, float fieldOfView)
+{
+	glm::vec3 front = glm::normalize(target - position);
+	glm::vec3 up(0.0f, 1.0f, 0.0f);
+	if (std::fabs(glm::dot(front, up)) > 0.999f)
+	{
+		up = glm::vec3(0.0f, 0.0f, -1.0f);
+	}
+
+	g_pCamera->Position = position;
+	g_pCamera->Front = front;
+	g_pCamera->Up = up;
+	if (fieldOfView > 0.0f)
+	{
+		g_pCamera->Zoom = fieldOfView;
+	}
+	bOrthographicProjection = false;
+	SetViewLayout(VIEW_LAYOUT_SINGLE);
+}
+
+/***********************************************************
+ *  ReplayCamera()
+ *
+ *  This method is used for moving the camera to the next
+ *  tick of the replayed recording, and for closing the
+ *  window with the frame time summary once it has ended.
+ ***********************************************************/
+void ViewManager::ReplayCamera()
+{
+	CameraRecorder::CAMERA_SAMPLE sample;
+	if (g_pCameraRecorder->NextSample(sample) == false)
+	{
+		if (glfwWindowShouldClose(m_pWindow) == 0)
+		{
+			g_pCameraRecorder->PrintReplaySummary();
+			glfwSetWindowShouldClose(m_pWindow, true);
+		}
+		return;
+	}
+
+	g_pCamera->Position = glm::vec3(sample.position[0], sample.position[1], sample.position[2]);
+	g_pCamera->Front = glm::vec3(sample.front[0], sample.front[1], sample.front[2]);
+	g_pCamera->Up = glm::vec3(sample.up[0], sample.up[1], sample.up[2]);
+	g_pCamera->Zoom = sample.zoom;
+	bOrthographicProjection = (sample.bOrthographic != 0);
+	if (sample.viewLayout <= VIEW_LAYOUT_QUAD)
+	{
+		SetViewLayout(static_cast<VIEW_LAYOUT>(sample.viewLayout));
+	}
+}
 
 /***********************************************************
  *  PrepareSceneView()
@@ -248,14 +592,68 @@ void ViewManager::ProcessKeyboardEvents()
  ***********************************************************/
 void ViewManager::PrepareSceneView()
 {
-	glm::mat4 view;
-	glm::mat4 projection;
-
 	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
+	float elapsedTime = currentFrame - gLastFrame;
+	gDeltaTime = std::min(elapsedTime, MAX_DELTA_TIME);
 	gLastFrame = currentFrame;
 
 	ProcessKeyboardEvents();
+	if (g_pCameraRecorder->IsReplaying() == true)
+	{
+		// every frame of a replay advances the camera by one
+		// tick of simulated time
+		gDeltaTime = g_pCameraRecorder->GetTickTime();
+		ReplayCamera();
+	}
+	CalculateViews();
+
+	// capture the camera as it is drawn in this frame
+	if (g_pCameraRecorder->IsRecording() == true)
+	{
+		CameraRecorder::CAMERA_SAMPLE sample;
+		for (int i = 0; i < 3; i++)
+		{
+			sample.position[i] = g_pCamera->Position[i];
+			sample.front[i] = g_pCamera->Front[i];
+			sample.up[i] = g_pCamera->Up[i];
+		}
+		sample.zoom = g_pCamera->Zoom;
+		sample.bOrthographic = (bOrthographicProjection == true) ? 1 : 0;
+		sample.viewLayout = static_cast<uint8_t>(m_viewLayout);
+		sample.padding = 0;
+		g_pCameraRecorder->Record(elapsedTime, sample);
+	}
+
+	// Update shaders with the view and projection matrices
+	if (m_pShaderManager != nullptr)
+	{
+		for (int i = 0; i < m_viewCount; i++)
+		{
+			GLState::SetUniform(m_pShaderManager, g_ViewNames[i], m_views[i].view);
+			GLState::SetUniform(m_pShaderManager, g_ProjectionNames[i], m_views[i].projection);
+			GLState::SetUniform(m_pShaderManager, g_ViewPositionNames[i], m_views[i].position);
+		}
+	}
+}
+
+/***********************************************************
+ *  CalculateViews()
+ *
+ *  This method is used for calculating the views of the
+ *  current layout from the camera.  It needs neither the
+ *  window nor the shaders, so the views can be drawn on
+ *  the CPU without them.
+ ***********************************************************/
+void ViewManager::CalculateViews()
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+
+	ArrangeViews();
+
+	// the camera view keeps the aspect ratio of its part of
+	// the window
+	float aspectRatio = (WINDOW_WIDTH * m_views[0].viewport.z) / (WINDOW_HEIGHT * m_views[0].viewport.w);
 
 	// Get the current view matrix from the camera
 	view = g_pCamera->GetViewMatrix();
@@ -263,9 +661,7 @@ void ViewManager::PrepareSceneView()
 	if (bOrthographicProjection)
 	{
 		// Orthographic projection setting
-		float orthoSize = 20.0f;  // Set based on the size of the scene
-		float aspectRatio = static_cast<float>(WINDOW_WIDTH) / static_cast<float>(WINDOW_HEIGHT);
-		projection = glm::ortho(-orthoSize * aspectRatio, orthoSize * aspectRatio, -orthoSize, orthoSize, 0.1f, 100.0f);
+		projection = glm::ortho(-ORTHO_SIZE * aspectRatio, ORTHO_SIZE * aspectRatio, -ORTHO_SIZE, ORTHO_SIZE, 0.1f, 100.0f);
 
 		// Adjust camera to center the scene
 		g_pCamera->Position = glm::vec3(0.0f, 10.0f, 10.0f);
@@ -274,16 +670,41 @@ void ViewManager::PrepareSceneView()
 	else
 	{
 		// Perspective projection
-		projection = glm::perspective(glm::radians(g_pCamera->Zoom), static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT, 0.1f, 100.0f);
+		projection = glm::perspective(glm::radians(g_pCamera->Zoom), aspectRatio, 0.1f, 100.0f);
 	}
 
-	// Update shaders with view and projection matrices
-	if (m_pShaderManager != nullptr)
+	m_views[0].view = view;
+	m_views[0].projection = projection;
+	m_views[0].position = g_pCamera->Position;
+
+	// the other views look at the scene from fixed directions
+	if (m_viewLayout == VIEW_LAYOUT_SIDE_BY_SIDE)
 	{
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		SetOrthographicView(1, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
 	}
+	else if (m_viewLayout == VIEW_LAYOUT_QUAD)
+	{
+		SetOrthographicView(1, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+		SetOrthographicView(2, glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		SetOrthographicView(3, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+
+	// keep the matrices for the shadow and culling passes
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+}
+
+/***********************************************************
+ *  GetWindowSize()
+ *
+ *  This method is used for getting the size the display
+ *  window is created with, which the aspect ratio of the
+ *  camera view is calculated for.
+ ***********************************************************/
+void ViewManager::GetWindowSize(int& width, int& height)
+{
+	width = WINDOW_WIDTH;
+	height = WINDOW_HEIGHT;
 }
 
 
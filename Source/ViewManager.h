@@ -10,6 +10,7 @@
 #pragma once
 
 #include "ShaderManager.h"
+#include "SceneView.h"
 #include "camera.h"
 
 // GLFW library
@@ -18,6 +19,17 @@
 class ViewManager
 {
 public:
+	// arrangement of the views drawn into the window
+	enum VIEW_LAYOUT
+	{
+		// the camera fills the window
+		VIEW_LAYOUT_SINGLE,
+		// the camera next to a top-down orthographic view
+		VIEW_LAYOUT_SIDE_BY_SIDE,
+		// the camera with top, front and side orthographic views
+		VIEW_LAYOUT_QUAD
+	};
+
 	// constructor
 	ViewManager(
 		ShaderManager* pShaderManager);
@@ -26,15 +38,37 @@ public:
 
 	// mouse position callback for mouse interaction with the 3D scene
 	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
+	// key callback for redrawing the 3D scene when a key changes
+	static void Key_Callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+	// mouse button callback for picking objects in the 3D scene
+	static void Mouse_Button_Callback(GLFWwindow* window, int button, int action, int mods);
+	// refresh callback for redrawing the 3D scene when the
+	// window contents are damaged
+	static void Window_Refresh_Callback(GLFWwindow* window);
 
 private:
 	// pointer to shader manager object
 	ShaderManager* m_pShaderManager;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// view and projection calculated for the current frame
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
+	// views drawn in the current frame, the first one is the
+	// camera
+	VIEW_LAYOUT m_viewLayout;
+	SCENE_VIEW m_views[SCENE_VIEW::MAX_VIEWS];
+	int m_viewCount;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
+	// place the views of the current layout in the window
+	void ArrangeViews();
+	// calculate an orthographic view looking at the scene
+	// from the passed in direction
+	void SetOrthographicView(int index, glm::vec3 direction, glm::vec3 up);
+	// move the camera to the next tick of a replay
+	void ReplayCamera();
 
 public:
 	// create the initial OpenGL display window
@@ -42,4 +76,33 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+	// calculate the views from the camera without the window,
+	// the input or the shaders
+	void CalculateViews();
+	// get the size the display window is created with
+	static void GetWindowSize(int& width, int& height);
+
+	// get the view and projection calculated for the current frame
+	glm::mat4 GetViewMatrix() { return(m_viewMatrix); }
+	glm::mat4 GetProjectionMatrix() { return(m_projectionMatrix); }
+
+	// choose how the views are arranged in the window
+	void SetViewLayout(VIEW_LAYOUT layout);
+	// get the views drawn in the current frame
+	const SCENE_VIEW* GetViews() { return(m_views); }
+	int GetViewCount() { return(m_viewCount); }
+
+	// get the world space ray through the cursor when an
+	// object was clicked since the last call
+	bool GetPickRay(glm::vec3& origin, glm::vec3& direction);
+
+	// capture the camera path into a file at the passed in
+	// ticks per second
+	void StartCameraRecording(const char* filename, int tickRate);
+	// drive the camera from a recording, one tick per frame
+	bool StartCameraReplay(const char* filename);
+
+	// move the camera to a pose looking at the passed in
+	// point, a field of view of 0 keeps the current one
+	void SetCameraPose(glm::vec3 position, glm::vec3 target, float fieldOfView);
 };
\ No newline at end of file
@@ -0,0 +1,6 @@
+#version 330 core
+
+void main()
+{
+    // the bounds are only tested against the depth buffer
+}
@@ -0,0 +1,10 @@
+#version 330 core
+layout (location = 0) in vec3 inVertexPosition;
+
+uniform mat4 model;
+uniform mat4 viewProjection;
+
+void main()
+{
+   gl_Position = viewProjection * model * vec4(inVertexPosition, 1.0f);
+}
@@ -4,6 +4,13 @@ out vec4 fragmentColor;
 in vec3 fragmentPosition;
 in vec3 fragmentVertexNormal;
 in vec2 fragmentTextureCoordinate;
+in float fragmentViewDepth;
+flat in int fragmentViewIndex;
+// ambient and diffuse light baked into the vertices of static
+// objects, and how much of each shadowed light reaches them
+in vec3 fragmentBakedAmbient;
+in vec3 fragmentBakedDiffuse;
+in vec4 fragmentLightVisibility;
 
 struct Material {
     vec3 diffuseColor;
@@ -48,14 +55,28 @@ struct SpotLight {
     bool bActive;
 };
 
+// per-object values written into the dynamic upload buffer, or
+// once into the static object buffer for static objects
+layout (std140) uniform ObjectData
+{
+    mat4 model;
+    vec4 objectColor;
+    vec2 UVscale;
+    int materialIndex;
+    bool bUseTexture;
+    // layer of the texture in the array bound to objectTexture
+    int textureLayer;
+    // lit by the baked vertex lighting instead of the lights
+    bool bBakedLighting;
+};
+
 // Update to handle four point lights
 #define TOTAL_POINT_LIGHTS 4
 #define TOTAL_SPOT_LIGHTS 5
 
-uniform bool bUseTexture = false;
 uniform bool bUseLighting = false;
-uniform vec4 objectColor = vec4(1.0f);
-uniform vec3 viewPosition;
+#define MAX_VIEWS 4
+uniform vec3 viewPositions[MAX_VIEWS];
 
 // Two directional lights
 uniform DirectionalLight directionalLight1;
@@ -63,32 +84,82 @@ uniform DirectionalLight directionalLight2;
 
 uniform PointLight pointLights[TOTAL_POINT_LIGHTS];
 uniform SpotLight spotLights[TOTAL_SPOT_LIGHTS];
-uniform Material material;
-uniform sampler2D objectTexture;
-uniform vec2 UVscale = vec2(1.0f, 1.0f);
+// materials are set once and picked per object by index
+#define MAX_MATERIALS 8
+uniform Material materials[MAX_MATERIALS];
+Material material;
+// the scene textures are layers of texture arrays
+uniform sampler2DArray objectTexture;
+
+// Shadow maps - cascades for both directional lights and one map for the first spotlight
+#define NUM_CASCADES 3
+uniform bool bUseShadows = false;
+uniform sampler2DArrayShadow directionalShadowMaps;
+uniform sampler2DShadow spotShadowMap;
+uniform mat4 directionalLightSpace[2 * NUM_CASCADES];
+uniform mat4 spotLightSpace;
+uniform float cascadeSplits[NUM_CASCADES];
 
 // function prototypes
-vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 reflectedView, float shadow);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 reflectedView);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 reflectedView, float shadow, inout vec3 ambientLight);
+float CalcDirectionalShadow(int lightIndex, vec3 normal, vec3 lightDir);
+float CalcSpotShadow(vec3 normal, vec3 lightDir);
+vec3 CalcBakedLighting(vec3 normal, vec3 fragPos, vec3 reflectedView, vec3 ambientColor);
+vec3 CalcSpecular(vec3 lightSpecular, vec3 lightDir, vec3 reflectedView);
+
+// The terms every light shares are worked out once per fragment - the texture is
+// fetched once for the ambient light and again for the base color only when the
+// UV scale changes it, the ambient light of all lights is summed before it is
+// multiplied by the ambient color, and the view is reflected once instead of every
+// light direction. dot(viewDir, reflect(-lightDir, n)) equals
+// dot(reflect(-viewDir, n), lightDir), so the highlights stay the same. The light
+// directions arrive normalized.
 void main()
 {
+    material = materials[clamp(materialIndex, 0, MAX_MATERIALS - 1)];
+
     vec3 norm = normalize(fragmentVertexNormal);
-    vec3 viewDir = normalize(viewPosition - fragmentPosition);
+    vec3 viewDir = normalize(viewPositions[fragmentViewIndex] - fragmentPosition);
+    vec3 reflectedView = reflect(-viewDir, norm);
+
+    // The ambient light takes the texture without the UV scale
+    vec3 ambientColor = vec3(objectColor);
+    vec3 baseColor = ambientColor;
+    if(bUseTexture == true)
+    {
+        ambientColor = vec3(texture(objectTexture, vec3(fragmentTextureCoordinate, textureLayer)));
+        baseColor = ambientColor;
+        if(UVscale != vec2(1.0))
+        {
+            baseColor = vec3(texture(objectTexture, vec3(fragmentTextureCoordinate * UVscale, textureLayer)));
+        }
+    }
 
     vec3 lightingResult = vec3(0.0f);
 
-    if(bUseLighting == true)
+    if((bUseLighting == true) && (bBakedLighting == true))
     {
+        // static objects only add the highlights to the baked light
+        lightingResult = CalcBakedLighting(norm, fragmentPosition, reflectedView, ambientColor);
+    }
+    else if(bUseLighting == true)
+    {
+        vec3 ambientLight = vec3(0.0f);
+
         // Phase 1: directional lighting (two lights)
         if(directionalLight1.bActive == true)
         {
-            lightingResult += CalcDirectionalLight(directionalLight1, norm, viewDir);
+            float shadow = CalcDirectionalShadow(0, norm, -directionalLight1.direction);
+            ambientLight += directionalLight1.ambient;
+            lightingResult += CalcDirectionalLight(directionalLight1, norm, reflectedView, shadow);
         }
         if(directionalLight2.bActive == true)
         {
-            lightingResult += CalcDirectionalLight(directionalLight2, norm, viewDir);
+            float shadow = CalcDirectionalShadow(1, norm, -directionalLight2.direction);
+            ambientLight += directionalLight2.ambient;
+            lightingResult += CalcDirectionalLight(directionalLight2, norm, reflectedView, shadow);
         }
 
         // Phase 2: point lights (now processing four lights)
@@ -96,7 +167,8 @@ void main()
         {
             if(pointLights[i].bActive == true)
             {
-                lightingResult += CalcPointLight(pointLights[i], norm, fragmentPosition, viewDir);   
+                ambientLight += pointLights[i].ambient;
+                lightingResult += CalcPointLight(pointLights[i], norm, fragmentPosition, reflectedView);
             }
         }
 
@@ -105,20 +177,13 @@ void main()
         {
             if(spotLights[i].bActive == true)
             {
-                lightingResult += CalcSpotLight(spotLights[i], norm, fragmentPosition, viewDir);    
+                // only the first spotlight has a shadow map
+                float shadow = (i == 0) ? CalcSpotShadow(norm, normalize(spotLights[i].position - fragmentPosition)) : 0.0;
+                lightingResult += CalcSpotLight(spotLights[i], norm, fragmentPosition, reflectedView, shadow, ambientLight);
             }
         }
-    }
 
-    // Final color calculation with or without texture
-    vec3 baseColor;
-    if(bUseTexture == true)
-    {
-        baseColor = vec3(texture(objectTexture, fragmentTextureCoordinate * UVscale));
-    }
-    else
-    {
-        baseColor = vec3(objectColor);
+        lightingResult += ambientLight * ambientColor;
     }
 
     // Mix lighting result with the base color
@@ -127,73 +192,207 @@ void main()
     fragmentColor = vec4(finalColor, 1.0f);  // Alpha is set to 1 for solid objects
 }
 
-// Calculates the color when using a directional light.
-vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir)
+// Calculates the diffuse and specular color of a directional light, the ambient
+// light is added by the caller.
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 reflectedView, float shadow)
 {
-    vec3 lightDir = normalize(-light.direction);
-    
-    // Ambient
-    vec3 ambient = light.ambient * (bUseTexture ? vec3(texture(objectTexture, fragmentTextureCoordinate)) : vec3(objectColor));
+    vec3 lightDir = -light.direction;
 
     // Diffuse
     float diff = max(dot(normal, lightDir), 0.0);
     vec3 diffuse = light.diffuse * diff * material.diffuseColor;
 
     // Specular (stronger specular for reflective surfaces)
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = light.specular * spec * material.specularColor;
+    vec3 specular = CalcSpecular(light.specular, lightDir, reflectedView);
 
-    return (ambient + diffuse + specular);  // Return specular lighting result as part of the light
+    // Shadowed fragments only keep the ambient term
+    return (diffuse + specular) * (1.0 - shadow);
 }
 
-// Calculates the color when using a point light.
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+// Calculates the diffuse and specular color of a point light, the ambient light is
+// added by the caller.
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 reflectedView)
 {
     vec3 lightDir = normalize(light.position - fragPos);
 
-    // Ambient
-    vec3 ambient = light.ambient * (bUseTexture ? vec3(texture(objectTexture, fragmentTextureCoordinate)) : vec3(objectColor));
-
     // Diffuse
     float diff = max(dot(normal, lightDir), 0.0);
     vec3 diffuse = light.diffuse * diff * material.diffuseColor;
 
     // Specular
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = light.specular * spec * material.specularColor;
+    vec3 specular = CalcSpecular(light.specular, lightDir, reflectedView);
 
-    return (ambient + diffuse + specular);
+    return (diffuse + specular);
 }
 
-// Calculates the color when using a spotlight.
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+// Calculates the diffuse and specular color of a spotlight, and adds its
+// attenuated ambient light to the ambient light of the fragment.
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 reflectedView, float shadow, inout vec3 ambientLight)
 {
-    vec3 lightDir = normalize(light.position - fragPos);
+    // The distance and the direction share one square root
+    vec3 toLight = light.position - fragPos;
+    float distanceSquared = dot(toLight, toLight);
+    float inverseDistance = inversesqrt(distanceSquared);
+    vec3 lightDir = toLight * inverseDistance;
+    float distance = distanceSquared * inverseDistance;
 
     // Diffuse shading
     float diff = max(dot(normal, lightDir), 0.0);
     vec3 diffuse = light.diffuse * diff * material.diffuseColor;
 
     // Specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    vec3 specular = light.specular * spec * material.specularColor;
+    vec3 specular = CalcSpecular(light.specular, lightDir, reflectedView);
 
     // Attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * distanceSquared);
 
     // Spotlight intensity
-    float theta = dot(lightDir, normalize(-light.direction));
+    float theta = dot(lightDir, -light.direction);
     float epsilon = light.cutOff - light.outerCutOff;
     float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
 
     // Combine results
-    vec3 ambient = light.ambient * (bUseTexture ? vec3(texture(objectTexture, fragmentTextureCoordinate)) : vec3(objectColor));
-    diffuse *= intensity;
-    specular *= intensity;
+    ambientLight += light.ambient * attenuation;
+    return (diffuse + specular) * (intensity * (1.0 - shadow) * attenuation);
+}
+
+// Calculates how much a fragment is in the shadow of a directional light.
+float CalcDirectionalShadow(int lightIndex, vec3 normal, vec3 lightDir)
+{
+    if(bUseShadows == false)
+    {
+        return 0.0;
+    }
+
+    // Pick the cascade that covers the fragment, nothing beyond the last one is shadowed
+    int cascade = -1;
+    for(int i = NUM_CASCADES - 1; i >= 0; i--)
+    {
+        if(fragmentViewDepth < cascadeSplits[i])
+        {
+            cascade = i;
+        }
+    }
+    if(cascade < 0)
+    {
+        return 0.0;
+    }
+
+    // The cascades are fitted to the first view, so a fragment of another view can lie
+    // outside of the cascade its depth picks - the next larger cascade that covers it is used
+    vec2 texelSize = 1.0 / vec2(textureSize(directionalShadowMaps, 0).xy);
+    int layer = 0;
+    vec3 shadowCoord = vec3(0.0);
+    for(; cascade < NUM_CASCADES; cascade++)
+    {
+        layer = (lightIndex * NUM_CASCADES) + cascade;
+        vec4 lightSpacePosition = directionalLightSpace[layer] * vec4(fragmentPosition, 1.0);
+        shadowCoord = (lightSpacePosition.xyz / lightSpacePosition.w) * 0.5 + 0.5;
+        if(all(greaterThanEqual(shadowCoord.xy, texelSize)) && all(lessThanEqual(shadowCoord.xy, 1.0 - texelSize)))
+        {
+            break;
+        }
+    }
+    if((cascade >= NUM_CASCADES) || (shadowCoord.z > 1.0))
+    {
+        return 0.0;
+    }
+
+    // Slope scaled bias against shadow acne
+    float bias = max(0.0015 * (1.0 - dot(normal, lightDir)), 0.0003);
+
+    // 3x3 percentage closer filtering on top of the hardware comparison
+    float lit = 0.0;
+    for(int x = -1; x <= 1; x++)
+    {
+        for(int y = -1; y <= 1; y++)
+        {
+            lit += texture(directionalShadowMaps, vec4(shadowCoord.xy + vec2(x, y) * texelSize, float(layer), shadowCoord.z - bias));
+        }
+    }
+
+    return 1.0 - (lit / 9.0);
+}
+
+// Calculates how much a fragment is in the shadow of the spotlight.
+float CalcSpotShadow(vec3 normal, vec3 lightDir)
+{
+    if(bUseShadows == false)
+    {
+        return 0.0;
+    }
+
+    vec4 lightSpacePosition = spotLightSpace * vec4(fragmentPosition, 1.0);
+    vec3 shadowCoord = (lightSpacePosition.xyz / lightSpacePosition.w) * 0.5 + 0.5;
+    if((lightSpacePosition.w <= 0.0) || (shadowCoord.z > 1.0))
+    {
+        return 0.0;
+    }
+
+    float bias = max(0.0005 * (1.0 - dot(normal, lightDir)), 0.00005);
+
+    vec2 texelSize = 1.0 / vec2(textureSize(spotShadowMap, 0));
+    float lit = 0.0;
+    for(int x = -1; x <= 1; x++)
+    {
+        for(int y = -1; y <= 1; y++)
+        {
+            lit += texture(spotShadowMap, vec3(shadowCoord.xy + vec2(x, y) * texelSize, shadowCoord.z - bias));
+        }
+    }
+
+    return 1.0 - (lit / 9.0);
+}
+
+// Calculates the specular highlight of a light from the view reflected around the
+// normal.
+vec3 CalcSpecular(vec3 lightSpecular, vec3 lightDir, vec3 reflectedView)
+{
+    float spec = pow(max(dot(reflectedView, lightDir), 0.0), material.shininess);
+    return lightSpecular * spec * material.specularColor;
+}
+
+// Calculates the color of a static object from its baked lighting. The ambient and
+// diffuse light come from the vertices, only the highlights depend on the view. The
+// shadows of the directional lights and the first spotlight are baked into the visibility.
+vec3 CalcBakedLighting(vec3 normal, vec3 fragPos, vec3 reflectedView, vec3 ambientColor)
+{
+    vec3 result = (fragmentBakedAmbient * ambientColor) + fragmentBakedDiffuse;
+
+    if(directionalLight1.bActive == true)
+    {
+        result += CalcSpecular(directionalLight1.specular, -directionalLight1.direction, reflectedView) * fragmentLightVisibility.x;
+    }
+    if(directionalLight2.bActive == true)
+    {
+        result += CalcSpecular(directionalLight2.specular, -directionalLight2.direction, reflectedView) * fragmentLightVisibility.y;
+    }
+
+    for(int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+    {
+        if(pointLights[i].bActive == true)
+        {
+            result += CalcSpecular(pointLights[i].specular, normalize(pointLights[i].position - fragPos), reflectedView);
+        }
+    }
+
+    for(int i = 0; i < TOTAL_SPOT_LIGHTS; i++)
+    {
+        if(spotLights[i].bActive == true)
+        {
+            vec3 toLight = spotLights[i].position - fragPos;
+            float distanceSquared = dot(toLight, toLight);
+            float inverseDistance = inversesqrt(distanceSquared);
+            vec3 lightDir = toLight * inverseDistance;
+            float distance = distanceSquared * inverseDistance;
+            float attenuation = 1.0 / (spotLights[i].constant + spotLights[i].linear * distance + spotLights[i].quadratic * distanceSquared);
+            float theta = dot(lightDir, -spotLights[i].direction);
+            float epsilon = spotLights[i].cutOff - spotLights[i].outerCutOff;
+            float intensity = clamp((theta - spotLights[i].outerCutOff) / epsilon, 0.0, 1.0);
+            float visibility = (i == 0) ? fragmentLightVisibility.z : 1.0;
+            result += CalcSpecular(spotLights[i].specular, lightDir, reflectedView) * intensity * attenuation * visibility;
+        }
+    }
 
-    return (ambient + diffuse + specular) * attenuation;
+    return result;
 }
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 inVertexPosition;
+
+uniform mat4 model;
+uniform mat4 lightSpace;
+
+// packed vertices store the position relative to the mesh bounds
+uniform bool bPackedVertices = false;
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+void main()
+{
+   vec3 position = inVertexPosition;
+   if (bPackedVertices)
+   {
+      position = positionOffset + (inVertexPosition * positionScale);
+   }
+
+   gl_Position = lightSpace * model * vec4(position, 1.0f);
+}
@@ -0,0 +1,38 @@
+#version 330 core
+out vec4 fragmentColor;
+
+in vec2 fragmentTextureCoordinate;
+
+uniform sampler2D sourceTexture;
+// part of the source texture holding the scaled scene
+uniform vec2 sourceScale;
+uniform vec2 sourceTexelSize;
+// strength of the sharpening, 0 turns it off
+uniform float sharpness;
+
+// sample the scaled scene, keeping the filter from reading
+// past the part of the texture that was drawn
+vec3 SampleScene(vec2 uv)
+{
+    uv = clamp(uv, sourceTexelSize * 0.5f, sourceScale - sourceTexelSize * 0.5f);
+    return texture(sourceTexture, uv).rgb;
+}
+
+void main()
+{
+    vec2 uv = fragmentTextureCoordinate * sourceScale;
+
+    vec3 center = SampleScene(uv);
+    vec3 north = SampleScene(uv + vec2(0.0f, sourceTexelSize.y));
+    vec3 south = SampleScene(uv - vec2(0.0f, sourceTexelSize.y));
+    vec3 east = SampleScene(uv + vec2(sourceTexelSize.x, 0.0f));
+    vec3 west = SampleScene(uv - vec2(sourceTexelSize.x, 0.0f));
+
+    // push the center away from its neighbours, then keep it
+    // inside their range so the edges do not ring
+    vec3 sharpened = center + (4.0f * center - (north + south + east + west)) * (sharpness * 0.25f);
+    vec3 minimum = min(center, min(min(north, south), min(east, west)));
+    vec3 maximum = max(center, max(max(north, south), max(east, west)));
+
+    fragmentColor = vec4(clamp(sharpened, minimum, maximum), 1.0f);
+}
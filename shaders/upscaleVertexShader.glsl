@@ -0,0 +1,11 @@
+#version 330 core
+out vec2 fragmentTextureCoordinate;
+
+void main()
+{
+   // one triangle covering the whole window, made from the
+   // vertex index so no vertex buffer is needed
+   vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+   fragmentTextureCoordinate = corner;
+   gl_Position = vec4(corner * 2.0f - 1.0f, 0.0f, 1.0f);
+}
@@ -1,20 +1,91 @@
 #version 330 core
+// lets the vertex shader pick the viewport of each view
+#extension GL_ARB_shader_viewport_layer_array : enable
 layout (location = 0) in vec3 inVertexPosition;
 layout (location = 1) in vec3 inVertexNormal;
 layout (location = 2) in vec2 inTextureCoordinate;
+// lighting baked into the vertices of static objects
+layout (location = 3) in vec3 inBakedAmbient;
+layout (location = 4) in vec3 inBakedDiffuse;
+layout (location = 5) in vec4 inLightVisibility;
 
 out vec3 fragmentPosition;
 out vec3 fragmentVertexNormal;
 out vec2 fragmentTextureCoordinate;
+out float fragmentViewDepth;
+flat out int fragmentViewIndex;
+out vec3 fragmentBakedAmbient;
+out vec3 fragmentBakedDiffuse;
+out vec4 fragmentLightVisibility;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// per-object values written into the dynamic upload buffer, or
+// once into the static object buffer for static objects
+layout (std140) uniform ObjectData
+{
+   mat4 model;
+   vec4 objectColor;
+   vec2 UVscale;
+   int materialIndex;
+   bool bUseTexture;
+   // layer of the texture in the array bound to objectTexture
+   int textureLayer;
+   // lit by the baked vertex lighting instead of the lights
+   bool bBakedLighting;
+};
+
+// cameras of the views drawn in this frame - a draw goes
+// into firstView, and instanced draws go into one view per
+// instance
+#define MAX_VIEWS 4
+uniform mat4 views[MAX_VIEWS];
+uniform mat4 projections[MAX_VIEWS];
+uniform int firstView = 0;
+// true when every view has its own indexed viewport
+uniform bool bViewportArray = false;
+
+// packed vertices store the position relative to the mesh
+// bounds and the normal as two octahedral coordinates
+uniform bool bPackedVertices = false;
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+vec3 DecodeOctahedral(vec2 encoded)
+{
+   vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+   float fold = max(-normal.z, 0.0);
+   normal.x += (normal.x >= 0.0) ? -fold : fold;
+   normal.y += (normal.y >= 0.0) ? -fold : fold;
+   return normalize(normal);
+}
 
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = inVertexNormal;
+   vec3 position = inVertexPosition;
+   vec3 normal = inVertexNormal;
+   if (bPackedVertices)
+   {
+      position = positionOffset + (inVertexPosition * positionScale);
+      normal = DecodeOctahedral(inVertexNormal.xy);
+   }
+
+   int viewIndex = clamp(firstView + gl_InstanceID, 0, MAX_VIEWS - 1);
+   vec4 worldPosition = model * vec4(position, 1.0f);
+
+   fragmentPosition = vec3(worldPosition);
+   gl_Position = projections[viewIndex] * views[viewIndex] * worldPosition;
+   fragmentVertexNormal = normal;
    fragmentTextureCoordinate = inTextureCoordinate;
+   // the shadow cascade is picked by the depth in the view
+   // the fragment is drawn into
+   fragmentViewDepth = -(views[viewIndex] * worldPosition).z;
+   fragmentViewIndex = viewIndex;
+   fragmentBakedAmbient = inBakedAmbient;
+   fragmentBakedDiffuse = inBakedDiffuse;
+   fragmentLightVisibility = inLightVisibility;
+#ifdef GL_ARB_shader_viewport_layer_array
+   if (bViewportArray)
+   {
+      gl_ViewportIndex = viewIndex;
+   }
+#endif
 }
\ No newline at end of file